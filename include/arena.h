@@ -0,0 +1,91 @@
+/**
+ * @file arena.h
+ * @brief Header file for the ARENA bump allocator. The implementation is in
+ * src/modules/arena.c.
+ *
+ * @description:
+ * A job that produces many small objects with the same lifetime, like the
+ * VX_OBJ headers, y strings and prime gaps of a range of segments, pays a heap
+ * call per object and has to free each one. An ARENA hands out memory from
+ * large blocks by bumping an offset, and releases everything at once.
+ *
+ * Blocks grow geometrically: a block that can't fit a request is followed by
+ * one at least twice its size, so a job of any length makes O(log) heap calls.
+ * Allocations are aligned to ARENA_ALIGN bytes and can't be freed individually.
+ *
+ * @usage:
+ * ARENA *arena = arena_create(1 << 20);       // First block of 1 MB
+ * VX_OBJ *vx_obj = arena_alloc(arena, sizeof(VX_OBJ));
+ * arena_free(arena);                          // Releases every allocation
+ *
+ * @api:
+ * - @arena_create: Creates an arena with a first block of the given size.
+ * - @arena_alloc: Allocates a number of bytes from the arena.
+ * - @arena_reset: Discards all allocations, keeping the largest block for reuse.
+ * - @arena_free: Frees the arena and all of its blocks.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <utils.h>
+
+#define ARENA_ALIGN 16 ///< Alignment of every arena allocation, in bytes
+
+/**
+ * @struct ARENA_BLOCK
+ * @brief A block of arena memory, linked to the previously filled blocks.
+ */
+typedef struct ARENA_BLOCK
+{
+    struct ARENA_BLOCK *next; ///< Previously filled block, NULL for the first one.
+    size_t capacity;          ///< Usable bytes in data.
+    size_t used;              ///< Bytes handed out from data.
+    unsigned char *data;      ///< Start of the usable memory, ARENA_ALIGN aligned.
+} ARENA_BLOCK;
+
+/**
+ * @struct ARENA
+ * @brief A bump allocator over a list of blocks.
+ *
+ * @param head The current block, where allocations are made.
+ * @param allocated The total number of bytes handed out.
+ */
+typedef struct
+{
+    ARENA_BLOCK *head; ///< Current block.
+    size_t allocated;  ///< Total bytes handed out.
+} ARENA;
+
+/**
+ * @brief Creates an arena with a first block of block_size bytes.
+ *
+ * @param block_size The usable size of the first block.
+ * @return A pointer to the new ARENA, or NULL if memory allocation fails.
+ */
+ARENA *arena_create(size_t block_size);
+
+/**
+ * @brief Allocates size bytes from the arena, aligned to ARENA_ALIGN.
+ *
+ * @param arena A pointer to the ARENA.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to uninitialized memory owned by the arena, or NULL if memory allocation fails.
+ */
+void *arena_alloc(ARENA *arena, size_t size);
+
+/**
+ * @brief Discards all allocations of the arena, keeping its current (largest) block for reuse.
+ *
+ * @param arena A pointer to the ARENA.
+ */
+void arena_reset(ARENA *arena);
+
+/**
+ * @brief Frees the arena and all memory allocated from it.
+ *
+ * @param arena A pointer to the ARENA, may be NULL.
+ */
+void arena_free(ARENA *arena);
+
+#endif // ARENA_H
@@ -10,11 +10,19 @@
  * evaluation and comparison of different sieve algorithms.
  *
  * @api: This section describes the functions available for benchmarking sieve algorithms.
+ * - @bench_measure: Times a function by the monotonic clock over warmup and repeated runs (BENCH_STATS).
+ * - @bench_memory_begin, @bench_memory_end: Measure the peak RSS and the peak library bytes of a run (BENCH_MEMORY).
+ * - @bench_report_write: Writes the rows of a BENCH_REPORT as CSV or JSON for the plot scripts.
  * - @test_sieve_integrity: Tests the integrity of the sieve algorithms by comparing their results.
  * - @measure_sieve_time: Measures the execution time to compute primes up to a given limit using a sieve model.
  * - @benchmark_sieve_models: Benchmarks the sieve algorithms for a given range of exponents.
  * - @benchmark_sieve_vx6: Benchmarks the sieve_vx function by measuring its execution time and printing results.
+ * - @benchmark_vx_range_scaling: Benchmarks the thread scaling of sieve_vx6_range_parallel.
+ * - @benchmark_sieve_calibration: Times the sieve engines and prints the calibration table of iz_sieve_plan.
  * - @benchmark_prime_gen_methods: Benchmarks random prime generation algorithms for performance evaluation.
+ * - @benchmark_bitmap_primitives: Times the bitmap kernels in ns per bit or per mark, from L1 to DRAM sizes.
+ * - @benchmark_perf_counters: Reports hardware counters per library phase, per prime or per segment.
+ * - @benchmark_thread_scaling: Sweeps the parallel paths over 1, 2, 4, ... threads: speedup, efficiency, CPU use.
  *
  * @note: Developers looking to extend or modify the library can use these tools for performance
  * evaluation and comparison of different sieve algorithms.
@@ -42,6 +50,151 @@ typedef struct
     int models_count;
 } SieveModels;
 
+/**
+ * @b Benchmark_Harness
+ * @brief Wall-clock timing over repeated runs, shared by the benchmark tools.
+ *
+ * Every timing is a sample of CLOCK_MONOTONIC around one run, after untimed warmup
+ * runs, and a measurement is summarized by the statistics of its samples, so that
+ * a speedup can be told from noise by comparing the spread of two measurements.
+ *
+ * The memory of a measurement is its peak resident set size, reset before the runs
+ * through /proc/self/clear_refs where the kernel allows it, and the peak bytes held
+ * by the library allocations of mem_alloc and the arenas (see mem_alloc.h), which
+ * do not count what the allocator keeps or the code and stacks.
+ */
+
+#define BENCH_WARMUP_RUNS 1 ///< Default untimed runs before a measurement
+#define BENCH_RUNS 5        ///< Default timed runs of a measurement
+#define BENCH_NAME_SIZE 64  ///< Size of the name of a report row
+
+// Function timed by bench_measure, run < 0 for the warmup runs
+typedef void (*bench_fn)(void *ctx, int run);
+
+/**
+ * @struct BENCH_STATS
+ * @brief Summary of the timing samples of a measurement, in seconds.
+ */
+typedef struct
+{
+    int runs;      ///< Number of samples
+    double min;    ///< Fastest run
+    double median; ///< Median run
+    double p95;    ///< 95th percentile (nearest rank)
+    double mean;   ///< Mean of the runs
+    double stddev; ///< Sample standard deviation
+    double max;    ///< Slowest run
+} BENCH_STATS;
+
+/**
+ * @struct BENCH_MEMORY
+ * @brief Memory high-water marks of a measurement, in bytes.
+ */
+typedef struct
+{
+    uint64_t peak_rss;   ///< Peak resident set size of the process
+    uint64_t peak_bytes; ///< Peak library bytes above those live at bench_memory_begin
+    uint64_t base_bytes; ///< Library bytes live at bench_memory_begin
+    int is_rss_reset;    ///< Whether peak_rss was reset at bench_memory_begin, else it is that of the process
+} BENCH_MEMORY;
+
+/**
+ * @struct BENCH_ROW
+ * @brief A measurement of a benchmark report.
+ */
+typedef struct
+{
+    char name[BENCH_NAME_SIZE]; ///< Benchmarked operation
+    uint64_t n;                 ///< Size of the problem: sieve limit, bit size, ...
+    int threads;                ///< Threads of the runs
+    BENCH_STATS stats;          ///< Timing summary
+    BENCH_MEMORY memory;        ///< Memory high-water marks, zero if not measured
+} BENCH_ROW;
+
+/**
+ * @struct BENCH_REPORT
+ * @brief Growable list of measurements, zero-initialized before use.
+ */
+typedef struct
+{
+    BENCH_ROW *rows; ///< The measurements
+    int count;       ///< Number of rows
+    int capacity;    ///< Allocated rows
+} BENCH_REPORT;
+
+/**
+ * @brief Returns the time of the monotonic clock, in seconds.
+ */
+double bench_now(void);
+
+/**
+ * @brief Summarizes timing samples by min, median, p95, mean, stddev and max.
+ *
+ * @param samples The samples in seconds.
+ * @param count The number of samples.
+ * @param stats Receives the summary.
+ * @return int 1 on success, 0 if count < 1 or memory allocation fails.
+ */
+int bench_stats_compute(const double *samples, int count, BENCH_STATS *stats);
+
+/**
+ * @brief Times fn(ctx, run) over warmup untimed runs, then runs timed runs.
+ *
+ * @param fn The function to time.
+ * @param ctx The context passed to fn.
+ * @param warmup The number of untimed runs.
+ * @param runs The number of timed runs, at least 1.
+ * @param samples Receives the samples in seconds, may be NULL.
+ * @param stats Receives the summary of the samples.
+ * @return int 1 on success, 0 on failure.
+ */
+int bench_measure(bench_fn fn, void *ctx, int warmup, int runs, double *samples, BENCH_STATS *stats);
+
+/**
+ * @brief Returns the peak resident set size of the process, in bytes.
+ */
+uint64_t bench_peak_rss(void);
+
+/**
+ * @brief Starts measuring the memory of a run: resets the peak RSS and the peaks of the library bytes.
+ *
+ * @param memory Receives the baseline.
+ */
+void bench_memory_begin(BENCH_MEMORY *memory);
+
+/**
+ * @brief Reads the peak RSS and the peak library bytes since bench_memory_begin.
+ *
+ * @param memory The measurement started by bench_memory_begin.
+ */
+void bench_memory_end(BENCH_MEMORY *memory);
+
+/**
+ * @brief Appends a measurement to a report.
+ *
+ * @param memory The memory of the runs, may be NULL if not measured.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+int bench_report_add(BENCH_REPORT *report, const char *name, uint64_t n, int threads,
+                     const BENCH_STATS *stats, const BENCH_MEMORY *memory);
+
+/**
+ * @brief Writes a report as JSON if file_path ends with ".json", as CSV otherwise.
+ *
+ * @return int 1 on success, 0 on failure.
+ */
+int bench_report_write(const BENCH_REPORT *report, const char *file_path);
+
+/**
+ * @brief Frees the rows of a report.
+ */
+void bench_report_free(BENCH_REPORT *report);
+
+/**
+ * @brief Builds the path DIR_output/<prefix>_<timestamp>.<ext>, creating the output directory.
+ */
+void bench_output_path(char *file_path, size_t size, const char *prefix, const char *ext);
+
 /**
  * @b Sieve_Algorithms
  * @brief List of sieve algorithms available for benchmarking.
@@ -57,6 +210,8 @@ extern SieveAlgorithm SieveOfEuler;
 extern SieveAlgorithm SieveOfAtkin;
 extern SieveAlgorithm Sieve_iZ;
 extern SieveAlgorithm Sieve_iZm;
+extern SieveAlgorithm SieveWheel30;
+extern SieveAlgorithm SieveLinear;
 
 /**
  * @b Benchmarking_Tools
@@ -86,15 +241,18 @@ int test_sieve_integrity(SieveModels sieve_models, uint64_t n);
 /**
  * @brief Measure the execution time for a sieve algorithm.
  *
- * This function runs the sieve algorithm for a given upper limit `n` and measures the time taken
- * to compute the primes up to that limit. It prints the algorithm name, the value of `n`,
- * and the execution time in milliseconds.
+ * This function runs the sieve algorithm for a given upper limit `n` BENCH_WARMUP_RUNS
+ * untimed and BENCH_RUNS timed times, and prints the algorithm name, the value of `n`,
+ * the min, median, p95 and standard deviation of the wall-clock time in seconds, the
+ * peak RSS, the auxiliary library bytes beyond the prime array and the bytes per prime.
  *
  * @param sieve_model The sieve algorithm to be used for measuring time.
  * @param n The upper limit for prime number generation.
- * @return size_t The execution time in milliseconds.
+ * @param stats Receives the timing summary, may be NULL.
+ * @param memory Receives the memory high-water marks, may be NULL.
+ * @return size_t The median execution time in microseconds.
  */
-size_t measure_sieve_time(SieveAlgorithm sieve_model, uint64_t n);
+size_t measure_sieve_time(SieveAlgorithm sieve_model, uint64_t n, BENCH_STATS *stats, BENCH_MEMORY *memory);
 
 /**
  * @brief Benchmark the sieve algorithms for a given range of exponents.
@@ -109,7 +267,7 @@ size_t measure_sieve_time(SieveAlgorithm sieve_model, uint64_t n);
  * @param base The base value to be raised to the power of exponents.
  * @param min_exp The minimum exponent value.
  * @param max_exp The maximum exponent value.
- * @param save_results A flag indicating whether to save the results to a file named by timestamp in the output directory.
+ * @param save_results A flag indicating whether to save the results to a CSV file named by timestamp in the output directory.
  */
 void benchmark_sieve_models(SieveModels sieve_models, int base, int min_exp, int max_exp, int save_results);
 
@@ -126,6 +284,30 @@ void benchmark_sieve_models(SieveModels sieve_models, int base, int min_exp, int
  */
 void test_sieve_vx6(char *y, char *filename);
 
+/**
+ * @brief Benchmark the thread scaling of sieve_vx6_range_parallel.
+ *
+ * This function sieves the same range of VX6 segments with 1, 2, 4, ... up to
+ * max_threads threads, and prints the wall-clock time, throughput, speedup and
+ * parallel efficiency of each thread count, with the workers placed on each NUMA node.
+ *
+ * @param start_y Pointer to a numeric string representing the first y value in iZm.
+ * @param range_y The number of VX6 segments to be sieved.
+ * @param max_threads The largest thread count, 0 for one per online CPU.
+ */
+void benchmark_vx_range_scaling(char *start_y, int range_y, int max_threads);
+
+/**
+ * @brief Calibrates iz_sieve_plan and prints the calibration table for sieve_auto.c.
+ *
+ * Times every sieve engine single-threaded at n = 10^3, ..., 10^max_exp, sweeps the
+ * wheel-30 segment size where it wins, and prints the fastest engine per range of n
+ * as IZ_SIEVE_CALIBRATION rows.
+ *
+ * @param max_exp The largest exponent of 10, from 3 to 12.
+ */
+void benchmark_sieve_calibration(int max_exp);
+
 /**
  * @brief Benchmark random prime generation algorithms.
  *
@@ -139,4 +321,45 @@ void test_sieve_vx6(char *y, char *filename);
  */
 void benchmark_prime_gen_methods(int bit_size, int test_rounds, int save_results);
 
+/**
+ * @brief Benchmark the BITMAP primitives on their own.
+ *
+ * This function times bitmap_clear_mod_p over small, medium and large step sizes,
+ * bitmap_clear_pattern, the extraction of set bits by bitmap_scan_next, bitmap_popcount,
+ * bitmap_clone, bitmap_copy, bitmap_duplicate_segment and bitmap_compute_hash, on bitmaps
+ * sized to fit the L1, L2 and L3 caches and to spill to DRAM, and prints their cost in
+ * ns per bit, or per mark for the clearing kernels.
+ *
+ * @param max_bytes The largest bitmap size in bytes, 0 for no limit.
+ * @param save_results A flag indicating whether to save the results to a CSV file in the output directory.
+ */
+void benchmark_bitmap_primitives(size_t max_bytes, int save_results);
+
+/**
+ * @brief Benchmark the library phases with hardware performance counters.
+ *
+ * This function runs sieve_iZm, sieve_vx6_range below and above the root primes limit,
+ * random_iZprime on one core and the file I/O of a PRIMES_OBJ between iz_perf_start and
+ * iz_perf_stop, and prints the cycles, instructions, L1D, LLC, branch and dTLB misses of
+ * each phase per prime or per segment (see perf_counters.h). The phases are reported
+ * when the library is built with make IZ_PERF=1.
+ *
+ * @param quick If nonzero, runs smaller inputs.
+ */
+void benchmark_perf_counters(int quick);
+
+/**
+ * @brief Benchmark the thread scaling of the parallel paths of the library.
+ *
+ * This function runs random_iZprime (its forked search), sieve_vx6_range_parallel,
+ * sieve_wheel30_count and iz_factor_u64_batch at 1, 2, 4, ... up to max_threads threads,
+ * and prints the throughput, speedup, parallel efficiency and CPU utilization of each
+ * thread count, read by plot_scaling_results.py from the saved CSV.
+ *
+ * @param max_threads The largest thread count, 0 for one per online CPU.
+ * @param quick If nonzero, runs smaller inputs.
+ * @param save_results A flag indicating whether to save the results to a CSV file in the output directory.
+ */
+void benchmark_thread_scaling(int max_threads, int quick, int save_results);
+
 #endif
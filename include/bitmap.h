@@ -25,6 +25,10 @@
  * - @bitmap_flip_bit: Flips the value of a specific bit.
  * - @bitmap_clear_bit: Clears a specific bit in the bitmap (sets it to 0).
  * - @bitmap_clear_mod_p: Clears bits in the bitmap from a given index to a limit with a step size.
+ * - @bitmap_pattern_init: Precomputes the 64-bit word masks of a small step size.
+ * - @bitmap_clear_pattern: Clears the bits of bitmap_clear_mod_p a word at a time, from a precomputed pattern.
+ * - @bitmap_popcount: Counts the set bits in the bitmap.
+ * - @bitmap_scan_next: Finds the next set bit at or after a given index.
  * - @bitmap_clone: Creates a clone of the given bitmap.
  * - @bitmap_copy: Copies a segment of bits from one bitmap to another.
  * - @bitmap_duplicate_segment: Duplicates a segment of bits within the bitmap.
@@ -43,6 +47,8 @@
 
 #define BITMAP_EXT "bitmap"
 
+#define BITMAP_PATTERN_MAX_P 128 ///< Step sizes below this are cleared by word patterns
+
 /**
  * @struct BITMAP
  * @brief Structure representing a bitmap for prime sieve applications.
@@ -138,6 +144,64 @@ void bitmap_clear_bit(BITMAP *bitmap, size_t idx);
  */
 void bitmap_clear_mod_p(BITMAP *bitmap, uint64_t p, size_t start_idx, size_t limit);
 
+/**
+ * @struct BITMAP_PATTERN
+ * @brief Word masks of an odd step size p < BITMAP_PATTERN_MAX_P, for word-at-a-time clearing.
+ *
+ * A small step marks every word of a bitmap, and the marks of consecutive words
+ * repeat with a period of p words (64 * p bits). The pattern holds the masks of
+ * the bits to keep in one period, stored twice so that a run of up to p words
+ * from any position never wraps, and the position in the period of the word
+ * whose first mark is at bit r, for each r < p. A pattern is built once and
+ * reused for any number of bitmaps and start indices.
+ *
+ * @param p The step size.
+ * @param cycle The masks of the bits to keep over one period, repeated twice.
+ * @param phase_index The position in the period of the word whose first mark is at bit r.
+ */
+typedef struct
+{
+    uint64_t p;                                      ///< Step size.
+    uint64_t cycle[2 * BITMAP_PATTERN_MAX_P];        ///< Bits to keep in the words of a period, twice.
+    unsigned char phase_index[BITMAP_PATTERN_MAX_P]; ///< Position of the word whose first mark is at bit r.
+} BITMAP_PATTERN;
+
+/**
+ * @brief Precomputes the word masks of a step size p.
+ *
+ * @param pattern A pointer to the BITMAP_PATTERN to initialize.
+ * @param p The step size, odd and 1 < p < BITMAP_PATTERN_MAX_P.
+ */
+void bitmap_pattern_init(BITMAP_PATTERN *pattern, uint64_t p);
+
+/**
+ * @brief Clears bits start_idx, start_idx + p, ... up to limit, like bitmap_clear_mod_p,
+ * with one masked update per 64-bit word.
+ *
+ * @param bitmap A pointer to the BITMAP structure.
+ * @param pattern The precomputed pattern of the step size p.
+ * @param start_idx The starting index for clearing bits.
+ * @param limit The limit on the number of bits to be cleared.
+ */
+void bitmap_clear_pattern(BITMAP *bitmap, const BITMAP_PATTERN *pattern, size_t start_idx, size_t limit);
+
+/**
+ * @brief Counts the set bits in the bitmap.
+ *
+ * @param bitmap A pointer to the BITMAP structure.
+ * @return The number of bits set to 1 among the first bitmap->size bits.
+ */
+size_t bitmap_popcount(BITMAP *bitmap);
+
+/**
+ * @brief Finds the next set bit at or after a given index.
+ *
+ * @param bitmap A pointer to the BITMAP structure.
+ * @param idx The index to start scanning from.
+ * @return The index of the next set bit, or bitmap->size if there is none.
+ */
+size_t bitmap_scan_next(BITMAP *bitmap, size_t idx);
+
 /**
  * @brief Creates a clone of the given bitmap.
  *
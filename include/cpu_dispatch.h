@@ -0,0 +1,107 @@
+
+/**
+ * @file cpu_dispatch.h
+ * @brief Header file for the runtime CPU feature dispatch layer. The implementation
+ * is in src/modules/cpu_dispatch.c.
+ *
+ * @description:
+ * This file declares the CPU_KERNELS table that routes the bitmap hot paths
+ * (popcount and set-bit scanning), and the byte threshold scan of the logarithmic
+ * sieve, to the best implementation available on the running host. CPU features are detected once, on first use,
+ * so a single binary can serve SSE4.2, AVX2 and AVX-512 hosts without `-march=native`.
+ *
+ * The selected level can be forced through the IZ_CPU_DISPATCH environment variable
+ * (generic, sse4.2, avx2, avx512). A forced level above what the host supports is
+ * clamped to the detected level. The selected kernels are self-tested against the
+ * generic ones at init, and the generic table is used if the self-test fails.
+ *
+ * @api:
+ * - @cpu_detect_level: Detects the highest dispatch level supported by the host.
+ * - @cpu_level_to_string: Returns the name of a dispatch level.
+ * - @cpu_kernels_for_level: Returns the kernel table compiled for a given level.
+ * - @cpu_dispatch_self_test: Validates a kernel table against the generic kernels.
+ * - @cpu_dispatch_init: Selects and validates the kernel table of the host (once).
+ * - @cpu_kernels: Returns the active kernel table, initializing it if needed.
+ */
+
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <utils.h>
+
+#define CPU_DISPATCH_ENV "IZ_CPU_DISPATCH" ///< Environment variable to force a dispatch level
+
+/**
+ * @brief Dispatch levels, ordered from the most portable to the most specialized.
+ */
+typedef enum
+{
+    CPU_LEVEL_GENERIC, ///< Portable C kernels
+    CPU_LEVEL_SSE42,   ///< SSE4.2 + POPCNT (64-bit word kernels)
+    CPU_LEVEL_AVX2,    ///< AVX2 (256-bit kernels)
+    CPU_LEVEL_AVX512   ///< AVX-512 F/BW (512-bit kernels)
+} CPU_LEVEL;
+
+/**
+ * @struct CPU_KERNELS
+ * @brief Table of bitmap kernels compiled for one dispatch level.
+ *
+ * @param level The dispatch level of the kernels.
+ * @param popcount Counts the set bits in byte_size bytes of data.
+ * @param scan_next Returns the index of the first set bit in [idx, size), or size if none.
+ * @param scan_ge Returns the index of the first byte >= threshold in [idx, size), or size if none.
+ */
+typedef struct
+{
+    CPU_LEVEL level;
+    size_t (*popcount)(const unsigned char *data, size_t byte_size);
+    size_t (*scan_next)(const unsigned char *data, size_t size, size_t idx);
+    size_t (*scan_ge)(const unsigned char *data, size_t size, size_t idx, unsigned char threshold);
+} CPU_KERNELS;
+
+/**
+ * @brief Detects the highest dispatch level supported by the running host.
+ *
+ * @return The detected CPU_LEVEL, CPU_LEVEL_GENERIC on non-x86 hosts.
+ */
+CPU_LEVEL cpu_detect_level(void);
+
+/**
+ * @brief Returns the name of a dispatch level, as accepted by IZ_CPU_DISPATCH.
+ *
+ * @param level The dispatch level.
+ * @return A constant string naming the level.
+ */
+const char *cpu_level_to_string(CPU_LEVEL level);
+
+/**
+ * @brief Returns the kernel table compiled for the given level.
+ *
+ * @param level The dispatch level. Levels not compiled in fall back to a lower one.
+ * @return A pointer to a static CPU_KERNELS table.
+ */
+const CPU_KERNELS *cpu_kernels_for_level(CPU_LEVEL level);
+
+/**
+ * @brief Validates a kernel table against the generic kernels on a fixed pattern.
+ *
+ * @param kernels The kernel table to validate.
+ * @return 1 if all kernels match the generic results, 0 otherwise.
+ */
+int cpu_dispatch_self_test(const CPU_KERNELS *kernels);
+
+/**
+ * @brief Detects the host level, applies IZ_CPU_DISPATCH and self-tests the selection.
+ *
+ * @note Safe to call multiple times and from multiple threads; the work is done once.
+ */
+void cpu_dispatch_init(void);
+
+/**
+ * @brief Returns the active kernel table, calling cpu_dispatch_init on first use.
+ *
+ * @return A pointer to the active CPU_KERNELS table.
+ */
+const CPU_KERNELS *cpu_kernels(void);
+
+#endif // CPU_DISPATCH_H
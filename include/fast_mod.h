@@ -0,0 +1,67 @@
+/**
+ * @file fast_mod.h
+ * @brief Division-free modular reduction by a precomputed reciprocal.
+ *
+ * @description:
+ * The sieve setup reduces offsets modulo every root prime in every segment.
+ * With the reciprocal p_inv = floor((2^64 - 1) / p) computed once per prime
+ * (and stored in the VX_ASSETS tables), a mod p reduces to a 64x64 -> 128-bit
+ * multiply-high, a multiply-subtract and a single conditional correction,
+ * instead of a hardware 64-bit divide.
+ *
+ * Since p_inv >= 2^64 / p - 1, the estimated quotient q = (a * p_inv) >> 64
+ * satisfies floor(a / p) - 1 <= q <= floor(a / p) for any 64-bit a, hence
+ * a - q * p is in [0, 2p) and one subtraction completes the reduction.
+ *
+ * @api:
+ * - @fast_mod_inv: Computes the reciprocal of a divisor p > 1.
+ * - @fast_mod: Computes a mod p given the reciprocal of p.
+ * - @fast_mod_2_64: Computes 2^64 mod p given the reciprocal of p.
+ */
+
+#ifndef FAST_MOD_H
+#define FAST_MOD_H
+
+#include <stdint.h>
+
+/**
+ * @brief Computes the reciprocal used by fast_mod.
+ *
+ * @param p The divisor, p > 1.
+ * @return uint64_t floor((2^64 - 1) / p)
+ */
+static inline uint64_t fast_mod_inv(uint64_t p)
+{
+    return UINT64_MAX / p;
+}
+
+/**
+ * @brief Computes a mod p by multiply-shift.
+ *
+ * @param a The dividend.
+ * @param p The divisor, p > 1.
+ * @param p_inv The reciprocal fast_mod_inv(p).
+ * @return uint64_t a mod p
+ */
+static inline uint64_t fast_mod(uint64_t a, uint64_t p, uint64_t p_inv)
+{
+    uint64_t q = (uint64_t)(((__uint128_t)a * p_inv) >> 64);
+    uint64_t r = a - q * p;
+    return r >= p ? r - p : r;
+}
+
+/**
+ * @brief Computes 2^64 mod p from the reciprocal, to reduce two-word values.
+ *
+ * @param p The divisor, p > 1.
+ * @param p_inv The reciprocal fast_mod_inv(p).
+ * @return uint64_t 2^64 mod p
+ */
+static inline uint64_t fast_mod_2_64(uint64_t p, uint64_t p_inv)
+{
+    // (2^64 - 1) mod p is exact from p_inv = floor((2^64 - 1) / p)
+    uint64_t r = UINT64_MAX - p * p_inv + 1;
+    return r == p ? 0 : r;
+}
+
+#endif // FAST_MOD_H
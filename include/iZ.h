@@ -15,6 +15,7 @@
  * - @b BITMAP: A structure for efficient bit representation and manipulation. More details in bitmap.h.
  * - @b PRIMES_OBJ: A structure for holding prime numbers and their metadata. More details in primes_obj.h.
  * - @b VX_OBJ: A structure for holding the prime gaps in a VX6 segment and their metadata. More details in vx_obj.h.
+ * - @b CPU_KERNELS: A table of bitmap kernels selected at runtime for the host CPU. More details in cpu_dispatch.h.
  *
  * * ** iZ-based utilities and subroutines:
  * - @b iZ: Computes the value of 6x + i up to 2^64.
@@ -26,6 +27,7 @@
  * - @b normalized_xp: Normalizes x_p based on the p_id and p.
  * - @b solve_for_x: Solves for x given p_id, p, vx, and y.
  * - @b solve_for_x_gmp: Solves for x given p_id, p, vx, and y using GMP.
+ * - @b solve_for_x_mod: Solves for x given p_id, p, and the residue (vx * y) mod p.
  * - @b modular_inverse: Computes the modular inverse of a modulo m.
  * - @b modular_inverse_gmp: Computes the modular inverse of a modulo m using GMP.
  * - @b solve_for_y: Solves for y given p_id, p, vx, and x.
@@ -39,7 +41,23 @@
  * - @b sieve_atkin: Sieve of Atkin algorithm.
  * - @b sieve_iZ: Classic Sieve-iZ algorithm.
  * - @b sieve_iZm: Segmented Sieve-iZm algorithm.
+ * - @b sieve_wheel30: Segmented sieve on the mod 30 wheel, 8 numbers per byte.
+ * - @b sieve_linear: Linear sieve listing the primes of a smallest-prime-factor table of the numbers 6x ± 1.
+ * - @b sieve_spf: Smallest-prime-factor table of the numbers 6x ± 1, read by factorize_u64_small.
+ * - @b sieve_multiplicative: Segmented sieve of Euler's totient, the Möbius function and the prime factor counts over [lo, hi].
+ * - @b iz_count_primes_mod: Counts the primes of [lo, hi] in every residue class mod m in one pass, sieving iZm columns.
+ * - @b iz_count_primes_in_class: Counts the primes of [lo, hi] congruent to a mod m, sieving only the columns of the class.
+ * - @b iz_primes_mod_stream: Passes the primes of [lo, hi] congruent to a mod m to a callback, in increasing order.
+ * - @b iz_sieve_auto: Picks the engine, segment size and threads for n from a calibration table, with list, count and stream variants.
  * - @b sieve_vx: Advanced Sieve-iZm algorithm that processes a VX segment of a specific y in the iZ-Matrix and encodes prime gaps.
+ * - @b iz_sieve_state_izm, @b iz_sieve_state_vx6_range: Start resumable sieve_iZm and sieve_vx6_range jobs (IZ_SIEVE_STATE).
+ * - @b iz_sieve_step: Advances a sieve job by a bounded number of segments.
+ * - @b iz_sieve_state_write_file, @b iz_sieve_state_read_file: Snapshot a sieve job to a file and restore it.
+ *
+ * * ** Factorization methods:
+ * - @b iz_factor_u64: Factorizes a 64-bit integer by trial division over cached iZ primes, a deterministic primality test and Pollard-Rho-Brent.
+ * - @b iz_factor_u64_batch: Factorizes an array of 64-bit integers on several threads.
+ * - @b sieve_smooth: Logarithmic sieve of the positions of an interval where a linear or quadratic form is B-smooth.
  *
  * * ** Random prime generation methods:
  * - @b search_iZprime: Vertical search routine for a random prime that combines the iZ-Matrix space-filtering techniques and Miller-Rabin primality testing. It could be used independently, or via random_iZprime for parallel processing.
@@ -53,9 +71,17 @@
 #ifndef IZ_H
 #define IZ_H
 
-#include <utils.h> ///< For utility functions
+#include <utils.h>         ///< For utility functions
+#include <cpu_dispatch.h>  ///< Runtime CPU feature dispatch for bitmap kernels
+#include <fast_mod.h>      ///< Division-free mod p by precomputed reciprocals
+#include <montgomery.h>    ///< Native 128-bit Montgomery arithmetic and BPSW test
+#include <numa_topology.h> ///< NUMA node discovery, thread pinning and memory placement
+#include <tuning.h>        ///< Machine tuning profile written by iz-tune
+#include <perf_counters.h> ///< Hardware performance counters of the library phases
 
 // Including data structures modules
+#include <arena.h>      ///< Bump allocator for objects sharing a job's lifetime
+#include <mem_alloc.h>  ///< Aligned, huge-page-backed buffers for bitmaps and prime arrays
 #include <bitmap.h>     ///< Bitmap data structure for efficient bit manipulation
 #include <primes_obj.h> ///< Primes object for holding prime numbers and their metadata
 #include <vx_obj.h>     ///< VX object for holding prime gaps in a VX6 segment and their metadata
@@ -64,8 +90,14 @@
 #define DIR_output "output" ///< Directory for output files
 
 // Global Constants
-#define VX6 (5 * 7 * 11 * 13 * 17 * 19) // 1,616,615
-#define TEST_ROUNDS 25                  ///< Default rounds for Miller-Rabin primality testing
+#define VX5 (5 * 7 * 11 * 13 * 17)          // 85,085
+#define VX6 (5 * 7 * 11 * 13 * 17 * 19)     // 1,616,615
+#define VX7 (VX6 * 23)                      // 37,182,145
+#define TEST_ROUNDS 25                      ///< Default rounds for Miller-Rabin primality testing
+#define SIEVE_IZM_BLOCK_ROWS 4              ///< Default rows of iZm marked together by sieve_iZm
+#define SIEVE_VX_BLOCK_ROWS 4               ///< Default segments marked together by sieve_vx6_range
+#define SIEVE_W30_SEGMENT_BYTES (128 * 1024) ///< Default segment size of sieve_wheel30 (30 numbers per byte)
+#define SIEVE_SPF_SEGMENT_ENTRIES (1 << 18) ///< Entries filled per segment by sieve_spf (2 bytes, 3 numbers each)
 
 /**
  * @brief Computes 6x + i for a given x and i.
@@ -152,6 +184,17 @@ uint64_t solve_for_x(int p_id, uint64_t p, size_t vx, uint64_t y);
  */
 uint64_t solve_for_x_gmp(int p_id, uint64_t p, size_t vx, mpz_t y);
 
+/**
+ * @brief Solve for x given p_id, p, and the precomputed residue (vx * y) mod p.
+ *
+ * @param p_id       Integer indicating the matrix type (-1 for iZm5, 1 for iZm7).
+ * @param p          Unsigned 64-bit integer parameter.
+ * @param yvx_mod_p  The residue (vx * y) mod p.
+ *
+ * @return The computed x value as a 64-bit unsigned integer.
+ */
+uint64_t solve_for_x_mod(int p_id, uint64_t p, uint64_t yvx_mod_p);
+
 /**
  * @brief Compute the modular inverse of a modulo m.
  *
@@ -254,6 +297,211 @@ PRIMES_OBJ *sieve_iZ(uint64_t n);
  */
 PRIMES_OBJ *sieve_iZm(uint64_t n);
 
+/**
+ * @brief Segmented wheel-30 sieve to generate prime numbers up to a given limit.
+ *
+ * @description:
+ * Stores the 8 residues coprime to 30 in each byte (30 numbers per byte, against 24
+ * for the iZ x5/x7 bitmaps), pre-sieves 7, 11 and 13 from a byte pattern, and marks
+ * the other root primes through a precomputed mod 30 step table, in segments of
+ * SIEVE_W30_SEGMENT_BYTES bytes.
+ *
+ * @param n The upper limit for generating prime numbers.
+ * @return
+ *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
+ *      - NULL if memory allocation fails or if n is less than 10.
+ */
+PRIMES_OBJ *sieve_wheel30(uint64_t n);
+
+/**
+ * @brief Callback receiving the primes of a streaming sieve, in increasing order.
+ *
+ * @param p The prime.
+ * @param ctx The context given to the sieve.
+ * @return int 0 to go on, non-zero to stop the sieve.
+ */
+typedef int (*IZ_PRIME_CALLBACK)(uint64_t p, void *ctx);
+
+/**
+ * @brief Segmented wheel-30 sieve with a given segment size, split across threads.
+ *
+ * @description:
+ * [0, n] is split into one chunk of whole segments per thread; each thread sieves
+ * its chunk into its own list, and the lists are joined in order.
+ *
+ * @param n The upper limit for generating prime numbers.
+ * @param segment_bytes The segment size in bytes, 0 for the tuned default (see tuning.h).
+ * @param threads The number of threads, 0 for the tuned default.
+ * @return
+ *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
+ *      - NULL if memory allocation fails or if n is less than 10.
+ */
+PRIMES_OBJ *sieve_wheel30_list(uint64_t n, size_t segment_bytes, int threads);
+
+/**
+ * @brief Counts the primes up to n with the wheel-30 sieve, without storing them.
+ *
+ * @param n The upper limit.
+ * @param segment_bytes The segment size in bytes, 0 for the tuned default (see tuning.h).
+ * @param threads The number of threads, 0 for the tuned default.
+ * @return uint64_t pi(n), or 0 if memory allocation fails.
+ */
+uint64_t sieve_wheel30_count(uint64_t n, size_t segment_bytes, int threads);
+
+/**
+ * @brief Passes the primes up to n to a callback, in increasing order, with the wheel-30 sieve.
+ *
+ * @description:
+ * Memory stays at one segment and the root primes, whatever n.
+ *
+ * @param n The upper limit.
+ * @param segment_bytes The segment size in bytes, 0 for the tuned default (see tuning.h).
+ * @param callback Called with each prime; a non-zero return stops the sieve.
+ * @param ctx Passed to the callback.
+ * @return uint64_t The number of primes passed to the callback.
+ */
+uint64_t sieve_wheel30_stream(uint64_t n, size_t segment_bytes, IZ_PRIME_CALLBACK callback, void *ctx);
+
+#define SPF_MAX_N 4294967295ULL ///< Largest bound of an SPF_TABLE, so that every factor fits 16 bits
+#define SPF_MAX_FACTORS 32      ///< Most prime factors of a number up to SPF_MAX_N, with multiplicity
+
+/**
+ * @struct SPF_TABLE
+ * @brief Smallest prime factors of the numbers 6x ± 1 up to n, built by sieve_spf.
+ *
+ * @description:
+ * The entries interleave the iZ layout: iZ-(x) = 6x - 1 at entry 2x - 1 and
+ * iZ+(x) = 6x + 1 at entry 2x, i.e. the entry of m is m / 3, and entry 0 is 1.
+ * Primes and 1 hold 0; a composite holds its smallest prime factor, which is
+ * below 2^16 as n <= SPF_MAX_N.
+ */
+typedef struct
+{
+    uint64_t n;    ///< The bound of the table
+    uint64_t size; ///< Number of entries, the numbers 6x ± 1 up to n and 1
+    uint16_t *spf; ///< Smallest prime factor per entry, 0 for primes and 1
+} SPF_TABLE;
+
+/**
+ * @brief Builds the smallest-prime-factor table of the numbers 6x ± 1 up to n by a segmented linear sieve.
+ *
+ * @description:
+ * Each composite is written once, by its smallest prime factor. The first segment
+ * runs the classic linear sieve; the following segments of SIEVE_SPF_SEGMENT_ENTRIES
+ * entries are filled from the final entries below them, keeping writes in cache.
+ *
+ * @param n The bound, 1 to SPF_MAX_N.
+ * @return
+ *      - SPF_TABLE* The table, to be freed with spf_table_free.
+ *      - NULL if n is out of range or memory allocation fails.
+ */
+SPF_TABLE *sieve_spf(uint64_t n);
+
+/**
+ * @brief Frees an SPF_TABLE.
+ *
+ * @param table The table, may be NULL.
+ */
+void spf_table_free(SPF_TABLE *table);
+
+/**
+ * @brief Factorizes n by walking an SPF_TABLE, one lookup and division per prime factor.
+ *
+ * @param table The table, with n <= table->n.
+ * @param n The number to factorize.
+ * @param factors Receives the prime factors in increasing order, with multiplicity;
+ *        SPF_MAX_FACTORS entries are always enough.
+ * @return int The number of prime factors (0 for n = 1), or -1 if n is 0 or above the table.
+ */
+int factorize_u64_small(const SPF_TABLE *table, uint64_t n, uint64_t *factors);
+
+/**
+ * @brief Linear sieve to generate prime numbers up to a given limit, through sieve_spf.
+ *
+ * @param n The upper limit for generating prime numbers, at most SPF_MAX_N.
+ * @return
+ *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
+ *      - NULL if memory allocation fails, or if n is less than 10 or above SPF_MAX_N.
+ */
+PRIMES_OBJ *sieve_linear(uint64_t n);
+
+/**
+ * @struct IZ_MULT_FUNCS
+ * @brief Caller buffers receiving multiplicative functions of the integers of [lo, hi]
+ * from sieve_multiplicative, at index n - lo; a NULL buffer skips its function.
+ */
+typedef struct
+{
+    uint64_t *phi;      ///< Euler's totient φ(n)
+    int8_t *mu;         ///< Möbius function μ(n)
+    uint8_t *omega;     ///< ω(n), the number of distinct prime factors
+    uint8_t *big_omega; ///< Ω(n), the number of prime factors with multiplicity
+} IZ_MULT_FUNCS;
+
+/**
+ * @brief Segmented sieve of φ, μ, ω and Ω over every integer of [lo, hi], parallel over segments.
+ *
+ * @description:
+ * The root primes up to sqrt(hi) divide themselves out of their multiples in each
+ * segment, stepping their offsets from segment to segment as sieve_iZm does; the
+ * part left is 1 or one prime above sqrt(hi). The root primes are listed first, so
+ * hi is practical up to about 2^50.
+ *
+ * @param lo The first integer, at least 1.
+ * @param hi The last integer.
+ * @param out The buffers, each of hi - lo + 1 entries or NULL.
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @return int 1 on success, 0 on invalid arguments or memory allocation failure.
+ */
+int sieve_multiplicative(uint64_t lo, uint64_t hi, const IZ_MULT_FUNCS *out, int threads);
+
+#define IZ_CLASS_MAX_M (1 << 20)             ///< Largest modulus of iz_count_primes_mod, one count per class
+#define IZ_CLASS_MAX_N ((1ULL << 62) - 1)    ///< Largest hi of the residue-class sieves
+
+/**
+ * @brief Counts the primes of [lo, hi] in every residue class mod m, in one pass.
+ *
+ * @description:
+ * A column of iZm with segment width vx is a single class mod 6 vx. vx is chosen
+ * so that m divides 6 vx when the columns stay long enough, and each column is
+ * sieved on its own, with the solve_for_y offsets of the root primes, and counted
+ * for its class. A larger m takes the class of each prime from its value instead.
+ * The root primes up to sqrt(hi) are listed first, so hi is practical up to about 2^50.
+ *
+ * @param lo The first integer.
+ * @param hi The last integer, at most IZ_CLASS_MAX_N.
+ * @param m The modulus, in [1, IZ_CLASS_MAX_M].
+ * @param counts Receives the m counts, counts[a] for the primes ≡ a (mod m).
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @return int 1 on success, 0 on invalid arguments or memory allocation failure.
+ */
+int iz_count_primes_mod(uint64_t lo, uint64_t hi, uint64_t m, uint64_t *counts, int threads);
+
+/**
+ * @brief Counts the primes of [lo, hi] congruent to a mod m, sieving only the iZm columns of the class.
+ *
+ * @param lo The first integer.
+ * @param hi The last integer, at most IZ_CLASS_MAX_N.
+ * @param a The class, below m.
+ * @param m The modulus, at least 1.
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @return uint64_t The number of primes, 0 on invalid arguments or memory allocation failure.
+ */
+uint64_t iz_count_primes_in_class(uint64_t lo, uint64_t hi, uint64_t a, uint64_t m, int threads);
+
+/**
+ * @brief Passes the primes of [lo, hi] congruent to a mod m to a callback, in increasing order.
+ *
+ * @param lo The first integer.
+ * @param hi The last integer, at most IZ_CLASS_MAX_N.
+ * @param a The class, below m.
+ * @param m The modulus, at least 1.
+ * @param callback Called with each prime; a non-zero return stops the sieve.
+ * @param ctx Passed to the callback.
+ * @return uint64_t The number of primes passed to the callback.
+ */
+uint64_t iz_primes_mod_stream(uint64_t lo, uint64_t hi, uint64_t a, uint64_t m, IZ_PRIME_CALLBACK callback, void *ctx);
+
 /**
  * @brief An advanced implementation of the Sieve-iZm algorithm that processes a VX6 segment of a specific y in the iZ-Matrix.
  *
@@ -267,7 +515,130 @@ PRIMES_OBJ *sieve_iZm(uint64_t n);
  */
 // VX_OBJ *sieve_vx6(char *y_str, char *filename);
 
-VX_OBJ **sieve_vx6_range(char *start_y, int range_y);
+/**
+ * @brief Sieves the VX6 segments y = start_y, ..., start_y + range_y - 1 in blocks of SIEVE_VX_BLOCK_ROWS.
+ *
+ * @param start_y Pointer to a numeric string representing the first y value in iZm.
+ * @param range_y The number of segments to be sieved.
+ * @return
+ *      - VX_RANGE* The segments, owned by the arena of the range, to be freed with vx_range_free.
+ *      - NULL if the input is invalid or memory allocation fails.
+ */
+VX_RANGE *sieve_vx6_range(char *start_y, int range_y);
+
+/**
+ * @brief Sieves the VX6 segments y = start_y, ..., start_y + range_y - 1 with a pool of threads.
+ *
+ * @description:
+ * The range is split into one contiguous slice per worker. Workers are pinned to
+ * NUMA nodes in contiguous blocks (numa_worker_node), read a replica of VX_ASSETS
+ * bound to their node, and allocate their rows, gap buffers and output segments
+ * themselves, so every buffer a worker writes is local to it. On a single-node
+ * host the workers share the VX_ASSETS and run unpinned.
+ *
+ * @param start_y Pointer to a numeric string representing the first y value in iZm.
+ * @param range_y The number of segments to be sieved.
+ * @param threads The number of worker threads, 0 for the tuned default (one per online CPU unless set).
+ * @return
+ *      - VX_RANGE* The segments, in order of y, to be freed with vx_range_free.
+ *      - NULL if the input is invalid or memory allocation fails.
+ */
+VX_RANGE *sieve_vx6_range_parallel(char *start_y, int range_y, int threads);
+
+/**
+ * @brief A sieve_iZm or sieve_vx6_range job in progress: its position (the next row of
+ * iZm or VX6 segment, and the root-prime cursor), results so far and working set.
+ *
+ * @usage:
+ * IZ_SIEVE_STATE *state = iz_sieve_state_izm(1000000000);
+ * while (iz_sieve_step(state, 4) > 0)
+ *     ... // other cooperative work, or iz_sieve_state_write_file(path, state)
+ * PRIMES_OBJ *primes = iz_sieve_state_take_primes(state);
+ * iz_sieve_state_free(state);
+ */
+typedef struct IZ_SIEVE_STATE IZ_SIEVE_STATE;
+
+/**
+ * @brief Starts a Segmented Sieve-iZm job for the primes up to n, sieving its first segment.
+ *
+ * @param n The upper limit for generating prime numbers.
+ * @return
+ *      - IZ_SIEVE_STATE* The job, to be advanced by iz_sieve_step and freed by iz_sieve_state_free.
+ *      - NULL if memory allocation fails or if n is less than 10.
+ */
+IZ_SIEVE_STATE *iz_sieve_state_izm(uint64_t n);
+
+/**
+ * @brief Starts a job sieving the VX6 segments y = start_y, ..., start_y + range_y - 1.
+ *
+ * @param start_y Pointer to a numeric string representing the first y value in iZm.
+ * @param range_y The number of segments to be sieved.
+ * @return
+ *      - IZ_SIEVE_STATE* The job, to be advanced by iz_sieve_step and freed by iz_sieve_state_free.
+ *      - NULL if the input is invalid or memory allocation fails.
+ */
+IZ_SIEVE_STATE *iz_sieve_state_vx6_range(char *start_y, int range_y);
+
+/**
+ * @brief Advances a sieve job by at most max_segments rows of iZm or VX6 segments.
+ *
+ * @param state The sieve job.
+ * @param max_segments The largest number of segments to sieve, at least 1.
+ * @return
+ *      - 1 if segments remain.
+ *      - 0 if the job is completed.
+ *      - -1 on invalid input or if memory allocation fails, after which the state can only be freed.
+ */
+int iz_sieve_step(IZ_SIEVE_STATE *state, int max_segments);
+
+/**
+ * @brief Returns the number of segments a sieve job has left, 0 once completed.
+ *
+ * @param state The sieve job.
+ * @return int The rows of iZm or VX6 segments left.
+ */
+int iz_sieve_state_remaining(const IZ_SIEVE_STATE *state);
+
+/**
+ * @brief Detaches the primes of a completed iZm job, to be freed by primes_obj_free.
+ *
+ * @param state The iZm job.
+ * @return PRIMES_OBJ* The primes up to n, or NULL if the job is not a completed iZm job.
+ */
+PRIMES_OBJ *iz_sieve_state_take_primes(IZ_SIEVE_STATE *state);
+
+/**
+ * @brief Detaches the range of a completed VX6 range job, to be freed by vx_range_free.
+ *
+ * @param state The range job.
+ * @return VX_RANGE* The segments, in order of y, or NULL if the job is not a completed range job.
+ */
+VX_RANGE *iz_sieve_state_take_vx_range(IZ_SIEVE_STATE *state);
+
+/**
+ * @brief Frees a sieve job, its working set and the results not taken.
+ *
+ * @param state The sieve job, may be NULL.
+ */
+void iz_sieve_state_free(IZ_SIEVE_STATE *state);
+
+/**
+ * @brief Writes the position and results so far of a sieve job to a binary file, with a SHA-256 hash.
+ *
+ * @param file_path The path of the file to write.
+ * @param state The sieve job, between steps, with its results not taken.
+ * @return int 1 on success, 0 on failure.
+ */
+int iz_sieve_state_write_file(const char *file_path, IZ_SIEVE_STATE *state);
+
+/**
+ * @brief Reads a sieve job written by iz_sieve_state_write_file and rebuilds its working set.
+ *
+ * @param file_path The path of the file to read.
+ * @return IZ_SIEVE_STATE* The job, to be resumed by iz_sieve_step, or NULL if the file
+ * cannot be read, is invalid or its hash does not match.
+ */
+IZ_SIEVE_STATE *iz_sieve_state_read_file(const char *file_path);
 
 /**
  * @brief This function performs the sieve process on a given vx and y, defined
@@ -291,6 +662,189 @@ void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets);
  */
 void sieve_vx_root_primes(int vx, mpz_t y, PRIMES_OBJ *root_primes, BITMAP *x5, BITMAP *x7);
 
+// * Automatic sieve selection: Declarations
+// =========================================================
+
+/**
+ * @brief Output modes and options of the automatic sieve, combined with bitwise OR.
+ */
+typedef enum
+{
+    IZ_SIEVE_LIST = 0,      ///< Return the primes in a PRIMES_OBJ
+    IZ_SIEVE_COUNT = 1,     ///< Return the number of primes only
+    IZ_SIEVE_STREAM = 2,    ///< Pass the primes to a callback, in order
+    IZ_SIEVE_SEQUENTIAL = 4 ///< Stay on the calling thread
+} IZ_SIEVE_FLAGS;
+
+#define IZ_SIEVE_MODE_MASK 3 ///< Bits of IZ_SIEVE_FLAGS holding the output mode
+
+/**
+ * @brief The sieve engines the automatic sieve chooses from.
+ */
+typedef enum
+{
+    IZ_ENGINE_ERATOSTHENES, ///< sieve_eratosthenes
+    IZ_ENGINE_SEGMENTED,    ///< segmented_sieve
+    IZ_ENGINE_EULER,        ///< sieve_euler
+    IZ_ENGINE_ATKIN,        ///< sieve_atkin
+    IZ_ENGINE_IZ,           ///< sieve_iZ
+    IZ_ENGINE_IZM,          ///< sieve_iZm
+    IZ_ENGINE_WHEEL30,      ///< sieve_wheel30_list, with segment size and threads
+    IZ_ENGINE_COUNT
+} IZ_SIEVE_ENGINE;
+
+/**
+ * @struct IZ_SIEVE_CALIBRATION
+ * @brief One row of the calibration table: the fastest engine for n up to n_max.
+ */
+typedef struct
+{
+    uint64_t n_max;         ///< Largest n of the row
+    IZ_SIEVE_ENGINE engine; ///< Fastest engine for lists
+    int segment_l1;         ///< Wheel-30 segment size, in L1 data cache sizes
+} IZ_SIEVE_CALIBRATION;
+
+/**
+ * @struct IZ_SIEVE_PLAN
+ * @brief How a sieve up to n runs: engine, output mode, segment size and threads.
+ */
+typedef struct
+{
+    IZ_SIEVE_ENGINE engine; ///< The engine
+    int mode;               ///< IZ_SIEVE_LIST, IZ_SIEVE_COUNT or IZ_SIEVE_STREAM
+    size_t segment_bytes;   ///< Segment size of the wheel-30 engine, 0 for others
+    int threads;            ///< Number of threads, 1 for all engines but wheel-30
+} IZ_SIEVE_PLAN;
+
+/**
+ * @brief Returns the display name of an engine, e.g. "Sieve-Wheel30".
+ */
+const char *iz_sieve_engine_name(IZ_SIEVE_ENGINE engine);
+
+/**
+ * @brief Chooses the engine, segment size and thread count of a sieve up to n.
+ *
+ * @description:
+ * Lists use the engine of the calibration table row of n; counts and streams use
+ * the wheel-30 engine. Segments are sized from the L1 data cache, and threads
+ * from the online CPUs, keeping at least a few segments per thread. Streams and
+ * IZ_SIEVE_SEQUENTIAL run on one thread.
+ *
+ * @param n The upper limit.
+ * @param flags The output mode and options, see IZ_SIEVE_FLAGS.
+ * @return IZ_SIEVE_PLAN The plan.
+ */
+IZ_SIEVE_PLAN iz_sieve_plan(uint64_t n, int flags);
+
+/**
+ * @brief Runs a list plan: the primes up to n with the plan's engine, segment size and threads.
+ *
+ * @param n The upper limit, at least 10.
+ * @param plan The plan, from iz_sieve_plan or set by hand.
+ * @return PRIMES_OBJ* The primes up to n, or NULL on failure.
+ */
+PRIMES_OBJ *iz_sieve_run(uint64_t n, IZ_SIEVE_PLAN plan);
+
+/**
+ * @brief Generates the primes up to n with the engine and settings chosen by iz_sieve_plan.
+ *
+ * @param n The upper limit, at least 10.
+ * @param flags Options, see IZ_SIEVE_FLAGS; the output mode is set to IZ_SIEVE_LIST.
+ * @return PRIMES_OBJ* The primes up to n, or NULL on failure.
+ */
+PRIMES_OBJ *iz_sieve_auto(uint64_t n, int flags);
+
+/**
+ * @brief Counts the primes up to n with the settings chosen by iz_sieve_plan.
+ *
+ * @param n The upper limit, at least 10.
+ * @param flags Options, see IZ_SIEVE_FLAGS; the output mode is set to IZ_SIEVE_COUNT.
+ * @return uint64_t pi(n), or 0 on failure.
+ */
+uint64_t iz_sieve_auto_count(uint64_t n, int flags);
+
+/**
+ * @brief Passes the primes up to n to a callback, in increasing order, with the settings chosen by iz_sieve_plan.
+ *
+ * @param n The upper limit, at least 10.
+ * @param flags Options, see IZ_SIEVE_FLAGS; the output mode is set to IZ_SIEVE_STREAM.
+ * @param callback Called with each prime; a non-zero return stops the sieve.
+ * @param ctx Passed to the callback.
+ * @return uint64_t The number of primes passed to the callback.
+ */
+uint64_t iz_sieve_auto_stream(uint64_t n, int flags, IZ_PRIME_CALLBACK callback, void *ctx);
+
+// * Integer factorization: Declarations
+// =========================================================
+
+#define IZ_FACTOR_MAX 64            ///< Most prime factors of a 64-bit number, with multiplicity
+#define IZ_FACTOR_TRIAL_LIMIT 1024  ///< Primes below this are found by trial division, larger ones by rho
+
+/**
+ * @brief Factorizes a 64-bit integer: trial division by the cached iZ primes, a
+ * deterministic primality test, and Pollard-Rho-Brent in Montgomery form.
+ *
+ * @param n The number to factorize.
+ * @param factors Receives the prime factors in increasing order, with multiplicity;
+ *        IZ_FACTOR_MAX entries are always enough.
+ * @return int The number of prime factors (0 for n = 1), or -1 for n = 0.
+ */
+int iz_factor_u64(uint64_t n, uint64_t *factors);
+
+/**
+ * @brief Factorizes an array of 64-bit integers with iz_factor_u64, on several threads.
+ *
+ * @description: The threads take blocks of values from a shared counter, so a few
+ * hard values don't hold up a whole slice.
+ *
+ * @param values The numbers to factorize.
+ * @param count The number of values.
+ * @param factors Receives the factors of values[i] at factors + i * IZ_FACTOR_MAX,
+ *        count * IZ_FACTOR_MAX entries.
+ * @param factor_counts Receives the return value of iz_factor_u64 for each value.
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @return int 1 on success, 0 on invalid arguments.
+ */
+int iz_factor_u64_batch(const uint64_t *values, size_t count, uint64_t *factors, int *factor_counts, int threads);
+
+#define IZ_SMOOTH_BLOCK 65536      ///< Byte accumulators per block of sieve_smooth, sized for the L2 cache
+#define IZ_SMOOTH_MAX_B 2147483647 ///< Largest smoothness bound of sieve_smooth, within modular_inverse
+
+/**
+ * @struct IZ_SMOOTH_FORM
+ * @brief The form f(i) = c2 i^2 + c1 i + c0 sieved by sieve_smooth; c2 = 0 for a linear form.
+ */
+typedef struct
+{
+    int64_t c0; ///< Constant coefficient
+    int64_t c1; ///< Linear coefficient
+    int64_t c2; ///< Quadratic coefficient
+} IZ_SMOOTH_FORM;
+
+/**
+ * @brief Logarithmic sieve reporting the positions i of [start, start + len) where f(i) is likely B-smooth.
+ *
+ * @description:
+ * Every prime p <= B adds round(log2 p) to a byte accumulator at the positions where
+ * p divides f(i), found from the roots of f mod p and stepped from block to block as
+ * the iZ offsets are. The positions whose total reaches the threshold are candidates
+ * to confirm, e.g. with iz_factor_u64: prime powers are not sieved, so the threshold
+ * is usually log2 |f(i)| minus a slack covering them and the large prime allowed.
+ * The accumulators wrap past 255, far beyond any |f(i)| of interest.
+ *
+ * @param form The form.
+ * @param start The first position.
+ * @param len The number of positions, at least 1.
+ * @param B The smoothness bound, in [2, IZ_SMOOTH_MAX_B].
+ * @param threshold The least accumulated log reported.
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @param positions Receives the reported positions in increasing order, to free by the caller.
+ * @param count Receives the number of positions.
+ * @return int 1 on success, 0 on invalid arguments or memory allocation failure.
+ */
+int sieve_smooth(const IZ_SMOOTH_FORM *form, uint64_t start, uint64_t len, uint64_t B, uint8_t threshold,
+                 int threads, uint64_t **positions, size_t *count);
+
 // * Random prime generation algorithms: Declarations
 // =========================================================
 
@@ -0,0 +1,194 @@
+/**
+ * @file mem_alloc.h
+ * @brief Header file for the large-buffer allocator behind BITMAP and PRIMES_OBJ.
+ * The implementation is in src/modules/mem_alloc.c.
+ *
+ * @description:
+ * The bitmaps and prime arrays of sieve_iZ grow with n: at n = 1e10 the two
+ * bitmaps take ~400 MB and the primes array several GB. With 4 KB pages, the
+ * strided marking loops touch a new page on nearly every step of a large prime
+ * and miss the TLB on most of them. Backing these buffers with 2 MB pages
+ * divides the number of pages by 512.
+ *
+ * Every buffer is aligned to MEM_ALIGN (a cache line), so word and vector
+ * kernels never straddle lines at the start of a buffer. How buffers of at
+ * least MEM_HUGEPAGE_MIN_SIZE bytes are obtained is set by process-wide flags:
+ * - MEM_ALLOC_HUGEPAGE: anonymous mmap advised with MADV_HUGEPAGE (transparent huge pages),
+ * - MEM_ALLOC_HUGETLB: explicit hugetlbfs pages (MAP_HUGETLB), falling back to the
+ *   above when no huge pages are reserved,
+ * - MEM_ALLOC_PREFAULT: touch every page at allocation, moving page faults out of the sieve loops.
+ *
+ * The flags default to MEM_ALLOC_HUGEPAGE and can be set through the IZ_MEM_ALLOC
+ * environment variable, a comma-separated list of hugepage, hugetlb, prefault
+ * (or none), or at runtime with mem_alloc_set_flags. Hosts without mmap ignore
+ * them and use aligned heap memory.
+ *
+ * Every buffer is accounted to a MEM_KIND, given at allocation and kept across
+ * mem_realloc: the live and peak bytes and the allocation counts of each kind
+ * and of their total are kept in process-wide atomic counters, read by the
+ * benchmarks to measure the footprint of a run. The sizes are the usable sizes
+ * asked for, without the header, alignment or huge page rounding; the arena
+ * blocks, which are heap memory of their own, are accounted by arena.c.
+ *
+ * @api:
+ * - @mem_alloc_get_flags: Returns the active allocation flags, reading IZ_MEM_ALLOC once.
+ * - @mem_alloc_set_flags: Sets the allocation flags of subsequent buffers.
+ * - @mem_alloc: Allocates an aligned buffer, optionally zeroed.
+ * - @mem_realloc: Resizes a buffer, preserving its contents.
+ * - @mem_free: Frees a buffer, whichever way it was allocated.
+ * - @mem_alloc_kind: Allocates an aligned buffer accounted to a kind (BITMAP, PRIMES_OBJ, VX_OBJ).
+ * - @mem_alloc_pages: Allocates a buffer on whole pages of its own, e.g. to bind it to a NUMA node.
+ * - @mem_usage_get: Reads the live and peak bytes and allocation counts of each kind.
+ * - @mem_usage_reset_peaks: Starts a new measurement, the peaks set to the live bytes.
+ */
+
+#ifndef MEM_ALLOC_H
+#define MEM_ALLOC_H
+
+#include <utils.h>
+
+#define MEM_ALIGN 64                       ///< Alignment of every buffer, in bytes
+#define MEM_HUGEPAGE_MIN_SIZE (2UL << 20)  ///< Smallest buffer backed by huge pages (2 MB)
+#define MEM_ALLOC_ENV "IZ_MEM_ALLOC"       ///< Environment variable to set the allocation flags
+
+/**
+ * @brief Allocation flags, combined with bitwise OR.
+ */
+typedef enum
+{
+    MEM_ALLOC_DEFAULT = 0,  ///< Aligned heap memory
+    MEM_ALLOC_HUGEPAGE = 1, ///< mmap + MADV_HUGEPAGE for large buffers
+    MEM_ALLOC_HUGETLB = 2,  ///< mmap + MAP_HUGETLB for large buffers
+    MEM_ALLOC_PREFAULT = 4  ///< Fault in every page at allocation
+} MEM_ALLOC_FLAGS;
+
+/**
+ * @brief The owners the allocated bytes are accounted to.
+ */
+typedef enum
+{
+    MEM_KIND_OTHER,  ///< Buffers of mem_alloc, e.g. working buffers of the sieves
+    MEM_KIND_BITMAP, ///< BITMAP data
+    MEM_KIND_PRIMES, ///< PRIMES_OBJ prime arrays
+    MEM_KIND_VX,     ///< VX_OBJ prime gaps
+    MEM_KIND_ARENA,  ///< ARENA blocks, e.g. the segments of a VX_RANGE
+    MEM_KINDS        ///< Number of kinds
+} MEM_KIND;
+
+/**
+ * @struct MEM_USAGE
+ * @brief Allocation counters of a kind, or of all kinds.
+ */
+typedef struct
+{
+    uint64_t allocs;     ///< Buffers allocated
+    uint64_t frees;      ///< Buffers freed
+    uint64_t bytes;      ///< Live bytes
+    uint64_t peak_bytes; ///< Most live bytes since the start or the last mem_usage_reset_peaks
+} MEM_USAGE;
+
+/**
+ * @struct MEM_USAGE_REPORT
+ * @brief Allocation counters of each kind and of their total.
+ */
+typedef struct
+{
+    MEM_USAGE kind[MEM_KINDS]; ///< Counters of each kind
+    MEM_USAGE total;           ///< Counters of all kinds, its peak that of the sum
+} MEM_USAGE_REPORT;
+
+/**
+ * @brief Returns the active allocation flags, parsing IZ_MEM_ALLOC on first use.
+ *
+ * @return int A combination of MEM_ALLOC_FLAGS.
+ */
+int mem_alloc_get_flags(void);
+
+/**
+ * @brief Sets the allocation flags used by subsequent mem_alloc and mem_realloc calls.
+ *
+ * @param flags (int) A combination of MEM_ALLOC_FLAGS.
+ */
+void mem_alloc_set_flags(int flags);
+
+/**
+ * @brief Allocates a buffer aligned to MEM_ALIGN.
+ *
+ * @param size (size_t) The number of bytes to allocate.
+ * @param zeroed (int) Non-zero to zero the buffer.
+ * @return void* A pointer to the buffer, to be freed with mem_free, or NULL on failure.
+ */
+void *mem_alloc(size_t size, int zeroed);
+
+/**
+ * @brief Allocates a buffer aligned to MEM_ALIGN, accounted to a kind.
+ *
+ * @param size (size_t) The number of bytes to allocate.
+ * @param zeroed (int) Non-zero to zero the buffer.
+ * @param kind (MEM_KIND) The kind the buffer is accounted to, kept by mem_realloc.
+ * @return void* A pointer to the buffer, to be freed with mem_free, or NULL on failure.
+ */
+void *mem_alloc_kind(size_t size, int zeroed, MEM_KIND kind);
+
+/**
+ * @brief Allocates a heap buffer starting on a page boundary, accounted to a kind.
+ *
+ * The buffer shares no page with other allocations: its size rounded up to the page
+ * size is its own, so numa_bind_buffer over that span binds every page of it.
+ *
+ * @param size (size_t) The number of bytes to allocate.
+ * @param kind (MEM_KIND) The kind the buffer is accounted to.
+ * @return void* A pointer to the buffer, to be freed with mem_free, or NULL on failure.
+ */
+void *mem_alloc_pages(size_t size, MEM_KIND kind);
+
+/**
+ * @brief Resizes a buffer from mem_alloc, preserving min(old, new size) bytes.
+ *
+ * @param ptr (void *) The buffer to resize, or NULL to allocate a new one.
+ * @param size (size_t) The new size in bytes.
+ * @return void* The resized buffer, or NULL on failure (ptr is left valid).
+ */
+void *mem_realloc(void *ptr, size_t size);
+
+/**
+ * @brief Frees a buffer from mem_alloc or mem_realloc.
+ *
+ * @param ptr (void *) The buffer to free, may be NULL.
+ */
+void mem_free(void *ptr);
+
+/**
+ * @brief Accounts an allocation made outside of mem_alloc, e.g. an arena block.
+ *
+ * @param kind (MEM_KIND) The kind of the allocation.
+ * @param size (size_t) Its size in bytes.
+ */
+void mem_usage_alloc(MEM_KIND kind, size_t size);
+
+/**
+ * @brief Accounts the release of an allocation accounted by mem_usage_alloc.
+ *
+ * @param kind (MEM_KIND) The kind of the allocation.
+ * @param size (size_t) Its size in bytes.
+ */
+void mem_usage_free(MEM_KIND kind, size_t size);
+
+/**
+ * @brief Reads the allocation counters.
+ *
+ * @param report (MEM_USAGE_REPORT *) Receives the counters of each kind and of their total.
+ */
+void mem_usage_get(MEM_USAGE_REPORT *report);
+
+/**
+ * @brief Sets the peak of each kind and of the total to their live bytes, to measure the next run.
+ */
+void mem_usage_reset_peaks(void);
+
+/**
+ * @brief Returns the name of a kind, e.g. "bitmap".
+ */
+const char *mem_kind_name(MEM_KIND kind);
+
+#endif // MEM_ALLOC_H
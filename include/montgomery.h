@@ -0,0 +1,217 @@
+/**
+ * @file montgomery.h
+ * @brief Native Montgomery arithmetic and probable-prime tests for fixed-width integers.
+ * The implementation of the functions is in src/modules/montgomery.c.
+ *
+ * @description:
+ * Candidates below 2^126 fit two machine words, where GMP's general-purpose
+ * path costs more in call and allocation overhead than the arithmetic itself.
+ * This module works on __uint128_t with Montgomery multiplication (R = 2^128):
+ * - u128 helpers to move values between mpz_t and __uint128_t, and an integer square root,
+ * - a strong probable-prime test to a given base (Miller-Rabin),
+ * - a strong Lucas probable-prime test with Selfridge's parameters,
+ * - the Baillie-PSW test combining both, preceded by trial division.
+ *
+ * BPSW has no known pseudoprime; it is proven deterministic below 2^64.
+ *
+ * Below 2^64, single-word Montgomery arithmetic (R = 2^64, MONT64) is inlined from
+ * this header, for the deterministic Miller-Rabin test u64_is_prime here and for
+ * Pollard's rho in the factorization module.
+ *
+ * For cryptographic sizes, stack-allocated Montgomery kernels specialized for
+ * 4, 8 and 16 64-bit limbs (256, 512 and 1024 bits) run the base-2 strong
+ * probable-prime test without GMP's dynamic allocation. iZ_probab_prime uses
+ * them as the filter tier, leaving GMP's mpz_probab_prime_p to confirm the
+ * survivors and to handle larger numbers. The portable C kernels beat GMP where
+ * call overhead dominates; at larger sizes GMP's assembly powm is faster, so the
+ * tier covers candidates up to a tunable size (MONT_TIER_MAX_BITS by default).
+ *
+ * @api:
+ * - @u128_from_mpz: Converts an mpz_t to __uint128_t if it fits.
+ * - @u128_to_mpz: Converts a __uint128_t to mpz_t.
+ * - @u128_isqrt: Integer square root of a __uint128_t.
+ * - @u128_is_sprp: Strong probable-prime test of n to a given base.
+ * - @u128_is_slprp: Strong Lucas probable-prime test of n.
+ * - @u128_is_prime: Baillie-PSW primality test of n.
+ * - @mont64_init, @mont64_mul, @mont64_to, @mont64_from: 64-bit Montgomery arithmetic.
+ * - @u64_is_prime: Deterministic Miller-Rabin test of a 64-bit n.
+ * - @mont_is_sprp2: Base-2 strong probable-prime test with the fixed-width kernels.
+ * - @iZ_probab_prime: Tiered primality test: u128 BPSW, fixed-width SPRP + GMP, or GMP.
+ * - @mont_set_tier_max_bits: Sets the largest candidate size of the fixed-width tier.
+ */
+
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include <utils.h>
+
+#define U128_PRIME_LIMIT ((__uint128_t)1 << 126) ///< Upper bound (exclusive) of the u128 tests
+#define MONT_MAX_LIMBS 16                         ///< Largest fixed-width kernel: 16 x 64 = 1024 bits
+#define MONT_TIER_MAX_BITS 256                    ///< Default largest size routed through the fixed-width tier
+
+/**
+ * @brief Converts an mpz_t to __uint128_t.
+ *
+ * @param out (__uint128_t *) The converted value.
+ * @param z (mpz_t) A non-negative integer.
+ * @return int 1 if z fits 128 bits, 0 otherwise (out is untouched).
+ */
+int u128_from_mpz(__uint128_t *out, mpz_t z);
+
+/**
+ * @brief Converts a __uint128_t to mpz_t.
+ *
+ * @param z (mpz_t) The converted value, initialized by the caller.
+ * @param n (__uint128_t) The value to convert.
+ */
+void u128_to_mpz(mpz_t z, __uint128_t n);
+
+/**
+ * @brief Computes floor(sqrt(n)).
+ *
+ * @param n (__uint128_t) The radicand.
+ * @return __uint128_t The integer square root of n.
+ */
+__uint128_t u128_isqrt(__uint128_t n);
+
+/**
+ * @brief Strong probable-prime (Miller-Rabin) test of n to a given base.
+ *
+ * @param n (__uint128_t) An odd integer, 3 <= n < U128_PRIME_LIMIT.
+ * @param base (uint64_t) The witness base, reduced mod n.
+ * @return int 1 if n is a strong probable prime to base, 0 if composite.
+ */
+int u128_is_sprp(__uint128_t n, uint64_t base);
+
+/**
+ * @brief Strong Lucas probable-prime test of n, with Selfridge's method A parameters.
+ *
+ * @param n (__uint128_t) An odd integer, 3 <= n < U128_PRIME_LIMIT.
+ * @return int 1 if n is a strong Lucas probable prime, 0 if composite.
+ */
+int u128_is_slprp(__uint128_t n);
+
+/**
+ * @brief Baillie-PSW primality test: trial division, base-2 SPRP and strong Lucas test.
+ *
+ * @description: Below 2^64, the deterministic Miller-Rabin test of u64_is_prime
+ * replaces the SPRP and Lucas steps, in single-word arithmetic.
+ *
+ * @param n (__uint128_t) The integer to test, n < U128_PRIME_LIMIT.
+ * @return int 1 if n is (probably) prime, 0 if composite.
+ */
+int u128_is_prime(__uint128_t n);
+
+/**
+ * @struct MONT64
+ * @brief Montgomery context of an odd modulus n < 2^64, with R = 2^64.
+ */
+typedef struct
+{
+    uint64_t n;     ///< The modulus
+    uint64_t n_inv; ///< n^-1 mod 2^64
+    uint64_t one;   ///< R mod n, i.e. 1 in Montgomery form
+    uint64_t r2;    ///< R^2 mod n, to convert into Montgomery form
+} MONT64;
+
+/**
+ * @brief Montgomery reduction of hi:lo, with hi < n: returns hi:lo * R^-1 mod n.
+ *
+ * @description: Subtracting the multiple q * n whose low word equals lo, with
+ * q = lo * n^-1, leaves a result in (-n, n): no carry to track, for any odd n < 2^64.
+ */
+static inline uint64_t mont64_redc(const MONT64 *m, uint64_t hi, uint64_t lo)
+{
+    uint64_t q = lo * m->n_inv;
+    uint64_t qn_hi = (uint64_t)(((__uint128_t)q * m->n) >> 64);
+    return hi >= qn_hi ? hi - qn_hi : hi - qn_hi + m->n;
+}
+
+/**
+ * @brief Montgomery product a * b * R^-1 mod n of a, b < n.
+ */
+static inline uint64_t mont64_mul(const MONT64 *m, uint64_t a, uint64_t b)
+{
+    __uint128_t t = (__uint128_t)a * b;
+    return mont64_redc(m, (uint64_t)(t >> 64), (uint64_t)t);
+}
+
+/**
+ * @brief Sets up the Montgomery context of an odd modulus n > 1.
+ */
+static inline void mont64_init(MONT64 *m, uint64_t n)
+{
+    m->n = n;
+
+    // Newton iteration for n^-1 mod 2^64, each step doubles the correct bits (3 -> 96)
+    uint64_t inv = n;
+    for (int i = 0; i < 5; i++)
+        inv *= 2 - n * inv;
+    m->n_inv = inv;
+
+    m->one = (-n) % n;
+    m->r2 = (uint64_t)(((__uint128_t)m->one * m->one) % n);
+}
+
+/**
+ * @brief Converts a into Montgomery form, a * R mod n.
+ */
+static inline uint64_t mont64_to(const MONT64 *m, uint64_t a)
+{
+    return mont64_mul(m, a % m->n, m->r2);
+}
+
+/**
+ * @brief Converts a out of Montgomery form, a * R^-1 mod n.
+ */
+static inline uint64_t mont64_from(const MONT64 *m, uint64_t a)
+{
+    return mont64_redc(m, 0, a);
+}
+
+/**
+ * @brief Deterministic primality test of a 64-bit integer.
+ *
+ * @description: Trial division by the primes up to 47, then Miller-Rabin with
+ * Sinclair's seven bases, which has no pseudoprime below 2^64.
+ *
+ * @param n (uint64_t) The integer to test.
+ * @return int 1 if n is prime, 0 otherwise.
+ */
+int u64_is_prime(uint64_t n);
+
+/**
+ * @brief Base-2 strong probable-prime test with the fixed-width Montgomery kernels.
+ *
+ * @param n (mpz_t) An odd integer > 2.
+ * @return int 1 if n is a strong probable prime to base 2, 0 if composite,
+ *         -1 if n exceeds MONT_MAX_LIMBS limbs.
+ */
+int mont_is_sprp2(mpz_t n);
+
+/**
+ * @brief Sets the largest candidate size routed through the fixed-width SPRP tier.
+ *
+ * @description: The size is the mont_tier_max_bits key of the tuning profile
+ * (see tuning.h); this sets it in the active profile.
+ *
+ * @param max_bits (int) Size in bits, clamped to 64 * MONT_MAX_LIMBS; 0 disables the tier.
+ */
+void mont_set_tier_max_bits(int max_bits);
+
+/**
+ * @brief Tiered probabilistic primality test, a drop-in for mpz_probab_prime_p.
+ *
+ * @description:
+ * - n < U128_PRIME_LIMIT: the native Baillie-PSW test (u128_is_prime).
+ * - n up to the tier size (MONT_TIER_MAX_BITS unless tuned): the fixed-width base-2
+ *   SPRP rejects composites, survivors are confirmed by mpz_probab_prime_p(n, rounds).
+ * - larger n: mpz_probab_prime_p(n, rounds).
+ *
+ * @param n (mpz_t) The integer to test.
+ * @param rounds (int) Miller-Rabin rounds of the GMP confirmation.
+ * @return int 0 if n is composite, non-zero if n is (probably) prime.
+ */
+int iZ_probab_prime(mpz_t n, int rounds);
+
+#endif // MONTGOMERY_H
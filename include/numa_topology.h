@@ -0,0 +1,83 @@
+/**
+ * @file numa_topology.h
+ * @brief Header file for NUMA node discovery, thread pinning and memory placement.
+ * The implementation is in src/modules/numa_topology.c.
+ *
+ * @description:
+ * On multi-socket hosts each node has its own memory controller; a thread that
+ * reads memory placed on another node pays the interconnect latency and shares
+ * its bandwidth. The parallel drivers (e.g. sieve_vx6_range_parallel) pin each
+ * worker to a node and keep its working set there:
+ * - buffers a pinned worker allocates and touches first are placed on its node,
+ * - read-shared data (VX_ASSETS) is replicated per node and bound there with mbind.
+ *
+ * The topology is read once from /sys/devices/system/node, without libnuma.
+ * Nodes without CPUs are ignored. On hosts without NUMA information, the host is
+ * one node with every online CPU, and pinning and binding are no-ops.
+ *
+ * @api:
+ * - @numa_node_count: Returns the number of nodes with CPUs.
+ * - @numa_node_cpu_count: Returns the number of CPUs of a node.
+ * - @numa_worker_node: Assigns a worker to a node, in contiguous blocks of workers.
+ * - @numa_pin_thread: Pins the calling thread to the CPUs of a node.
+ * - @numa_bind_buffer: Moves a buffer's pages to a node and keeps them there.
+ */
+
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <utils.h>
+
+#define NUMA_MAX_NODES 64 ///< Largest number of nodes handled
+
+/**
+ * @brief Returns the number of NUMA nodes with CPUs, reading the topology on first use.
+ *
+ * @return int The number of nodes, at least 1.
+ */
+int numa_node_count(void);
+
+/**
+ * @brief Returns the number of CPUs of a node.
+ *
+ * @param node (int) The node index, 0 <= node < numa_node_count().
+ * @return int The number of CPUs, 0 for an invalid node.
+ */
+int numa_node_cpu_count(int node);
+
+/**
+ * @brief Assigns worker w of a pool to a node, contiguous workers sharing a node.
+ *
+ * @description:
+ * Workers are split into numa_node_count() blocks of nearly equal size, so the
+ * consecutive slices of a range job processed by a node stay adjacent.
+ *
+ * @param worker (int) The worker index, 0 <= worker < workers.
+ * @param workers (int) The number of workers.
+ * @return int The node index of the worker.
+ */
+int numa_worker_node(int worker, int workers);
+
+/**
+ * @brief Pins the calling thread to the CPUs of a node.
+ *
+ * @param node (int) The node index.
+ * @return int 1 if the thread is pinned, 0 if pinning is unsupported or failed.
+ */
+int numa_pin_thread(int node);
+
+/**
+ * @brief Binds the pages of a buffer to a node (preferred policy), moving the pages already touched.
+ *
+ * @description:
+ * Only the pages that lie entirely within the buffer are bound, so neighbouring
+ * allocations sharing its first and last pages keep their placement.
+ *
+ * @param ptr (void *) The buffer.
+ * @param size (size_t) The size of the buffer in bytes.
+ * @param node (int) The node index.
+ * @return int 1 if the buffer is bound (or too small to own a page), 0 if mbind is unsupported or failed.
+ */
+int numa_bind_buffer(void *ptr, size_t size, int node);
+
+#endif // NUMA_TOPOLOGY_H
@@ -0,0 +1,133 @@
+/**
+ * @file perf_counters.h
+ * @brief Header file for hardware performance counters of the library phases.
+ * The implementation is in src/modules/perf_counters.c.
+ *
+ * @description:
+ * The bit_ops and p_test_ops of a VX_OBJ estimate the work of a sieve, not where
+ * its time goes. Between iz_perf_start and iz_perf_stop, the calling thread counts
+ * cycles, instructions, L1 data cache read misses, last-level cache misses, branch
+ * misses and data TLB read misses with perf_event_open, and attributes them, with
+ * the wall-clock time, to the library phase running when they occur:
+ * - marking: clearing the composites of the root primes in the sieve bitmaps,
+ * - extraction: scanning the bitmaps for the primes or the prime gaps,
+ * - primality: probabilistic tests of the candidates left by a sieve,
+ * - io: reading and writing bitmaps, PRIMES_OBJ and VX_OBJ files.
+ *
+ * The phase hooks are compiled into the library only with -DIZ_PERF (make IZ_PERF=1),
+ * so the default build pays nothing for them. Phases nest: the counts of a phase
+ * exclude those of the phases it encloses. Counting needs Linux and access to the
+ * PMU (kernel.perf_event_paranoid <= 2 for user-space events); without it, the
+ * phases are still timed and the counters are reported as unavailable. Threads
+ * other than the one that called iz_perf_start are not counted.
+ *
+ * @api:
+ * - @iz_perf_start: Opens the counters of the calling thread and resets the phase totals.
+ * - @iz_perf_stop: Reads the counters into a report and closes them.
+ * - @iz_perf_phase_begin, @iz_perf_phase_end: Enter and leave a phase (the IZ_PERF_BEGIN/END hooks).
+ * - @iz_perf_print: Prints a report per phase, normalized per prime, per segment, ...
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <utils.h>
+
+/**
+ * @brief The library phases the counters are attributed to.
+ */
+typedef enum
+{
+    IZ_PERF_MARKING,    ///< Marking composites in the sieve bitmaps
+    IZ_PERF_EXTRACTION, ///< Collecting primes or gaps from the bitmaps
+    IZ_PERF_PRIMALITY,  ///< Primality tests of sieve survivors and random candidates
+    IZ_PERF_IO,         ///< File reads and writes
+    IZ_PERF_PHASES      ///< Number of phases
+} IZ_PERF_PHASE;
+
+/**
+ * @brief The hardware events counted.
+ */
+typedef enum
+{
+    IZ_PERF_CYCLES,        ///< CPU cycles
+    IZ_PERF_INSTRUCTIONS,  ///< Retired instructions
+    IZ_PERF_L1D_MISSES,    ///< L1 data cache read misses
+    IZ_PERF_LLC_MISSES,    ///< Last-level cache misses
+    IZ_PERF_BRANCH_MISSES, ///< Mispredicted branches
+    IZ_PERF_DTLB_MISSES,   ///< Data TLB read misses
+    IZ_PERF_EVENTS         ///< Number of events
+} IZ_PERF_EVENT;
+
+/**
+ * @struct IZ_PERF_TOTALS
+ * @brief Counts accumulated by a phase, or by a whole run.
+ */
+typedef struct
+{
+    uint64_t calls;                 ///< Times the phase was entered
+    double seconds;                 ///< Wall-clock time
+    uint64_t count[IZ_PERF_EVENTS]; ///< Event counts, scaled if the counters were multiplexed
+} IZ_PERF_TOTALS;
+
+/**
+ * @struct IZ_PERF_REPORT
+ * @brief Counts of a run between iz_perf_start and iz_perf_stop.
+ */
+typedef struct
+{
+    int available[IZ_PERF_EVENTS];        ///< Whether each event was counted
+    IZ_PERF_TOTALS phase[IZ_PERF_PHASES]; ///< Counts of each phase, nested phases excluded
+    IZ_PERF_TOTALS total;                 ///< Counts of the whole run, phases or not
+} IZ_PERF_REPORT;
+
+#ifdef IZ_PERF
+#define IZ_PERF_BEGIN(phase) iz_perf_phase_begin(phase) ///< Enters a phase in instrumented builds
+#define IZ_PERF_END() iz_perf_phase_end()               ///< Leaves the phase in instrumented builds
+#else
+#define IZ_PERF_BEGIN(phase) ((void)0)
+#define IZ_PERF_END() ((void)0)
+#endif
+
+/**
+ * @brief Opens the performance counters of the calling thread and resets the phase totals.
+ *
+ * @return int The number of events counted, 0 if none can be (the phases are still timed).
+ */
+int iz_perf_start(void);
+
+/**
+ * @brief Stops counting, fills a report and closes the counters of the calling thread.
+ *
+ * @param report Receives the counts, may be NULL to discard them.
+ */
+void iz_perf_stop(IZ_PERF_REPORT *report);
+
+/**
+ * @brief Enters a phase, attributing the counts since the last boundary to the enclosing one.
+ *
+ * @param phase The phase entered. A no-op outside iz_perf_start / iz_perf_stop.
+ */
+void iz_perf_phase_begin(IZ_PERF_PHASE phase);
+
+/**
+ * @brief Leaves the current phase, attributing the counts since the last boundary to it.
+ */
+void iz_perf_phase_end(void);
+
+/**
+ * @brief Returns the name of a phase, e.g. "marking".
+ */
+const char *iz_perf_phase_name(IZ_PERF_PHASE phase);
+
+/**
+ * @brief Prints the counts of each phase, of the time outside the phases and of the run,
+ * per unit of work.
+ *
+ * @param report The report of the run.
+ * @param units The units of work of the run, e.g. the primes found or the segments sieved.
+ * @param unit The name of a unit, e.g. "prime".
+ */
+void iz_perf_print(const IZ_PERF_REPORT *report, double units, const char *unit);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,99 @@
+/**
+ * @file tuning.h
+ * @brief Header file for the machine tuning profile written by iz-tune.
+ * The implementation is in src/modules/tuning.c.
+ *
+ * @description:
+ * Several parameters of the sieves and primality tests depend on the host's
+ * caches, core count and GMP build rather than on the input: the rows marked
+ * per block, the segment sizes, the primes cleared by word patterns, the
+ * pre-sieved primes of sieve_iZm's vx, the root primes used on huge-y VX
+ * segments before falling back to primality tests, the size range of the
+ * fixed-width Montgomery tier and the Miller-Rabin rounds.
+ *
+ * IZ_TUNING holds them all. It starts from the compiled-in defaults and, on
+ * first use, is overridden by the profile file named by IZ_TUNE_PROFILE, or by
+ * IZ_TUNE_DEFAULT_PATH in the working directory if the variable is unset. The
+ * iz-tune tool (tools/iz_tune.c, `make tune`) benchmarks the host and writes
+ * such a profile. A profile is a text file of `key = value` lines, `#` starting
+ * a comment; unknown keys are ignored with a warning and values are clamped to
+ * their valid range.
+ *
+ * @api:
+ * - @iz_tuning: Returns the active profile, loading the profile file once.
+ * - @iz_tuning_defaults: Fills a profile with the compiled-in defaults.
+ * - @iz_tuning_load: Reads a profile file over a profile.
+ * - @iz_tuning_save: Writes a profile file.
+ * - @iz_tuning_apply: Makes a profile the active one.
+ */
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <utils.h>
+
+#define IZ_TUNE_ENV "IZ_TUNE_PROFILE"          ///< Environment variable naming the profile file
+#define IZ_TUNE_DEFAULT_PATH "iz-tune.profile" ///< Profile file read when IZ_TUNE_PROFILE is unset
+#define SIEVE_MAX_BLOCK_ROWS 16                ///< Largest number of rows of a sieve block
+
+/**
+ * @struct IZ_TUNING
+ * @brief The tunable parameters of the library.
+ */
+typedef struct
+{
+    int vx_limit;             ///< Primes multiplied into the vx of sieve_iZm (2 to 7, 5 * 7 * 11 * ...)
+    int pattern_max_p;        ///< Root primes below this are cleared by word patterns (at most BITMAP_PATTERN_MAX_P)
+    int izm_block_rows;       ///< Rows of iZm marked together by sieve_iZm
+    int vx_block_rows;        ///< Segments marked together by the VX range sieves
+    size_t w30_segment_bytes; ///< Default segment size of sieve_wheel30
+    int vx_sieve_depth;       ///< Largest root prime sieved on huge-y VX segments, 0 for all primes below vx
+    int test_rounds;          ///< Miller-Rabin rounds of the primality tests
+    int mont_tier_max_bits;   ///< Largest candidate size of the fixed-width Montgomery tier
+    int threads;              ///< Default thread count of the parallel drivers, 0 for one per online CPU
+} IZ_TUNING;
+
+/**
+ * @brief Returns the active tuning profile, reading the profile file on first use.
+ *
+ * @return const IZ_TUNING* The active profile.
+ */
+const IZ_TUNING *iz_tuning(void);
+
+/**
+ * @brief Fills a profile with the compiled-in defaults.
+ *
+ * @param tuning (IZ_TUNING *) The profile to fill.
+ */
+void iz_tuning_defaults(IZ_TUNING *tuning);
+
+/**
+ * @brief Reads a profile file over a profile, keeping the values of the keys it doesn't set.
+ *
+ * @param tuning (IZ_TUNING *) The profile to update.
+ * @param path (const char *) The profile file.
+ * @return int 1 on success, 0 if the file can't be read.
+ */
+int iz_tuning_load(IZ_TUNING *tuning, const char *path);
+
+/**
+ * @brief Writes a profile file, with a comment line per key.
+ *
+ * @param tuning (const IZ_TUNING *) The profile to write.
+ * @param path (const char *) The profile file.
+ * @return int 1 on success, 0 if the file can't be written.
+ */
+int iz_tuning_save(const IZ_TUNING *tuning, const char *path);
+
+/**
+ * @brief Makes a copy of a profile, clamped to the valid ranges, the active profile.
+ *
+ * @description:
+ * Meant for configuration at startup: sieves running concurrently may see a mix
+ * of the old and new values.
+ *
+ * @param tuning (const IZ_TUNING *) The new profile.
+ */
+void iz_tuning_apply(const IZ_TUNING *tuning);
+
+#endif // TUNING_H
@@ -17,6 +17,8 @@
  * @api:
  * - @vx_init: Initializes a new VX_OBJ structure with the given y string.
  * - @vx_free: Frees the memory allocated for the VX_OBJ structure.
+ * - @vx_arena_init: Initializes a VX_OBJ and its y string in an arena.
+ * - @vx_range_free: Frees a VX_RANGE and all of its segments.
  * - @vx_resize_p_gaps: Resizes the p_gaps array to fit the actual count of prime gaps.
  * - @vx_write_file: Writes the contents of the VX_OBJ structure to a file.
  * - @vx_read_file: Reads the contents of a file into a VX_OBJ structure.
@@ -24,6 +26,9 @@
  * - @print_p_gaps: Prints the prime gaps in the VX_OBJ structure.
  * - @print_vx_header: Prints the header for VX statistics.
  * - @print_vx_stats: Prints VX statistics.
+ * - @root_table_init: Builds the ROOT_PRIME_TABLE of root primes for a segment size vx.
+ * - @root_table_free: Frees a ROOT_PRIME_TABLE.
+ * - @vx_assets_replicate: Copies VX_ASSETS into memory bound to a NUMA node.
  */
 
 #ifndef VX_OBJ_H
@@ -32,11 +37,76 @@
 #include <utils.h>
 #include <bitmap.h>
 #include <primes_obj.h>
+#include <fast_mod.h>
+#include <arena.h>
 
 #define VX_EXT ".vx"              // File extension for VX files
 #define GAP_TYPE uint16_t         // Type of an integer
 #define GAP_SIZE sizeof(uint16_t) // Size of an integer in bytes
 
+/**
+ * @brief Root primes of a segment size vx with their precomputed wheel metadata.
+ *
+ * A structure-of-arrays indexed like the PRIMES_OBJ it was built from, so the
+ * per-segment offset computation streams through flat arrays and needs neither
+ * x_p = (p + 1) / 6, nor p_id, nor a division by p.
+ *
+ * @param p_count (int) The number of root primes in the table.
+ * @param start (int) Index of the first root prime that doesn't divide vx.
+ * @param p (uint32_t *) The root primes.
+ * @param x5_p (uint32_t *) x_p normalized for iZm5: the x of the first composite of p in the matrix.
+ * @param x7_p (uint32_t *) x_p normalized for iZm7.
+ * @param vx_mod_p (uint32_t *) vx mod p, 0 for primes that divide vx.
+ * @param p_inv (uint64_t *) fast_mod_inv(p), for multiply-shift reductions.
+ */
+typedef struct
+{
+    int p_count;        ///< Number of root primes
+    int start;          ///< Index of the first root prime not dividing vx (skips 2, 3 and the pre-sieved primes)
+    uint32_t *p;        ///< Root primes
+    uint32_t *x5_p;     ///< Normalized x_p in iZm5
+    uint32_t *x7_p;     ///< Normalized x_p in iZm7
+    uint32_t *vx_mod_p; ///< vx mod p, 0 for primes that divide vx
+    uint64_t *p_inv;    ///< Reciprocal of p, see fast_mod.h
+} ROOT_PRIME_TABLE;
+
+/**
+ * @brief Builds the ROOT_PRIME_TABLE of the first p_count primes of a PRIMES_OBJ.
+ *
+ * @param primes (PRIMES_OBJ *) Primes in ascending order, starting with 2, 3; each < 2^32.
+ * @param p_count (int) The number of primes to include.
+ * @param vx (size_t) The segment size the table is used with.
+ * @return A pointer to the table, or NULL if memory allocation fails.
+ */
+ROOT_PRIME_TABLE *root_table_init(PRIMES_OBJ *primes, int p_count, size_t vx);
+
+/**
+ * @brief Frees the memory allocated for a ROOT_PRIME_TABLE.
+ *
+ * @param table (ROOT_PRIME_TABLE *) The table to be freed.
+ */
+void root_table_free(ROOT_PRIME_TABLE *table);
+
+/**
+ * @brief Computes the first composite offsets of a root prime in a segment.
+ *
+ * @param table (const ROOT_PRIME_TABLE *) The root prime table.
+ * @param i (int) Index of the root prime in the table.
+ * @param yvx_mod_p (uint64_t) The residue (vx * y) mod p of the segment.
+ * @param x5 (uint64_t *) Output: first x to mark in iZm5, in [1:p].
+ * @param x7 (uint64_t *) Output: first x to mark in iZm7, in [1:p].
+ */
+static inline void root_table_offsets(const ROOT_PRIME_TABLE *table, int i, uint64_t yvx_mod_p,
+                                      uint64_t *x5, uint64_t *x7)
+{
+    // x = p - (vx * y - x_p) mod p, where yvx_mod_p + p - x_p is in [1, 2p)
+    uint64_t p = table->p[i];
+    uint64_t d5 = yvx_mod_p + p - table->x5_p[i];
+    uint64_t d7 = yvx_mod_p + p - table->x7_p[i];
+    *x5 = p - (d5 >= p ? d5 - p : d5);
+    *x7 = p - (d7 >= p ? d7 - p : d7);
+}
+
 /**
  * @brief Sieve assets for vx prime sieve.
  *
@@ -48,24 +118,62 @@
  * @param root_primes (PRIMES_OBJ *) Pointer to the root primes used for sieving.
  * @param base_x5 (BITMAP *) Pointer to the base bitmap for iZm5/vx.
  * @param base_x7 (BITMAP *) Pointer to the base bitmap for iZm7/vx.
+ * @param root_table (ROOT_PRIME_TABLE *) The root primes with their wheel metadata for vx.
+ * @param is_static (int) 1 if the assets are compiled-in tables, which must not be modified or freed.
  */
 typedef struct
 {
-    int vx;                  ///< Size of the segment
-    PRIMES_OBJ *root_primes; ///< Root primes used for sieving
-    BITMAP *base_x5;         ///< Base bitmap for iZm5/vx
-    BITMAP *base_x7;         ///< Base bitmap for iZm7/vx
+    int vx;                       ///< Size of the segment
+    PRIMES_OBJ *root_primes;      ///< Root primes used for sieving
+    BITMAP *base_x5;              ///< Base bitmap for iZm5/vx
+    BITMAP *base_x7;              ///< Base bitmap for iZm7/vx
+    ROOT_PRIME_TABLE *root_table; ///< Root primes metadata for computing offsets
+    int is_static;                ///< 1 if generated at build time (read-only), 0 if heap allocated
 } VX_ASSETS;
 
+/**
+ * @brief Compiled-in VX_ASSETS tables, generated at build time by tools/gen_vx_tables.c
+ * for the vx standards listed in the Makefile's VX_TABLES.
+ */
+extern VX_ASSETS *const vx_static_assets[];
+extern const int vx_static_assets_count;
+
+/**
+ * @brief Looks up the compiled-in VX_ASSETS of a given vx.
+ *
+ * @param vx (size_t) The size of the segment.
+ *
+ * @return A pointer to the read-only VX_ASSETS, or NULL if vx has no compiled-in table.
+ */
+VX_ASSETS *vx_assets_static(size_t vx);
+
 /**
  * @brief Initializes vx assets for the sieve.
  *
+ * @description:
+ * Returns the compiled-in tables when vx is one of the build-time vx standards,
+ * otherwise computes the root primes and pre-sieved base bitmaps at runtime.
+ *
  * @param vx (size_t) The size of the segment.
  *
  * @return A pointer to the initialized VX_ASSETS structure.
  */
 VX_ASSETS *vx_assets_init(size_t vx);
 
+/**
+ * @brief Copies vx assets into heap memory bound to a NUMA node.
+ *
+ * @description:
+ * Workers pinned to a node read the root table and base bitmaps for every
+ * segment; a replica on their node keeps these reads off the interconnect.
+ * The replica is a deep copy (is_static = 0), freed with vx_assets_free.
+ *
+ * @param vx_assets (VX_ASSETS *) The vx assets to copy, static or not.
+ * @param node (int) The NUMA node index (see numa_topology.h).
+ * @return A pointer to the replica, or NULL if memory allocation fails.
+ */
+VX_ASSETS *vx_assets_replicate(VX_ASSETS *vx_assets, int node);
+
 /**
  * @brief Frees the memory allocated for vx assets.
  *
@@ -132,6 +240,48 @@ VX_OBJ *vx_init(int vx, char *y);
  */
 void vx_free(VX_OBJ *vx_obj);
 
+/**
+ * @brief Initializes a VX_OBJ in an arena, with its y string and no p_gaps yet.
+ *
+ * @description:
+ * The VX_OBJ and its decimal y string are allocated from the arena and released
+ * with it, they must not be passed to vx_free. p_gaps is NULL, to be set by the caller.
+ *
+ * @param arena The arena to allocate from.
+ * @param vx The segment size.
+ * @param y The segment index in iZm.
+ * @return Pointer to the new VX_OBJ, or NULL if allocation fails.
+ */
+VX_OBJ *vx_arena_init(ARENA *arena, int vx, mpz_t y);
+
+/**
+ * @struct VX_RANGE
+ * @brief The segments y, y + 1, ..., y + count - 1 of a range job, owned by its arenas.
+ *
+ * @param vx The segment size.
+ * @param count The number of segments.
+ * @param vx_objs The VX_OBJ of the segments, in order of y.
+ * @param arena The arena holding the range, and the VX_OBJ headers, y strings and prime gaps of a sequential job.
+ * @param worker_arenas The arenas of the workers of a parallel job, each holding the segments of its slice.
+ * @param worker_count The number of worker arenas, 0 for a sequential job.
+ */
+typedef struct
+{
+    int vx;                 ///< The segment size.
+    int count;              ///< Number of segments.
+    VX_OBJ **vx_objs;       ///< The segments, in order of y.
+    ARENA *arena;           ///< Owner of the range (and of the segments of a sequential job).
+    ARENA **worker_arenas;  ///< Owners of the segments of a parallel job, one per worker.
+    int worker_count;       ///< Number of worker arenas.
+} VX_RANGE;
+
+/**
+ * @brief Frees a VX_RANGE, its segments and their prime gaps, by releasing its arenas.
+ *
+ * @param vx_range Pointer to the VX_RANGE to free, may be NULL.
+ */
+void vx_range_free(VX_RANGE *vx_range);
+
 /**
  * @brief Append a gap to the p_gaps array in the VX_OBJ structure.
  *
@@ -0,0 +1,323 @@
+/**
+ * @file factor.c
+ * @brief Factorization of 64-bit integers: trial division, then Pollard-Rho-Brent.
+ *
+ * @description:
+ * iz_factor_u64 splits n in three stages:
+ * - the factors 2 and 3 are stripped directly, and the other primes below
+ *   IZ_FACTOR_TRIAL_LIMIT, all of the form 6x ± 1, are tried from a PRIMES_OBJ of
+ *   sieve_iZ cached on first use. A division is replaced by a multiplication with
+ *   the inverse of p mod 2^64: n * p^-1 is the quotient when p divides n, and
+ *   exceeds (2^64 - 1) / p otherwise. Trial division stops at sqrt(n),
+ * - a cofactor below IZ_FACTOR_TRIAL_LIMIT^2 is then prime; a larger one is
+ *   checked by the deterministic Miller-Rabin test u64_is_prime,
+ * - a composite cofactor is split by Pollard's rho with Brent's cycle detection
+ *   in 64-bit Montgomery form (MONT64, montgomery.h), taking one gcd per
+ *   FACTOR_RHO_BATCH steps, and both parts are factored in turn.
+ *
+ * iz_factor_u64_batch factors an array of values on several threads, which take
+ * blocks of FACTOR_BATCH_BLOCK values from a shared counter, as the cost of a value
+ * varies with the size of its second largest factor.
+ *
+ * @usage:
+ * uint64_t factors[IZ_FACTOR_MAX];
+ * int count = iz_factor_u64(18446744073709551615ULL, factors); // 3, 5, 17, 257, 641, 65537, 6700417
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For pthread_once and the threads of iz_factor_u64_batch
+#include <unistd.h>  // For sysconf
+
+#define FACTOR_RHO_BATCH 128   ///< Rho steps multiplied together per gcd
+#define FACTOR_BATCH_BLOCK 64  ///< Values taken at once by a thread of iz_factor_u64_batch
+
+// Trial primes from 5, with their inverses mod 2^64 and the largest exact quotients
+static PRIMES_OBJ *trial_primes = NULL;
+static uint64_t *trial_inv = NULL;
+static uint64_t *trial_max_quotient = NULL;
+static int trial_count = 0;
+static pthread_once_t trial_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Caches the trial primes and their inverses, run once through pthread_once.
+ */
+static void factor_trial_init(void)
+{
+    trial_primes = sieve_iZ(IZ_FACTOR_TRIAL_LIMIT);
+    if (trial_primes == NULL)
+        return;
+
+    trial_inv = malloc(trial_primes->p_count * sizeof(uint64_t));
+    trial_max_quotient = malloc(trial_primes->p_count * sizeof(uint64_t));
+    if (trial_inv == NULL || trial_max_quotient == NULL)
+    {
+        log_error("Memory allocation failed for the trial primes, factoring by rho only.");
+        free(trial_inv);
+        free(trial_max_quotient);
+        trial_inv = trial_max_quotient = NULL;
+        return;
+    }
+
+    // 2 and 3 are stripped before, the table starts at 5
+    for (int i = 2; i < trial_primes->p_count; i++)
+    {
+        uint64_t p = trial_primes->p_array[i];
+
+        // Newton iteration for p^-1 mod 2^64
+        uint64_t inv = p;
+        for (int k = 0; k < 5; k++)
+            inv *= 2 - p * inv;
+
+        trial_inv[i] = inv;
+        trial_max_quotient[i] = UINT64_MAX / p;
+    }
+
+    trial_count = trial_primes->p_count;
+}
+
+/**
+ * @brief Binary gcd of a and an odd n.
+ */
+static uint64_t factor_gcd(uint64_t a, uint64_t n)
+{
+    if (a == 0)
+        return n;
+
+    a >>= __builtin_ctzll(a);
+    while (a != n)
+    {
+        if (a > n)
+        {
+            uint64_t t = a;
+            a = n;
+            n = t;
+        }
+        n -= a;
+        n >>= __builtin_ctzll(n);
+    }
+
+    return a;
+}
+
+/**
+ * @brief One step y -> y^2 + c of the rho iteration, in Montgomery form.
+ */
+static inline uint64_t rho_step(const MONT64 *m, uint64_t y, uint64_t c)
+{
+    y = mont64_mul(m, y, y);
+    return y >= m->n - c ? y - (m->n - c) : y + c;
+}
+
+/**
+ * @brief Finds a non-trivial factor of an odd composite n with Pollard's rho and Brent's cycle detection.
+ *
+ * @param n An odd composite.
+ * @return uint64_t A factor of n in (1, n).
+ */
+static uint64_t rho_brent(uint64_t n)
+{
+    MONT64 m;
+    mont64_init(&m, n);
+
+    // a cycle closing on n itself is retried with another polynomial
+    for (uint64_t c_value = 1;; c_value++)
+    {
+        uint64_t c = mont64_to(&m, c_value);
+        uint64_t y = mont64_to(&m, 2), x = y, saved_y = y;
+        uint64_t q = m.one, g = 1;
+
+        for (uint64_t r = 1; g == 1; r <<= 1)
+        {
+            x = y;
+            for (uint64_t i = 0; i < r; i++)
+                y = rho_step(&m, y, c);
+
+            // |x - y| accumulated over batches, one gcd per batch
+            for (uint64_t k = 0; k < r && g == 1; k += FACTOR_RHO_BATCH)
+            {
+                saved_y = y;
+                uint64_t steps = MIN((uint64_t)FACTOR_RHO_BATCH, r - k);
+                for (uint64_t i = 0; i < steps; i++)
+                {
+                    y = rho_step(&m, y, c);
+                    q = mont64_mul(&m, q, x > y ? x - y : y - x);
+                }
+                g = factor_gcd(q, n);
+            }
+        }
+
+        // the batch overshot to n: replay it one step at a time
+        if (g == n)
+        {
+            do
+            {
+                saved_y = rho_step(&m, saved_y, c);
+                g = factor_gcd(x > saved_y ? x - saved_y : saved_y - x, n);
+            } while (g == 1);
+        }
+
+        if (g != n)
+            return g;
+    }
+}
+
+/**
+ * @brief Appends the prime factors of an n without prime factors below IZ_FACTOR_TRIAL_LIMIT.
+ */
+static void factor_cofactor(uint64_t n, uint64_t *factors, int *count)
+{
+    // without trial primes (allocation failure) the bound says nothing
+    if ((trial_count > 0 && n < (uint64_t)IZ_FACTOR_TRIAL_LIMIT * IZ_FACTOR_TRIAL_LIMIT) || u64_is_prime(n))
+    {
+        factors[(*count)++] = n;
+        return;
+    }
+
+    uint64_t d = rho_brent(n);
+    factor_cofactor(d, factors, count);
+    factor_cofactor(n / d, factors, count);
+}
+
+int iz_factor_u64(uint64_t n, uint64_t *factors)
+{
+    if (n == 0)
+        return -1;
+
+    pthread_once(&trial_once, factor_trial_init);
+
+    int count = 0;
+
+    // 1. Factors 2 and 3
+    int twos = __builtin_ctzll(n);
+    n >>= twos;
+    while (count < twos)
+        factors[count++] = 2;
+
+    while (n % 3 == 0)
+    {
+        factors[count++] = 3;
+        n /= 3;
+    }
+
+    // 2. Trial division by the cached 6x ± 1 primes, up to sqrt(n)
+    int is_covered = 0; // 1 once the trial primes pass sqrt(n)
+    for (int i = 2; i < trial_count; i++)
+    {
+        uint64_t p = trial_primes->p_array[i];
+        if (p * p > n)
+        {
+            is_covered = 1;
+            break;
+        }
+
+        // p divides n iff n * p^-1 is an exact quotient
+        uint64_t quotient = n * trial_inv[i];
+        while (quotient <= trial_max_quotient[i])
+        {
+            factors[count++] = p;
+            n = quotient;
+            quotient = n * trial_inv[i];
+        }
+    }
+
+    // 3. The cofactor: 1, a prime, or split by rho
+    if (n > 1)
+    {
+        if (is_covered)
+            factors[count++] = n;
+        else
+        {
+            int first = count;
+            factor_cofactor(n, factors, &count);
+
+            // rho finds factors in no particular order
+            for (int a = first + 1; a < count; a++)
+            {
+                uint64_t f = factors[a];
+                int b = a;
+                for (; b > first && factors[b - 1] > f; b--)
+                    factors[b] = factors[b - 1];
+                factors[b] = f;
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @struct FACTOR_BATCH
+ * @brief The shared state of the threads of iz_factor_u64_batch.
+ */
+typedef struct
+{
+    const uint64_t *values; ///< The values to factor
+    size_t count;           ///< Number of values
+    uint64_t *factors;      ///< IZ_FACTOR_MAX factors per value
+    int *factor_counts;     ///< Number of factors per value
+    size_t next;            ///< First value not taken yet, advanced atomically
+} FACTOR_BATCH;
+
+/**
+ * @brief Thread body of iz_factor_u64_batch: factors blocks of values until none are left.
+ *
+ * @param arg The FACTOR_BATCH.
+ * @return void* NULL.
+ */
+static void *factor_batch_worker(void *arg)
+{
+    FACTOR_BATCH *batch = arg;
+
+    for (;;)
+    {
+        size_t first = __atomic_fetch_add(&batch->next, FACTOR_BATCH_BLOCK, __ATOMIC_RELAXED);
+        if (first >= batch->count)
+            break;
+
+        size_t end = MIN(first + FACTOR_BATCH_BLOCK, batch->count);
+        for (size_t i = first; i < end; i++)
+            batch->factor_counts[i] = iz_factor_u64(batch->values[i], batch->factors + i * IZ_FACTOR_MAX);
+    }
+
+    return NULL;
+}
+
+int iz_factor_u64_batch(const uint64_t *values, size_t count, uint64_t *factors, int *factor_counts, int threads)
+{
+    if (values == NULL || factors == NULL || factor_counts == NULL || threads < 0)
+    {
+        log_error("Invalid arguments in iz_factor_u64_batch.");
+        return 0;
+    }
+
+    if (threads == 0)
+        threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (int)MAX(MIN((size_t)threads, (count + FACTOR_BATCH_BLOCK - 1) / FACTOR_BATCH_BLOCK), 1);
+
+    // the trial primes are cached before the threads share them
+    pthread_once(&trial_once, factor_trial_init);
+
+    FACTOR_BATCH batch = {values, count, factors, factor_counts, 0};
+    pthread_t *thread_ids = threads > 1 ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+
+    // Helper threads; the calling thread works too, and takes over the blocks of
+    // threads that could not be started
+    int started = 0;
+    for (int t = 1; t < threads && thread_ids != NULL; t++)
+    {
+        if (pthread_create(&thread_ids[started], NULL, factor_batch_worker, &batch) != 0)
+        {
+            log_message(LOG_WARNING, "iz_factor_u64_batch: started %d of %d threads", started + 1, threads);
+            break;
+        }
+        started++;
+    }
+
+    factor_batch_worker(&batch);
+
+    for (int t = 0; t < started; t++)
+        pthread_join(thread_ids[t], NULL);
+    free(thread_ids);
+
+    return 1;
+}
@@ -46,6 +46,18 @@
 #include <string.h>   // For strlen
 #include <time.h>     // For time
 
+/**
+ * @brief Tests a candidate by iZ_probab_prime with the tuned rounds, as the primality phase
+ * of the performance counters.
+ */
+static int prime_gen_test(mpz_t n)
+{
+    IZ_PERF_BEGIN(IZ_PERF_PRIMALITY);
+    int is_prime = iZ_probab_prime(n, iz_tuning()->test_rounds);
+    IZ_PERF_END();
+    return is_prime;
+}
+
 /**
  * @brief Seed the GMP random state.
  *
@@ -127,7 +139,7 @@ int search_iZprime(mpz_t p, int p_id, mpz_t vx)
         mpz_add(tmp, tmp, vx);
 
         // check if tmp is prime
-        found = mpz_probab_prime_p(tmp, TEST_ROUNDS);
+        found = prime_gen_test(tmp);
 
         // if tmp is prime, set p = tmp
         if (found)
@@ -305,7 +317,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
     if (mpz_fdiv_ui(tmp, 6) == 5 && forward)
     {
         mpz_add_ui(tmp, tmp, 2); // increment tmp by 2
-        if (mpz_probab_prime_p(tmp, TEST_ROUNDS))
+        if (prime_gen_test(tmp))
         {
             mpz_set(p, tmp); // set p = tmp + 2
             mpz_clear(tmp);
@@ -316,7 +328,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
     else if (mpz_fdiv_ui(tmp, 6) == 1 && !forward)
     {
         mpz_sub_ui(tmp, tmp, 2); // decrement tmp by 2
-        if (mpz_probab_prime_p(tmp, TEST_ROUNDS))
+        if (prime_gen_test(tmp))
         {
             mpz_set(p, tmp); // set p = tmp - 2
             mpz_clear(tmp);
@@ -324,11 +336,21 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
         }
     }
 
-    // b. Create pre-sieved vx bitmaps
-    BITMAP *x5 = bitmap_create(vx + 10);
-    BITMAP *x7 = bitmap_create(vx + 10);
-    // construct iZ matrix segment
-    construct_iZm_segment(vx, x5, x7);
+    // b. Create pre-sieved vx bitmaps, copied from the compiled-in tables if available
+    BITMAP *x5, *x7;
+    VX_ASSETS *static_assets = vx_assets_static(vx);
+    if (static_assets != NULL)
+    {
+        x5 = bitmap_clone(static_assets->base_x5);
+        x7 = bitmap_clone(static_assets->base_x7);
+    }
+    else
+    {
+        x5 = bitmap_create(vx + 10);
+        x7 = bitmap_create(vx + 10);
+        // construct iZ matrix segment
+        construct_iZm_segment(vx, x5, x7);
+    }
 
     // c. Initialize and set y and yvx
     mpz_t y, yvx;
@@ -367,7 +389,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
                     mpz_add_ui(x_p, yvx, x); // set x_p = yvx + x
                     iZ_gmp(tmp, x_p, -1);    // compute p = iZ(x_p, -1)
                     // check if tmp is prime
-                    found = mpz_probab_prime_p(tmp, TEST_ROUNDS);
+                    found = prime_gen_test(tmp);
 
                     if (found)
                         break;
@@ -379,7 +401,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
                     mpz_add_ui(x_p, yvx, x); // set x_p = yvx + x
                     iZ_gmp(tmp, x_p, 1);     // compute tmp = iZ(x_p, 1)
                     // check if tmp is prime
-                    found = mpz_probab_prime_p(tmp, TEST_ROUNDS);
+                    found = prime_gen_test(tmp);
 
                     if (found)
                         break;
@@ -402,7 +424,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
                     mpz_add_ui(x_p, yvx, x); // set x_p = yvx + x
                     iZ_gmp(tmp, x_p, 1);     // compute tmp = iZ(x_p, 1)
                     // check if tmp is prime
-                    found = mpz_probab_prime_p(tmp, TEST_ROUNDS);
+                    found = prime_gen_test(tmp);
 
                     if (found)
                         break;
@@ -414,7 +436,7 @@ int iZ_next_prime(mpz_t p, mpz_t base, int forward)
                     mpz_add_ui(x_p, yvx, x); // set x_p = yvx + x
                     iZ_gmp(tmp, x_p, -1);    // compute p = iZ(x_p, -1)
                     // check if tmp is prime
-                    found = mpz_probab_prime_p(tmp, TEST_ROUNDS);
+                    found = prime_gen_test(tmp);
 
                     if (found)
                         break;
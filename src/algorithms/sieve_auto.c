@@ -0,0 +1,158 @@
+/**
+ * @file sieve_auto.c
+ * @brief Automatic selection of the sieve engine, segment size and thread count.
+ *
+ * @description:
+ * No single engine wins everywhere: the classic sieve_iZ has the least setup and
+ * wins for small n, while the segmented wheel-30 engine wins once its tables and
+ * segment pay off. iz_sieve_plan picks:
+ * - the engine, from the calibration table below for lists, and the wheel-30
+ *   engine for counts and streams (the only engine with those outputs),
+ * - the segment size, as a multiple of the L1 data cache given by the table,
+ * - the thread count, one per online CPU (or the threads of the tuning profile) as
+ *   long as each thread gets at least SIEVE_AUTO_MIN_SEGMENTS segments; streams
+ *   stay on one thread to keep their order.
+ *
+ * The table comes from benchmark_sieve_calibration, which times every engine
+ * at each power of 10 and prints the rows to paste here.
+ *
+ * @usage:
+ * PRIMES_OBJ *primes = iz_sieve_auto(100000000, IZ_SIEVE_LIST);
+ * uint64_t pi = iz_sieve_auto_count(10000000000, IZ_SIEVE_COUNT);
+ * primes_obj_free(primes);
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For pthread_once
+#include <unistd.h>  // For sysconf
+
+#define SIEVE_AUTO_MIN_SEGMENTS 8        ///< Fewest segments worth a thread of their own
+#define SIEVE_AUTO_DEFAULT_L1 (32 * 1024) ///< L1 data cache size when the host doesn't report it
+
+// Fastest list engine per range of n, from benchmark_sieve_calibration(10)
+// on a Xeon with 48 KB L1d and 2 MB L2, single thread
+static const IZ_SIEVE_CALIBRATION sieve_auto_table[] = {
+    {3162ULL, IZ_ENGINE_ERATOSTHENES, 1},
+    {31623ULL, IZ_ENGINE_IZ, 1},
+    {316228ULL, IZ_ENGINE_WHEEL30, 4},
+    {UINT64_MAX, IZ_ENGINE_WHEEL30, 1},
+};
+
+static const char *engine_names[IZ_ENGINE_COUNT] = {
+    "Sieve-Eratosthenes",
+    "Segmented-Sieve",
+    "Sieve-Euler",
+    "Sieve-Atkin",
+    "Sieve-iZ",
+    "Sieve-iZm",
+    "Sieve-Wheel30",
+};
+
+static size_t host_l1_bytes = SIEVE_AUTO_DEFAULT_L1;
+static int host_cpus = 1;
+static pthread_once_t host_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Reads the L1 data cache size and CPU count of the host, run once through pthread_once.
+ */
+static void sieve_auto_read_host(void)
+{
+    long l1 = 0;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+
+    // round down to a power of two, e.g. 48 KB -> 32 KB
+    if (l1 > 0)
+    {
+        size_t bytes = 4096;
+        while (bytes * 2 <= (size_t)l1)
+            bytes *= 2;
+        host_l1_bytes = bytes;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    host_cpus = cpus > 0 ? (int)cpus : 1;
+
+    log_message(LOG_DEBUG, "sieve_auto: %zu bytes L1d segment unit, %d CPU(s)", host_l1_bytes, host_cpus);
+}
+
+const char *iz_sieve_engine_name(IZ_SIEVE_ENGINE engine)
+{
+    if (engine < 0 || engine >= IZ_ENGINE_COUNT)
+        return "unknown";
+
+    return engine_names[engine];
+}
+
+IZ_SIEVE_PLAN iz_sieve_plan(uint64_t n, int flags)
+{
+    pthread_once(&host_once, sieve_auto_read_host);
+
+    // the row of n in the calibration table
+    const IZ_SIEVE_CALIBRATION *row = sieve_auto_table;
+    while (n > row->n_max)
+        row++;
+
+    IZ_SIEVE_PLAN plan;
+    plan.mode = flags & IZ_SIEVE_MODE_MASK;
+    plan.engine = plan.mode == IZ_SIEVE_LIST ? row->engine : IZ_ENGINE_WHEEL30;
+    plan.segment_bytes = 0;
+    plan.threads = 1;
+
+    if (plan.engine != IZ_ENGINE_WHEEL30)
+        return plan;
+
+    plan.segment_bytes = host_l1_bytes * MAX(row->segment_l1, 1);
+
+    if (plan.mode != IZ_SIEVE_STREAM && !(flags & IZ_SIEVE_SEQUENTIAL))
+    {
+        int cpus = iz_tuning()->threads > 0 ? iz_tuning()->threads : host_cpus;
+        uint64_t segments = (n / 30 + 1) / plan.segment_bytes;
+        plan.threads = (int)MAX(MIN((uint64_t)cpus, segments / SIEVE_AUTO_MIN_SEGMENTS), 1);
+    }
+
+    return plan;
+}
+
+PRIMES_OBJ *iz_sieve_run(uint64_t n, IZ_SIEVE_PLAN plan)
+{
+    switch (plan.engine)
+    {
+    case IZ_ENGINE_ERATOSTHENES:
+        return sieve_eratosthenes(n);
+    case IZ_ENGINE_SEGMENTED:
+        return segmented_sieve(n);
+    case IZ_ENGINE_EULER:
+        return sieve_euler(n);
+    case IZ_ENGINE_ATKIN:
+        return sieve_atkin(n);
+    case IZ_ENGINE_IZ:
+        return sieve_iZ(n);
+    case IZ_ENGINE_IZM:
+        return sieve_iZm(n);
+    case IZ_ENGINE_WHEEL30:
+        return sieve_wheel30_list(n, plan.segment_bytes, MAX(plan.threads, 1));
+    default:
+        log_message(LOG_ERROR, "iz_sieve_run: unknown engine %d", (int)plan.engine);
+        return NULL;
+    }
+}
+
+PRIMES_OBJ *iz_sieve_auto(uint64_t n, int flags)
+{
+    IZ_SIEVE_PLAN plan = iz_sieve_plan(n, (flags & ~IZ_SIEVE_MODE_MASK) | IZ_SIEVE_LIST);
+    return iz_sieve_run(n, plan);
+}
+
+uint64_t iz_sieve_auto_count(uint64_t n, int flags)
+{
+    IZ_SIEVE_PLAN plan = iz_sieve_plan(n, (flags & ~IZ_SIEVE_MODE_MASK) | IZ_SIEVE_COUNT);
+    return sieve_wheel30_count(n, plan.segment_bytes, plan.threads);
+}
+
+uint64_t iz_sieve_auto_stream(uint64_t n, int flags, IZ_PRIME_CALLBACK callback, void *ctx)
+{
+    IZ_SIEVE_PLAN plan = iz_sieve_plan(n, (flags & ~IZ_SIEVE_MODE_MASK) | IZ_SIEVE_STREAM);
+    return sieve_wheel30_stream(n, plan.segment_bytes, callback, ctx);
+}
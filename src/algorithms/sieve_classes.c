@@ -0,0 +1,603 @@
+/**
+ * @file sieve_classes.c
+ * @brief Primes in residue classes: per-class counts and enumeration over [lo, hi], sieving the iZm columns of the classes.
+ *
+ * @description:
+ * In iZm with segment width vx, the number 6x ± 1 sits in row y = x / vx and column
+ * c = x mod vx, and 6(y vx + c) ± 1 ≡ 6c ± 1 (mod 6 vx): a column holds a single
+ * residue class mod 6 vx, and so mod every m dividing 6 vx. The sieve thus runs
+ * column by column, over the rows of the range:
+ * - vx takes the part of m coprime to 6, times small primes from 5 while the
+ *   columns stay long enough, so m divides 6 vx unless 4 or 9 divides m, and every
+ *   column is a class mod m (else mod gcd(m, 6 vx), see below). A column whose 6c ± 1 shares a factor
+ *   with vx holds no primes beyond that factor, and is dropped,
+ * - a root prime p not dividing vx hits column c at the rows y ≡ (x_p - c) vx^-1
+ *   (mod p), the solve_for_y offset, and every p rows after; the offset of a
+ *   block of rows follows from the previous one by the block length mod p,
+ * - the primes of a column are then counted by popcount, for the column's class.
+ * As in sieve_iZm, the small root primes clear whole words with BITMAP_PATTERN.
+ *
+ * Only the columns of the requested classes are sieved. When m is too large to
+ * divide 6 vx with columns of a useful length, vx takes the largest part of m that
+ * fits: the columns then give the class mod g = gcd(m, 6 vx), only the columns of
+ * the requested class mod g are sieved, and the class mod m of each prime found is
+ * read from its value (the other CRT component).
+ *
+ * The counts are split over threads by column. The stream sieves windows of rows
+ * in all its columns and walks them row by row, so that the primes come in
+ * increasing order; it uses a narrower vx, as the window is shared by the columns.
+ *
+ * @usage:
+ * uint64_t counts[4];
+ * iz_count_primes_mod(1, 1000000000000ULL, 4, counts, 0); // counts[1], counts[3]: Chebyshev's bias
+ * uint64_t count = iz_count_primes_in_class(1, 1000000000, 1, 10, 0); // primes ending in 1
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For the threads of iz_count_primes_mod
+#include <unistd.h>  // For sysconf
+
+#define CLASS_BLOCK_ROWS (1 << 20)   ///< Rows of a column sieved at once: 128 KB, sized for the L2 cache
+#define CLASS_STREAM_BITS (1 << 24)  ///< Bits of a stream window, over all its columns
+#define CLASS_STREAM_WHEEL 35        ///< Product of the small primes added to vx by the stream: 5 * 7
+#define CLASS_NO_CLASS UINT64_MAX    ///< Class filter of the sieves counting every class
+
+/**
+ * @struct CLASS_SIEVE
+ * @brief The plan of a residue-class sieve: vx, the selected columns and the root primes.
+ */
+typedef struct
+{
+    uint64_t lo, hi;          ///< The range
+    uint64_t m, m_inv;        ///< The modulus and fast_mod_inv(m)
+    uint64_t a;               ///< The class, CLASS_NO_CLASS for all of them
+    uint64_t vx;              ///< Segment width: the columns of iZm
+    uint64_t g;               ///< gcd(m, 6 vx): the columns are classes mod g
+    uint64_t x_min[2];        ///< Least x of 6x - 1 (index 0) and 6x + 1 (index 1) in the range
+    uint64_t x_max[2];        ///< Largest x of each side, x_max < x_min if the side is empty
+    PRIMES_OBJ *root_primes;  ///< Primes up to sqrt(hi)
+    ROOT_PRIME_TABLE *table;  ///< The root primes with vx
+    uint32_t *vx_inv;         ///< vx^-1 mod p, 0 for the primes dividing 6 vx
+    uint32_t *rows_mod_p;     ///< CLASS_BLOCK_ROWS mod p, or the stream window mod p
+    BITMAP_PATTERN *patterns; ///< Word patterns of the root primes below pattern_end
+    int pattern_end;          ///< End of the root primes below the tuned pattern_max_p
+    uint64_t *columns;        ///< Selected columns, 2c + side, c ascending
+    size_t column_count;      ///< Number of selected columns
+    uint64_t specials[16];    ///< 2, 3 and the primes dividing vx, in the range and class
+    int special_count;        ///< Number of specials
+} CLASS_SIEVE;
+
+static uint64_t class_gcd(uint64_t a, uint64_t b)
+{
+    while (b)
+    {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief The class of a value, mod m.
+ */
+static inline uint64_t class_of(const CLASS_SIEVE *sieve, uint64_t value)
+{
+    return sieve->m == 1 ? 0 : fast_mod(value, sieve->m, sieve->m_inv);
+}
+
+/**
+ * @brief Plans a residue-class sieve: picks vx, selects the columns and lists the root primes.
+ *
+ * @param sieve The plan, zeroed.
+ * @param a The class, CLASS_NO_CLASS for all of them.
+ * @param vx_cap The largest vx.
+ * @param wheel_cap The largest product of the small primes added to vx.
+ * @param rows The rows sieved at once, for rows_mod_p.
+ * @return int 1 on success, 0 if memory allocation failed.
+ */
+static int class_sieve_init(CLASS_SIEVE *sieve, uint64_t lo, uint64_t hi, uint64_t a, uint64_t m,
+                            uint64_t vx_cap, uint64_t wheel_cap, uint64_t rows)
+{
+    sieve->lo = lo;
+    sieve->hi = hi;
+    sieve->m = m;
+    sieve->m_inv = m > 1 ? fast_mod_inv(m) : 0;
+    sieve->a = a;
+
+    // 1. vx: the part of m coprime to 6, or its largest part below vx_cap, times small primes
+    uint64_t m_part = m;
+    while (m_part % 2 == 0)
+        m_part /= 2;
+    while (m_part % 3 == 0)
+        m_part /= 3;
+    uint64_t factors[IZ_FACTOR_MAX];
+    int factor_count = iz_factor_u64(m_part, factors);
+
+    uint64_t vx = 1;
+    for (int k = 0; k < factor_count; k++)
+        if (vx * factors[k] <= vx_cap)
+            vx *= factors[k];
+
+    static const uint64_t wheel[] = {5, 7, 11, 13, 17, 19, 23};
+    uint64_t wheel_product = 1;
+    for (int k = 0; k < 7; k++)
+    {
+        if (vx % wheel[k] == 0)
+            continue;
+        if (vx * wheel[k] > vx_cap || wheel_product * wheel[k] > wheel_cap)
+            break;
+        vx *= wheel[k];
+        wheel_product *= wheel[k];
+    }
+
+    sieve->vx = vx;
+    sieve->g = class_gcd(m, 6 * vx);
+
+    // 2. The x of each side in the range, from x = 1 (5 and 7)
+    sieve->x_min[0] = MAX((lo + 1 + 5) / 6, 1);
+    sieve->x_max[0] = (hi + 1) / 6;
+    sieve->x_min[1] = MAX((lo - 1 + 5) / 6, 1);
+    sieve->x_max[1] = hi >= 1 ? (hi - 1) / 6 : 0;
+
+    // 3. Specials: 2, 3 and the prime factors of vx, which have no column
+    uint64_t candidates[18] = {2, 3};
+    int candidate_count = 2;
+    uint64_t rest = vx;
+    for (int k = 0; k < factor_count; k++)
+    {
+        if (rest % factors[k] == 0)
+        {
+            candidates[candidate_count++] = factors[k];
+            while (rest % factors[k] == 0)
+                rest /= factors[k];
+        }
+    }
+    for (int k = 0; k < 7 && rest > 1; k++)
+    {
+        if (rest % wheel[k] == 0)
+        {
+            candidates[candidate_count++] = wheel[k];
+            rest /= wheel[k];
+        }
+    }
+
+    for (int k = 0; k < candidate_count; k++)
+    {
+        uint64_t p = candidates[k];
+        if (p >= lo && p <= hi && (a == CLASS_NO_CLASS || class_of(sieve, p) == a))
+            sieve->specials[sieve->special_count++] = p;
+    }
+
+    // in increasing order, for the stream
+    for (int i = 1; i < sieve->special_count; i++)
+        for (int j = i; j > 0 && sieve->specials[j - 1] > sieve->specials[j]; j--)
+        {
+            uint64_t t = sieve->specials[j];
+            sieve->specials[j] = sieve->specials[j - 1];
+            sieve->specials[j - 1] = t;
+        }
+
+    // 4. Root primes up to sqrt(hi), with vx^-1 mod p
+    sieve->root_primes = iz_sieve_auto(MAX((uint64_t)sqrtl((long double)hi) + 1, 10), IZ_SIEVE_SEQUENTIAL);
+    if (sieve->root_primes == NULL)
+        return 0;
+
+    int p_count = sieve->root_primes->p_count;
+    sieve->table = root_table_init(sieve->root_primes, p_count, vx);
+    sieve->vx_inv = calloc(p_count, sizeof(uint32_t));
+    sieve->rows_mod_p = calloc(p_count, sizeof(uint32_t));
+    if (sieve->table == NULL || sieve->vx_inv == NULL || sieve->rows_mod_p == NULL)
+        return 0;
+
+    for (int k = 2; k < p_count; k++)
+    {
+        uint64_t p = sieve->table->p[k];
+        if (sieve->table->vx_mod_p[k] != 0)
+            sieve->vx_inv[k] = (uint32_t)modular_inverse((int)sieve->table->vx_mod_p[k], (int)p);
+        sieve->rows_mod_p[k] = (uint32_t)(rows % p);
+    }
+
+    // the small root primes, which mark every word of a column, are cleared by word patterns
+    int pattern_end = 2;
+    while (pattern_end < p_count && sieve->table->p[pattern_end] < (uint64_t)iz_tuning()->pattern_max_p)
+        pattern_end++;
+
+    sieve->patterns = malloc(pattern_end * sizeof(BITMAP_PATTERN));
+    if (sieve->patterns == NULL)
+        return 0;
+
+    sieve->pattern_end = pattern_end;
+    for (int k = 2; k < pattern_end; k++)
+        bitmap_pattern_init(&sieve->patterns[k], sieve->table->p[k]);
+
+    // 5. The columns coprime to vx, of the class mod g if one is requested
+    sieve->columns = malloc(2 * vx * sizeof(uint64_t));
+    if (sieve->columns == NULL)
+        return 0;
+
+    for (uint64_t c = 0; c < vx; c++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            // 6c ± 1 + 6 vx, positive, in the column's class mod 6 vx
+            uint64_t value = 6 * (c + vx) + 2 * side - 1;
+            if (class_gcd(value % vx, vx) != 1)
+                continue;
+            if (a != CLASS_NO_CLASS && value % sieve->g != a % sieve->g)
+                continue;
+            if (sieve->x_max[side] < MAX(sieve->x_min[side], c))
+                continue; // no row in the range
+
+            sieve->columns[sieve->column_count++] = 2 * c + side;
+        }
+    }
+
+    return 1;
+}
+
+static void class_sieve_free(CLASS_SIEVE *sieve)
+{
+    root_table_free(sieve->table);
+    primes_obj_free(sieve->root_primes);
+    free(sieve->vx_inv);
+    free(sieve->rows_mod_p);
+    free(sieve->patterns);
+    free(sieve->columns);
+}
+
+/**
+ * @brief The rows of a column holding values of the range.
+ *
+ * @return int 0 if there are none.
+ */
+static int class_column_rows(const CLASS_SIEVE *sieve, uint64_t column, uint64_t *y_lo, uint64_t *y_hi)
+{
+    uint64_t c = column >> 1;
+    int side = column & 1;
+
+    if (sieve->x_max[side] < MAX(sieve->x_min[side], c))
+        return 0;
+
+    *y_lo = sieve->x_min[side] > c ? (sieve->x_min[side] - c + sieve->vx - 1) / sieve->vx : 0;
+    *y_hi = (sieve->x_max[side] - c) / sieve->vx;
+    return *y_lo <= *y_hi;
+}
+
+/**
+ * @brief Sieves the rows [y_b, y_b + rows) of a column: bit r is set if 6((y_b + r) vx + c) ± 1 is prime.
+ *
+ * @description:
+ * The rows must hold values of the range. offsets[k] is the first row of the
+ * root prime k from y_b, computed if init is set, and stepped by rows_mod_p
+ * afterwards for the next block.
+ *
+ * @param sieve The plan.
+ * @param column The column, 2c + side.
+ * @param y_b The first row.
+ * @param rows The number of rows, at most the bitmap size.
+ * @param offsets The offsets of the root primes.
+ * @param init 1 to compute the offsets.
+ * @param bits The bitmap receiving the rows.
+ */
+static void class_sieve_column(const CLASS_SIEVE *sieve, uint64_t column, uint64_t y_b, size_t rows,
+                               uint32_t *offsets, int init, BITMAP *bits)
+{
+    const ROOT_PRIME_TABLE *table = sieve->table;
+    uint64_t c = column >> 1, vx = sieve->vx;
+    int side = column & 1;
+    int64_t sign = side ? 1 : -1;
+
+    // 1. The rows of the block set, the rest of the bitmap clear
+    size_t full_bytes = rows / 8;
+    memset(bits->data, 0xFF, full_bytes);
+    memset(bits->data + full_bytes, 0, (bits->size + 7) / 8 - full_bytes);
+    for (size_t r = full_bytes * 8; r < rows; r++)
+        bitmap_set_bit(bits, r);
+
+    // 2. Every root prime from 5 not dividing vx clears its rows
+    for (int k = 2; k < table->p_count; k++)
+    {
+        uint32_t vx_inv = sieve->vx_inv[k];
+        if (vx_inv == 0)
+            continue;
+
+        uint64_t p = table->p[k];
+        if (init)
+        {
+            // y ≡ (x_p - c) vx^-1 (mod p), then from y_b
+            uint64_t x_p = side ? table->x7_p[k] : table->x5_p[k];
+            uint64_t delta = x_p + p - fast_mod(c, p, table->p_inv[k]);
+            uint64_t y = fast_mod(delta * vx_inv, p, table->p_inv[k]);
+            uint64_t y_b_mod_p = fast_mod(y_b, p, table->p_inv[k]);
+            offsets[k] = (uint32_t)(y >= y_b_mod_p ? y - y_b_mod_p : y + p - y_b_mod_p);
+        }
+
+        uint64_t idx = offsets[k];
+
+        // p itself is the first value of the column divisible by p
+        if (6 * ((y_b + idx) * vx + c) + sign == p)
+            idx += p;
+
+        if (idx < rows && k < sieve->pattern_end)
+            bitmap_clear_pattern(bits, &sieve->patterns[k], idx, rows - 1);
+        else if (idx < rows)
+            bitmap_clear_mod_p(bits, p, idx, rows - 1);
+
+        // the offset of the next block
+        uint32_t step = sieve->rows_mod_p[k];
+        offsets[k] = offsets[k] >= step ? offsets[k] - step : offsets[k] + (uint32_t)p - step;
+    }
+}
+
+/**
+ * @struct CLASS_COUNT
+ * @brief The shared state of the threads of a residue-class count.
+ */
+typedef struct
+{
+    const CLASS_SIEVE *sieve;
+    uint64_t *counts;  ///< Per class, or a single count
+    size_t next;       ///< First column not taken yet, advanced atomically
+    int status;        ///< 1 on success, 0 if memory allocation failed
+} CLASS_COUNT;
+
+/**
+ * @brief Thread body of the counts: sieves and counts columns until none are left.
+ *
+ * @param arg The CLASS_COUNT.
+ * @return void* NULL.
+ */
+static void *class_count_worker(void *arg)
+{
+    CLASS_COUNT *job = arg;
+    const CLASS_SIEVE *sieve = job->sieve;
+    int is_direct = sieve->g == sieve->m; // every column is a class mod m
+    int is_single = sieve->a != CLASS_NO_CLASS;
+
+    BITMAP *bits = bitmap_create(CLASS_BLOCK_ROWS);
+    uint32_t *offsets = malloc(sieve->table->p_count * sizeof(uint32_t));
+    uint64_t *counts = is_direct || is_single ? NULL : calloc(sieve->m, sizeof(uint64_t));
+    uint64_t single = 0;
+
+    if (bits == NULL || offsets == NULL || (!is_direct && !is_single && counts == NULL))
+    {
+        __atomic_store_n(&job->status, 0, __ATOMIC_RELAXED);
+        bitmap_free(bits);
+        free(offsets);
+        free(counts);
+        return NULL;
+    }
+
+    for (;;)
+    {
+        size_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= sieve->column_count)
+            break;
+
+        uint64_t column = sieve->columns[i], y_lo, y_hi;
+        if (!class_column_rows(sieve, column, &y_lo, &y_hi))
+            continue;
+
+        uint64_t c = column >> 1;
+        int64_t sign = (column & 1) ? 1 : -1;
+        uint64_t column_count = 0;
+
+        for (uint64_t y_b = y_lo; y_b <= y_hi; y_b += CLASS_BLOCK_ROWS)
+        {
+            size_t rows = (size_t)MIN((uint64_t)CLASS_BLOCK_ROWS, y_hi - y_b + 1);
+            class_sieve_column(sieve, column, y_b, rows, offsets, y_b == y_lo, bits);
+
+            if (is_direct)
+                column_count += bitmap_popcount(bits);
+            else
+            {
+                // the class mod m from the value
+                for (size_t r = bitmap_scan_next(bits, 0); r < rows; r = bitmap_scan_next(bits, r + 1))
+                {
+                    uint64_t value_class = class_of(sieve, 6 * ((y_b + r) * sieve->vx + c) + sign);
+                    if (is_single)
+                        single += value_class == sieve->a;
+                    else
+                        counts[value_class]++;
+                }
+            }
+        }
+
+        if (is_direct)
+        {
+            uint64_t *target = is_single ? job->counts : job->counts + class_of(sieve, 6 * (c + sieve->vx) + sign);
+            __atomic_fetch_add(target, column_count, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (is_single && !is_direct)
+        __atomic_fetch_add(job->counts, single, __ATOMIC_RELAXED);
+    for (uint64_t k = 0; counts != NULL && k < sieve->m; k++)
+        if (counts[k])
+            __atomic_fetch_add(job->counts + k, counts[k], __ATOMIC_RELAXED);
+
+    bitmap_free(bits);
+    free(offsets);
+    free(counts);
+    return NULL;
+}
+
+/**
+ * @brief Counts the primes of [lo, hi] in class a mod m, or in every class, on several threads.
+ *
+ * @param counts m counts for every class, or a single count for class a.
+ * @return int 1 on success, 0 if memory allocation failed.
+ */
+static int class_count(uint64_t lo, uint64_t hi, uint64_t a, uint64_t m, uint64_t *counts, int threads)
+{
+    // vx leaves each column at least four blocks of rows
+    uint64_t x_span = hi / 6 - lo / 6 + 1;
+    uint64_t vx_cap = MAX(MIN((uint64_t)VX6, x_span / (4 * (uint64_t)CLASS_BLOCK_ROWS)), 1);
+
+    CLASS_SIEVE sieve = {0};
+    int status = class_sieve_init(&sieve, lo, hi, a, m, vx_cap, UINT64_MAX, CLASS_BLOCK_ROWS);
+
+    if (status)
+    {
+        for (int k = 0; k < sieve.special_count; k++)
+            counts[a == CLASS_NO_CLASS ? class_of(&sieve, sieve.specials[k]) : 0]++;
+
+        if (threads == 0)
+            threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (int)MAX(MIN((size_t)threads, sieve.column_count), 1);
+
+        CLASS_COUNT job = {&sieve, counts, 0, 1};
+        pthread_t *thread_ids = threads > 1 ? malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+
+        // Helper threads; the calling thread works too, and takes over the columns of
+        // threads that could not be started
+        int started = 0;
+        for (int t = 1; t < threads && thread_ids != NULL; t++)
+        {
+            if (pthread_create(&thread_ids[started], NULL, class_count_worker, &job) != 0)
+                break;
+            started++;
+        }
+
+        class_count_worker(&job);
+
+        for (int t = 0; t < started; t++)
+            pthread_join(thread_ids[t], NULL);
+        free(thread_ids);
+
+        status = job.status;
+    }
+
+    if (!status)
+        log_error("Memory allocation failed in the residue-class sieve.");
+
+    class_sieve_free(&sieve);
+    return status;
+}
+
+int iz_count_primes_mod(uint64_t lo, uint64_t hi, uint64_t m, uint64_t *counts, int threads)
+{
+    if (counts == NULL || m == 0 || m > IZ_CLASS_MAX_M || lo > hi || hi > IZ_CLASS_MAX_N || threads < 0)
+    {
+        log_error("Invalid range, modulus or threads in iz_count_primes_mod.");
+        return 0;
+    }
+
+    memset(counts, 0, m * sizeof(uint64_t));
+    return class_count(lo, hi, CLASS_NO_CLASS, m, counts, threads);
+}
+
+uint64_t iz_count_primes_in_class(uint64_t lo, uint64_t hi, uint64_t a, uint64_t m, int threads)
+{
+    if (m == 0 || a >= m || lo > hi || hi > IZ_CLASS_MAX_N || threads < 0)
+    {
+        log_error("Invalid range, class or threads in iz_count_primes_in_class.");
+        return 0;
+    }
+
+    uint64_t count = 0;
+    return class_count(lo, hi, a, m, &count, threads) ? count : 0;
+}
+
+uint64_t iz_primes_mod_stream(uint64_t lo, uint64_t hi, uint64_t a, uint64_t m, IZ_PRIME_CALLBACK callback, void *ctx)
+{
+    if (callback == NULL || m == 0 || a >= m || lo > hi || hi > IZ_CLASS_MAX_N)
+    {
+        log_error("Invalid range, class or callback in iz_primes_mod_stream.");
+        return 0;
+    }
+
+    // a window of rows is shared by the columns: few small primes in vx, to keep them few
+    uint64_t x_span = hi / 6 - lo / 6 + 1;
+    uint64_t vx_cap = MAX(MIN((uint64_t)VX6, x_span / (4 * (uint64_t)CLASS_BLOCK_ROWS)), 1);
+
+    CLASS_SIEVE sieve = {0};
+    size_t window = 0;
+    BITMAP **bits = NULL;
+    uint32_t *offsets = NULL;
+
+    // the offsets are computed for each window, rows_mod_p is unused
+    int status = class_sieve_init(&sieve, lo, hi, a, m, vx_cap, CLASS_STREAM_WHEEL, 0);
+    if (status)
+    {
+        window = MAX(CLASS_STREAM_BITS / MAX(sieve.column_count, 1) / 64 * 64, 64);
+        bits = calloc(MAX(sieve.column_count, 1), sizeof(BITMAP *));
+        offsets = malloc(sieve.table->p_count * sizeof(uint32_t));
+        status = bits != NULL && offsets != NULL;
+        for (size_t i = 0; status && i < sieve.column_count; i++)
+            status = (bits[i] = bitmap_create(window)) != NULL;
+    }
+
+    uint64_t count = 0;
+    int special = 0, is_stopped = 0;
+    if (status && sieve.column_count > 0)
+    {
+        uint64_t y_first = MIN(sieve.x_min[0], sieve.x_min[1]) / sieve.vx;
+        uint64_t y_last = MAX(sieve.x_max[0], sieve.x_max[1]) / sieve.vx;
+
+        for (uint64_t y_w = y_first; y_w <= y_last && !is_stopped; y_w += window)
+        {
+            uint64_t w_last = MIN(y_last, y_w + window - 1);
+
+            // 1. Each column over the rows of the window, its rows out of the range cleared
+            for (size_t i = 0; i < sieve.column_count; i++)
+            {
+                uint64_t y_lo, y_hi;
+                if (!class_column_rows(&sieve, sieve.columns[i], &y_lo, &y_hi) || y_hi < y_w || y_lo > w_last)
+                {
+                    bitmap_clear_all(bits[i]);
+                    continue;
+                }
+
+                uint64_t to = MIN(y_hi, w_last);
+                class_sieve_column(&sieve, sieve.columns[i], y_w, to - y_w + 1, offsets, 1, bits[i]);
+                for (uint64_t y = y_w; y < y_lo; y++)
+                    bitmap_clear_bit(bits[i], y - y_w);
+            }
+
+            // 2. Row by row, column by column: increasing values
+            for (uint64_t y = y_w; y <= w_last && !is_stopped; y++)
+            {
+                for (size_t i = 0; i < sieve.column_count && !is_stopped; i++)
+                {
+                    if (!bitmap_get_bit(bits[i], y - y_w))
+                        continue;
+
+                    uint64_t column = sieve.columns[i];
+                    uint64_t value = 6 * (y * sieve.vx + (column >> 1)) + ((column & 1) ? 1 : -1);
+                    if (sieve.g != m && class_of(&sieve, value) != a)
+                        continue;
+
+                    while (special < sieve.special_count && sieve.specials[special] < value && !is_stopped)
+                    {
+                        count++;
+                        is_stopped = callback(sieve.specials[special++], ctx) != 0;
+                    }
+
+                    if (!is_stopped)
+                    {
+                        count++;
+                        is_stopped = callback(value, ctx) != 0;
+                    }
+                }
+            }
+        }
+    }
+
+    while (status && special < sieve.special_count && !is_stopped)
+    {
+        count++;
+        is_stopped = callback(sieve.specials[special++], ctx) != 0;
+    }
+
+    if (!status)
+        log_error("Memory allocation failed in iz_primes_mod_stream.");
+
+    for (size_t i = 0; bits != NULL && i < sieve.column_count; i++)
+        bitmap_free(bits[i]);
+    free(bits);
+    free(offsets);
+    class_sieve_free(&sieve);
+    return count;
+}
@@ -9,6 +9,7 @@
  * - @b sieve_iZm: Segmented Sieve-iZm algorithm,
  * - @b sieve_vx: Sieve-VX algorithm.
  * - @b sieve_vx6_range: Sieve-VX algorithm for a range of y values using VX6 segments.
+ * - @b IZ_SIEVE_STATE: Resumable sieve_iZm and sieve_vx6_range jobs, advanced in bounded slices by iz_sieve_step.
  *
  * @b sieve_iZ and @b sieve_iZm take an upper limit `n` and returns a pointer to a PRIMES_OBJ
  * structure containing the list of primes found.
@@ -40,6 +41,17 @@
  */
 
 #include <iZ.h>
+#include <limits.h>      // For INT_MAX
+#include <openssl/evp.h> // For the running hash of sieve state files
+#include <pthread.h>     // For the threads of sieve_vx6_range_parallel
+#include <unistd.h>      // For sysconf
+
+#define IZ_SIEVE_JOB_IZM 0                   ///< IZ_SIEVE_STATE of a sieve_iZm job
+#define IZ_SIEVE_JOB_VX6_RANGE 1             ///< IZ_SIEVE_STATE of a sieve_vx6_range job
+#define IZ_SIEVE_STATE_MAGIC 0x53535A49      ///< "IZSS", the first bytes of a sieve state file
+#define IZ_SIEVE_STATE_MAX_Y_LEN 4096        ///< Largest y string of a range job read from a file
+#define IZ_SIEVE_STATE_MAX_RANGE_Y (1 << 20) ///< Most segments of a range job read from a file
+#define IZ_SIEVE_STATE_MAX_N (1ULL << 35)    ///< Largest n of an iZm job read from a file, 1.5 pi_n(n) within an int
 
 /**
  * @brief An implementation of the Classic Sieve-iZ algorithm to generate prime numbers up to a given limit.
@@ -75,8 +87,9 @@ PRIMES_OBJ *sieve_iZ(uint64_t n)
     primes_obj_append(primes, 2);
     primes_obj_append(primes, 3);
 
-    // Calculate x_n, index of the upper bound n
-    uint64_t x_n = n / 6 + 1;
+    // Calculate x_n, index of the upper bound n,
+    // (n + 1) / 6 so that n = 6x - 1 is reached when n % 6 == 5
+    uint64_t x_n = (n + 1) / 6 + 1;
 
     // Create bitmap X-Arrays base_x5, base_x7, each of size x_n + 1 bits,
     // thus, total (n/3) bits
@@ -146,42 +159,246 @@ PRIMES_OBJ *sieve_iZ(uint64_t n)
 }
 
 /**
- * @brief A basic implementation of the Segmented Sieve-iZm algorithm to generate prime numbers up
- * to a given limit n.
+ * @brief Returns the index of the first root prime greater than root_limit.
  *
- * @description:
- * This function divides the target limit into segments of size vx, where vx is a product of small primes up to 19.
- * It constructs a pre-sieved segment from primes that divide vx, and marks composites of the remaining root primes
- * in each segment over a range of y values. Each segment is cloned from the pre-sieved base segment.
+ * @param root_primes The root primes in ascending order.
+ * @param root_limit The largest prime to sieve with.
+ * @return int The end index for iterating the root primes.
+ */
+static int root_primes_end(PRIMES_OBJ *root_primes, uint64_t root_limit)
+{
+    int lo = 0, hi = root_primes->p_count;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (root_primes->p_array[mid] <= root_limit)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Appends the primes of a sieved row of iZm, in ascending order.
  *
- * The function uses the solve_for_x function to find the first composite index of a prime in a given segment,
- * then proceeds to mark the composites in the bitmaps x5 and x7 using the Xp Wheel.
- * The function also handles edge cases, such as removing the last prime if it exceeds the limit.
- * Finally, it resizes the primes object to fit the number of primes found.
+ * @description: Walks the set bits x in [2, limit] of x5 and x7 with bitmap_scan_next,
+ * merging iZ(x + yvx, -1) and iZ(x + yvx, 1), instead of probing every bit.
  *
- * Aside from the output size, which can be offloaded, this function has a constant space complexity O(1),
- * requiring maximum 4 * 0.2 = 0.8 MB of memory.
+ * @param primes The primes object to append to.
+ * @param x5 The sieved bitmap of iZ- numbers in the row.
+ * @param x7 The sieved bitmap of iZ+ numbers in the row.
+ * @param yvx The base value y * vx of the row.
+ * @param limit The last x of the row.
+ */
+static void sieve_iZm_emit_row(PRIMES_OBJ *primes, BITMAP *x5, BITMAP *x7, uint64_t yvx, uint64_t limit)
+{
+    size_t x5_next = bitmap_scan_next(x5, 2);
+    size_t x7_next = bitmap_scan_next(x7, 2);
+
+    while (MIN(x5_next, x7_next) <= limit)
+    {
+        // iZ(x, -1) < iZ(x, 1) < iZ(x + 1, -1)
+        if (x5_next <= x7_next)
+        {
+            primes_obj_append(primes, iZ(x5_next + yvx, -1));
+            x5_next = bitmap_scan_next(x5, x5_next + 1);
+        }
+        else
+        {
+            primes_obj_append(primes, iZ(x7_next + yvx, 1));
+            x7_next = bitmap_scan_next(x7, x7_next + 1);
+        }
+    }
+}
+
+/**
+ * @struct IZ_SIEVE_STATE
+ * @brief The position of a sieve_iZm or sieve_vx6_range job in progress, advanced by iz_sieve_step.
+ *
+ * @description: A job is a sequence of segments: the rows y = 1, ..., max_y of iZm for an
+ * iZm job, and the VX6 segments start_y, ..., start_y + range_y - 1 for a range job.
+ * Its position is the next segment and, for iZm, the root-prime cursor seg_end. The
+ * offsets of the root primes in a row follow from its y by a single reduction
+ * (root_table_offsets), so the working set of a job (base segment, root prime table,
+ * offsets and row bitmaps) is rebuilt from its position when a state is read back
+ * from a file by iz_sieve_state_read_file.
+ */
+struct IZ_SIEVE_STATE
+{
+    int kind;    ///< IZ_SIEVE_JOB_IZM or IZ_SIEVE_JOB_VX6_RANGE
+    int is_done; ///< 1 once every segment is sieved and the working set released
+
+    // iZm job
+    uint64_t n;                     ///< The upper limit
+    size_t x_n;                     ///< n / 6 + 1
+    size_t vx;                      ///< The segment size
+    int max_y;                      ///< The last row of iZm
+    int y;                          ///< The next row to sieve
+    int start_i;                    ///< Index of the first root prime not dividing vx
+    int small_end;                  ///< End of the root primes marked by word patterns
+    int root_end;                   ///< End of the root primes up to sqrt(n)
+    int seg_end;                    ///< End of the root primes with composites so far
+    int block_rows;                 ///< Rows marked together
+    PRIMES_OBJ *primes;             ///< The primes found so far
+    VX_ASSETS *static_assets;       ///< The compiled-in assets of vx, if any
+    ROOT_PRIME_TABLE *root_table;   ///< Root primes metadata for computing offsets
+    uint32_t *x5_offsets;           ///< Offsets of the larger root primes in the current row of x5
+    uint32_t *x7_offsets;           ///< Offsets of the larger root primes in the current row of x7
+    BITMAP *base_x5, *base_x7;      ///< The pre-sieved base segment
+    BITMAP *x5_rows[SIEVE_MAX_BLOCK_ROWS]; ///< Row bitmaps of a block, for iZ- numbers
+    BITMAP *x7_rows[SIEVE_MAX_BLOCK_ROWS]; ///< Row bitmaps of a block, for iZ+ numbers
+
+    // VX6 range job
+    int range_y;          ///< The number of segments
+    int next;             ///< Index of the next segment to sieve
+    VX_ASSETS *vx_assets; ///< The assets of VX6
+    VX_RANGE *vx_range;   ///< The range, with the headers of every segment
+};
+
+/**
+ * @brief Builds the pre-sieved base segment of an iZm job: a copy of the compiled-in
+ * segment if vx is a build-time vx standard, otherwise a generated one of vx + 10 bits.
+ *
+ * @param state The iZm job, with vx set.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int sieve_iZm_state_base(IZ_SIEVE_STATE *state)
+{
+    state->static_assets = vx_assets_static(state->vx);
+    if (state->static_assets != NULL)
+    {
+        state->base_x5 = bitmap_clone(state->static_assets->base_x5);
+        state->base_x7 = bitmap_clone(state->static_assets->base_x7);
+    }
+    else
+    {
+        state->base_x5 = bitmap_create(state->vx + 10);
+        state->base_x7 = bitmap_create(state->vx + 10);
+        if (state->base_x5 != NULL && state->base_x7 != NULL)
+            construct_iZm_segment(state->vx, state->base_x5, state->base_x7);
+    }
+
+    return state->base_x5 != NULL && state->base_x7 != NULL;
+}
+
+/**
+ * @brief Allocates the working set of the rows of an iZm job from its root primes:
+ * the root prime table, the offsets of the larger root primes and the row bitmaps of a block.
+ *
+ * @param state The iZm job, with its base segment and the primes of its first segment.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int sieve_iZm_state_rows(IZ_SIEVE_STATE *state)
+{
+    const IZ_TUNING *tuning = iz_tuning();
+
+    // Root primes up to sqrt(n) with their wheel metadata: the compiled-in table
+    // if it covers them, otherwise built once for this job
+    state->root_end = root_primes_end(state->primes, sqrt(state->n) + 1);
+    if (state->static_assets != NULL && state->root_end <= state->static_assets->root_table->p_count)
+        state->root_table = state->static_assets->root_table;
+    else
+        state->root_table = root_table_init(state->primes, state->root_end, state->vx);
+
+    // First composite offsets of the larger root primes in the current row
+    state->x5_offsets = malloc(state->root_end * sizeof(uint32_t));
+    state->x7_offsets = malloc(state->root_end * sizeof(uint32_t));
+
+    // Row bitmaps of a block, reset from the base segment for each block
+    state->block_rows = tuning->izm_block_rows;
+    int is_allocated = state->root_table != NULL && state->x5_offsets != NULL && state->x7_offsets != NULL;
+    for (int r = 0; r < state->block_rows; r++)
+    {
+        state->x5_rows[r] = bitmap_create(state->base_x5->size);
+        state->x7_rows[r] = bitmap_create(state->base_x7->size);
+        is_allocated = is_allocated && state->x5_rows[r] != NULL && state->x7_rows[r] != NULL;
+    }
+
+    if (!is_allocated)
+        return 0;
+
+    // Root primes below pattern_max_p are marked by word patterns
+    state->small_end = state->start_i;
+    while (state->small_end < state->root_end &&
+           state->root_table->p[state->small_end] < (uint64_t)tuning->pattern_max_p)
+        state->small_end++;
+
+    return 1;
+}
+
+/**
+ * @brief Releases the working set of an iZm job, keeping its primes.
+ *
+ * @param state The iZm job.
+ */
+static void sieve_iZm_state_release(IZ_SIEVE_STATE *state)
+{
+    if (state->static_assets == NULL || state->root_table != state->static_assets->root_table)
+        root_table_free(state->root_table);
+    state->root_table = NULL;
+
+    free(state->x5_offsets);
+    free(state->x7_offsets);
+    state->x5_offsets = state->x7_offsets = NULL;
+
+    for (int r = 0; r < SIEVE_MAX_BLOCK_ROWS; r++)
+    {
+        bitmap_free(state->x5_rows[r]);
+        bitmap_free(state->x7_rows[r]);
+        state->x5_rows[r] = state->x7_rows[r] = NULL;
+    }
+
+    bitmap_free(state->base_x5);
+    bitmap_free(state->base_x7);
+    state->base_x5 = state->base_x7 = NULL;
+}
+
+/**
+ * @brief Starts a Segmented Sieve-iZm job for the primes up to n, to be advanced by iz_sieve_step.
+ *
+ * @description: Chooses the segment size vx, builds the pre-sieved base segment,
+ * sieves the first segment to collect the root primes, and allocates the working
+ * set of the remaining rows of iZm. For n < 1000 the job is completed by sieve_iZ.
  *
  * @param n The upper limit for generating prime numbers.
- * @return
- *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
- *      - NULL if memory allocation fails.
+ * @return IZ_SIEVE_STATE* The job at row y = 1, or NULL if memory allocation fails.
  */
-PRIMES_OBJ *sieve_iZm(uint64_t n)
+IZ_SIEVE_STATE *iz_sieve_state_izm(uint64_t n)
 {
-    // Check if n is less than 1000, return sieve_iZ(n)
+    IZ_SIEVE_STATE *state = calloc(1, sizeof(IZ_SIEVE_STATE));
+    if (state == NULL)
+    {
+        log_error("Memory allocation failed in iz_sieve_state_izm.");
+        return NULL;
+    }
+    state->kind = IZ_SIEVE_JOB_IZM;
+    state->n = n;
+
+    // Check if n is less than 1000, completed by sieve_iZ(n)
     if (n < 1000)
-        return sieve_iZ(n);
+    {
+        state->primes = sieve_iZ(n);
+        state->is_done = 1;
+        if (state->primes == NULL)
+        {
+            free(state);
+            return NULL;
+        }
+        return state;
+    }
 
     // 1. Initialization
-    size_t x_n = n / 6 + 1;
+    state->x_n = n / 6 + 1;
 
     // Initialize primes array with enough capacity
-    PRIMES_OBJ *primes = primes_obj_init(pi_n(n) * 1.5);
-
-    // Memory allocation failed, check logs
-    if (primes == NULL)
+    state->primes = primes_obj_init(pi_n(n) * 1.5);
+    if (state->primes == NULL)
+    {
+        free(state);
         return NULL;
+    }
+    PRIMES_OBJ *primes = state->primes;
 
     // add 2, 3 to the primes array
     primes_obj_append(primes, 2);
@@ -191,10 +408,13 @@ PRIMES_OBJ *sieve_iZm(uint64_t n)
     uint64_t s_primes[] = {5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
 
     // Calculate optimal segment size vx for x_n
-    int vx_limit = 6; // max number of primes to be pre-sieved
-    size_t vx = compute_limited_vx(x_n, vx_limit);
+    int vx_limit = iz_tuning()->vx_limit; // max number of primes to be pre-sieved
+    size_t vx = compute_limited_vx(state->x_n, vx_limit);
+    state->vx = vx;
+    state->max_y = state->x_n / vx; // number of segments
+    state->y = 1;
 
-    int start_i = 2; // skip 2, 3 in the primes array
+    state->start_i = 2; // skip 2, 3 in the primes array
 
     // Add pre-sieved primes to primes array
     for (int i = 0; i < vx_limit; i++)
@@ -202,26 +422,29 @@ PRIMES_OBJ *sieve_iZm(uint64_t n)
         if (vx % s_primes[i] == 0)
         {
             primes_obj_append(primes, s_primes[i]);
-            start_i++;
+            state->start_i++;
         }
         else
             break;
     }
+    state->seg_end = state->start_i;
 
-    // Initialize base_x5, base_x7 bitmaps for resetting and x5, x7 for active sieve
-    BITMAP *base_x5, *base_x7, *x5, *x7;
-
-    // Initialize base segments with vx + 10 bits
-    base_x5 = bitmap_create(vx + 10);
-    base_x7 = bitmap_create(vx + 10);
-
-    // 2. Preprocessing:
-    // Generate pre-sieved segments of size vx in base_x5, base_x7
-    construct_iZm_segment(vx, base_x5, base_x7);
+    // 2. Preprocessing: the base segment, cloned into x5, x7 for the first segment
+    BITMAP *x5 = NULL, *x7 = NULL;
+    if (sieve_iZm_state_base(state))
+    {
+        x5 = bitmap_clone(state->base_x5);
+        x7 = bitmap_clone(state->base_x7);
+    }
 
-    // Clone base_x5, base_x7 into x5, x7 for processing
-    x5 = bitmap_clone(base_x5);
-    x7 = bitmap_clone(base_x7);
+    if (x5 == NULL || x7 == NULL)
+    {
+        log_error("Memory allocation failed in iz_sieve_state_izm.");
+        bitmap_free(x5);
+        bitmap_free(x7);
+        iz_sieve_state_free(state);
+        return NULL;
+    }
 
     // 3. Process 1st segment to collect enough root primes
     for (uint64_t x = 2; x <= vx; x++)
@@ -252,183 +475,486 @@ PRIMES_OBJ *sieve_iZm(uint64_t n)
         }
     }
 
-    // 4. Processing remaining segments:
-    int max_y = x_n / vx; // number of segments
-    uint64_t limit = vx;  // upper bound for marking composites
-    uint64_t yvx = vx;    // base value
+    // The first segment bitmaps are no longer needed
+    bitmap_free(x5);
+    bitmap_free(x7);
+
+    // 4. Working set of the remaining rows
+    if (!sieve_iZm_state_rows(state))
+    {
+        log_error("Memory allocation failed for the iZm block rows.");
+        iz_sieve_state_free(state);
+        return NULL;
+    }
+
+    return state;
+}
 
-    // Process the remaining segments for y in 1:max_y (inclusive)
-    for (int y = 1; y <= max_y; y++)
+/**
+ * @brief Sieves the next rows of an iZm job, at most max_segments of them, in blocks of block_rows.
+ *
+ * @description: The rows are processed as in sieve_iZm; the job completes after its
+ * last row, dropping a last prime above n and trimming the primes object.
+ *
+ * @param state The iZm job, not completed.
+ * @param max_segments The largest number of rows to sieve, at least 1.
+ * @return int 1 if rows remain, 0 if the job is completed.
+ */
+static int sieve_iZm_state_step(IZ_SIEVE_STATE *state, int max_segments)
+{
+    PRIMES_OBJ *primes = state->primes;
+    const ROOT_PRIME_TABLE *root_table = state->root_table;
+    uint32_t *x5_offsets = state->x5_offsets;
+    uint32_t *x7_offsets = state->x7_offsets;
+    BITMAP **x5_rows = state->x5_rows;
+    BITMAP **x7_rows = state->x7_rows;
+    size_t x_n = state->x_n;
+    size_t vx = state->vx;
+    int start_i = state->start_i;
+    int small_end = state->small_end;
+    int root_end = state->root_end;
+    int block_rows = state->block_rows;
+
+    int max_y = state->max_y; // number of segments
+
+    // The last row of this step
+    int last_y = (int)MIN((int64_t)max_y, (int64_t)state->y + max_segments - 1);
+
+    size_t byte_size = (state->base_x5->size + 7) / 8;
+    int seg_end = state->seg_end;          // end of the root primes with composites so far
+    int seg_ends[SIEVE_MAX_BLOCK_ROWS];    // end of the root primes with composites in each row
+    uint64_t limits[SIEVE_MAX_BLOCK_ROWS]; // upper bound for marking composites in each row
+
+    // Process the segments for y in state->y:last_y (inclusive)
+    for (int y = state->y; y <= last_y; y += block_rows)
     {
-        // Reset to base segment for each run
-        x5 = bitmap_clone(base_x5);
-        x7 = bitmap_clone(base_x7);
+        int rows = MIN(block_rows, last_y - y + 1);
+        uint64_t yvx = (uint64_t)y * vx; // base value of the first row
 
-        // limit is vx or x_n % vx in the last segment
-        if (y == max_y)
-            limit = x_n % vx;
+        IZ_PERF_BEGIN(IZ_PERF_MARKING);
+        for (int r = 0; r < rows; r++)
+        {
+            // Reset to base segment for each run
+            memcpy(x5_rows[r]->data, state->base_x5->data, byte_size);
+            memcpy(x7_rows[r]->data, state->base_x7->data, byte_size);
+
+            // limit is vx or x_n % vx in the last segment
+            limits[r] = (y + r == max_y) ? x_n % vx : vx;
+
+            // Extend to the root primes that have composites in this row
+            while (seg_end < root_end &&
+                   ((uint64_t)root_table->p[seg_end] * root_table->p[seg_end]) / 6 <= (yvx + r * vx + limits[r]))
+                seg_end++;
+            seg_ends[r] = seg_end;
+        }
 
-        // Mark composites of the rest of root primes in current segment
-        for (int i = start_i; i < primes->p_count; i++)
+        // Small primes, which mark every word, column-major: each crosses all rows of
+        // the block by a word pattern built once, its offsets stepping by vx mod p
+        for (int i = start_i; i < small_end && i < seg_end; i++)
         {
-            uint64_t p = primes->p_array[i];
+            uint64_t p = root_table->p[i];
+            uint64_t yvx_mod_p = fast_mod(yvx, p, root_table->p_inv[i]);
 
-            // Exit if p doesn't have composites in this range
-            if ((p * p) / 6 > (yvx + limit))
-                break;
+            BITMAP_PATTERN pattern;
+            bitmap_pattern_init(&pattern, p);
 
-            // Mark composites of p in the current segment
-            bitmap_clear_mod_p(x5, p, solve_for_x(-1, p, vx, y), limit);
-            bitmap_clear_mod_p(x7, p, solve_for_x(1, p, vx, y), limit);
+            for (int r = 0; r < rows; r++)
+            {
+                if (i < seg_ends[r])
+                {
+                    uint64_t x5_i, x7_i;
+                    root_table_offsets(root_table, i, yvx_mod_p, &x5_i, &x7_i);
+                    bitmap_clear_pattern(x5_rows[r], &pattern, x5_i, limits[r]);
+                    bitmap_clear_pattern(x7_rows[r], &pattern, x7_i, limits[r]);
+                }
+
+                // (vx * (y + 1)) mod p
+                yvx_mod_p += root_table->vx_mod_p[i];
+                if (yvx_mod_p >= p)
+                    yvx_mod_p -= p;
+            }
         }
 
-        // Collect unmarked x values as primes
-        for (uint64_t x = 2; x <= limit; x++)
+        // Larger primes row by row, keeping the row bitmaps in cache
+        for (int r = 0; r < rows; r++)
         {
-            if (bitmap_get_bit(x5, x)) // iZ- prime
-                primes_obj_append(primes, iZ(x + yvx, -1));
+            uint64_t row_yvx = yvx + r * vx;
+
+            // Compute the offsets of the rest of root primes in the row,
+            // a branch-free pass over the table columns
+            for (int i = small_end; i < seg_ends[r]; i++)
+            {
+                uint64_t x5_i, x7_i;
+                uint64_t yvx_mod_p = fast_mod(row_yvx, root_table->p[i], root_table->p_inv[i]);
+                root_table_offsets(root_table, i, yvx_mod_p, &x5_i, &x7_i);
+                x5_offsets[i] = x5_i;
+                x7_offsets[i] = x7_i;
+            }
 
-            if (bitmap_get_bit(x7, x)) // iZ+ prime
-                primes_obj_append(primes, iZ(x + yvx, 1));
+            // Mark composites of the root primes in the row
+            for (int i = small_end; i < seg_ends[r]; i++)
+            {
+                bitmap_clear_mod_p(x5_rows[r], root_table->p[i], x5_offsets[i], limits[r]);
+                bitmap_clear_mod_p(x7_rows[r], root_table->p[i], x7_offsets[i], limits[r]);
+            }
         }
 
-        yvx += vx; // increment yvx
+        IZ_PERF_END();
+
+        // Collect unmarked x values as primes, emitting the rows in order
+        IZ_PERF_BEGIN(IZ_PERF_EXTRACTION);
+        for (int r = 0; r < rows; r++)
+        {
+            sieve_iZm_emit_row(primes, x5_rows[r], x7_rows[r], yvx, limits[r]);
+            yvx += vx; // increment yvx
+        }
+        IZ_PERF_END();
     }
+    state->y = last_y + 1;
+    state->seg_end = seg_end;
+    if (state->y <= max_y)
+        return 1;
 
-    // 5. Clean up bitmaps
-    bitmap_free(base_x5);
-    bitmap_free(base_x7);
-    bitmap_free(x5);
-    bitmap_free(x7);
+    // 5. Clean up bitmaps and root primes metadata
+    sieve_iZm_state_release(state);
 
     // Handle edge case: if last prime > n, remove it
-    if (primes->p_array[primes->p_count - 1] > n)
+    if (primes->p_array[primes->p_count - 1] > state->n)
         primes->p_count--;
 
     // Trim unused memory in primes object
     primes_obj_resize_to_p_count(primes);
 
-    return primes;
+    state->is_done = 1;
+    return 0;
 }
 
 /**
- * @brief This function initializes and processes a range of VX_OBJ.
+ * @brief A basic implementation of the Segmented Sieve-iZm algorithm to generate prime numbers up
+ * to a given limit n.
  *
- * @param start_y The starting value for y.
- * @param range_y The number of segments to be sieved.
- * @return VX_OBJ** A pointer to an array of VX_OBJ.
+ * @description:
+ * This function divides the target limit into segments of size vx, where vx is a product of small primes up to 19.
+ * It constructs a pre-sieved segment from primes that divide vx, and marks composites of the remaining root primes
+ * in each segment over a range of y values. Each segment is reset from the pre-sieved base segment.
+ *
+ * Segments are processed in blocks of consecutive rows of iZm (izm_block_rows of the tuning profile,
+ * SIEVE_IZM_BLOCK_ROWS by default). The marks of a root
+ * prime p in row y + 1 are those of row y shifted by vx mod p, so the small primes, which mark every
+ * word of a row, are applied column-major across the block by word patterns (see BITMAP_PATTERN)
+ * built once per block. The larger primes are marked row by row, and the rows are emitted in order.
+ *
+ * The function uses the solve_for_x function to find the first composite index of a prime in a given segment,
+ * then proceeds to mark the composites in the bitmaps x5 and x7 using the Xp Wheel.
+ * The function also handles edge cases, such as removing the last prime if it exceeds the limit.
+ * Finally, it resizes the primes object to fit the number of primes found.
+ *
+ * The job runs as an IZ_SIEVE_STATE advanced through all of its rows at once; see
+ * iz_sieve_state_izm and iz_sieve_step to sieve it in bounded slices instead.
+ *
+ * Aside from the output size, which can be offloaded, this function has a constant space complexity O(1),
+ * requiring maximum (2 + 2 * block rows) * 0.2 = 2 MB of memory with the default 4 rows.
+ *
+ * @param n The upper limit for generating prime numbers.
+ * @return
+ *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
+ *      - NULL if memory allocation fails.
  */
-VX_OBJ **sieve_vx6_range(char *start_y, int range_y)
+PRIMES_OBJ *sieve_iZm(uint64_t n)
 {
-    // initialize a list of vx_obj
-    VX_OBJ **vx_obj_list = malloc(range_y * sizeof(VX_OBJ *));
-
-    if (vx_obj_list == NULL)
-    {
-        log_error("Memory allocation failed for vx_obj_list.");
+    IZ_SIEVE_STATE *state = iz_sieve_state_izm(n);
+    if (state == NULL)
         return NULL;
-    }
-
-    size_t vx = VX6; // default segment size
-    VX_ASSETS *vx_assets = vx_assets_init(vx);
 
-    mpz_t y;
-    mpz_init(y);
-    mpz_set_str(y, start_y, 10); // Set y from start_y
+    PRIMES_OBJ *primes = NULL;
+    if (iz_sieve_step(state, INT_MAX) == 0)
+        primes = iz_sieve_state_take_primes(state);
 
-    for (int i = 0; i < range_y; i++)
-    {
-        vx_obj_list[i] = vx_init(VX6, mpz_get_str(NULL, 10, y));
-        if (vx_obj_list[i] == NULL)
-        {
-            log_error("Failed to initialize VX_OBJ.");
-            return NULL; // or handle error appropriately
-        }
+    iz_sieve_state_free(state);
+    return primes;
+}
 
-        sieve_vx(vx_obj_list[i], vx_assets);
+/**
+ * @brief A segment of sieve_vx in progress: its position in iZm, its bitmaps and
+ * the GMP variables of its primality tests.
+ *
+ * A VX_ROW is allocated once by sieve_vx_row_alloc and reused for any number of
+ * segments of the same vx, so a range job makes no heap calls per segment.
+ *
+ * @param vx_obj The VX_OBJ of the segment, accumulating the prime gaps and counters.
+ * @param y The segment index in iZm.
+ * @param yvx The base value y * vx.
+ * @param root_limit The square root of the last number of the segment.
+ * @param p, x_p Reusable GMP variables of the primality tests.
+ * @param y_fits 1 if y fits 128 bits, with y_lo and y_hi its low and high words.
+ * @param is_u128 1 if every number of the segment is below U128_PRIME_LIMIT, with yvx128 = yvx.
+ * @param is_large_limit 1 if the root limit exceeds vx, i.e. candidates need a primality test.
+ * @param root_end The end index of the root primes to sieve with.
+ * @param x5 The bitmap for iZ- numbers.
+ * @param x7 The bitmap for iZ+ numbers.
+ */
+typedef struct
+{
+    VX_OBJ *vx_obj;
+    mpz_t y, yvx, root_limit;
+    mpz_t p, x_p;
+    int y_fits;
+    uint64_t y_lo, y_hi;
+    int is_u128;
+    __uint128_t yvx128;
+    int is_large_limit;
+    int root_end;
+    BITMAP *x5, *x7;
+} VX_ROW;
 
-        // increment y by 1 for each segment
-        mpz_add_ui(y, y, 1);
-    }
+/**
+ * @brief Allocates the bitmaps and GMP variables of a VX_ROW for segments of vx_assets->vx.
+ *
+ * @param row The VX_ROW to allocate, released by sieve_vx_row_free.
+ * @param vx_assets The VX_ASSETS containing the base bitmaps.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int sieve_vx_row_alloc(VX_ROW *row, VX_ASSETS *vx_assets)
+{
+    row->x5 = bitmap_create(vx_assets->base_x5->size);
+    row->x7 = bitmap_create(vx_assets->base_x7->size);
 
-    // 4. Cleanup:
-    // Free sieve assets
-    vx_assets_free(vx_assets);
-    mpz_clear(y);
+    mpz_init(row->y);
+    mpz_init(row->yvx);
+    mpz_init(row->root_limit);
+    mpz_init(row->p);
+    mpz_init(row->x_p);
 
-    // 6. Return the VX_OBJ
-    return vx_obj_list;
+    return row->x5 != NULL && row->x7 != NULL;
 }
 
 /**
- * @brief This function performs the sieve process on a given vx and y defined
- * in the VX_OBJ structure, and stores the primes gaps in the vx_obj->p_gaps array.
+ * @brief Frees the bitmaps and GMP variables of a VX_ROW.
  *
- * @description: This function combines deterministic sieving and probabilistic
- * primality tests to identify prime candidates in a standard VX segment of a
- * specific y in the iZ-Matrix. It populates the vx_obj->p_gaps array with
- * prime gaps between consecutive primes detected in the segment.
+ * @param row The VX_ROW to free.
+ */
+static void sieve_vx_row_free(VX_ROW *row)
+{
+    bitmap_free(row->x5);
+    bitmap_free(row->x7);
+    mpz_clear(row->y);
+    mpz_clear(row->yvx);
+    mpz_clear(row->root_limit);
+    mpz_clear(row->p);
+    mpz_clear(row->x_p);
+}
+
+/**
+ * @brief Initializes the VX_ROW of vx_obj: y, yvx, the root limit of the segment
+ * and its x5, x7 bitmaps reset from the base segment.
  *
+ * @param row The VX_ROW, allocated by sieve_vx_row_alloc.
  * @param vx_obj The VX_OBJ to be processed.
- * @param vx_assets The VX_ASSETS containing the reusable base bitmaps and root primes
- * for the sieve process.
+ * @param vx_assets The VX_ASSETS containing the base bitmaps and root primes.
  */
-void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
+static void sieve_vx_row_init(VX_ROW *row, VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
 {
-    // 1. Initialization
-    // Default number of rounds for Miller-Rabin primality test
-    int p_test_rounds = 25;
+    int vx = vx_obj->vx; // segment size
+    row->vx_obj = vx_obj;
 
-    // Create x5 and x7 bitmaps cloned from base_x5 and base_x7
-    BITMAP *x5 = bitmap_clone(vx_assets->base_x5);
-    BITMAP *x7 = bitmap_clone(vx_assets->base_x7);
+    // Reset x5 and x7 bitmaps from base_x5 and base_x7
+    memcpy(row->x5->data, vx_assets->base_x5->data, (row->x5->size + 7) / 8);
+    memcpy(row->x7->data, vx_assets->base_x7->data, (row->x7->size + 7) / 8);
 
-    int vx = vx_obj->vx; // segment size
-    // Initialize mpz_t y and yvx
-    mpz_t y, yvx;
-    mpz_init(y);
-    mpz_init(yvx);
-    mpz_set_str(y, vx_obj->y, 10); // Set y from vx_obj->y
-    mpz_mul_ui(yvx, y, vx);        // Compute yvx = y * vx
+    // Set y and yvx
+    mpz_set_str(row->y, vx_obj->y, 10); // Set y from vx_obj->y
+    mpz_mul_ui(row->yvx, row->y, vx);   // Compute yvx = y * vx
+
+    // Reduce y natively when it fits two machine words
+    __uint128_t y128 = 0;
+    row->y_fits = u128_from_mpz(&y128, row->y);
+    row->y_lo = (uint64_t)y128;
+    row->y_hi = (uint64_t)(y128 >> 64);
 
-    // Initialize and compute root_limit = sqrt(iZ(vx * (y+1), 1))
-    mpz_t root_limit;
-    mpz_init(root_limit);
-    mpz_add_ui(root_limit, yvx, vx);
-    iZ_gmp(root_limit, root_limit, 1);
-    mpz_sqrt(root_limit, root_limit);
+    // Native 128-bit path if every number of the segment is below U128_PRIME_LIMIT,
+    // i.e. iZ(vx * (y+1), 1) < 2^126
+    row->is_u128 = row->y_fits && y128 < (U128_PRIME_LIMIT / 6) / vx - 2;
+    row->yvx128 = 0;
+
+    // Compute root_limit = sqrt(iZ(vx * (y+1), 1))
+    if (row->is_u128)
+    {
+        row->yvx128 = y128 * vx;
+        u128_to_mpz(row->root_limit, u128_isqrt(6 * (row->yvx128 + vx) + 1));
+    }
+    else
+    {
+        mpz_add_ui(row->root_limit, row->yvx, vx);
+        iZ_gmp(row->root_limit, row->root_limit, 1);
+        mpz_sqrt(row->root_limit, row->root_limit);
+    }
 
     // Flag to determine if probabilistic primality test is needed:
     // if root_limit > vx, then we need to test
-    int is_large_limit = mpz_cmp_ui(root_limit, vx) > 0 ? 1 : 0;
+    row->is_large_limit = mpz_cmp_ui(row->root_limit, vx) > 0 ? 1 : 0;
+
+    // Root primes up to root_limit, or up to the tuned sieve depth (all of them by default)
+    // if root_limit > vx, leaving the rest to the primality tests
+    int sieve_depth = iz_tuning()->vx_sieve_depth;
+    row->root_end = vx_assets->root_primes->p_count;
+    if (!row->is_large_limit)
+        row->root_end = root_primes_end(vx_assets->root_primes, mpz_get_ui(row->root_limit));
+    else if (sieve_depth > 0)
+        row->root_end = root_primes_end(vx_assets->root_primes, sieve_depth);
+}
+
+/**
+ * @brief Computes (vx * y) mod p for the i-th root prime of the table.
+ *
+ * @description: A single reduction of y, by multiply-shift when y fits two machine
+ * words, combined with the precomputed vx mod p.
+ *
+ * @param row The VX_ROW holding y.
+ * @param table The root prime table.
+ * @param i The index of the root prime p.
+ * @return uint64_t (vx * y) mod p
+ */
+static inline __attribute__((always_inline)) uint64_t sieve_vx_yvx_mod_p(
+    const VX_ROW *row, const ROOT_PRIME_TABLE *table, int i)
+{
+    uint64_t p = table->p[i];
+    uint64_t y_mod_p;
+
+    if (row->y_fits && row->y_hi == 0)
+        y_mod_p = fast_mod(row->y_lo, p, table->p_inv[i]);
+    else if (row->y_fits)
+        y_mod_p = fast_mod(fast_mod(row->y_hi, p, table->p_inv[i]) * fast_mod_2_64(p, table->p_inv[i]) +
+                               fast_mod(row->y_lo, p, table->p_inv[i]),
+                           p, table->p_inv[i]);
+    else
+        y_mod_p = mpz_fdiv_ui(row->y, p);
+
+    return fast_mod(y_mod_p * table->vx_mod_p[i], p, table->p_inv[i]);
+}
+
+/**
+ * @brief Marks composites of the root primes [start, root_end) of vx_assets
+ * in the x5 and x7 bitmaps of consecutive segments y, y + 1, ..., y + row_count - 1.
+ *
+ * @description: Each prime takes a single reduction of y, combined with the
+ * precomputed vx mod p, reciprocal and normalized x_p of the root prime table,
+ * to place its first composite in both matrices.
+ *
+ * The small primes below pattern_max_p (tuning.h) mark every word of a segment. They
+ * are applied column-major, across all rows, by a word pattern built once: their
+ * offsets in row y + 1 are those of row y shifted by vx mod p. The larger primes
+ * are marked row by row, keeping the bitmaps of a row in cache.
+ *
+ * This body is always inlined into the kernels below, so that vx is a
+ * compile-time constant in the standard vx kernels. For these the primes that
+ * divide vx are exactly the skipped leading ones, so the check_divisors branch
+ * is folded away as well.
+ *
+ * @param vx The segment size.
+ * @param check_divisors 1 to skip root primes dividing vx past the table start.
+ * @param rows The segments to mark, of consecutive y values.
+ * @param row_count The number of segments.
+ * @param vx_assets The VX_ASSETS holding the root prime table.
+ */
+static inline __attribute__((always_inline)) void sieve_vx_mark_root_primes(
+    const int vx, const int check_divisors,
+    VX_ROW *rows, int row_count, VX_ASSETS *vx_assets)
+{
+    const ROOT_PRIME_TABLE *table = vx_assets->root_table;
+    const uint64_t pattern_max_p = iz_tuning()->pattern_max_p;
 
-    // 2. Deterministic Sieve: Mark composites of primes < vx in x5, x7
-    // Iterate through root primes, skipping 2, 3 and those that divide vx
-    for (int i = 2; i < vx_assets->root_primes->p_count; i++)
+    int small_end = table->start;
+    while (small_end < rows[row_count - 1].root_end && table->p[small_end] < pattern_max_p)
+        small_end++;
+
+    // Small primes, column-major across the rows
+    for (int i = table->start; i < small_end; i++)
     {
-        int p = vx_assets->root_primes->p_array[i];
+        uint64_t p = table->p[i];
 
         // Skip if p divides vx
-        if (vx % p == 0)
+        if (check_divisors && table->vx_mod_p[i] == 0)
             continue;
 
-        // Exit when p > root_limit
-        if (!is_large_limit)
-            if (mpz_cmp_ui(root_limit, p) < 0)
-                break;
+        uint64_t yvx_mod_p = sieve_vx_yvx_mod_p(&rows[0], table, i);
 
-        // Mark composites of p in x5 and x7
-        bitmap_clear_mod_p(x5, p, solve_for_x_gmp(-1, p, vx, y), vx);
-        bitmap_clear_mod_p(x7, p, solve_for_x_gmp(1, p, vx, y), vx);
+        BITMAP_PATTERN pattern;
+        bitmap_pattern_init(&pattern, p);
+
+        for (int r = 0; r < row_count; r++)
+        {
+            if (i < rows[r].root_end)
+            {
+                // Mark composites of p in x5 and x7
+                uint64_t x5_i, x7_i;
+                root_table_offsets(table, i, yvx_mod_p, &x5_i, &x7_i);
+                bitmap_clear_pattern(rows[r].x5, &pattern, x5_i, vx);
+                bitmap_clear_pattern(rows[r].x7, &pattern, x7_i, vx);
+
+                rows[r].vx_obj->bit_ops += (2 * vx) / p;
+            }
 
-        vx_obj->bit_ops += (2 * vx) / p;
+            // (vx * (y + 1)) mod p
+            yvx_mod_p += table->vx_mod_p[i];
+            if (yvx_mod_p >= p)
+                yvx_mod_p -= p;
+        }
     }
 
-    // 3. Collect prime gaps in the segment
-    // Initialize GMP reusable variables p, x_p
-    mpz_t p, x_p;
-    mpz_init(p);
-    mpz_init(x_p);
+    // Larger primes, row by row
+    for (int r = 0; r < row_count; r++)
+    {
+        for (int i = small_end; i < rows[r].root_end; i++)
+        {
+            uint64_t p = table->p[i];
+
+            // Skip if p divides vx
+            if (check_divisors && table->vx_mod_p[i] == 0)
+                continue;
+
+            // (vx * y) mod p, shared by both matrices
+            uint64_t yvx_mod_p = sieve_vx_yvx_mod_p(&rows[r], table, i);
+
+            // Mark composites of p in x5 and x7
+            uint64_t x5_i, x7_i;
+            root_table_offsets(table, i, yvx_mod_p, &x5_i, &x7_i);
+            bitmap_clear_mod_p(rows[r].x5, p, x5_i, vx);
+            bitmap_clear_mod_p(rows[r].x7, p, x7_i, vx);
+
+            rows[r].vx_obj->bit_ops += (2 * vx) / p;
+        }
+    }
+}
+
+// Kernel instances: one per standard vx, and a generic one for any other vx
+#define SIEVE_VX_MARKS_KERNEL(name, vx, check_divisors)                            \
+    static void name(VX_ROW *rows, int row_count, VX_ASSETS *vx_assets)              \
+    {                                                                                \
+        sieve_vx_mark_root_primes(vx, check_divisors, rows, row_count, vx_assets);   \
+    }
+
+SIEVE_VX_MARKS_KERNEL(sieve_vx5_marks, VX5, 0)
+SIEVE_VX_MARKS_KERNEL(sieve_vx6_marks, VX6, 0)
+SIEVE_VX_MARKS_KERNEL(sieve_vx7_marks, VX7, 0)
+SIEVE_VX_MARKS_KERNEL(sieve_vx_generic_marks, rows[0].vx_obj->vx, 1)
+
+/**
+ * @brief Collects the prime gaps of a marked segment into the p_gaps array of its VX_OBJ.
+ *
+ * @description: Unmarked candidates are primes if the root primes cover the
+ * segment, otherwise they are confirmed by a primality test: the native BPSW
+ * test on the 128-bit path, or iZ_probab_prime.
+ *
+ * @param row The marked segment.
+ * @param p_test_rounds The number of rounds of the Miller-Rabin primality test.
+ */
+static void sieve_vx_collect_row(VX_ROW *row, int p_test_rounds)
+{
+    VX_OBJ *vx_obj = row->vx_obj;
+    int vx = vx_obj->vx;
+
+    // GMP reusable variables p, x_p
+    mpz_ptr p = row->p, x_p = row->x_p;
 
     // Initialize gap counter
     int gap = 0;
@@ -440,16 +966,22 @@ void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
         gap += 4;
 
         // Check if iZ(x + vx * y, -1) is prime, if not clear x in x5
-        if (bitmap_get_bit(x5, x))
+        if (bitmap_get_bit(row->x5, x))
         {
             int is_prime = 1;
 
-            if (is_large_limit)
+            if (row->is_large_limit && row->is_u128)
             {
-                // Compute x_p = x + vx * y
-                mpz_add_ui(x_p, yvx, x);
-                iZ_gmp(p, x_p, -1); // Compute p = iZ(x_p, -1)
-                is_prime = mpz_probab_prime_p(p, p_test_rounds);
+                // BPSW on p = iZ(x + vx * y, -1) natively
+                is_prime = u128_is_prime(6 * (row->yvx128 + x) - 1);
+                vx_obj->p_test_ops++;
+            }
+            else if (row->is_large_limit)
+            {
+                // Compute x_p = x + vx * y
+                mpz_add_ui(x_p, row->yvx, x);
+                iZ_gmp(p, x_p, -1); // Compute p = iZ(x_p, -1)
+                is_prime = iZ_probab_prime(p, p_test_rounds);
                 vx_obj->p_test_ops++;
             }
 
@@ -464,15 +996,20 @@ void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
         gap += 2;
 
         // Same for iZ+
-        if (bitmap_get_bit(x7, x))
+        if (bitmap_get_bit(row->x7, x))
         {
             int is_prime = 1;
 
-            if (is_large_limit)
+            if (row->is_large_limit && row->is_u128)
             {
-                mpz_add_ui(x_p, yvx, x);
+                is_prime = u128_is_prime(6 * (row->yvx128 + x) + 1);
+                vx_obj->p_test_ops++;
+            }
+            else if (row->is_large_limit)
+            {
+                mpz_add_ui(x_p, row->yvx, x);
                 iZ_gmp(p, x_p, 1); // Compute p = iZ(x_p, 1)
-                is_prime = mpz_probab_prime_p(p, p_test_rounds);
+                is_prime = iZ_probab_prime(p, p_test_rounds);
                 vx_obj->p_test_ops++;
             }
 
@@ -484,22 +1021,456 @@ void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
         }
     }
 
-    // 4. Cleanup:
-    // Free bitmap objects
-    bitmap_free(x5);
-    bitmap_free(x7);
+}
 
-    // Clear GMP variables
-    mpz_clear(root_limit);
-    mpz_clear(y);
-    mpz_clear(yvx);
-    mpz_clear(p);
-    mpz_clear(x_p);
+/**
+ * @brief Performs the sieve process on consecutive segments y, y + 1, ..., y + row_count - 1
+ * of the same vx, marking them together and collecting their prime gaps in order.
+ *
+ * @param rows The VX_ROW of the segments, allocated by sieve_vx_row_alloc.
+ * @param vx_objs The VX_OBJ of the segments, of consecutive y values, with p_gaps arrays of vx/2 gaps.
+ * @param row_count The number of segments, at most SIEVE_MAX_BLOCK_ROWS.
+ * @param vx_assets The VX_ASSETS containing the reusable base bitmaps and root primes.
+ */
+static void sieve_vx_rows(VX_ROW *rows, VX_OBJ **vx_objs, int row_count, VX_ASSETS *vx_assets)
+{
+    // 1. Initialization
+    // Number of rounds for Miller-Rabin primality test
+    int p_test_rounds = iz_tuning()->test_rounds;
+
+    IZ_PERF_BEGIN(IZ_PERF_MARKING);
+    for (int r = 0; r < row_count; r++)
+        sieve_vx_row_init(&rows[r], vx_objs[r], vx_assets);
+
+    // 2. Deterministic Sieve: Mark composites of primes < vx in x5, x7,
+    // dispatched to the kernel specialized for the standard vx, if any
+    switch (vx_objs[0]->vx)
+    {
+    case VX5:
+        sieve_vx5_marks(rows, row_count, vx_assets);
+        break;
+    case VX6:
+        sieve_vx6_marks(rows, row_count, vx_assets);
+        break;
+    case VX7:
+        sieve_vx7_marks(rows, row_count, vx_assets);
+        break;
+    default:
+        sieve_vx_generic_marks(rows, row_count, vx_assets);
+        break;
+    }
+    IZ_PERF_END();
+
+    // 3. Collect prime gaps, segment by segment in order; above the limit of
+    // the root primes, the collection is dominated by the primality tests
+    for (int r = 0; r < row_count; r++)
+    {
+        IZ_PERF_BEGIN(rows[r].is_large_limit ? IZ_PERF_PRIMALITY : IZ_PERF_EXTRACTION);
+        sieve_vx_collect_row(&rows[r], p_test_rounds);
+        IZ_PERF_END();
+    }
+}
+
+/**
+ * @brief This function performs the sieve process on a given vx and y defined
+ * in the VX_OBJ structure, and stores the primes gaps in the vx_obj->p_gaps array.
+ *
+ * @description: This function combines deterministic sieving and probabilistic
+ * primality tests to identify prime candidates in a standard VX segment of a
+ * specific y in the iZ-Matrix. It populates the vx_obj->p_gaps array with
+ * prime gaps between consecutive primes detected in the segment.
+ *
+ * @param vx_obj The VX_OBJ to be processed.
+ * @param vx_assets The VX_ASSETS containing the reusable base bitmaps and root primes
+ * for the sieve process.
+ */
+void sieve_vx(VX_OBJ *vx_obj, VX_ASSETS *vx_assets)
+{
+    VX_ROW row;
+    if (sieve_vx_row_alloc(&row, vx_assets))
+        sieve_vx_rows(&row, &vx_obj, 1, vx_assets);
+    else
+        log_error("Memory allocation failed for the sieve_vx bitmaps.");
+    sieve_vx_row_free(&row);
 
     // Resize p_gaps array to fit the actual count
     vx_resize_p_gaps(vx_obj);
 }
 
+/**
+ * @brief Creates the headers and y strings of the segments y, y + 1, ..., y + count - 1 in an arena.
+ *
+ * @param vx_objs The array receiving the segments.
+ * @param count The number of segments.
+ * @param arena The arena holding the headers.
+ * @param vx The segment size.
+ * @param y_str The y of the range, as a numeric string.
+ * @param y_offset Added to y_str for the first segment.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int sieve_vx_range_headers(VX_OBJ **vx_objs, int count, ARENA *arena, int vx, char *y_str, int y_offset)
+{
+    mpz_t y;
+    mpz_init(y);
+    mpz_set_str(y, y_str, 10); // Set y from start_y
+    mpz_add_ui(y, y, y_offset);
+
+    int is_allocated = 1;
+    for (int i = 0; i < count && is_allocated; i++)
+    {
+        vx_objs[i] = vx_arena_init(arena, vx, y);
+        is_allocated = vx_objs[i] != NULL;
+
+        // increment y by 1 for each segment
+        mpz_add_ui(y, y, 1);
+    }
+    mpz_clear(y);
+
+    return is_allocated;
+}
+
+/**
+ * @brief Sieves consecutive segments in blocks of vx_block_rows (tuning.h), moving their gaps into an arena.
+ *
+ * @param vx_objs The segments, with headers.
+ * @param count The number of segments.
+ * @param arena The arena receiving the exact-size p_gaps arrays.
+ * @param vx_assets The assets of the segment size.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int sieve_vx_range_slice(VX_OBJ **vx_objs, int count, ARENA *arena, VX_ASSETS *vx_assets)
+{
+    int vx = vx_assets->vx;
+    int block_rows = iz_tuning()->vx_block_rows;
+
+    // 1. Working set of a block: rows and gap buffers, reused by every block
+    VX_ROW rows[SIEVE_MAX_BLOCK_ROWS];
+    GAP_TYPE *gap_buffers[SIEVE_MAX_BLOCK_ROWS];
+    int is_allocated = 1;
+    for (int r = 0; r < block_rows; r++)
+    {
+        is_allocated = sieve_vx_row_alloc(&rows[r], vx_assets) && is_allocated;
+        gap_buffers[r] = malloc(vx / 2 * GAP_SIZE);
+        is_allocated = is_allocated && gap_buffers[r] != NULL;
+    }
+
+    // 2. Sieve consecutive segments in blocks of block_rows
+    for (int i = 0; i < count && is_allocated; i += block_rows)
+    {
+        VX_OBJ **block = vx_objs + i;
+        int row_count = MIN(block_rows, count - i);
+
+        for (int r = 0; r < row_count; r++)
+            block[r]->p_gaps = gap_buffers[r];
+
+        sieve_vx_rows(rows, block, row_count, vx_assets);
+
+        // Move the gaps to exact-size arrays in the arena
+        for (int r = 0; r < row_count && is_allocated; r++)
+        {
+            block[r]->p_gaps = arena_alloc(arena, block[r]->p_count * GAP_SIZE);
+            is_allocated = block[r]->p_gaps != NULL;
+            if (is_allocated)
+                memcpy(block[r]->p_gaps, gap_buffers[r], block[r]->p_count * GAP_SIZE);
+        }
+    }
+
+    // 3. Free the working set
+    for (int r = 0; r < block_rows; r++)
+    {
+        sieve_vx_row_free(&rows[r]);
+        free(gap_buffers[r]);
+    }
+
+    return is_allocated;
+}
+
+/**
+ * @brief Starts a job sieving the VX6 segments y = start_y, ..., start_y + range_y - 1,
+ * to be advanced by iz_sieve_step.
+ *
+ * @description: The range, the VX_OBJ headers and y strings of all of its segments
+ * are allocated upfront from one arena, which grows geometrically and also receives
+ * the exact-size p_gaps arrays of the segments as they are sieved.
+ *
+ * @param start_y The starting value for y.
+ * @param range_y The number of segments to be sieved.
+ * @return IZ_SIEVE_STATE* The job at its first segment, or NULL if the input is invalid or memory allocation fails.
+ */
+IZ_SIEVE_STATE *iz_sieve_state_vx6_range(char *start_y, int range_y)
+{
+    if (start_y == NULL || !is_numeric_str(start_y) || range_y <= 0)
+    {
+        log_error("Invalid start_y or range_y in iz_sieve_state_vx6_range.");
+        return NULL;
+    }
+
+    int vx = VX6; // default segment size
+    IZ_SIEVE_STATE *state = calloc(1, sizeof(IZ_SIEVE_STATE));
+    VX_ASSETS *vx_assets = vx_assets_init(vx);
+
+    // 1. Arena sized for the headers and the gaps of about one segment
+    ARENA *arena = arena_create(range_y * (sizeof(VX_OBJ *) + sizeof(VX_OBJ) + strlen(start_y) + 24) +
+                                vx / 2 * GAP_SIZE);
+    VX_RANGE *vx_range = arena != NULL ? arena_alloc(arena, sizeof(VX_RANGE)) : NULL;
+    VX_OBJ **vx_objs = arena != NULL ? arena_alloc(arena, range_y * sizeof(VX_OBJ *)) : NULL;
+    if (state == NULL || vx_assets == NULL || vx_range == NULL || vx_objs == NULL)
+    {
+        log_error("Memory allocation failed in iz_sieve_state_vx6_range.");
+        free(state);
+        vx_assets_free(vx_assets);
+        arena_free(arena);
+        return NULL;
+    }
+
+    state->kind = IZ_SIEVE_JOB_VX6_RANGE;
+    state->vx = vx;
+    state->range_y = range_y;
+    state->vx_assets = vx_assets;
+
+    vx_range->vx = vx;
+    vx_range->count = range_y;
+    vx_range->arena = arena;
+    vx_range->worker_arenas = NULL;
+    vx_range->worker_count = 0;
+    vx_range->vx_objs = vx_objs;
+    state->vx_range = vx_range;
+
+    // 2. Headers and y strings of the segments y = start_y, start_y + 1, ...
+    if (!sieve_vx_range_headers(vx_range->vx_objs, range_y, arena, vx, start_y, 0))
+    {
+        log_error("Memory allocation failed in iz_sieve_state_vx6_range.");
+        iz_sieve_state_free(state);
+        return NULL;
+    }
+
+    return state;
+}
+
+/**
+ * @brief Sieves the next segments of a VX6 range job, at most max_segments of them.
+ *
+ * @param state The range job, not completed.
+ * @param max_segments The largest number of segments to sieve, at least 1.
+ * @return int 1 if segments remain, 0 if the job is completed, -1 if memory allocation fails.
+ */
+static int sieve_vx_state_step(IZ_SIEVE_STATE *state, int max_segments)
+{
+    int count = MIN(max_segments, state->range_y - state->next);
+    VX_RANGE *vx_range = state->vx_range;
+
+    if (!sieve_vx_range_slice(vx_range->vx_objs + state->next, count, vx_range->arena, state->vx_assets))
+    {
+        log_error("Memory allocation failed in iz_sieve_step.");
+        return -1;
+    }
+
+    state->next += count;
+    if (state->next < state->range_y)
+        return 1;
+
+    // The assets are no longer needed
+    vx_assets_free(state->vx_assets);
+    state->vx_assets = NULL;
+    state->is_done = 1;
+    return 0;
+}
+
+/**
+ * @brief This function initializes and processes a range of VX_OBJ.
+ *
+ * @description: The consecutive segments are sieved in blocks of vx_block_rows (tuning.h),
+ * sharing the word patterns of the small root primes across the block.
+ *
+ * The job allocates its working set once: a VX_ROW per block row, with its bitmaps,
+ * GMP variables and a gap buffer of vx/2 gaps reused by every block. The range, the
+ * VX_OBJ headers, y strings and the exact-size p_gaps arrays are allocated from one
+ * arena, which grows geometrically, and are all released by vx_range_free.
+ *
+ * The job runs as an IZ_SIEVE_STATE advanced through all of its segments at once; see
+ * iz_sieve_state_vx6_range and iz_sieve_step to sieve it in bounded slices instead.
+ *
+ * @param start_y The starting value for y.
+ * @param range_y The number of segments to be sieved.
+ * @return VX_RANGE* A pointer to the range of VX_OBJ, or NULL if memory allocation fails.
+ */
+VX_RANGE *sieve_vx6_range(char *start_y, int range_y)
+{
+    IZ_SIEVE_STATE *state = iz_sieve_state_vx6_range(start_y, range_y);
+    if (state == NULL)
+        return NULL;
+
+    VX_RANGE *vx_range = NULL;
+    if (iz_sieve_step(state, range_y) == 0)
+        vx_range = iz_sieve_state_take_vx_range(state);
+    else
+        log_error("Memory allocation failed in sieve_vx6_range.");
+
+    iz_sieve_state_free(state);
+    return vx_range;
+}
+
+/**
+ * @struct VX_RANGE_WORKER
+ * @brief The slice of a parallel range job processed by one thread.
+ */
+typedef struct
+{
+    char *start_y;         ///< First y of the range
+    int first;             ///< Index of the slice's first segment in the range
+    int count;             ///< Number of segments in the slice
+    int node;              ///< NUMA node the worker is pinned to, -1 to run unpinned
+    VX_OBJ **vx_objs;      ///< The slice of the range's segments
+    ARENA **arena;         ///< Receives the worker's arena, holding its segments
+    VX_ASSETS *vx_assets;  ///< Assets local to the worker's node
+    int is_allocated;      ///< Result: 1 on success, 0 if memory allocation failed
+} VX_RANGE_WORKER;
+
+/**
+ * @brief Thread body of sieve_vx6_range_parallel: pins itself, then sieves its slice
+ * into its own arena, so its buffers are first touched, and placed, on its node.
+ *
+ * @param arg The VX_RANGE_WORKER.
+ * @return void* NULL.
+ */
+static void *sieve_vx_range_worker(void *arg)
+{
+    VX_RANGE_WORKER *worker = arg;
+    int vx = worker->vx_assets->vx;
+
+    if (worker->node >= 0)
+        numa_pin_thread(worker->node);
+
+    ARENA *arena = arena_create(worker->count * (sizeof(VX_OBJ) + strlen(worker->start_y) + 24) +
+                                vx / 2 * GAP_SIZE);
+    *worker->arena = arena;
+
+    worker->is_allocated = arena != NULL &&
+                           sieve_vx_range_headers(worker->vx_objs, worker->count, arena, vx, worker->start_y, worker->first) &&
+                           sieve_vx_range_slice(worker->vx_objs, worker->count, arena, worker->vx_assets);
+    return NULL;
+}
+
+/**
+ * @brief This function processes a range of VX_OBJ with a pool of NUMA-pinned threads.
+ *
+ * @description: Each worker sieves a contiguous slice of the range with the blocked
+ * sieve of sieve_vx6_range. On hosts with several NUMA nodes, workers are pinned to
+ * nodes in contiguous blocks, and each node reads its own replica of the VX_ASSETS.
+ * A worker allocates its working set and output segments from its own arena after
+ * pinning itself, so they are placed on its node.
+ *
+ * @param start_y The starting value for y.
+ * @param range_y The number of segments to be sieved.
+ * @param threads The number of threads, 0 for the tuned default (one per online CPU unless set).
+ * @return VX_RANGE* A pointer to the range of VX_OBJ, or NULL if memory allocation fails.
+ */
+VX_RANGE *sieve_vx6_range_parallel(char *start_y, int range_y, int threads)
+{
+    if (!is_numeric_str(start_y) || range_y <= 0 || threads < 0)
+    {
+        log_error("Invalid start_y, range_y or threads in sieve_vx6_range_parallel.");
+        return NULL;
+    }
+
+    if (threads == 0)
+        threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = MIN(threads, range_y);
+    if (threads < 2)
+        return sieve_vx6_range(start_y, range_y);
+
+    int vx = VX6; // default segment size
+    int node_count = numa_node_count();
+    int is_allocated = 1;
+
+    // 1. Assets, replicated on each node when there is more than one
+    VX_ASSETS *vx_assets = vx_assets_init(vx);
+    VX_ASSETS *node_assets[NUMA_MAX_NODES] = {NULL};
+    is_allocated = vx_assets != NULL;
+    for (int node = 0; node < node_count && node_count > 1 && is_allocated; node++)
+    {
+        node_assets[node] = vx_assets_replicate(vx_assets, node);
+        is_allocated = node_assets[node] != NULL;
+    }
+
+    // 2. The range, its segment array and worker arenas
+    ARENA *arena = arena_create(sizeof(VX_RANGE) + range_y * sizeof(VX_OBJ *) + threads * sizeof(ARENA *));
+    VX_RANGE_WORKER *workers = malloc(threads * sizeof(VX_RANGE_WORKER));
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    is_allocated = is_allocated && arena != NULL && workers != NULL && thread_ids != NULL;
+
+    VX_RANGE *vx_range = NULL;
+    if (is_allocated)
+    {
+        VX_RANGE *range = arena_alloc(arena, sizeof(VX_RANGE));
+        VX_OBJ **vx_objs = arena_alloc(arena, range_y * sizeof(VX_OBJ *));
+        ARENA **worker_arenas = arena_alloc(arena, threads * sizeof(ARENA *));
+        is_allocated = range != NULL && vx_objs != NULL && worker_arenas != NULL;
+        if (is_allocated)
+        {
+            vx_range = range;
+            vx_range->vx = vx;
+            vx_range->count = range_y;
+            vx_range->arena = arena;
+            vx_range->vx_objs = vx_objs;
+            vx_range->worker_arenas = worker_arenas;
+            vx_range->worker_count = threads;
+            memset(vx_range->worker_arenas, 0, threads * sizeof(ARENA *));
+        }
+    }
+
+    // 3. One contiguous slice per worker, workers of a node adjacent
+    int started = 0;
+    for (int w = 0; w < threads && is_allocated; w++)
+    {
+        int first = (int)((int64_t)range_y * w / threads);
+        int node = numa_worker_node(w, threads);
+
+        workers[w].start_y = start_y;
+        workers[w].first = first;
+        workers[w].count = (int)((int64_t)range_y * (w + 1) / threads) - first;
+        workers[w].node = node_count > 1 ? node : -1;
+        workers[w].vx_objs = vx_range->vx_objs + first;
+        workers[w].arena = &vx_range->worker_arenas[w];
+        workers[w].vx_assets = node_count > 1 ? node_assets[node] : vx_assets;
+        workers[w].is_allocated = 0;
+
+        if (pthread_create(&thread_ids[w], NULL, sieve_vx_range_worker, &workers[w]) != 0)
+        {
+            log_error("Thread creation failed in sieve_vx6_range_parallel.");
+            is_allocated = 0;
+            break;
+        }
+        started++;
+    }
+
+    for (int w = 0; w < started; w++)
+    {
+        pthread_join(thread_ids[w], NULL);
+        is_allocated = is_allocated && workers[w].is_allocated;
+    }
+
+    // 4. Cleanup:
+    for (int node = 0; node < node_count; node++)
+        vx_assets_free(node_assets[node]);
+    vx_assets_free(vx_assets);
+    free(workers);
+    free(thread_ids);
+
+    if (!is_allocated)
+    {
+        log_error("Memory allocation failed in sieve_vx6_range_parallel.");
+        if (vx_range != NULL)
+            vx_range_free(vx_range);
+        else
+            arena_free(arena);
+        return NULL;
+    }
+
+    // 5. Return the range of VX_OBJ
+    return vx_range;
+}
+
 /**
  * @brief This a utility function that marks composites of given root primes in the
  * x5 and x7 bitmaps representing iZ- and iZ+ segments at a given y.
@@ -529,3 +1500,402 @@ void sieve_vx_root_primes(int vx, mpz_t y, PRIMES_OBJ *root_primes, BITMAP *x5,
         bitmap_clear_mod_p(x7, p, solve_for_x_gmp(1, p, vx, y), vx);
     }
 }
+
+/**
+ * @brief Advances a sieve job by at most max_segments segments.
+ *
+ * @description: A step sieves the next rows of an iZm job, or the next VX6 segments
+ * of a range job, and returns, bounding the time spent in a call by max_segments.
+ * The job can be interleaved with other work on the same thread, or written to a
+ * file by iz_sieve_state_write_file between steps.
+ *
+ * @param state The sieve job.
+ * @param max_segments The largest number of segments to sieve, at least 1.
+ * @return int 1 if segments remain, 0 if the job is completed, -1 on invalid input or
+ * if memory allocation fails, after which the state can only be freed.
+ */
+int iz_sieve_step(IZ_SIEVE_STATE *state, int max_segments)
+{
+    if (state == NULL || max_segments <= 0)
+    {
+        log_error("Invalid state or max_segments in iz_sieve_step.");
+        return -1;
+    }
+
+    if (state->is_done)
+        return 0;
+
+    if (state->kind == IZ_SIEVE_JOB_IZM)
+        return sieve_iZm_state_step(state, max_segments);
+
+    return sieve_vx_state_step(state, max_segments);
+}
+
+/**
+ * @brief Returns the number of segments a sieve job has left.
+ *
+ * @param state The sieve job.
+ * @return int The rows of iZm or VX6 segments left, 0 once completed.
+ */
+int iz_sieve_state_remaining(const IZ_SIEVE_STATE *state)
+{
+    if (state == NULL || state->is_done)
+        return 0;
+
+    if (state->kind == IZ_SIEVE_JOB_IZM)
+        return state->max_y - state->y + 1;
+
+    return state->range_y - state->next;
+}
+
+/**
+ * @brief Detaches the primes of a completed iZm job, to be freed by the caller.
+ *
+ * @param state The iZm job.
+ * @return PRIMES_OBJ* The primes up to n, or NULL if the job is not an iZm job, is
+ * not completed or its primes were already taken.
+ */
+PRIMES_OBJ *iz_sieve_state_take_primes(IZ_SIEVE_STATE *state)
+{
+    if (state == NULL || state->kind != IZ_SIEVE_JOB_IZM || !state->is_done)
+        return NULL;
+
+    PRIMES_OBJ *primes = state->primes;
+    state->primes = NULL;
+    return primes;
+}
+
+/**
+ * @brief Detaches the range of a completed VX6 range job, to be freed by vx_range_free.
+ *
+ * @param state The range job.
+ * @return VX_RANGE* The segments, in order of y, or NULL if the job is not a range job,
+ * is not completed or its range was already taken.
+ */
+VX_RANGE *iz_sieve_state_take_vx_range(IZ_SIEVE_STATE *state)
+{
+    if (state == NULL || state->kind != IZ_SIEVE_JOB_VX6_RANGE || !state->is_done)
+        return NULL;
+
+    VX_RANGE *vx_range = state->vx_range;
+    state->vx_range = NULL;
+    return vx_range;
+}
+
+/**
+ * @brief Frees a sieve job, its working set and the results not taken.
+ *
+ * @param state The sieve job, may be NULL.
+ */
+void iz_sieve_state_free(IZ_SIEVE_STATE *state)
+{
+    if (state == NULL)
+        return;
+
+    sieve_iZm_state_release(state);
+    primes_obj_free(state->primes);
+    vx_assets_free(state->vx_assets);
+    vx_range_free(state->vx_range);
+    free(state);
+}
+
+/**
+ * @brief Writes data to a state file, adding it to the running hash of the file.
+ *
+ * @param file The state file.
+ * @param ctx The SHA-256 context of the file.
+ * @param data The data to write.
+ * @param size The size of the data in bytes.
+ * @return int 1 on success, 0 on failure.
+ */
+static int sieve_state_write(FILE *file, EVP_MD_CTX *ctx, const void *data, size_t size)
+{
+    return fwrite(data, 1, size, file) == size && EVP_DigestUpdate(ctx, data, size) == 1;
+}
+
+/**
+ * @brief Reads data from a state file, adding it to the running hash of the file.
+ *
+ * @param file The state file.
+ * @param ctx The SHA-256 context of the file.
+ * @param data Receives the data.
+ * @param size The size of the data in bytes.
+ * @return int 1 on success, 0 on failure.
+ */
+static int sieve_state_read(FILE *file, EVP_MD_CTX *ctx, void *data, size_t size)
+{
+    return fread(data, 1, size, file) == size && EVP_DigestUpdate(ctx, data, size) == 1;
+}
+
+/**
+ * @brief Writes a sieve job to a binary file, to be resumed by iz_sieve_state_read_file.
+ *
+ * @description: The file holds the position of the job and the results so far:
+ *   - The magic number IZ_SIEVE_STATE_MAGIC and the kind of the job.
+ *   - iZm job: n, vx, the index of the first root prime, the next row y, the root-prime
+ *     cursor seg_end, the completion flag, then the count and array of the primes so far.
+ *   - VX6 range job: the length and string of start_y, range_y, the index of the next
+ *     segment and the completion flag, then the p_count, bit_ops, p_test_ops and
+ *     p_gaps of each sieved segment.
+ *   - A SHA-256 hash of all of the above, for data integrity.
+ *
+ * The working set is not written, it is rebuilt from the position when the file is read.
+ *
+ * @param file_path The path of the file to write.
+ * @param state The sieve job, between steps, with its results not taken.
+ * @return int 1 on success, 0 on failure.
+ */
+int iz_sieve_state_write_file(const char *file_path, IZ_SIEVE_STATE *state)
+{
+    if (file_path == NULL || state == NULL ||
+        (state->kind == IZ_SIEVE_JOB_IZM ? state->primes == NULL : state->vx_range == NULL))
+    {
+        log_error("Invalid state in iz_sieve_state_write_file.");
+        return 0;
+    }
+
+    FILE *file = fopen(file_path, "wb");
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (file == NULL || ctx == NULL || EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) != 1)
+    {
+        log_error("Could not open file %s for writing", file_path);
+        if (file != NULL)
+            fclose(file);
+        EVP_MD_CTX_free(ctx);
+        return 0;
+    }
+
+    uint32_t magic = IZ_SIEVE_STATE_MAGIC;
+    int is_written = sieve_state_write(file, ctx, &magic, sizeof(magic)) &&
+                     sieve_state_write(file, ctx, &state->kind, sizeof(int));
+
+    if (state->kind == IZ_SIEVE_JOB_IZM)
+    {
+        uint64_t vx = state->vx;
+        PRIMES_OBJ *primes = state->primes;
+        is_written = is_written &&
+                     sieve_state_write(file, ctx, &state->n, sizeof(uint64_t)) &&
+                     sieve_state_write(file, ctx, &vx, sizeof(uint64_t)) &&
+                     sieve_state_write(file, ctx, &state->start_i, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &state->y, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &state->seg_end, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &state->is_done, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &primes->p_count, sizeof(int)) &&
+                     sieve_state_write(file, ctx, primes->p_array, primes->p_count * sizeof(uint64_t));
+    }
+    else
+    {
+        VX_OBJ **vx_objs = state->vx_range->vx_objs;
+        size_t y_len = strlen(vx_objs[0]->y) + 1;
+        is_written = is_written &&
+                     sieve_state_write(file, ctx, &y_len, sizeof(size_t)) &&
+                     sieve_state_write(file, ctx, vx_objs[0]->y, y_len) &&
+                     sieve_state_write(file, ctx, &state->range_y, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &state->next, sizeof(int)) &&
+                     sieve_state_write(file, ctx, &state->is_done, sizeof(int));
+
+        for (int i = 0; i < state->next && is_written; i++)
+            is_written = sieve_state_write(file, ctx, &vx_objs[i]->p_count, sizeof(int)) &&
+                         sieve_state_write(file, ctx, &vx_objs[i]->bit_ops, sizeof(int)) &&
+                         sieve_state_write(file, ctx, &vx_objs[i]->p_test_ops, sizeof(int)) &&
+                         sieve_state_write(file, ctx, vx_objs[i]->p_gaps, vx_objs[i]->p_count * GAP_SIZE);
+    }
+
+    // Write the hash of the file
+    unsigned char sha256[SHA256_DIGEST_LENGTH];
+    is_written = is_written && EVP_DigestFinal_ex(ctx, sha256, NULL) == 1 &&
+                 fwrite(sha256, 1, SHA256_DIGEST_LENGTH, file) == SHA256_DIGEST_LENGTH;
+
+    EVP_MD_CTX_free(ctx);
+    is_written = fclose(file) == 0 && is_written;
+    if (!is_written)
+        log_error("Could not write the sieve state to %s", file_path);
+
+    return is_written;
+}
+
+/**
+ * @brief Reads the position and results of an iZm job and rebuilds its working set.
+ *
+ * @param file The state file, past the kind of the job.
+ * @param ctx The SHA-256 context of the file.
+ * @return IZ_SIEVE_STATE* The job, or NULL if the file is invalid or memory allocation fails.
+ */
+static IZ_SIEVE_STATE *sieve_iZm_state_read(FILE *file, EVP_MD_CTX *ctx)
+{
+    IZ_SIEVE_STATE *state = calloc(1, sizeof(IZ_SIEVE_STATE));
+    if (state == NULL)
+        return NULL;
+    state->kind = IZ_SIEVE_JOB_IZM;
+
+    uint64_t vx = 0;
+    int p_count = 0;
+    int is_valid = sieve_state_read(file, ctx, &state->n, sizeof(uint64_t)) &&
+                   sieve_state_read(file, ctx, &vx, sizeof(uint64_t)) &&
+                   sieve_state_read(file, ctx, &state->start_i, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &state->y, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &state->seg_end, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &state->is_done, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &p_count, sizeof(int));
+
+    // The primes so far must fit the capacity of the job, 1.5 pi_n(n) (168 primes below 1000),
+    // checked before allocating it as the hash of the file is only verified at its end
+    is_valid = is_valid && state->n >= 2 && state->n <= IZ_SIEVE_STATE_MAX_N;
+    uint64_t capacity = !is_valid ? 0 : state->n < 1000 ? 168 : (uint64_t)(pi_n(state->n) * 1.5);
+    is_valid = is_valid && capacity <= INT_MAX && p_count > 0 && (uint64_t)p_count <= capacity;
+
+    // The position must lie in the rows of a job of a pre-sieved vx
+    state->vx = vx;
+    state->x_n = state->n / 6 + 1;
+    is_valid = is_valid && (state->is_done ||
+                            (state->n >= 1000 && vx >= 35 && vx <= state->x_n &&
+                             state->start_i >= 2 && state->start_i <= state->seg_end &&
+                             state->y >= 1 && (uint64_t)state->y <= state->x_n / vx + 1 &&
+                             state->start_i < p_count));
+    if (is_valid && !state->is_done)
+        state->max_y = state->x_n / vx;
+
+    // The primes so far, with the capacity of the rows left
+    if (is_valid)
+        state->primes = primes_obj_init(state->is_done ? p_count : (int)capacity);
+    is_valid = is_valid && state->primes != NULL &&
+               sieve_state_read(file, ctx, state->primes->p_array, p_count * sizeof(uint64_t));
+    if (is_valid)
+        state->primes->p_count = p_count;
+
+    // Rebuild the working set of the rows left
+    is_valid = is_valid && (state->is_done ||
+                            (sieve_iZm_state_base(state) && sieve_iZm_state_rows(state) &&
+                             state->seg_end <= state->root_end));
+
+    if (!is_valid)
+    {
+        iz_sieve_state_free(state);
+        return NULL;
+    }
+
+    return state;
+}
+
+/**
+ * @brief Reads the position and sieved segments of a VX6 range job and rebuilds its working set.
+ *
+ * @param file The state file, past the kind of the job.
+ * @param ctx The SHA-256 context of the file.
+ * @return IZ_SIEVE_STATE* The job, or NULL if the file is invalid or memory allocation fails.
+ */
+static IZ_SIEVE_STATE *sieve_vx_state_read(FILE *file, EVP_MD_CTX *ctx)
+{
+    size_t y_len = 0;
+    if (!sieve_state_read(file, ctx, &y_len, sizeof(size_t)) || y_len < 2 || y_len > IZ_SIEVE_STATE_MAX_Y_LEN)
+        return NULL;
+
+    char *start_y = malloc(y_len);
+    int range_y = 0, next = 0, is_done = 0;
+    int is_valid = start_y != NULL &&
+                   sieve_state_read(file, ctx, start_y, y_len) &&
+                   sieve_state_read(file, ctx, &range_y, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &next, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &is_done, sizeof(int));
+    // range_y sizes the arena and the headers below, checked before the hash of the file is verified
+    is_valid = is_valid && start_y[y_len - 1] == '\0' && range_y > 0 && range_y <= IZ_SIEVE_STATE_MAX_RANGE_Y &&
+               next >= 0 && next <= range_y && is_done == (next == range_y);
+
+    // The range and the headers of all of its segments
+    IZ_SIEVE_STATE *state = is_valid ? iz_sieve_state_vx6_range(start_y, range_y) : NULL;
+    free(start_y);
+    if (state == NULL)
+        return NULL;
+
+    // The sieved segments
+    VX_RANGE *vx_range = state->vx_range;
+    for (int i = 0; i < next && is_valid; i++)
+    {
+        VX_OBJ *vx_obj = vx_range->vx_objs[i];
+        is_valid = sieve_state_read(file, ctx, &vx_obj->p_count, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &vx_obj->bit_ops, sizeof(int)) &&
+                   sieve_state_read(file, ctx, &vx_obj->p_test_ops, sizeof(int)) &&
+                   vx_obj->p_count >= 0 && vx_obj->p_count <= vx_obj->vx;
+
+        if (is_valid)
+            vx_obj->p_gaps = arena_alloc(vx_range->arena, vx_obj->p_count * GAP_SIZE);
+        is_valid = is_valid && vx_obj->p_gaps != NULL &&
+                   sieve_state_read(file, ctx, vx_obj->p_gaps, vx_obj->p_count * GAP_SIZE);
+    }
+
+    state->next = next;
+    if (is_valid && is_done)
+    {
+        vx_assets_free(state->vx_assets);
+        state->vx_assets = NULL;
+        state->is_done = 1;
+    }
+
+    if (!is_valid)
+    {
+        iz_sieve_state_free(state);
+        return NULL;
+    }
+
+    return state;
+}
+
+/**
+ * @brief Reads a sieve job written by iz_sieve_state_write_file, to be resumed by iz_sieve_step.
+ *
+ * @description: Reads the position and results of the job, validates the SHA-256 hash
+ * of the file, and rebuilds the working set of the segments left: the base segment,
+ * root prime table and row bitmaps of an iZm job, or the VX6 assets of a range job.
+ *
+ * @param file_path The path of the file to read.
+ * @return IZ_SIEVE_STATE* The job, or NULL if the file cannot be read, is invalid or
+ * its hash does not match.
+ */
+IZ_SIEVE_STATE *iz_sieve_state_read_file(const char *file_path)
+{
+    if (file_path == NULL)
+        return NULL;
+
+    FILE *file = fopen(file_path, "rb");
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (file == NULL || ctx == NULL || EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) != 1)
+    {
+        log_error("Could not open file %s for reading", file_path);
+        if (file != NULL)
+            fclose(file);
+        EVP_MD_CTX_free(ctx);
+        return NULL;
+    }
+
+    // Read the magic number and the kind of the job, then the job itself
+    uint32_t magic = 0;
+    int kind = -1;
+    IZ_SIEVE_STATE *state = NULL;
+    if (sieve_state_read(file, ctx, &magic, sizeof(magic)) && magic == IZ_SIEVE_STATE_MAGIC &&
+        sieve_state_read(file, ctx, &kind, sizeof(int)))
+    {
+        if (kind == IZ_SIEVE_JOB_IZM)
+            state = sieve_iZm_state_read(file, ctx);
+        else if (kind == IZ_SIEVE_JOB_VX6_RANGE)
+            state = sieve_vx_state_read(file, ctx);
+    }
+
+    // Validate the hash of the file
+    unsigned char sha256[SHA256_DIGEST_LENGTH], computed_hash[SHA256_DIGEST_LENGTH];
+    int is_valid = state != NULL &&
+                   fread(sha256, 1, SHA256_DIGEST_LENGTH, file) == SHA256_DIGEST_LENGTH &&
+                   EVP_DigestFinal_ex(ctx, computed_hash, NULL) == 1 &&
+                   memcmp(sha256, computed_hash, SHA256_DIGEST_LENGTH) == 0;
+
+    EVP_MD_CTX_free(ctx);
+    fclose(file);
+
+    if (!is_valid)
+    {
+        log_error("Invalid sieve state file %s", file_path);
+        iz_sieve_state_free(state);
+        return NULL;
+    }
+
+    return state;
+}
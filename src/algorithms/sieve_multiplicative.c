@@ -0,0 +1,278 @@
+/**
+ * @file sieve_multiplicative.c
+ * @brief Segmented sieve of multiplicative functions: φ, μ, ω and Ω of every integer in [lo, hi].
+ *
+ * @description:
+ * Each integer of a segment keeps its unfactored part, starting at the integer
+ * itself. Every root prime p up to sqrt(hi) walks its multiples in the segment and
+ * divides p out of them, as often as it divides, updating the functions:
+ * - φ is multiplied by p - 1, then by p for each further power of p,
+ * - μ changes sign, and becomes 0 at the second power of p,
+ * - ω counts p once, Ω counts every power.
+ * The factor 2 is taken in one step with a trailing-zero count, and the exact
+ * divisions by odd p are multiplications by p^-1 mod 2^64, which also test
+ * divisibility (see factor.c). What remains after the root primes is 1 or a
+ * single prime above sqrt(hi), applied last.
+ *
+ * The loop follows sieve_iZm: the root primes come with a ROOT_PRIME_TABLE built for
+ * the segment length as vx, so the first multiple of p in a segment follows from
+ * the previous one by vx mod p, with one fast_mod per prime and chunk. The
+ * segments are split in contiguous chunks over threads; each thread works in its
+ * own buffers and copies the requested functions into the caller's.
+ *
+ * @usage:
+ * uint64_t phi[1001];
+ * int8_t mu[1001];
+ * IZ_MULT_FUNCS out = {phi, mu, NULL, NULL}; // φ and μ only
+ * sieve_multiplicative(1000000, 1001000, &out, 0); // phi[i] = φ(1000000 + i)
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For the threads of sieve_multiplicative
+#include <unistd.h>  // For sysconf
+
+#define MF_SEGMENT 16384 ///< Integers per segment: 18 bytes each, sized for the L2 cache
+
+/**
+ * @struct MF_SIEVE
+ * @brief The root primes of a multiplicative-function sieve, shared by its threads.
+ */
+typedef struct
+{
+    uint64_t lo;                 ///< First integer
+    uint64_t hi;                 ///< Last integer
+    const IZ_MULT_FUNCS *out;    ///< The caller's buffers
+    ROOT_PRIME_TABLE *root_table; ///< Root primes from 2 up to sqrt(hi), with vx = MF_SEGMENT
+    uint64_t *p_inv_2_64;        ///< p^-1 mod 2^64 of the odd root primes
+    uint64_t *max_quotient;      ///< (2^64 - 1) / p of the odd root primes
+} MF_SIEVE;
+
+/**
+ * @struct MF_WORKER
+ * @brief One chunk of segments of a multiplicative-function sieve, and the thread sieving it.
+ */
+typedef struct
+{
+    const MF_SIEVE *sieve;
+    uint64_t first;  ///< First integer of the chunk
+    uint64_t last;   ///< Last integer of the chunk
+    int status;      ///< 1 on success, 0 if memory allocation failed
+    pthread_t thread;
+} MF_WORKER;
+
+/**
+ * @brief Sieves the functions of the integers [first, last] of one chunk, segment by segment.
+ *
+ * @param arg The MF_WORKER.
+ * @return void* NULL.
+ */
+static void *mf_worker(void *arg)
+{
+    MF_WORKER *worker = arg;
+    const MF_SIEVE *sieve = worker->sieve;
+    const ROOT_PRIME_TABLE *table = sieve->root_table;
+    const IZ_MULT_FUNCS *out = sieve->out;
+
+    uint64_t *rest = malloc(MF_SEGMENT * sizeof(uint64_t));
+    uint64_t *phi = malloc(MF_SEGMENT * sizeof(uint64_t));
+    int8_t *mu = malloc(MF_SEGMENT);
+    uint8_t *omega = malloc(MF_SEGMENT);
+    uint8_t *big_omega = malloc(MF_SEGMENT);
+
+    // first multiple offsets of the odd root primes: p - (start mod p) mod p
+    uint64_t *start_mod_p = malloc(table->p_count * sizeof(uint64_t));
+
+    worker->status = rest != NULL && phi != NULL && mu != NULL && omega != NULL && big_omega != NULL &&
+                     start_mod_p != NULL;
+
+    // the root primes up to sqrt(last) are the only ones with multiples to divide in the chunk
+    int root_end = 1;
+    while (root_end < table->p_count && (uint64_t)table->p[root_end] * table->p[root_end] <= worker->last)
+        root_end++;
+
+    for (int i = 1; i < root_end && worker->status; i++)
+        start_mod_p[i] = fast_mod(worker->first, table->p[i], table->p_inv[i]);
+
+    for (uint64_t start = worker->first; worker->status; start += MF_SEGMENT)
+    {
+        int len = (int)MIN((uint64_t)MF_SEGMENT - 1, worker->last - start) + 1;
+        uint64_t end = start + len - 1;
+
+        // 1. Every integer unfactored
+        for (int x = 0; x < len; x++)
+            rest[x] = start + x;
+        memset(mu, 1, len);
+        memset(omega, 0, len);
+        memset(big_omega, 0, len);
+
+        // 2. The factor 2, by trailing zeros
+        for (int x = (start & 1); x < len; x += 2)
+        {
+            int k = __builtin_ctzll(rest[x]);
+            rest[x] >>= k;
+            phi[x] = (uint64_t)1 << (k - 1);
+            mu[x] = k == 1 ? -1 : 0;
+            omega[x] = 1;
+            big_omega[x] = k;
+        }
+        for (int x = 1 - (start & 1); x < len; x += 2)
+            phi[x] = 1;
+
+        // 3. The odd root primes up to sqrt(end), each walking its multiples
+        for (int i = 1; i < root_end; i++)
+        {
+            uint64_t p = table->p[i];
+            uint64_t residue = start_mod_p[i];
+
+            // step the residue to the next segment, as the iZm rows do
+            start_mod_p[i] += table->vx_mod_p[i];
+            if (start_mod_p[i] >= p)
+                start_mod_p[i] -= p;
+
+            if (p * p > end)
+                continue;
+
+            uint64_t inv = sieve->p_inv_2_64[i], max_quotient = sieve->max_quotient[i];
+            for (uint64_t x = residue ? p - residue : 0; x < (uint64_t)len; x += p)
+            {
+                uint64_t r = rest[x] * inv;
+                uint64_t f = phi[x] * (p - 1);
+                int k = 1;
+
+                // further powers of p
+                for (uint64_t q = r * inv; q <= max_quotient; q *= inv)
+                {
+                    r = q;
+                    f *= p;
+                    k++;
+                }
+
+                rest[x] = r;
+                phi[x] = f;
+                mu[x] = k == 1 ? -mu[x] : 0;
+                omega[x]++;
+                big_omega[x] += k;
+            }
+        }
+
+        // 4. The prime factor above sqrt(end), if any
+        for (int x = 0; x < len; x++)
+        {
+            if (rest[x] > 1)
+            {
+                phi[x] *= rest[x] - 1;
+                mu[x] = -mu[x];
+                omega[x]++;
+                big_omega[x]++;
+            }
+        }
+
+        // 5. The requested functions into the caller's buffers
+        uint64_t offset = start - sieve->lo;
+        if (out->phi != NULL)
+            memcpy(out->phi + offset, phi, len * sizeof(uint64_t));
+        if (out->mu != NULL)
+            memcpy(out->mu + offset, mu, len);
+        if (out->omega != NULL)
+            memcpy(out->omega + offset, omega, len);
+        if (out->big_omega != NULL)
+            memcpy(out->big_omega + offset, big_omega, len);
+
+        if (end == worker->last)
+            break;
+    }
+
+    free(rest);
+    free(phi);
+    free(mu);
+    free(omega);
+    free(big_omega);
+    free(start_mod_p);
+    return NULL;
+}
+
+int sieve_multiplicative(uint64_t lo, uint64_t hi, const IZ_MULT_FUNCS *out, int threads)
+{
+    if (lo == 0 || hi < lo || out == NULL || threads < 0)
+    {
+        log_error("Invalid range, output or threads in sieve_multiplicative.");
+        return 0;
+    }
+
+    // 1. Root primes up to sqrt(hi), with their table for vx = MF_SEGMENT
+    MF_SIEVE sieve = {lo, hi, out, NULL, NULL, NULL};
+    PRIMES_OBJ *root_primes = iz_sieve_auto(MAX((uint64_t)sqrtl((long double)hi) + 1, 10), IZ_SIEVE_SEQUENTIAL);
+    if (root_primes != NULL)
+    {
+        sieve.root_table = root_table_init(root_primes, root_primes->p_count, MF_SEGMENT);
+        sieve.p_inv_2_64 = malloc(root_primes->p_count * sizeof(uint64_t));
+        sieve.max_quotient = malloc(root_primes->p_count * sizeof(uint64_t));
+    }
+
+    int status = root_primes != NULL && sieve.root_table != NULL && sieve.p_inv_2_64 != NULL &&
+                 sieve.max_quotient != NULL;
+
+    for (int i = 1; status && i < root_primes->p_count; i++)
+    {
+        uint64_t p = root_primes->p_array[i];
+
+        // Newton iteration for p^-1 mod 2^64
+        uint64_t inv = p;
+        for (int k = 0; k < 5; k++)
+            inv *= 2 - p * inv;
+
+        sieve.p_inv_2_64[i] = inv;
+        sieve.max_quotient[i] = UINT64_MAX / p;
+    }
+
+    // 2. One contiguous chunk of segments per thread
+    MF_WORKER *workers = NULL;
+    if (status)
+    {
+        uint64_t segments = (hi - lo) / MF_SEGMENT + 1;
+        if (threads == 0)
+            threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (int)MIN((uint64_t)MAX(threads, 1), segments);
+
+        workers = calloc(threads, sizeof(MF_WORKER));
+        status = workers != NULL;
+
+        for (int t = 0; t < threads && status; t++)
+        {
+            workers[t].sieve = &sieve;
+            uint64_t end_segment = segments * (t + 1) / threads;
+            workers[t].first = lo + segments * t / threads * MF_SEGMENT;
+            workers[t].last = end_segment == segments ? hi : lo + end_segment * MF_SEGMENT - 1;
+        }
+
+        // the calling thread sieves the first chunk
+        int started = 1;
+        for (; status && started < threads; started++)
+            if (pthread_create(&workers[started].thread, NULL, mf_worker, &workers[started]) != 0)
+                break;
+
+        if (status)
+        {
+            mf_worker(&workers[0]);
+
+            // chunks whose thread couldn't start are sieved here
+            for (int t = started; t < threads; t++)
+                mf_worker(&workers[t]);
+            for (int t = 1; t < started; t++)
+                pthread_join(workers[t].thread, NULL);
+
+            for (int t = 0; t < threads; t++)
+                status &= workers[t].status;
+        }
+    }
+
+    if (!status)
+        log_error("Memory allocation failed in sieve_multiplicative.");
+
+    free(workers);
+    free(sieve.p_inv_2_64);
+    free(sieve.max_quotient);
+    root_table_free(sieve.root_table);
+    primes_obj_free(root_primes);
+    return status;
+}
@@ -0,0 +1,394 @@
+/**
+ * @file sieve_smooth.c
+ * @brief Logarithmic sieve of the positions of an interval where a linear or quadratic form is B-smooth.
+ *
+ * @description:
+ * For the form f(i) = c2 i^2 + c1 i + c0 and the positions i in [start, start + len),
+ * every prime p up to B adds its rounded log2 to a byte accumulator at the positions
+ * where p divides f(i), and the positions whose total reaches the threshold are
+ * reported as smoothness candidates. Prime powers are not sieved: their extra
+ * logs are left to the slack between the threshold and log2 |f(i)|.
+ *
+ * The positions are found as the iZ offsets are: each prime solves once for the
+ * roots r of f mod p, the offsets of the iZm rows when f(i) = 6i ± 1 (x_p of
+ * solve_for_x), then steps them from block to block by the block length mod p.
+ * - a linear root is r = -c0 c1^-1 mod p, by modular_inverse,
+ * - a quadratic root is r = (-c1 ± s) (2 c2)^-1 mod p, with s a square root of
+ *   c1^2 - 4 c2 c0 mod p by Tonelli-Shanks,
+ * - a prime dividing c2 sees f mod p as linear, and p = 2 has both residues
+ *   checked; a prime dividing every coefficient divides every f(i), and its log
+ *   is the initial value of the accumulators.
+ *
+ * The blocks are IZ_SMOOTH_BLOCK bytes, sized for the L2 cache, and the threshold
+ * scan runs through the scan_ge kernel of cpu_dispatch.h, 16 to 64 bytes per step.
+ * The blocks are split in contiguous chunks over threads, each collecting its
+ * positions, which are then joined in increasing order.
+ *
+ * @usage:
+ * IZ_SMOOTH_FORM form = {1, 6, 0}; // f(i) = 6i + 1, the iZ+ numbers
+ * uint64_t *positions;
+ * size_t count;
+ * sieve_smooth(&form, 1000000000, 1000000, 65536, 50, 0, &positions, &count);
+ * free(positions);
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For the threads of sieve_smooth
+#include <unistd.h>  // For sysconf
+
+/**
+ * @struct SMOOTH_SIEVE
+ * @brief The primes and roots of a logarithmic sieve, shared by its threads.
+ */
+typedef struct
+{
+    uint64_t start;               ///< First position
+    uint64_t len;                 ///< Number of positions
+    uint8_t threshold;            ///< Reporting threshold of the accumulated logs
+    uint8_t base;                 ///< Initial value: the logs of the primes dividing every f(i)
+    ROOT_PRIME_TABLE *root_table; ///< Primes up to B, with vx = IZ_SMOOTH_BLOCK
+    uint8_t *logp;                ///< Rounded log2 p, 0 for the primes not sieved
+    uint32_t *roots;              ///< Two roots of f mod p per prime, equal for a single root
+} SMOOTH_SIEVE;
+
+/**
+ * @struct SMOOTH_WORKER
+ * @brief One chunk of blocks of a logarithmic sieve, the positions it found and the thread sieving it.
+ */
+typedef struct
+{
+    const SMOOTH_SIEVE *sieve;
+    uint64_t first;      ///< First position of the chunk, relative to start
+    uint64_t last;       ///< Last position of the chunk, relative to start
+    uint64_t *positions; ///< Positions found
+    size_t count;        ///< Number of positions found
+    size_t capacity;     ///< Capacity of positions
+    int status;          ///< 1 on success, 0 if memory allocation failed
+    pthread_t thread;
+} SMOOTH_WORKER;
+
+/**
+ * @brief c mod p for a signed c.
+ */
+static inline uint64_t smooth_mod(int64_t c, uint64_t p)
+{
+    int64_t r = c % (int64_t)p;
+    return r < 0 ? (uint64_t)(r + (int64_t)p) : (uint64_t)r;
+}
+
+/**
+ * @brief b^e mod p, for p below 2^32.
+ */
+static uint64_t smooth_pow_mod(uint64_t b, uint64_t e, uint64_t p)
+{
+    uint64_t r = 1;
+    for (b %= p; e; e >>= 1, b = b * b % p)
+        if (e & 1)
+            r = r * b % p;
+    return r;
+}
+
+/**
+ * @brief Square root of a quadratic residue a mod an odd prime p, by Tonelli-Shanks.
+ */
+static uint64_t smooth_sqrt_mod(uint64_t a, uint64_t p)
+{
+    if (a == 0)
+        return 0;
+
+    // p - 1 = q 2^s with q odd
+    uint64_t q = p - 1;
+    int s = __builtin_ctzll(q);
+    q >>= s;
+
+    // a quadratic non-residue z
+    uint64_t z = 2;
+    while (smooth_pow_mod(z, (p - 1) / 2, p) != p - 1)
+        z++;
+
+    uint64_t c = smooth_pow_mod(z, q, p);
+    uint64_t r = smooth_pow_mod(a, (q + 1) / 2, p);
+    uint64_t t = smooth_pow_mod(a, q, p);
+
+    while (t != 1)
+    {
+        // least i with t^(2^i) = 1
+        int i = 0;
+        for (uint64_t t2 = t; t2 != 1; t2 = t2 * t2 % p)
+            i++;
+
+        uint64_t b = c;
+        for (int k = 0; k < s - i - 1; k++)
+            b = b * b % p;
+
+        r = r * b % p;
+        c = b * b % p;
+        t = t * c % p;
+        s = i;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Finds the roots of f mod p.
+ *
+ * @param form The form.
+ * @param p A prime below 2^31.
+ * @param roots Receives up to two roots, in [0, p).
+ * @return int The number of roots (0, 1 or 2), or -1 if p divides every coefficient.
+ */
+static int smooth_roots(const IZ_SMOOTH_FORM *form, uint64_t p, uint32_t *roots)
+{
+    uint64_t c0 = smooth_mod(form->c0, p), c1 = smooth_mod(form->c1, p), c2 = smooth_mod(form->c2, p);
+
+    if (c0 == 0 && c1 == 0 && c2 == 0)
+        return -1;
+
+    // 1. Linear mod p: r = -c0 c1^-1
+    if (c2 == 0)
+    {
+        if (c1 == 0)
+            return 0;
+
+        roots[0] = (uint32_t)((p - c0) % p * modular_inverse((int)c1, (int)p) % p);
+        return 1;
+    }
+
+    // 2. p = 2: both residues checked
+    if (p == 2)
+    {
+        int count = 0;
+        for (uint64_t r = 0; r < 2; r++)
+            if ((c2 * r * r + c1 * r + c0) % 2 == 0)
+                roots[count++] = (uint32_t)r;
+        return count;
+    }
+
+    // 3. Quadratic mod an odd p: r = (-c1 ± sqrt(c1^2 - 4 c2 c0)) (2 c2)^-1
+    uint64_t disc = (c1 * c1 % p + p - 4 * c2 % p * c0 % p) % p;
+    if (disc != 0 && smooth_pow_mod(disc, (p - 1) / 2, p) != 1)
+        return 0;
+
+    uint64_t s = smooth_sqrt_mod(disc, p);
+    uint64_t inv = (uint64_t)modular_inverse((int)(2 * c2 % p), (int)p);
+    roots[0] = (uint32_t)((p - c1 + s) % p * inv % p);
+    roots[1] = (uint32_t)((2 * p - c1 - s) % p * inv % p);
+    return disc == 0 ? 1 : 2;
+}
+
+/**
+ * @brief Appends a position to the positions of a worker, growing them as needed.
+ */
+static int smooth_append(SMOOTH_WORKER *worker, uint64_t position)
+{
+    if (worker->count == worker->capacity)
+    {
+        size_t capacity = worker->capacity ? 2 * worker->capacity : 1024;
+        uint64_t *positions = realloc(worker->positions, capacity * sizeof(uint64_t));
+        if (positions == NULL)
+            return 0;
+
+        worker->positions = positions;
+        worker->capacity = capacity;
+    }
+
+    worker->positions[worker->count++] = position;
+    return 1;
+}
+
+/**
+ * @brief Sieves the positions [first, last] of one chunk, block by block.
+ *
+ * @param arg The SMOOTH_WORKER.
+ * @return void* NULL.
+ */
+static void *smooth_worker(void *arg)
+{
+    SMOOTH_WORKER *worker = arg;
+    const SMOOTH_SIEVE *sieve = worker->sieve;
+    const ROOT_PRIME_TABLE *table = sieve->root_table;
+    const CPU_KERNELS *kernels = cpu_kernels();
+
+    uint8_t *acc = malloc(IZ_SMOOTH_BLOCK);
+    uint32_t *offsets = malloc(2 * (size_t)table->p_count * sizeof(uint32_t));
+    worker->status = acc != NULL && offsets != NULL;
+
+    // offsets of the roots from the first position of the chunk: (r - i) mod p
+    uint64_t chunk_start = sieve->start + worker->first;
+    for (int k = 0; k < table->p_count && worker->status; k++)
+    {
+        uint64_t p = table->p[k];
+        uint64_t i_mod_p = fast_mod(chunk_start, p, table->p_inv[k]);
+        for (int j = 0; j < 2; j++)
+        {
+            uint64_t r = sieve->roots[2 * k + j];
+            offsets[2 * k + j] = (uint32_t)(r >= i_mod_p ? r - i_mod_p : r + p - i_mod_p);
+        }
+    }
+
+    for (uint64_t block = worker->first; worker->status; block += IZ_SMOOTH_BLOCK)
+    {
+        size_t len = (size_t)MIN((uint64_t)IZ_SMOOTH_BLOCK - 1, worker->last - block) + 1;
+        memset(acc, sieve->base, len);
+
+        // 1. Every prime adds its log at the positions of its roots
+        for (int k = 0; k < table->p_count; k++)
+        {
+            uint8_t logp = sieve->logp[k];
+            if (logp == 0)
+                continue;
+
+            uint32_t p = table->p[k];
+            uint32_t vx_mod_p = table->vx_mod_p[k];
+            uint32_t *o = offsets + 2 * k;
+
+            for (size_t x = o[0]; x < len; x += p)
+                acc[x] += logp;
+            if (o[1] != o[0])
+                for (size_t x = o[1]; x < len; x += p)
+                    acc[x] += logp;
+
+            // step the offsets to the next block: (o - IZ_SMOOTH_BLOCK) mod p
+            o[0] = o[0] >= vx_mod_p ? o[0] - vx_mod_p : o[0] + p - vx_mod_p;
+            o[1] = o[1] >= vx_mod_p ? o[1] - vx_mod_p : o[1] + p - vx_mod_p;
+        }
+
+        // 2. Positions whose logs reach the threshold
+        for (size_t x = kernels->scan_ge(acc, len, 0, sieve->threshold); x < len && worker->status;
+             x = kernels->scan_ge(acc, len, x + 1, sieve->threshold))
+            worker->status = smooth_append(worker, sieve->start + block + x);
+
+        if (block + len - 1 == worker->last)
+            break;
+    }
+
+    free(acc);
+    free(offsets);
+    return NULL;
+}
+
+int sieve_smooth(const IZ_SMOOTH_FORM *form, uint64_t start, uint64_t len, uint64_t B, uint8_t threshold,
+                 int threads, uint64_t **positions, size_t *count)
+{
+    if (form == NULL || positions == NULL || count == NULL || len == 0 || start + (len - 1) < start ||
+        B < 2 || B > IZ_SMOOTH_MAX_B || threads < 0)
+    {
+        log_error("Invalid form, interval, bound or threads in sieve_smooth.");
+        return 0;
+    }
+
+    *positions = NULL;
+    *count = 0;
+
+    // 1. Primes up to B, their logs and the roots of f mod p
+    SMOOTH_SIEVE sieve = {start, len, threshold, 0, NULL, NULL, NULL};
+    PRIMES_OBJ *primes = iz_sieve_auto(MAX(B, 10), IZ_SIEVE_SEQUENTIAL);
+    int p_count = 0;
+    if (primes != NULL)
+    {
+        while (p_count < primes->p_count && primes->p_array[p_count] <= B)
+            p_count++;
+
+        sieve.root_table = root_table_init(primes, p_count, IZ_SMOOTH_BLOCK);
+        sieve.logp = calloc(p_count, 1);
+        sieve.roots = calloc(2 * (size_t)p_count, sizeof(uint32_t));
+    }
+
+    int status = primes != NULL && sieve.root_table != NULL && sieve.logp != NULL && sieve.roots != NULL;
+
+    for (int k = 0; status && k < p_count; k++)
+    {
+        uint64_t p = primes->p_array[k];
+        uint8_t logp = (uint8_t)lround(log2((double)p));
+        int roots = smooth_roots(form, p, sieve.roots + 2 * k);
+
+        if (roots < 0)
+            sieve.base += logp; // p divides every f(i)
+        else if (roots > 0)
+        {
+            sieve.logp[k] = logp;
+            if (roots == 1)
+                sieve.roots[2 * k + 1] = sieve.roots[2 * k];
+        }
+    }
+
+    // 2. One contiguous chunk of blocks per thread
+    SMOOTH_WORKER *workers = NULL;
+    if (status)
+    {
+        uint64_t blocks = (len - 1) / IZ_SMOOTH_BLOCK + 1;
+        if (threads == 0)
+            threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (int)MIN((uint64_t)MAX(threads, 1), blocks);
+
+        workers = calloc(threads, sizeof(SMOOTH_WORKER));
+        status = workers != NULL;
+
+        for (int t = 0; t < threads && status; t++)
+        {
+            workers[t].sieve = &sieve;
+            uint64_t end_block = blocks * (t + 1) / threads;
+            workers[t].first = blocks * t / threads * IZ_SMOOTH_BLOCK;
+            workers[t].last = end_block == blocks ? len - 1 : end_block * IZ_SMOOTH_BLOCK - 1;
+        }
+
+        // the calling thread sieves the first chunk
+        int started = 1;
+        for (; status && started < threads; started++)
+            if (pthread_create(&workers[started].thread, NULL, smooth_worker, &workers[started]) != 0)
+                break;
+
+        if (status)
+        {
+            smooth_worker(&workers[0]);
+
+            // chunks whose thread couldn't start are sieved here
+            for (int t = started; t < threads; t++)
+                smooth_worker(&workers[t]);
+            for (int t = 1; t < started; t++)
+                pthread_join(workers[t].thread, NULL);
+
+            size_t total = 0;
+            for (int t = 0; t < threads; t++)
+            {
+                status &= workers[t].status;
+                total += workers[t].count;
+            }
+
+            // 3. The positions of the chunks, in order
+            if (status)
+            {
+                *positions = malloc(MAX(total, 1) * sizeof(uint64_t));
+                status = *positions != NULL;
+            }
+            for (int t = 0; t < threads && status; t++)
+            {
+                // a chunk without positions has no array to copy from
+                if (workers[t].count == 0)
+                    continue;
+
+                memcpy(*positions + *count, workers[t].positions, workers[t].count * sizeof(uint64_t));
+                *count += workers[t].count;
+            }
+        }
+
+        for (int t = 0; workers != NULL && t < threads; t++)
+            free(workers[t].positions);
+    }
+
+    if (!status)
+    {
+        log_error("Memory allocation failed in sieve_smooth.");
+        free(*positions);
+        *positions = NULL;
+        *count = 0;
+    }
+
+    free(workers);
+    free(sieve.logp);
+    free(sieve.roots);
+    root_table_free(sieve.root_table);
+    primes_obj_free(primes);
+    return status;
+}
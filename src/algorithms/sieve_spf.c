@@ -0,0 +1,225 @@
+/**
+ * @file sieve_spf.c
+ * @brief Linear sieve building a smallest-prime-factor table of the numbers 6x ± 1.
+ *
+ * @description:
+ * Only the numbers coprime to 6 get an entry (a third of all numbers), in the
+ * interleaved iZ layout of SPF_TABLE: iZ-(x) = 6x - 1 at entry 2x - 1 and
+ * iZ+(x) = 6x + 1 at entry 2x, so the entry of m is m / 3. Factors of 2 and 3 are
+ * stripped directly by factorize_u64_small, and every other factor is read
+ * from the table, one lookup and one division per factor.
+ *
+ * The table is filled like the linear sieve of Euler: each composite m is written
+ * once, by its smallest prime p, from its cofactor i = m / p, for the primes p not
+ * above the smallest prime factor of i. The numbers coprime to 6 are closed under
+ * this, as both p and i are coprime to 6. The bound is split in segments of
+ * SIEVE_SPF_SEGMENT_ENTRIES entries, sized for the L2 cache:
+ * - the first segment runs the classic linear sieve, walking i in increasing order,
+ * - a later segment [lo, hi], with hi < 2 lo, takes each root prime p and walks
+ *   the cofactors i in [lo / p, hi / p], all below lo and thus final: reads stream
+ *   through the table below the segment and writes stay in the segment.
+ *
+ * @usage:
+ * SPF_TABLE *spf = sieve_spf(1000000000);
+ * uint64_t factors[SPF_MAX_FACTORS];
+ * int count = factorize_u64_small(spf, 999999999, factors); // 3, 3, 3, 3, 37, 333667
+ * spf_table_free(spf);
+ */
+
+#include <iZ.h>
+
+/**
+ * @brief Entry of a number coprime to 6 in an SPF_TABLE.
+ */
+static inline uint64_t spf_index(uint64_t m)
+{
+    return m / 3;
+}
+
+/**
+ * @brief Number coprime to 6 held by an entry of an SPF_TABLE, the inverse of spf_index.
+ */
+static inline uint64_t spf_value(uint64_t i)
+{
+    return 3 * i + 1 + (i & 1);
+}
+
+/**
+ * @brief Fills the entries of [1, end] with the classic linear sieve.
+ *
+ * @param table The table, zeroed.
+ * @param root_primes The primes up to at least sqrt(end).
+ * @param end The last value of the segment.
+ */
+static void spf_sieve_first(SPF_TABLE *table, const PRIMES_OBJ *root_primes, uint64_t end)
+{
+    uint16_t *spf = table->spf;
+    uint64_t last_i = spf_index(end / 5); // cofactors up to end / 5 have a multiple in range
+
+    for (uint64_t i = 1; i <= last_i; i++)
+    {
+        uint64_t m = spf_value(i);
+        uint64_t m_spf = spf[i] ? spf[i] : m; // 0 marks a prime
+
+        // primes from 5 up to the smallest prime factor of m
+        for (int k = 2; k < root_primes->p_count; k++)
+        {
+            uint64_t p = root_primes->p_array[k];
+            if (p > m_spf || p * m > end)
+                break;
+
+            spf[spf_index(p * m)] = (uint16_t)p;
+        }
+    }
+}
+
+/**
+ * @brief Fills the entries of [lo, hi] from the final entries below lo.
+ *
+ * @param table The table, final below lo.
+ * @param root_primes The primes up to at least sqrt(hi).
+ * @param lo The first value of the segment.
+ * @param hi The last value of the segment, below 2 lo so that every cofactor is below lo.
+ */
+static void spf_sieve_segment(SPF_TABLE *table, const PRIMES_OBJ *root_primes, uint64_t lo, uint64_t hi)
+{
+    uint16_t *spf = table->spf;
+
+    for (int k = 2; k < root_primes->p_count; k++)
+    {
+        uint64_t p = root_primes->p_array[k];
+        if (p * p > hi)
+            break;
+
+        // cofactors i >= p of the multiples of p in [lo, hi]
+        uint64_t i_first = MAX(p, (lo + p - 1) / p);
+        uint64_t i_last = hi / p;
+
+        uint64_t i = spf_index(i_first);
+        if (spf_value(i) < i_first)
+            i++;
+
+        for (uint64_t m = p * spf_value(i); m <= p * i_last; m = p * spf_value(i))
+        {
+            // p is the smallest factor of p * i unless i has a smaller one
+            uint64_t i_spf = spf[i];
+            if (i_spf == 0 || i_spf >= p)
+                spf[spf_index(m)] = (uint16_t)p;
+            i++;
+        }
+    }
+}
+
+SPF_TABLE *sieve_spf(uint64_t n)
+{
+    if (n < 1 || n > SPF_MAX_N)
+    {
+        log_message(LOG_ERROR, "sieve_spf: n = %llu out of range [1, %llu]",
+                    (unsigned long long)n, (unsigned long long)SPF_MAX_N);
+        return NULL;
+    }
+
+    SPF_TABLE *table = malloc(sizeof(SPF_TABLE));
+    PRIMES_OBJ *root_primes = sieve_eratosthenes(MAX((uint64_t)sqrt(n) + 1, 10));
+    if (table != NULL)
+    {
+        table->n = n;
+        table->size = (n / 6) * 2 + (n % 6 >= 1) + (n % 6 >= 5);
+        table->spf = mem_alloc(table->size * sizeof(uint16_t), 1);
+    }
+
+    if (table == NULL || table->spf == NULL || root_primes == NULL)
+    {
+        log_error("Memory allocation failed in sieve_spf.");
+        spf_table_free(table);
+        primes_obj_free(root_primes);
+        return NULL;
+    }
+
+    // 1. First segment, by the classic linear sieve
+    uint64_t segment_values = 3 * (uint64_t)SIEVE_SPF_SEGMENT_ENTRIES;
+    uint64_t end = MIN(n, segment_values);
+    spf_sieve_first(table, root_primes, end);
+
+    // 2. Following segments, each shorter than its start
+    for (uint64_t lo = end + 1; lo <= n; lo += segment_values)
+        spf_sieve_segment(table, root_primes, lo, MIN(n, lo + segment_values - 1));
+
+    primes_obj_free(root_primes);
+    return table;
+}
+
+void spf_table_free(SPF_TABLE *table)
+{
+    if (table == NULL)
+        return;
+
+    mem_free(table->spf);
+    free(table);
+}
+
+int factorize_u64_small(const SPF_TABLE *table, uint64_t n, uint64_t *factors)
+{
+    if (table == NULL || n == 0 || n > table->n)
+        return -1;
+
+    int count = 0;
+
+    // Factors 2 and 3, which have no entries
+    int twos = __builtin_ctzll(n);
+    n >>= twos;
+    while (count < twos)
+        factors[count++] = 2;
+
+    while (n % 3 == 0)
+    {
+        factors[count++] = 3;
+        n /= 3;
+    }
+
+    // The rest, coprime to 6, by the table
+    while (n > 1)
+    {
+        uint64_t p = table->spf[spf_index(n)];
+        if (p == 0)
+            p = n; // n is prime
+
+        factors[count++] = p;
+        n /= p;
+    }
+
+    return count;
+}
+
+PRIMES_OBJ *sieve_linear(uint64_t n)
+{
+    // Check if n is less than 10 or above the table range, return NULL
+    if (n < 10 || n > SPF_MAX_N)
+        return NULL;
+
+    SPF_TABLE *table = sieve_spf(n);
+    if (table == NULL)
+        return NULL;
+
+    PRIMES_OBJ *primes = primes_obj_init(pi_n(n) * 1.5);
+    if (primes == NULL)
+    {
+        spf_table_free(table);
+        return NULL;
+    }
+
+    primes_obj_append(primes, 2);
+    primes_obj_append(primes, 3);
+
+    // Entries without a factor, skipping entry 0 (the number 1)
+    for (uint64_t i = 1; i < table->size; i++)
+        if (table->spf[i] == 0)
+            primes_obj_append(primes, spf_value(i));
+
+    spf_table_free(table);
+
+    // Resize primes array to fit the exact number of primes found
+    primes_obj_resize_to_p_count(primes);
+
+    return primes;
+}
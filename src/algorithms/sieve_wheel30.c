@@ -0,0 +1,704 @@
+/**
+ * @file sieve_wheel30.c
+ * @brief Segmented sieve on the mod 30 wheel, with 8 numbers per byte.
+ *
+ * @description:
+ * Of every 30 consecutive numbers, only the 8 residues coprime to 30
+ * (1, 7, 11, 13, 17, 19, 23, 29) can be primes above 5. This engine stores them
+ * in one byte: byte i, bit k stands for 30i + W30_RESIDUES[k]. A byte covers 30
+ * numbers, against 24 for a byte of the split iZ x5/x7 bitmaps (2 bits per 6).
+ *
+ * The range is sieved in segments of w30_segment_bytes (tuning.h, SIEVE_W30_SEGMENT_BYTES
+ * by default), sized for the L2 cache:
+ * - each segment starts as a copy of a 7 * 11 * 13 byte pattern, pre-sieved for 7, 11 and 13,
+ * - every other root prime p clears its multiples p * q, q coprime to 30, from p^2,
+ *   stepping with a precomputed mark table indexed by (p mod 30, q mod 30). Eight
+ *   consecutive steps advance exactly p bytes, so whole wheel cycles are unrolled
+ *   with fixed offsets and masks,
+ * - the surviving bits are delivered to a sink: appended to a PRIMES_OBJ, counted
+ *   with the popcount kernel, or passed one by one to a callback.
+ *
+ * Any byte range can be sieved on its own, each root prime starting its walk at
+ * its first multiple in the range, so sieve_wheel30_list and sieve_wheel30_count
+ * split [0, n] into segment-aligned chunks, one per thread, and join the results.
+ *
+ * @usage:
+ * PRIMES_OBJ *primes = sieve_wheel30(1000000);
+ * primes_obj_free(primes);
+ *
+ * uint64_t pi = sieve_wheel30_count(10000000000, 0, 0); // default segments, one thread per CPU
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For the threads of sieve_wheel30_list and sieve_wheel30_count
+#include <unistd.h>  // For sysconf
+#include <limits.h>  // For INT_MAX
+
+#define W30_PATTERN_BYTES (7 * 11 * 13) ///< Period of the pre-sieved pattern, in bytes
+
+static const uint8_t W30_RESIDUES[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+// the primes below 10, for which sieve_eratosthenes returns no list
+static const uint8_t W30_SMALL_PRIMES[4] = {2, 3, 5, 7};
+
+// distance from each residue to the next one, 29 -> 31 wrapping to residue 1
+static const uint8_t W30_GAPS[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+
+// residue index of each r mod 30 coprime to 30, and of the first such residue >= r otherwise
+static const uint8_t W30_CEIL_INDEX[30] = {0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4,
+                                           4, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7};
+
+/**
+ * @struct W30_STEP
+ * @brief One step of a prime through its multiples p * q, for given p mod 30 and q mod 30.
+ *
+ * Writing p = 30a + r, the multiple p * q sits in bit `mask` of its byte, and
+ * the next multiple p * (q + gap) is a * gap + carry bytes further.
+ */
+typedef struct
+{
+    uint8_t mask;  ///< Byte mask that clears the multiple
+    uint8_t gap;   ///< Distance from q to the next q coprime to 30
+    uint8_t carry; ///< floor((p * q mod 30 + r * gap) / 30)
+    uint8_t next;  ///< Residue index of the next q
+} W30_STEP;
+
+/**
+ * @struct W30_PRIME
+ * @brief The position of a root prime in its walk through the segments.
+ */
+typedef struct
+{
+    uint64_t next_byte; ///< Absolute byte of the next multiple to clear
+    uint32_t a;         ///< p / 30
+    uint8_t r_idx;      ///< Residue index of p mod 30
+    uint8_t q_idx;      ///< Residue index of the current q mod 30
+} W30_PRIME;
+
+/**
+ * @brief Builds the mark table of every (p mod 30, q mod 30) pair.
+ *
+ * @param steps The table to fill, indexed by residue indices.
+ */
+static void w30_init_steps(W30_STEP steps[8][8])
+{
+    int residue_index[30];
+    for (int i = 0; i < 30; i++)
+        residue_index[i] = -1;
+    for (int k = 0; k < 8; k++)
+        residue_index[W30_RESIDUES[k]] = k;
+
+    for (int r = 0; r < 8; r++)
+    {
+        for (int q = 0; q < 8; q++)
+        {
+            int c = (W30_RESIDUES[r] * W30_RESIDUES[q]) % 30;
+            steps[r][q].mask = (uint8_t)~(1u << residue_index[c]);
+            steps[r][q].gap = W30_GAPS[q];
+            steps[r][q].carry = (c + W30_RESIDUES[r] * W30_GAPS[q]) / 30;
+            steps[r][q].next = (q + 1) & 7;
+        }
+    }
+}
+
+/**
+ * @brief Builds the byte pattern of the wheel with the multiples of 7, 11 and 13 cleared.
+ *
+ * @param pattern The W30_PATTERN_BYTES bytes to fill.
+ */
+static void w30_init_pattern(uint8_t *pattern)
+{
+    for (int i = 0; i < W30_PATTERN_BYTES; i++)
+    {
+        uint8_t byte = 0xFF;
+        for (int k = 0; k < 8; k++)
+        {
+            int v = 30 * i + W30_RESIDUES[k];
+            if (v % 7 == 0 || v % 11 == 0 || v % 13 == 0)
+                byte &= ~(1u << k);
+        }
+        pattern[i] = byte;
+    }
+}
+
+/**
+ * @brief Fills a segment from the pre-sieved pattern, at its phase in the period.
+ *
+ * @param segment The segment to fill.
+ * @param length The length of the segment in bytes.
+ * @param start The absolute byte of the segment start.
+ * @param pattern The pre-sieved pattern.
+ */
+static void w30_fill_segment(uint8_t *segment, size_t length, uint64_t start, const uint8_t *pattern)
+{
+    size_t phase = start % W30_PATTERN_BYTES;
+    size_t filled = 0;
+    while (filled < length)
+    {
+        size_t chunk = MIN(length - filled, (size_t)(W30_PATTERN_BYTES - phase));
+        memcpy(segment + filled, pattern + phase, chunk);
+        filled += chunk;
+        phase = 0;
+    }
+}
+
+/**
+ * @struct W30_SIEVE
+ * @brief The read-only state shared by every range of a sieve up to n.
+ */
+typedef struct
+{
+    uint64_t n;                         ///< Upper limit of the sieve
+    W30_STEP steps[8][8];               ///< Mark table, see W30_STEP
+    uint8_t pattern[W30_PATTERN_BYTES]; ///< Bytes pre-sieved for 7, 11 and 13
+    PRIMES_OBJ *root_primes;            ///< Primes up to sqrt(n) + 1
+    int root_first;                     ///< Index of the first root prime >= 17
+    int root_end;                       ///< Index past the last root prime p with p * p <= n
+} W30_SIEVE;
+
+/**
+ * @struct W30_SINK
+ * @brief Where the primes of a range go: a list, a count, or a callback.
+ */
+typedef struct
+{
+    PRIMES_OBJ *primes;         ///< List mode: the primes of the range, or NULL
+    size_t capacity;            ///< List mode: capacity of primes->p_array
+    uint64_t count;             ///< Number of primes delivered
+    IZ_PRIME_CALLBACK callback; ///< Stream mode: called with each prime, or NULL
+    void *ctx;                  ///< Stream mode: passed to the callback
+    int stopped;                ///< Set when the callback asks to stop
+} W30_SINK;
+
+/**
+ * @brief Sieves the root primes and builds the tables of a sieve up to n >= 1000.
+ *
+ * @param sieve The state to fill.
+ * @param n The upper limit.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int w30_sieve_init(W30_SIEVE *sieve, uint64_t n)
+{
+    sieve->n = n;
+    sieve->root_primes = sieve_eratosthenes((uint64_t)sqrt(n) + 1);
+    if (sieve->root_primes == NULL)
+        return 0;
+
+    w30_init_steps(sieve->steps);
+    w30_init_pattern(sieve->pattern);
+
+    // skip 2, 3, 5 (the wheel) and 7, 11, 13 (the pattern)
+    const uint64_t *roots = sieve->root_primes->p_array;
+    int first = 0, end = sieve->root_primes->p_count;
+    while (first < end && roots[first] < 17)
+        first++;
+    while (end > first && roots[end - 1] * roots[end - 1] > n)
+        end--;
+
+    sieve->root_first = first;
+    sieve->root_end = end;
+    return 1;
+}
+
+/**
+ * @brief Places every root prime at its first multiple p * q >= max(p^2, 30 * first_byte), q coprime to 30.
+ *
+ * @param walks The walks to fill, one per root prime.
+ * @param sieve The sieve state.
+ * @param first_byte The first byte of the range.
+ * @return int The number of walks.
+ */
+static int w30_init_walks(W30_PRIME *walks, const W30_SIEVE *sieve, uint64_t first_byte)
+{
+    int walk_count = 0;
+    uint64_t first_value = 30 * first_byte;
+
+    for (int i = sieve->root_first; i < sieve->root_end; i++)
+    {
+        uint64_t p = sieve->root_primes->p_array[i];
+
+        // smallest q >= p with p * q >= first_value, rounded up to a residue
+        uint64_t q = MAX(p, (first_value + p - 1) / p);
+        int q_idx = W30_CEIL_INDEX[q % 30];
+        q += W30_RESIDUES[q_idx] - q % 30;
+
+        walks[walk_count].next_byte = p * q / 30;
+        walks[walk_count].a = p / 30;
+        walks[walk_count].r_idx = W30_CEIL_INDEX[p % 30];
+        walks[walk_count].q_idx = q_idx;
+        walk_count++;
+    }
+
+    return walk_count;
+}
+
+/**
+ * @brief Clears the multiples of the root primes in one segment.
+ *
+ * @param segment The segment, filled from the pattern.
+ * @param start The absolute byte of the segment start.
+ * @param length The length of the segment in bytes.
+ * @param walks The walks of the root primes, advanced past the segment.
+ * @param walk_count The number of walks.
+ * @param steps The mark table.
+ */
+static void w30_mark_segment(uint8_t *segment, uint64_t start, size_t length,
+                             W30_PRIME *walks, int walk_count, const W30_STEP steps[8][8])
+{
+    for (int i = 0; i < walk_count; i++)
+    {
+        W30_PRIME *walk = &walks[i];
+        if (walk->next_byte >= start + length)
+            continue;
+
+        const W30_STEP *row = steps[walk->r_idx];
+        uint64_t a = walk->a;
+        uint64_t byte = walk->next_byte - start;
+        int q_idx = walk->q_idx;
+
+        // Whole wheel cycles: 8 multiples, p bytes, at fixed offsets from the cycle start
+        uint64_t p = 30 * a + W30_RESIDUES[walk->r_idx];
+        if (byte + p < length)
+        {
+            uint8_t masks[8];
+            uint64_t offsets[8];
+            uint64_t offset = 0;
+            for (int k = 0; k < 8; k++)
+            {
+                const W30_STEP *step = &row[(q_idx + k) & 7];
+                masks[k] = step->mask;
+                offsets[k] = offset;
+                offset += a * step->gap + step->carry;
+            }
+
+            for (; byte + offsets[7] < length; byte += p)
+            {
+                uint8_t *cycle = segment + byte;
+                cycle[offsets[0]] &= masks[0];
+                cycle[offsets[1]] &= masks[1];
+                cycle[offsets[2]] &= masks[2];
+                cycle[offsets[3]] &= masks[3];
+                cycle[offsets[4]] &= masks[4];
+                cycle[offsets[5]] &= masks[5];
+                cycle[offsets[6]] &= masks[6];
+                cycle[offsets[7]] &= masks[7];
+            }
+        }
+
+        while (byte < length)
+        {
+            const W30_STEP *step = &row[q_idx];
+            segment[byte] &= step->mask;
+            byte += a * step->gap + step->carry;
+            q_idx = step->next;
+        }
+
+        walk->next_byte = start + byte;
+        walk->q_idx = q_idx;
+    }
+}
+
+/**
+ * @brief Delivers one prime to a sink.
+ *
+ * @return int 1 to go on, 0 if the sink stopped.
+ */
+static inline int w30_sink_put(W30_SINK *sink, uint64_t p)
+{
+    sink->count++;
+    if (sink->primes != NULL)
+        sink->primes->p_array[sink->primes->p_count++] = p;
+    else if (sink->callback != NULL && sink->callback(p, sink->ctx) != 0)
+        sink->stopped = 1;
+
+    return !sink->stopped;
+}
+
+/**
+ * @brief Delivers the primes of a sieved segment to a sink.
+ *
+ * @param sink The sink.
+ * @param segment The sieved segment, with the bits above n cleared.
+ * @param start The absolute byte of the segment start.
+ * @param length The length of the segment in bytes.
+ * @return int 1 on success, 0 if the list can't grow.
+ */
+static int w30_sink_segment(W30_SINK *sink, const uint8_t *segment, uint64_t start, size_t length)
+{
+    // count only: one popcount over the segment
+    if (sink->primes == NULL && sink->callback == NULL)
+    {
+        sink->count += cpu_kernels()->popcount(segment, length);
+        return 1;
+    }
+
+    if (sink->primes != NULL)
+    {
+        // grow the list to hold the primes of the segment, known from its popcount,
+        // up to the INT_MAX primes a PRIMES_OBJ can count
+        size_t needed = sink->primes->p_count + cpu_kernels()->popcount(segment, length);
+        if (needed > INT_MAX)
+            return 0;
+        if (needed > sink->capacity)
+        {
+            size_t capacity = MIN(MAX(needed, sink->capacity + sink->capacity / 4), (size_t)INT_MAX);
+            uint64_t *p_array = mem_realloc(sink->primes->p_array, capacity * sizeof(uint64_t));
+            if (p_array == NULL)
+                return 0;
+
+            sink->primes->p_array = p_array;
+            sink->capacity = capacity;
+        }
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned int bits = segment[i];
+        uint64_t base = 30 * (start + i);
+        while (bits)
+        {
+            if (!w30_sink_put(sink, base + W30_RESIDUES[__builtin_ctz(bits)]))
+                return 1;
+            bits &= bits - 1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Sieves the bytes [first_byte, end_byte) of a sieve up to n into a sink.
+ *
+ * @description:
+ * The range is processed in segments of segment_bytes, the last byte of the sieve
+ * (byte n / 30) masked to the residues <= n mod 30. The range holding byte 0 also
+ * delivers 2, 3 and 5 first.
+ *
+ * @param sieve The sieve state.
+ * @param first_byte The first byte of the range.
+ * @param end_byte The byte past the range, at most n / 30 + 1.
+ * @param segment_bytes The segment size in bytes.
+ * @param sink The sink.
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+static int w30_sieve_range(const W30_SIEVE *sieve, uint64_t first_byte, uint64_t end_byte,
+                           size_t segment_bytes, W30_SINK *sink)
+{
+    W30_PRIME *walks = malloc(MAX(sieve->root_end - sieve->root_first, 1) * sizeof(W30_PRIME));
+    uint8_t *segment = malloc(segment_bytes);
+    if (walks == NULL || segment == NULL)
+    {
+        free(walks);
+        free(segment);
+        return 0;
+    }
+
+    int walk_count = w30_init_walks(walks, sieve, first_byte);
+    uint64_t last_byte = sieve->n / 30;
+
+    // residues of the last byte that are <= n
+    uint8_t last_mask = 0;
+    for (int k = 0; k < 8; k++)
+        if (W30_RESIDUES[k] <= sieve->n % 30)
+            last_mask |= 1u << k;
+
+    int status = 1;
+    if (first_byte == 0)
+        status = w30_sink_put(sink, 2) && w30_sink_put(sink, 3) && w30_sink_put(sink, 5);
+
+    for (uint64_t start = first_byte; status && start < end_byte; start += segment_bytes)
+    {
+        size_t length = MIN((uint64_t)segment_bytes, end_byte - start);
+        w30_fill_segment(segment, length, start, sieve->pattern);
+
+        // 1 is not prime, 7, 11 and 13 were cleared by their own pattern
+        if (start == 0)
+            segment[0] = (segment[0] & 0xFE) | 0x0E;
+
+        w30_mark_segment(segment, start, length, walks, walk_count, sieve->steps);
+
+        if (start + length > last_byte)
+            segment[last_byte - start] &= last_mask;
+
+        if (!w30_sink_segment(sink, segment, start, length))
+        {
+            log_error("Memory allocation failed in sieve_wheel30.");
+            free(walks);
+            free(segment);
+            return 0;
+        }
+
+        status = !sink->stopped;
+    }
+
+    free(walks);
+    free(segment);
+    return 1;
+}
+
+/**
+ * @brief Estimates the number of primes in [30 * first_byte, 30 * end_byte), from above.
+ *
+ * @description:
+ * Uses pi(x) < x / (ln x - 1.1) for the end and pi(x) > x / ln x for the start,
+ * both valid from x = 60184 on, with some slack for small ranges.
+ */
+static size_t w30_estimate_count(uint64_t first_byte, uint64_t end_byte)
+{
+    double end = MAX(30.0 * end_byte, 60184.0);
+    double upper = end / (log(end) - 1.1);
+    double lower = first_byte > 2006 ? 30.0 * first_byte / log(30.0 * first_byte) : 0;
+    return (size_t)(upper - lower) + 1024;
+}
+
+/**
+ * @struct W30_WORKER
+ * @brief One chunk of a parallel wheel-30 sieve, and the thread sieving it.
+ */
+typedef struct
+{
+    const W30_SIEVE *sieve;
+    uint64_t first_byte;
+    uint64_t end_byte;
+    size_t segment_bytes;
+    W30_SINK sink;
+    int status;
+    pthread_t thread;
+} W30_WORKER;
+
+/**
+ * @brief Thread body: allocates the chunk's list if needed and sieves the chunk.
+ */
+static void *w30_worker(void *arg)
+{
+    W30_WORKER *worker = arg;
+
+    if (worker->sink.capacity > 0)
+    {
+        // the capacity must be the size allocated, which the sink grows from
+        worker->sink.capacity = MIN(worker->sink.capacity, (size_t)INT_MAX);
+        worker->sink.primes = primes_obj_init((int)worker->sink.capacity);
+        if (worker->sink.primes == NULL)
+        {
+            worker->status = 0;
+            return NULL;
+        }
+    }
+
+    worker->status = w30_sieve_range(worker->sieve, worker->first_byte, worker->end_byte,
+                                     worker->segment_bytes, &worker->sink);
+    return NULL;
+}
+
+/**
+ * @brief Sieves [0, n] into lists or counts, split across threads in segment-aligned chunks.
+ *
+ * @param sieve The sieve state.
+ * @param segment_bytes The segment size in bytes.
+ * @param threads The number of threads, 0 for the tuned default.
+ * @param list Non-zero to collect the primes, zero to count them.
+ * @param primes_out List mode: receives the joined list.
+ * @return uint64_t The number of primes, 0 on failure.
+ */
+static uint64_t w30_sieve_chunks(const W30_SIEVE *sieve, size_t segment_bytes, int threads,
+                                 int list, PRIMES_OBJ **primes_out)
+{
+    uint64_t total_bytes = sieve->n / 30 + 1;
+    uint64_t segments = (total_bytes + segment_bytes - 1) / segment_bytes;
+
+    if (threads <= 0)
+        threads = iz_tuning()->threads > 0 ? iz_tuning()->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (int)MIN((uint64_t)MAX(threads, 1), segments);
+
+    W30_WORKER *workers = calloc(threads, sizeof(W30_WORKER));
+    if (workers == NULL)
+        return 0;
+
+    for (int t = 0; t < threads; t++)
+    {
+        W30_WORKER *worker = &workers[t];
+        worker->sieve = sieve;
+        worker->first_byte = segments * t / threads * segment_bytes;
+        worker->end_byte = MIN(segments * (t + 1) / threads * segment_bytes, total_bytes);
+        worker->segment_bytes = segment_bytes;
+        worker->sink.capacity = list ? w30_estimate_count(worker->first_byte, worker->end_byte) : 0;
+    }
+
+    // the calling thread sieves the first chunk
+    int started = 1;
+    for (; started < threads; started++)
+        if (pthread_create(&workers[started].thread, NULL, w30_worker, &workers[started]) != 0)
+            break;
+
+    w30_worker(&workers[0]);
+
+    // chunks whose thread couldn't start are sieved here
+    for (int t = started; t < threads; t++)
+        w30_worker(&workers[t]);
+    for (int t = 1; t < started; t++)
+        pthread_join(workers[t].thread, NULL);
+
+    int status = 1;
+    uint64_t count = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        status &= workers[t].status;
+        count += workers[t].sink.count;
+    }
+
+    // join the lists onto the first one, whose count must fit an int
+    status = status && (!list || count <= INT_MAX);
+    if (list && status)
+    {
+        PRIMES_OBJ *primes = workers[0].sink.primes;
+        uint64_t *p_array = mem_realloc(primes->p_array, MAX(count, 1) * sizeof(uint64_t));
+        if (p_array == NULL)
+            status = 0;
+        else
+        {
+            primes->p_array = p_array;
+            for (int t = 1; t < threads; t++)
+            {
+                PRIMES_OBJ *chunk = workers[t].sink.primes;
+                memcpy(p_array + primes->p_count, chunk->p_array, chunk->p_count * sizeof(uint64_t));
+                primes->p_count += chunk->p_count;
+            }
+
+            *primes_out = primes;
+            workers[0].sink.primes = NULL;
+        }
+    }
+
+    for (int t = 0; t < threads; t++)
+        primes_obj_free(workers[t].sink.primes);
+    free(workers);
+
+    if (!status)
+    {
+        log_error("Memory allocation failed in sieve_wheel30.");
+        return 0;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Segmented wheel-30 sieve to generate prime numbers up to a given limit.
+ *
+ * @description:
+ * The root primes up to sqrt(n) are sieved first. The range [0, n] is then covered by
+ * segments of w30_segment_bytes bytes (30 numbers each), which are pre-sieved
+ * from the 7 * 11 * 13 pattern, marked by the root primes from 17 on through the
+ * mark table, and scanned for primes. Each root prime keeps its next multiple and
+ * wheel position from one segment to the next.
+ *
+ * @param n The upper limit for generating prime numbers.
+ * @return
+ *      - PRIMES_OBJ* A pointer to the PRIMES_OBJ structure containing the list of primes up to n.
+ *      - NULL if memory allocation fails or if n is less than 10.
+ */
+PRIMES_OBJ *sieve_wheel30(uint64_t n)
+{
+    return sieve_wheel30_list(n, 0, 1);
+}
+
+PRIMES_OBJ *sieve_wheel30_list(uint64_t n, size_t segment_bytes, int threads)
+{
+    // Check if n is less than 1000, use the optimized sieve of Eratosthenes
+    if (n < 1000)
+        return sieve_eratosthenes(n);
+
+    W30_SIEVE *sieve = malloc(sizeof(W30_SIEVE));
+    if (sieve == NULL || !w30_sieve_init(sieve, n))
+    {
+        log_error("Memory allocation failed in sieve_wheel30.");
+        free(sieve);
+        return NULL;
+    }
+
+    PRIMES_OBJ *primes = NULL;
+    w30_sieve_chunks(sieve, segment_bytes ? segment_bytes : iz_tuning()->w30_segment_bytes, threads, 1, &primes);
+
+    primes_obj_free(sieve->root_primes);
+    free(sieve);
+
+    // Resize primes array to fit the exact number of primes found
+    if (primes != NULL)
+        primes_obj_resize_to_p_count(primes);
+
+    return primes;
+}
+
+uint64_t sieve_wheel30_count(uint64_t n, size_t segment_bytes, int threads)
+{
+    if (n < 10)
+    {
+        uint64_t count = 0;
+        while (count < 4 && W30_SMALL_PRIMES[count] <= n)
+            count++;
+        return count;
+    }
+
+    if (n < 1000)
+    {
+        PRIMES_OBJ *primes = sieve_eratosthenes(n);
+        uint64_t count = primes ? primes->p_count : 0;
+        primes_obj_free(primes);
+        return count;
+    }
+
+    W30_SIEVE *sieve = malloc(sizeof(W30_SIEVE));
+    if (sieve == NULL || !w30_sieve_init(sieve, n))
+    {
+        log_error("Memory allocation failed in sieve_wheel30_count.");
+        free(sieve);
+        return 0;
+    }
+
+    uint64_t count = w30_sieve_chunks(sieve, segment_bytes ? segment_bytes : iz_tuning()->w30_segment_bytes, threads, 0, NULL);
+
+    primes_obj_free(sieve->root_primes);
+    free(sieve);
+    return count;
+}
+
+uint64_t sieve_wheel30_stream(uint64_t n, size_t segment_bytes, IZ_PRIME_CALLBACK callback, void *ctx)
+{
+    if (callback == NULL)
+        return 0;
+
+    if (n < 10)
+    {
+        uint64_t count = 0;
+        while (count < 4 && W30_SMALL_PRIMES[count] <= n)
+            if (callback(W30_SMALL_PRIMES[count++], ctx) != 0)
+                break;
+        return count;
+    }
+
+    if (n < 1000)
+    {
+        PRIMES_OBJ *primes = sieve_eratosthenes(n);
+        uint64_t count = 0;
+        while (primes != NULL && count < (uint64_t)primes->p_count)
+            if (callback(primes->p_array[count++], ctx) != 0)
+                break;
+        primes_obj_free(primes);
+        return count;
+    }
+
+    W30_SIEVE *sieve = malloc(sizeof(W30_SIEVE));
+    if (sieve == NULL || !w30_sieve_init(sieve, n))
+    {
+        log_error("Memory allocation failed in sieve_wheel30_stream.");
+        free(sieve);
+        return 0;
+    }
+
+    W30_SINK sink = {.callback = callback, .ctx = ctx};
+    w30_sieve_range(sieve, 0, n / 30 + 1, segment_bytes ? segment_bytes : iz_tuning()->w30_segment_bytes, &sink);
+
+    primes_obj_free(sieve->root_primes);
+    free(sieve);
+    return sink.count;
+}
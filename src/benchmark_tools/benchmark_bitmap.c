@@ -0,0 +1,309 @@
+/**
+ * @file benchmark_bitmap.c
+ * @brief Microbenchmarks of the BITMAP primitives, the hot paths of the sieves.
+ *
+ * @description:
+ * Times each bitmap kernel on its own, over bitmap sizes chosen to fit the L1, L2
+ * and L3 data caches of this host and to spill to DRAM, and reports the cost per
+ * bit processed, or per mark for the clearing kernels:
+ * - bitmap_clear_mod_p over small (p < BITMAP_PATTERN_MAX_P), medium (up to 2^16)
+ *   and large (a few marks per bitmap) step sizes, and bitmap_clear_pattern over
+ *   the small ones,
+ * - extraction of the set bits by bitmap_scan_next, and bitmap_popcount,
+ * - bitmap_clone, bitmap_copy at unaligned offsets and bitmap_duplicate_segment,
+ * - bitmap_compute_hash.
+ *
+ * The scanned, copied and hashed bitmaps are sieved by the small and medium steps
+ * first, so that their density of set bits is that of a sieve segment.
+ *
+ * @usage:
+ * benchmark_bitmap_primitives(0, 1); // all levels, results saved to output/bitmap_results_<timestamp>.csv
+ */
+
+#include <benchmark.h>
+#include <unistd.h> // For sysconf
+
+#define BITMAP_BENCH_LEVELS 4            ///< L1, L2, L3 and DRAM
+#define BITMAP_BENCH_MEDIUM_MAX_P 65536  ///< Largest medium step size
+#define BITMAP_BENCH_LARGE_STEPS 1024    ///< Number of large step sizes
+#define BITMAP_BENCH_DUP_SEGMENT 5005    ///< Duplicated segment, 5 * 7 * 11 * 13 bits
+#define BITMAP_BENCH_DRAM_MIN (64 << 20) ///< Smallest DRAM-level bitmap, in bytes
+
+/**
+ * @brief Context of the timed bitmap runs: the bitmaps, the step sizes of a bucket
+ * and the buffer of the extracted indices.
+ */
+typedef struct
+{
+    BITMAP *bitmap;           ///< The bitmap cleared, scanned or hashed
+    BITMAP *dest;             ///< Destination of bitmap_copy and bitmap_duplicate_segment
+    const uint64_t *steps;    ///< Step sizes of the bucket being cleared
+    int steps_count;          ///< Number of step sizes
+    BITMAP_PATTERN *patterns; ///< Patterns of the small step sizes
+    size_t *indices;          ///< Receives the extracted indices, one per set bit
+    size_t count;             ///< Result of the last scan or popcount, kept to defeat dead-code elimination
+} BITMAP_RUN;
+
+/**
+ * @brief Clears the multiples of each step size of the bucket, from an offset below the step.
+ */
+static void clear_mod_p_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    for (int i = 0; i < b->steps_count; i++)
+        bitmap_clear_mod_p(b->bitmap, b->steps[i], b->steps[i] / 2, b->bitmap->size);
+}
+
+/**
+ * @brief Clears the multiples of each small step size by its word pattern.
+ */
+static void clear_pattern_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    for (int i = 0; i < b->steps_count; i++)
+        bitmap_clear_pattern(b->bitmap, &b->patterns[i], b->steps[i] / 2, b->bitmap->size);
+}
+
+/**
+ * @brief Extracts the indices of the set bits, as the sieves collect their primes.
+ */
+static void scan_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    size_t count = 0;
+    for (size_t idx = bitmap_scan_next(b->bitmap, 0); idx < b->bitmap->size; idx = bitmap_scan_next(b->bitmap, idx + 1))
+        b->indices[count++] = idx;
+    b->count = count;
+}
+
+/**
+ * @brief Counts the set bits.
+ */
+static void popcount_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    b->count = bitmap_popcount(b->bitmap);
+}
+
+/**
+ * @brief Clones the bitmap, allocation included, and frees the clone.
+ */
+static void clone_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    bitmap_free(bitmap_clone(b->bitmap));
+}
+
+/**
+ * @brief Copies the bitmap to another at offsets of different alignment.
+ */
+static void copy_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    bitmap_copy(b->dest, 7, b->bitmap, 3, b->bitmap->size - 8);
+}
+
+/**
+ * @brief Fills the bitmap with copies of its first BITMAP_BENCH_DUP_SEGMENT bits.
+ */
+static void duplicate_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    bitmap_duplicate_segment(b->dest, 0, BITMAP_BENCH_DUP_SEGMENT, b->dest->size / BITMAP_BENCH_DUP_SEGMENT);
+}
+
+/**
+ * @brief Computes the SHA-256 hash of the bitmap.
+ */
+static void hash_run(void *ctx, int run)
+{
+    (void)run;
+    BITMAP_RUN *b = ctx;
+    bitmap_compute_hash(b->bitmap);
+}
+
+/**
+ * @brief Returns the number of bits cleared by a run over a bucket of step sizes.
+ */
+static double bucket_marks(const uint64_t *steps, int count, size_t size)
+{
+    double marks = 0;
+    for (int i = 0; i < count; i++)
+        marks += (double)((size - 1 - steps[i] / 2) / steps[i] + 1);
+    return marks;
+}
+
+/**
+ * @brief Returns the size of a cache level from sysconf, or fallback if unknown.
+ */
+static size_t cache_size(int name, size_t fallback)
+{
+    long size = sysconf(name);
+    return size > 0 ? (size_t)size : fallback;
+}
+
+/**
+ * @brief Times one primitive, prints its cost per unit and adds it to the report.
+ *
+ * @param fn The timed run.
+ * @param b The context of the run.
+ * @param op The name of the primitive.
+ * @param level The memory level of the bitmap size.
+ * @param units The bits or marks processed by one run.
+ * @param unit The name of the unit.
+ * @param report Receives the measurement, named "<op> [<level>]" with n = units.
+ */
+static void bitmap_bench_op(bench_fn fn, BITMAP_RUN *b, const char *op, const char *level,
+                            double units, const char *unit, BENCH_REPORT *report)
+{
+    BENCH_STATS stats;
+    if (units < 1 || !bench_measure(fn, b, BENCH_WARMUP_RUNS, BENCH_RUNS, NULL, &stats))
+        return;
+
+    printf("| %-22s| %-6s| %-14.0f| %-6s| %-12.3f| %-12.3f| %-12.3f\n",
+           op, level, units, unit, stats.min * 1e9 / units, stats.median * 1e9 / units, stats.p95 * 1e9 / units);
+    fflush(stdout);
+
+    char name[BENCH_NAME_SIZE];
+    snprintf(name, sizeof(name), "%s [%s]", op, level);
+    bench_report_add(report, name, (uint64_t)units, 1, &stats, NULL);
+}
+
+/**
+ * @brief Benchmarks the bitmap primitives over bitmap sizes spanning L1, L2, L3 and DRAM.
+ *
+ * @description: The bitmap of a level takes half of its cache, so that the clone and
+ * copy destinations still fit, and the DRAM bitmap takes 4 times the L3 cache, at least
+ * 64 MB; sizes above max_bytes are skipped. The costs are printed in ns per unit, for the
+ * min, median and 95th percentile of BENCH_RUNS runs. Saved rows are named
+ * "<primitive> [<level>]", with n the units of a run, so that ns per unit is
+ * 1e9 * time / n.
+ *
+ * @param max_bytes The largest bitmap size in bytes, 0 for no limit.
+ * @param save_results If nonzero, saves the measurements to output/bitmap_results_<timestamp>.csv.
+ */
+void benchmark_bitmap_primitives(size_t max_bytes, int save_results)
+{
+    size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+    size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 1 << 20);
+    size_t l3 = cache_size(_SC_LEVEL3_CACHE_SIZE, 32 << 20);
+
+    const char *level_names[BITMAP_BENCH_LEVELS] = {"L1", "L2", "L3", "DRAM"};
+    size_t level_bytes[BITMAP_BENCH_LEVELS] = {l1 / 2, l2 / 2, l3 / 2, MAX(4 * l3, (size_t)BITMAP_BENCH_DRAM_MIN)};
+
+    // Small steps: the odd primes from 5 below BITMAP_PATTERN_MAX_P, as in the sieves
+    // medium steps: the primes up to BITMAP_BENCH_MEDIUM_MAX_P
+    PRIMES_OBJ *primes = sieve_iZ(BITMAP_BENCH_MEDIUM_MAX_P);
+    if (primes == NULL)
+    {
+        log_error("Failed to sieve the step sizes in benchmark_bitmap_primitives.");
+        return;
+    }
+
+    int small_start = 2, medium_start = 2;
+    while (medium_start < primes->p_count && primes->p_array[medium_start] < BITMAP_PATTERN_MAX_P)
+        medium_start++;
+    int small_count = medium_start - small_start;
+    int medium_count = primes->p_count - medium_start;
+
+    BITMAP_PATTERN *patterns = malloc(small_count * sizeof(BITMAP_PATTERN));
+    uint64_t *large_steps = malloc(BITMAP_BENCH_LARGE_STEPS * sizeof(uint64_t));
+    BENCH_REPORT report = {0};
+    if (patterns == NULL || large_steps == NULL)
+    {
+        log_error("Memory allocation failed in benchmark_bitmap_primitives.");
+        goto cleanup;
+    }
+    for (int i = 0; i < small_count; i++)
+        bitmap_pattern_init(&patterns[i], primes->p_array[small_start + i]);
+
+    print_line(100);
+    printf("BITMAP primitives: L1d %zu KB, L2 %zu KB, L3 %zu KB", l1 >> 10, l2 >> 10, l3 >> 10);
+    print_line(100);
+    printf("| %-22s| %-6s| %-14s| %-6s| %-12s| %-12s| %-12s",
+           "Primitive", "Level", "Units", "Unit", "ns/unit min", "ns/unit med", "ns/unit p95");
+    print_line(100);
+
+    for (int level = 0; level < BITMAP_BENCH_LEVELS; level++)
+    {
+        if (max_bytes && level_bytes[level] > max_bytes)
+            continue;
+
+        size_t size = 8 * level_bytes[level];
+        const char *name = level_names[level];
+
+        // Large steps: odd, spread over [size / 256, size / 4], 4 to 256 marks each
+        for (int i = 0; i < BITMAP_BENCH_LARGE_STEPS; i++)
+            large_steps[i] = (size / 256 + (uint64_t)i * (size / 4 - size / 256) / BITMAP_BENCH_LARGE_STEPS) | 1;
+
+        BITMAP_RUN b = {0};
+        b.bitmap = bitmap_create(size);
+        b.dest = bitmap_create(size);
+        b.patterns = patterns;
+        if (b.bitmap == NULL || b.dest == NULL)
+        {
+            log_error("Memory allocation failed for the %s bitmaps in benchmark_bitmap_primitives.", name);
+            bitmap_free(b.bitmap);
+            bitmap_free(b.dest);
+            break;
+        }
+        bitmap_set_all(b.bitmap);
+        bitmap_set_all(b.dest);
+
+        // clearing: a cleared bit is cleared again at the same cost, no reset between runs
+        b.steps = primes->p_array + small_start;
+        b.steps_count = small_count;
+        double small_marks = bucket_marks(b.steps, small_count, size);
+        bitmap_bench_op(clear_mod_p_run, &b, "clear_mod_p small", name, small_marks, "mark", &report);
+        bitmap_bench_op(clear_pattern_run, &b, "clear_pattern small", name, small_marks, "mark", &report);
+
+        b.steps = primes->p_array + medium_start;
+        b.steps_count = medium_count;
+        bitmap_bench_op(clear_mod_p_run, &b, "clear_mod_p medium", name,
+                        bucket_marks(b.steps, medium_count, size), "mark", &report);
+
+        b.steps = large_steps;
+        b.steps_count = BITMAP_BENCH_LARGE_STEPS;
+        bitmap_bench_op(clear_mod_p_run, &b, "clear_mod_p large", name,
+                        bucket_marks(b.steps, BITMAP_BENCH_LARGE_STEPS, size), "mark", &report);
+
+        // the bitmap now has the density of a sieved segment
+        b.indices = malloc((bitmap_popcount(b.bitmap) + 1) * sizeof(size_t));
+        if (b.indices != NULL)
+            bitmap_bench_op(scan_run, &b, "scan_next extract", name, size, "bit", &report);
+        bitmap_bench_op(popcount_run, &b, "popcount", name, size, "bit", &report);
+        bitmap_bench_op(clone_run, &b, "clone", name, size, "bit", &report);
+        bitmap_bench_op(copy_run, &b, "copy", name, size - 8, "bit", &report);
+
+        bitmap_copy(b.dest, 0, b.bitmap, 0, BITMAP_BENCH_DUP_SEGMENT);
+        bitmap_bench_op(duplicate_run, &b, "duplicate_segment", name,
+                        (size / BITMAP_BENCH_DUP_SEGMENT - 1) * BITMAP_BENCH_DUP_SEGMENT, "bit", &report);
+        bitmap_bench_op(hash_run, &b, "compute_hash", name, size, "bit", &report);
+
+        print_line(100);
+        bitmap_free(b.bitmap);
+        bitmap_free(b.dest);
+        free(b.indices);
+    }
+
+    if (save_results && report.count > 0)
+    {
+        char file_path[256];
+        bench_output_path(file_path, sizeof(file_path), "bitmap_results", "csv");
+        if (bench_report_write(&report, file_path))
+            printf("Results saved to %s\n", file_path);
+    }
+
+cleanup:
+    bench_report_free(&report);
+    free(large_steps);
+    free(patterns);
+    primes_obj_free(primes);
+}
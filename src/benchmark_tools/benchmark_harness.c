@@ -0,0 +1,343 @@
+/**
+ * @file benchmark_harness.c
+ * @brief Wall-clock timing harness shared by the benchmark tools.
+ *
+ * @description:
+ * Times a function by CLOCK_MONOTONIC over warmup and repeated runs, and summarizes
+ * the samples by their min, median, 95th percentile, mean, standard deviation and max.
+ * The peak RSS and the peak library bytes of the runs are measured between
+ * bench_memory_begin and bench_memory_end. Results are collected in a BENCH_REPORT,
+ * written as CSV or JSON for the plot scripts.
+ *
+ * @usage:
+ * BENCH_STATS stats;
+ * BENCH_MEMORY memory;
+ * bench_memory_begin(&memory);
+ * bench_measure(run_sieve, &n, BENCH_WARMUP_RUNS, BENCH_RUNS, NULL, &stats);
+ * bench_memory_end(&memory);
+ *
+ * BENCH_REPORT report = {0};
+ * bench_report_add(&report, "Sieve-iZm", n, 1, &stats, &memory);
+ * bench_report_write(&report, "output/sieve_results.csv");
+ * bench_report_free(&report);
+ */
+
+#include <benchmark.h>
+#include <time.h>         // For clock_gettime
+#include <sys/resource.h> // For getrusage
+
+/**
+ * @brief Returns the time of the monotonic clock, in seconds.
+ *
+ * @return double Seconds since an arbitrary fixed point, unaffected by clock adjustments.
+ */
+double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Orders doubles ascending, for qsort.
+ */
+static int bench_compare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Summarizes timing samples.
+ *
+ * @description: The median is the middle sample, or the mean of the two middle ones,
+ * the 95th percentile is the nearest-rank one, and the standard deviation is that of
+ * the sample (n - 1 degrees of freedom), 0 for a single sample.
+ *
+ * @param samples The samples in seconds, left unchanged.
+ * @param count The number of samples.
+ * @param stats Receives the summary, zeroed if count < 1.
+ * @return int 1 on success, 0 if count < 1 or memory allocation fails.
+ */
+int bench_stats_compute(const double *samples, int count, BENCH_STATS *stats)
+{
+    memset(stats, 0, sizeof(BENCH_STATS));
+    if (count < 1)
+        return 0;
+
+    double *sorted = malloc(count * sizeof(double));
+    if (sorted == NULL)
+        return 0;
+    memcpy(sorted, samples, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), bench_compare);
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += sorted[i];
+
+    double variance = 0;
+    for (int i = 0; i < count; i++)
+        variance += (sorted[i] - sum / count) * (sorted[i] - sum / count);
+
+    stats->runs = count;
+    stats->min = sorted[0];
+    stats->max = sorted[count - 1];
+    stats->median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    stats->p95 = sorted[(int)ceil(0.95 * count) - 1];
+    stats->mean = sum / count;
+    stats->stddev = count > 1 ? sqrt(variance / (count - 1)) : 0;
+
+    free(sorted);
+    return 1;
+}
+
+/**
+ * @brief Times a function over warmup and repeated runs by the monotonic clock.
+ *
+ * @description: The warmup runs, called with run = -warmup, ..., -1, fill the caches,
+ * fault in the memory of the allocator and settle the CPU frequency; they are not timed.
+ * Each timed run, called with run = 0, ..., runs - 1, is one sample of wall-clock time,
+ * so parallel code is measured by its latency and not by the CPU time of its threads.
+ *
+ * @param fn The function to time.
+ * @param ctx The context passed to fn.
+ * @param warmup The number of untimed runs.
+ * @param runs The number of timed runs, at least 1.
+ * @param samples Receives the runs samples in seconds, in order, may be NULL.
+ * @param stats Receives the summary of the samples.
+ * @return int 1 on success, 0 on invalid input or if memory allocation fails.
+ */
+int bench_measure(bench_fn fn, void *ctx, int warmup, int runs, double *samples, BENCH_STATS *stats)
+{
+    if (fn == NULL || runs < 1 || warmup < 0 || stats == NULL)
+    {
+        log_error("Invalid function or run counts in bench_measure.");
+        return 0;
+    }
+
+    double *times = samples != NULL ? samples : malloc(runs * sizeof(double));
+    if (times == NULL)
+        return 0;
+
+    for (int run = -warmup; run < 0; run++)
+        fn(ctx, run);
+
+    for (int run = 0; run < runs; run++)
+    {
+        double start = bench_now();
+        fn(ctx, run);
+        times[run] = bench_now() - start;
+    }
+
+    int is_valid = bench_stats_compute(times, runs, stats);
+    if (samples == NULL)
+        free(times);
+
+    return is_valid;
+}
+
+/**
+ * @brief Returns the peak resident set size of the process.
+ *
+ * @description: Reads VmHWM from /proc/self/status, which /proc/self/clear_refs resets,
+ * or else the ru_maxrss of getrusage, the peak since the start of the process.
+ *
+ * @return uint64_t The peak RSS in bytes, 0 if unknown.
+ */
+uint64_t bench_peak_rss(void)
+{
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp != NULL)
+    {
+        char line[256];
+        unsigned long long kb = 0;
+        int is_found = 0;
+        while (!is_found && fgets(line, sizeof(line), fp) != NULL)
+            is_found = sscanf(line, "VmHWM: %llu kB", &kb) == 1;
+        fclose(fp);
+
+        if (is_found)
+            return (uint64_t)kb * 1024;
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (uint64_t)usage.ru_maxrss * 1024; // kilobytes on Linux
+}
+
+/**
+ * @brief Starts measuring the memory of a run.
+ *
+ * @description: Writing 5 to /proc/self/clear_refs resets the peak RSS to the current
+ * RSS (Linux 4.0 and later); where that fails, the peak RSS read by bench_memory_end
+ * is that of the process so far. The peaks of the library bytes are reset to the
+ * live bytes, which are kept as the baseline.
+ *
+ * @param memory Receives the baseline.
+ */
+void bench_memory_begin(BENCH_MEMORY *memory)
+{
+    memset(memory, 0, sizeof(BENCH_MEMORY));
+
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp != NULL)
+    {
+        memory->is_rss_reset = fputs("5", fp) >= 0;
+        memory->is_rss_reset = fclose(fp) == 0 && memory->is_rss_reset;
+    }
+
+    mem_usage_reset_peaks();
+    MEM_USAGE_REPORT usage;
+    mem_usage_get(&usage);
+    memory->base_bytes = usage.total.bytes;
+}
+
+/**
+ * @brief Reads the peak RSS and the peak library bytes of a run.
+ *
+ * @param memory The measurement started by bench_memory_begin, receives the peaks.
+ */
+void bench_memory_end(BENCH_MEMORY *memory)
+{
+    MEM_USAGE_REPORT usage;
+    mem_usage_get(&usage);
+
+    memory->peak_rss = bench_peak_rss();
+    memory->peak_bytes = usage.total.peak_bytes - memory->base_bytes;
+}
+
+/**
+ * @brief Appends a row to a benchmark report, growing it geometrically.
+ *
+ * @param report The report, zero-initialized before the first row.
+ * @param name The name of the benchmarked operation, truncated to BENCH_NAME_SIZE - 1 characters.
+ * @param n The size of the problem: the limit of a sieve, the bit size of a prime, ...
+ * @param threads The number of threads of the runs.
+ * @param stats The timing summary of the runs.
+ * @param memory The memory high-water marks of the runs, NULL if not measured (zeros).
+ * @return int 1 on success, 0 if memory allocation fails.
+ */
+int bench_report_add(BENCH_REPORT *report, const char *name, uint64_t n, int threads,
+                     const BENCH_STATS *stats, const BENCH_MEMORY *memory)
+{
+    if (report->count == report->capacity)
+    {
+        int capacity = report->capacity ? 2 * report->capacity : 16;
+        BENCH_ROW *rows = realloc(report->rows, capacity * sizeof(BENCH_ROW));
+        if (rows == NULL)
+        {
+            log_error("Memory allocation failed in bench_report_add.");
+            return 0;
+        }
+        report->rows = rows;
+        report->capacity = capacity;
+    }
+
+    BENCH_ROW *row = &report->rows[report->count++];
+    snprintf(row->name, BENCH_NAME_SIZE, "%s", name);
+    row->n = n;
+    row->threads = threads;
+    row->stats = *stats;
+    if (memory != NULL)
+        row->memory = *memory;
+    else
+        memset(&row->memory, 0, sizeof(BENCH_MEMORY));
+    return 1;
+}
+
+/**
+ * @brief Writes a benchmark report, as JSON if the path ends with ".json", as CSV otherwise.
+ *
+ * @description: The CSV has a header line and one line per row:
+ *   name,n,threads,runs,min_s,median_s,p95_s,mean_s,stddev_s,max_s,peak_rss_b,peak_lib_b
+ * The JSON is an array of objects with the same keys. Times are in seconds, memory in
+ * bytes (0 if not measured), and names are quoted, their quotes and backslashes replaced
+ * by underscores.
+ *
+ * @param report The report.
+ * @param file_path The path of the file to write.
+ * @return int 1 on success, 0 on failure.
+ */
+int bench_report_write(const BENCH_REPORT *report, const char *file_path)
+{
+    FILE *fp = fopen(file_path, "w");
+    if (fp == NULL)
+    {
+        log_error("Failed to open file %s", file_path);
+        return 0;
+    }
+
+    size_t length = strlen(file_path);
+    int is_json = length >= 5 && strcmp(file_path + length - 5, ".json") == 0;
+
+    if (is_json)
+        fprintf(fp, "[\n");
+    else
+        fprintf(fp, "name,n,threads,runs,min_s,median_s,p95_s,mean_s,stddev_s,max_s,peak_rss_b,peak_lib_b\n");
+
+    for (int i = 0; i < report->count; i++)
+    {
+        const BENCH_ROW *row = &report->rows[i];
+        const BENCH_STATS *s = &row->stats;
+        const BENCH_MEMORY *m = &row->memory;
+
+        char name[BENCH_NAME_SIZE];
+        snprintf(name, sizeof(name), "%s", row->name);
+        for (char *c = name; *c; c++)
+            if (*c == '"' || *c == '\\')
+                *c = '_';
+
+        if (is_json)
+            fprintf(fp, "  {\"name\": \"%s\", \"n\": %llu, \"threads\": %d, \"runs\": %d, "
+                        "\"min_s\": %.9g, \"median_s\": %.9g, \"p95_s\": %.9g, "
+                        "\"mean_s\": %.9g, \"stddev_s\": %.9g, \"max_s\": %.9g, "
+                        "\"peak_rss_b\": %llu, \"peak_lib_b\": %llu}%s\n",
+                    name, (unsigned long long)row->n, row->threads, s->runs,
+                    s->min, s->median, s->p95, s->mean, s->stddev, s->max,
+                    (unsigned long long)m->peak_rss, (unsigned long long)m->peak_bytes,
+                    i + 1 < report->count ? "," : "");
+        else
+            fprintf(fp, "\"%s\",%llu,%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%llu,%llu\n",
+                    name, (unsigned long long)row->n, row->threads, s->runs,
+                    s->min, s->median, s->p95, s->mean, s->stddev, s->max,
+                    (unsigned long long)m->peak_rss, (unsigned long long)m->peak_bytes);
+    }
+
+    if (is_json)
+        fprintf(fp, "]\n");
+
+    return fclose(fp) == 0;
+}
+
+/**
+ * @brief Frees the rows of a benchmark report and resets it.
+ *
+ * @param report The report.
+ */
+void bench_report_free(BENCH_REPORT *report)
+{
+    free(report->rows);
+    memset(report, 0, sizeof(BENCH_REPORT));
+}
+
+/**
+ * @brief Builds a timestamped path in the output directory, creating the directory if needed.
+ *
+ * @param file_path Receives the path DIR_output/<prefix>_<YYYYmmddHHMMSS>.<ext>.
+ * @param size The size of file_path.
+ * @param prefix The file name prefix.
+ * @param ext The file extension, without the dot.
+ */
+void bench_output_path(char *file_path, size_t size, const char *prefix, const char *ext)
+{
+    struct stat st = {0};
+    if (stat(DIR_output, &st) == -1)
+        mkdir(DIR_output, 0700);
+
+    time_t now = time(NULL);
+    char timestamp[64];
+    strftime(timestamp, sizeof(timestamp) - 1, "%Y%m%d%H%M%S", localtime(&now));
+
+    snprintf(file_path, size, "%s/%s_%s.%s", DIR_output, prefix, timestamp, ext);
+}
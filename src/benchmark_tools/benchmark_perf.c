@@ -0,0 +1,106 @@
+/**
+ * @file benchmark_perf.c
+ * @brief Hardware performance counters of the sieves, the random prime search and the file I/O.
+ *
+ * @description:
+ * Runs each workload once between iz_perf_start and iz_perf_stop, and prints its
+ * cycles, instructions, cache, branch and TLB misses per phase (see perf_counters.h),
+ * per prime found or per segment sieved:
+ * - sieve_iZm up to n, per prime: marking and extraction,
+ * - sieve_vx6_range at y = 1000, per segment: marking and extraction,
+ * - sieve_vx6_range at y = 10^20, per segment: marking and primality tests of the survivors,
+ * - random_iZprime of 1024 bits on one core, per prime: primality tests,
+ * - primes_obj_write_file and primes_obj_read_file of the primes up to n, per prime: io.
+ *
+ * The phases are only reported by a library built with make IZ_PERF=1; otherwise
+ * the whole run is reported as "other".
+ *
+ * @usage:
+ * benchmark_perf_counters(0);
+ */
+
+#include <benchmark.h>
+
+/**
+ * @brief Starts the counters and prints the name of a workload.
+ */
+static void perf_workload_start(const char *name)
+{
+    printf("\n%s\n", name);
+    fflush(stdout);
+    iz_perf_start();
+}
+
+/**
+ * @brief Benchmarks the library phases with hardware performance counters.
+ *
+ * @param quick If nonzero, runs smaller inputs.
+ */
+void benchmark_perf_counters(int quick)
+{
+    uint64_t n = quick ? 10000000ULL : 100000000ULL;
+    int range_y = quick ? 4 : 16;
+    int prime_rounds = quick ? 2 : 8;
+    IZ_PERF_REPORT report;
+
+#ifndef IZ_PERF
+    printf("The library is built without IZ_PERF, phases are reported as \"other\" (make clean && make IZ_PERF=1 bench-perf).\n");
+#endif
+
+    int events = iz_perf_start();
+    iz_perf_stop(NULL);
+    printf("Performance counters: %d of %d events available\n", events, IZ_PERF_EVENTS);
+
+    // 1. Small primes, per prime
+    char name[128];
+    snprintf(name, sizeof(name), "sieve_iZm(%llu)", (unsigned long long)n);
+    perf_workload_start(name);
+    PRIMES_OBJ *primes = sieve_iZm(n);
+    iz_perf_stop(&report);
+    if (primes == NULL)
+        return;
+    iz_perf_print(&report, primes->p_count, "prime");
+
+    // 2. Segments below the root primes limit, per segment
+    snprintf(name, sizeof(name), "sieve_vx6_range(1000, %d)", range_y);
+    perf_workload_start(name);
+    VX_RANGE *vx_range = sieve_vx6_range("1000", range_y);
+    iz_perf_stop(&report);
+    vx_range_free(vx_range);
+    iz_perf_print(&report, range_y, "segment");
+
+    // 3. Segments above the root primes limit, per segment
+    int huge_range_y = quick ? 1 : 2;
+    snprintf(name, sizeof(name), "sieve_vx6_range(10^20, %d)", huge_range_y);
+    perf_workload_start(name);
+    vx_range = sieve_vx6_range("100000000000000000000", huge_range_y);
+    iz_perf_stop(&report);
+    vx_range_free(vx_range);
+    iz_perf_print(&report, huge_range_y, "segment");
+
+    // 4. Random primes, per prime
+    snprintf(name, sizeof(name), "random_iZprime(1024 bits, 1 core) x %d", prime_rounds);
+    mpz_t p;
+    mpz_init(p);
+    perf_workload_start(name);
+    for (int i = 0; i < prime_rounds; i++)
+        random_iZprime(p, 1, 1024, 1);
+    iz_perf_stop(&report);
+    mpz_clear(p);
+    iz_perf_print(&report, prime_rounds, "prime");
+
+    // 5. File I/O of the primes up to n, per prime
+    char file_path[256];
+    snprintf(file_path, sizeof(file_path), "%s/perf_primes.bin", DIR_output);
+    mkdir(DIR_output, 0700);
+    snprintf(name, sizeof(name), "primes_obj_write_file + primes_obj_read_file(%d primes)", primes->p_count);
+    perf_workload_start(name);
+    primes_obj_write_file(file_path, primes);
+    PRIMES_OBJ *read_primes = primes_obj_read_file(file_path);
+    iz_perf_stop(&report);
+    iz_perf_print(&report, primes->p_count, "prime");
+
+    remove(file_path);
+    primes_obj_free(read_primes);
+    primes_obj_free(primes);
+}
@@ -1,6 +1,5 @@
 #include <benchmark.h>
 
-#include <sys/time.h>
 #include <openssl/bn.h>
 
 // List of prime generation algorithms: [iZn, iZp, gmp, ssl]
@@ -21,6 +20,7 @@ typedef struct
     char **primes_list; // Array of string primes
     double *time_array; // Array of execution times
     int results_count;  // Number of results stored in the arrays
+    BENCH_STATS stats;  // Summary of the execution times
 } RANDOM_PRIME_RESULT;
 
 // create results list structure
@@ -118,6 +118,8 @@ void print_results_list(const RESULTS_LIST *list)
         {
             print_line(32);
             printf("Average Time: %f seconds\n", total_time / res->results_count);
+            printf("Min / Median / P95 / Stddev: %f / %f / %f / %f seconds\n",
+                   res->stats.min, res->stats.median, res->stats.p95, res->stats.stddev);
         }
     }
 
@@ -125,107 +127,92 @@ void print_results_list(const RESULTS_LIST *list)
 }
 
 /**
- * @brief Measures the time to generate random primes using different algorithms.
+ * @brief Generates one random prime for bench_measure with the algorithm of a RANDOM_PRIME_RESULT.
  *
- * This function performs multiple tests to measure the performance of prime number
- * generation algorithms (iZp, GMP, or OpenSSL). For each test round, it:
- * 1. Generates a prime number using the algorithm specified in the result struct
- * 2. Measures the time taken for generation
- * 3. Stores the generated prime and timing information
+ * @description: The prime of timed run i is stored in result->primes_list[i], the
+ * primes of the warmup runs are discarded.
  *
- * The function allocates memory for storing the results, which should be freed by the caller
- * when no longer needed.
- *
- * @param result Pointer to a RANDOM_PRIME_RESULT structure that will be populated with
- *               the generated primes and timing data. The algorithm field must be set before calling.
- * @param test_rounds Number of prime generations to perform
+ * @param ctx The RANDOM_PRIME_RESULT, with its algorithm, bit size and cores number set.
+ * @param run The index of the run, negative for warmup runs.
  */
-void measure_prime_gen_time(RANDOM_PRIME_RESULT *result, int test_rounds)
+static void prime_gen_run(void *ctx, int run)
 {
+    RANDOM_PRIME_RESULT *result = ctx;
 
-    result->results_count = test_rounds;
-    result->primes_list = malloc(test_rounds * sizeof(char *));
-    result->time_array = malloc(test_rounds * sizeof(double));
+    // initialize the prime string
+    char *prime_str = NULL;
 
-    for (int i = 0; i < test_rounds; i++)
+    switch (result->algorithm)
     {
-        // initialize the prime string
-        char *prime_str = NULL;
-        struct timeval start, end;
-        double elapsed_seconds = 0;
-
-        switch (result->algorithm)
-        {
-        case iZp:
-        {
-            // iZp algorithm: use random_iZprime
-            mpz_t p;
-            mpz_init(p);
+    case iZp:
+    case iZn:
+    case GMP:
+    {
+        // iZp: random_iZprime, iZn: iZ_random_next_prime, GMP: gmp_random_next_prime
+        mpz_t p;
+        mpz_init(p);
 
-            gettimeofday(&start, NULL);
+        if (result->algorithm == iZp)
             random_iZprime(p, -1, result->bit_size, result->cores_num);
-            gettimeofday(&end, NULL);
-
-            prime_str = mpz_get_str(NULL, 10, p);
-            mpz_clear(p);
-            break;
-        }
-        case iZn:
-        {
-            // iZn algorithm: use iZ_random_next_prime
-            mpz_t p;
-            mpz_init(p);
-
-            gettimeofday(&start, NULL);
+        else if (result->algorithm == iZn)
             iZ_random_next_prime(p, result->bit_size);
-            gettimeofday(&end, NULL);
-
-            prime_str = mpz_get_str(NULL, 10, p);
-            mpz_clear(p);
-            break;
-        }
-        case GMP:
-        {
-            // GMP algorithm: use gmp_random_next_prime
-            mpz_t p;
-            mpz_init(p);
-
-            gettimeofday(&start, NULL);
+        else
             gmp_random_next_prime(p, result->bit_size);
-            gettimeofday(&end, NULL);
 
-            prime_str = mpz_get_str(NULL, 10, p);
-            mpz_clear(p);
-            break;
-        }
-        case OpenSSL:
-        {
-            // OpenSSL algorithm: use BN_generate_prime_ex
-            BIGNUM *prime = BN_new();
+        prime_str = mpz_get_str(NULL, 10, p);
+        mpz_clear(p);
+        break;
+    }
+    case OpenSSL:
+    {
+        // OpenSSL algorithm: use BN_generate_prime_ex
+        BIGNUM *prime = BN_new();
+        BN_generate_prime_ex(prime, result->bit_size, 0, NULL, NULL, NULL);
+
+        // BN_bn2dec strings are released by OPENSSL_free, copy it for free_results_list
+        char *bn_str = BN_bn2dec(prime);
+        prime_str = bn_str != NULL ? strdup(bn_str) : NULL;
+        OPENSSL_free(bn_str);
+        BN_free(prime);
+        break;
+    }
+    default:
+        fprintf(stderr, "Unknown algorithm: %d\n", result->algorithm);
+        break;
+    }
 
-            gettimeofday(&start, NULL);
-            BN_generate_prime_ex(prime, result->bit_size, 0, NULL, NULL, NULL);
-            gettimeofday(&end, NULL);
+    if (run >= 0)
+        result->primes_list[run] = prime_str;
+    else
+        free(prime_str);
+}
 
-            prime_str = BN_bn2dec(prime);
-            BN_free(prime);
-            break;
-        }
-        default:
-            // Handle unknown algorithm or provide a default behavior
-            // For example, print an error or skip this iteration
-            fprintf(stderr, "Unknown algorithm: %d\n", result->algorithm);
-            prime_str = NULL; // Ensure prime_str is initialized
-            // Or, if you want to skip this iteration:
-            // continue;
-            break;
-        }
+/**
+ * @brief Measures the time to generate random primes using different algorithms.
+ *
+ * This function performs multiple tests to measure the performance of prime number
+ * generation algorithms (iZp, GMP, or OpenSSL) with the shared benchmark harness:
+ * BENCH_WARMUP_RUNS untimed generations, then test_rounds generations, each timed
+ * by the monotonic clock, storing the generated primes and timing information and
+ * summarizing the times in result->stats.
+ *
+ * The function allocates memory for storing the results, which should be freed by the caller
+ * when no longer needed.
+ *
+ * @param result Pointer to a RANDOM_PRIME_RESULT structure that will be populated with
+ *               the generated primes and timing data. The algorithm field must be set before calling.
+ * @param test_rounds Number of prime generations to perform
+ */
+void measure_prime_gen_time(RANDOM_PRIME_RESULT *result, int test_rounds)
+{
+    result->results_count = test_rounds;
+    result->primes_list = calloc(test_rounds, sizeof(char *));
+    result->time_array = calloc(test_rounds, sizeof(double));
+    memset(&result->stats, 0, sizeof(BENCH_STATS));
 
-        elapsed_seconds = (end.tv_sec - start.tv_sec) +
-                          (end.tv_usec - start.tv_usec) / 1e6;
-        result->primes_list[i] = prime_str;
-        result->time_array[i] = elapsed_seconds;
-    }
+    if (result->primes_list == NULL || result->time_array == NULL ||
+        !bench_measure(prime_gen_run, result, BENCH_WARMUP_RUNS, test_rounds, result->time_array, &result->stats))
+        log_error("Failed to measure the prime generation time.");
 }
 
 /**
@@ -304,20 +291,9 @@ void benchmark_prime_gen_methods(int bit_size, int test_rounds, int save_results
     // If save_results is non-zero, save the output to a file
     if (save_results)
     {
-        struct stat st = {0};
-        // Create the output directory if it doesn't exist.
-        if (stat(DIR_output, &st) == -1)
-            mkdir(DIR_output, 0700);
-
-        // Get the current timestamp for file naming.
-        time_t now = time(NULL);
-        struct tm *t = localtime(&now);
-        char timestamp[64];
-        strftime(timestamp, sizeof(timestamp) - 1, "%Y%m%d%H%M%S", t);
-
-        // Build the output file path.
+        // Build the output file path, named by timestamp.
         char file_path[256];
-        snprintf(file_path, sizeof(file_path), "%s/random_prime_results_%s.txt", DIR_output, timestamp);
+        bench_output_path(file_path, sizeof(file_path), "random_prime_results", "txt");
 
         FILE *fp = fopen(file_path, "w");
         if (fp == NULL)
@@ -362,6 +338,20 @@ void benchmark_prime_gen_methods(int bit_size, int test_rounds, int save_results
             fclose(fp);
             printf("\n\nResults saved to %s\n", file_path);
         }
+
+        // The timing summaries, with the same timestamp
+        static const char *names[] = {"random_iZprime", "iZ_random_next_prime", "gmp_random_next_prime", "BN_generate_prime_ex"};
+        BENCH_REPORT report = {0};
+        for (int i = 0; i < results_list.results_count; i++)
+        {
+            RANDOM_PRIME_RESULT *res = &results_list.results[i];
+            bench_report_add(&report, names[res->algorithm], res->bit_size, res->cores_num, &res->stats, NULL);
+        }
+
+        strcpy(file_path + strlen(file_path) - strlen("txt"), "csv");
+        if (bench_report_write(&report, file_path))
+            printf("Timing summaries saved to %s\n", file_path);
+        bench_report_free(&report);
     }
 
     // Free allocated memory
@@ -399,22 +389,13 @@ int test_iZ_next_prime(int bit_size)
     // Generate a random number in the given range
     mpz_urandomb(base, state, bit_size);
 
-    struct timeval start, end;
-    double elapsed_seconds = 0;
-
-    gettimeofday(&start, NULL);
+    double start = bench_now();
     iZ_next_prime(p_iZ, base, 1);
-    gettimeofday(&end, NULL);
-    elapsed_seconds = (end.tv_sec - start.tv_sec) +
-                      (end.tv_usec - start.tv_usec) / 1e6;
-    printf("iZ Time : %f seconds\n", elapsed_seconds);
+    printf("iZ Time : %f seconds\n", bench_now() - start);
 
-    gettimeofday(&start, NULL);
+    start = bench_now();
     mpz_nextprime(p_gmp, base);
-    gettimeofday(&end, NULL);
-    elapsed_seconds = (end.tv_sec - start.tv_sec) +
-                      (end.tv_usec - start.tv_usec) / 1e6;
-    printf("GMP Time: %f seconds\n", elapsed_seconds);
+    printf("GMP Time: %f seconds\n", bench_now() - start);
 
     printf("iZ Prime : %s\n", mpz_get_str(NULL, 10, p_iZ));
     printf("GMP Prime: %s\n", mpz_get_str(NULL, 10, p_gmp));
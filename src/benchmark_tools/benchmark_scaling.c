@@ -0,0 +1,277 @@
+/**
+ * @file benchmark_scaling.c
+ * @brief Thread-scaling sweep of the parallel paths of the library.
+ *
+ * @description:
+ * Runs each parallel operation at 1, 2, 4, ... up to max_threads threads (or
+ * forked processes) on the same input, and reports its throughput, its speedup
+ * and parallel efficiency against one thread, and its CPU utilization, the CPU
+ * time of the process and of its reaped children over threads × wall-clock time:
+ * - random_iZprime, its search raced by forked processes, per prime,
+ * - sieve_vx6_range_parallel, per VX6 segment,
+ * - sieve_wheel30_count, per integer sieved,
+ * - iz_factor_u64_batch, the batch primality and factorization of 64-bit
+ *   integers, per value.
+ *
+ * A utilization well below 1 points at idle workers (load imbalance, serial
+ * phases), an efficiency below the utilization at workers slowed by sharing the
+ * memory bandwidth, the caches or the SMT cores of the host.
+ *
+ * @usage:
+ * benchmark_thread_scaling(0, 0, 1); // up to one thread per online CPU, results saved to
+ *                                    // output/scaling_results_<timestamp>.csv
+ */
+
+#include <benchmark.h>
+#include <unistd.h>       // For sysconf
+#include <sys/resource.h> // For getrusage
+
+#define SCALING_RUNS 3          ///< Timed runs of each thread count
+#define SCALING_MAX_POINTS 32   ///< Most thread counts of a sweep
+#define SCALING_PRIME_BITS 1024 ///< Bit size of the random primes
+
+/**
+ * @brief Context of a timed scaling run: the thread count and the inputs of the workloads.
+ */
+typedef struct
+{
+    int threads;            ///< Threads, or processes, of the run
+    int prime_rounds;       ///< Random primes generated per run
+    int range_y;            ///< VX6 segments sieved per run
+    uint64_t wheel_n;       ///< Limit of sieve_wheel30_count
+    const uint64_t *values; ///< Values factorized per run
+    size_t values_count;    ///< Number of values
+    uint64_t *factors;      ///< Receives the factors of the values
+    int *factor_counts;     ///< Receives the factor counts of the values
+    double units;           ///< Units of work of the last run
+    uint64_t result;        ///< Result of the last run, kept to check it and defeat dead-code elimination
+} SCALING_RUN;
+
+/**
+ * @brief A workload of the sweep: its name, its unit of work and its run function.
+ */
+typedef struct
+{
+    const char *name;     ///< Name of the operation
+    const char *unit;     ///< Unit of work, e.g. "prime"
+    bench_fn run;         ///< Runs the operation once with ctx->threads
+    int is_deterministic; ///< Whether the result of a run is the same at every thread count
+} SCALING_WORKLOAD;
+
+/**
+ * @brief Generates prime_rounds random primes, the search of each raced by ctx->threads processes.
+ */
+static void prime_gen_scaling_run(void *ctx, int run)
+{
+    (void)run;
+    SCALING_RUN *s = ctx;
+    mpz_t p;
+    mpz_init(p);
+    s->result = 0;
+    for (int i = 0; i < s->prime_rounds; i++)
+        s->result += random_iZprime(p, -1, SCALING_PRIME_BITS, s->threads);
+    s->units = s->prime_rounds;
+    mpz_clear(p);
+}
+
+/**
+ * @brief Sieves range_y VX6 segments above the first ones, counting their primes.
+ */
+static void vx_range_scaling_run(void *ctx, int run)
+{
+    (void)run;
+    SCALING_RUN *s = ctx;
+    VX_RANGE *vx_range = sieve_vx6_range_parallel("1000", s->range_y, s->threads);
+
+    s->result = 0;
+    for (int i = 0; vx_range != NULL && i < vx_range->count; i++)
+        s->result += vx_range->vx_objs[i]->p_count;
+    s->units = s->range_y;
+    vx_range_free(vx_range);
+}
+
+/**
+ * @brief Counts the primes up to wheel_n with the wheel-30 sieve.
+ */
+static void wheel30_scaling_run(void *ctx, int run)
+{
+    (void)run;
+    SCALING_RUN *s = ctx;
+    s->result = sieve_wheel30_count(s->wheel_n, 0, s->threads);
+    s->units = (double)s->wheel_n;
+}
+
+/**
+ * @brief Factorizes the values, counting those found prime.
+ */
+static void factor_scaling_run(void *ctx, int run)
+{
+    (void)run;
+    SCALING_RUN *s = ctx;
+    iz_factor_u64_batch(s->values, s->values_count, s->factors, s->factor_counts, s->threads);
+
+    s->result = 0;
+    for (size_t i = 0; i < s->values_count; i++)
+        s->result += s->factor_counts[i] == 1;
+    s->units = (double)s->values_count;
+}
+
+static const SCALING_WORKLOAD scaling_workloads[] = {
+    {"random_iZprime", "prime", prime_gen_scaling_run, 0},
+    {"sieve_vx6_range_parallel", "segment", vx_range_scaling_run, 1},
+    {"sieve_wheel30_count", "integer", wheel30_scaling_run, 1},
+    {"iz_factor_u64_batch", "value", factor_scaling_run, 1},
+};
+
+/**
+ * @brief Returns the CPU time, user and system, of the process and of its reaped children, in seconds.
+ */
+static double scaling_cpu_seconds(void)
+{
+    double seconds = 0;
+    int who[2] = {RUSAGE_SELF, RUSAGE_CHILDREN};
+    for (int i = 0; i < 2; i++)
+    {
+        struct rusage usage;
+        if (getrusage(who[i], &usage) == 0)
+            seconds += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+                       usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    }
+    return seconds;
+}
+
+/**
+ * @brief Benchmarks the thread scaling of the parallel paths of the library.
+ *
+ * @description:
+ * Each workload runs once untimed and SCALING_RUNS times timed at each thread count,
+ * and is summarized by its median time. The speedup and the efficiency are those of
+ * the median against the median at one thread, the CPU utilization that of all its
+ * runs. The factorized values are the same pseudo-random odd 62-bit integers at every
+ * thread count, and a run whose result differs from the one-thread run is reported.
+ *
+ * @param max_threads The largest thread count, 0 for one per online CPU.
+ * @param quick If nonzero, runs smaller inputs.
+ * @param save_results A flag indicating whether to save the results to a CSV file in the output directory.
+ */
+void benchmark_thread_scaling(int max_threads, int quick, int save_results)
+{
+    if (max_threads <= 0)
+        max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    max_threads = MAX(max_threads, 1);
+
+    SCALING_RUN ctx = {0};
+    ctx.prime_rounds = quick ? 2 : 8;
+    ctx.range_y = quick ? 16 : 64;
+    ctx.wheel_n = quick ? 200000000ULL : 2000000000ULL;
+    ctx.values_count = quick ? 4096 : 32768;
+
+    uint64_t *values = malloc(ctx.values_count * sizeof(uint64_t));
+    ctx.factors = malloc(ctx.values_count * IZ_FACTOR_MAX * sizeof(uint64_t));
+    ctx.factor_counts = malloc(ctx.values_count * sizeof(int));
+    if (values == NULL || ctx.factors == NULL || ctx.factor_counts == NULL)
+    {
+        log_error("Memory allocation failed in benchmark_thread_scaling.");
+        free(values);
+        free(ctx.factors);
+        free(ctx.factor_counts);
+        return;
+    }
+
+    // splitmix64, so every thread count factorizes the same values
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < ctx.values_count; i++)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        values[i] = ((z ^ (z >> 31)) >> 2) | 1;
+    }
+    ctx.values = values;
+
+    int thread_counts[SCALING_MAX_POINTS];
+    int points = 0;
+    for (int threads = 1; points < SCALING_MAX_POINTS; threads = MIN(2 * threads, max_threads))
+    {
+        thread_counts[points++] = threads;
+        if (threads == max_threads)
+            break;
+    }
+
+    FILE *fp = NULL;
+    char file_path[256];
+    if (save_results)
+    {
+        bench_output_path(file_path, sizeof(file_path), "scaling_results", "csv");
+        fp = fopen(file_path, "w");
+        if (fp == NULL)
+            log_error("Failed to open file %s", file_path);
+        else
+            fprintf(fp, "name,unit,units,threads,runs,min_s,median_s,p95_s,throughput,speedup,efficiency,cpu_utilization\n");
+    }
+
+    int workloads = sizeof(scaling_workloads) / sizeof(scaling_workloads[0]);
+    for (int w = 0; w < workloads; w++)
+    {
+        const SCALING_WORKLOAD *workload = &scaling_workloads[w];
+
+        print_line(92);
+        printf("Thread scaling of %s (%d warmup, %d timed runs)", workload->name, BENCH_WARMUP_RUNS, SCALING_RUNS);
+        print_line(92);
+        printf("| %-8s| %-12s| %-12s| %-16s| %-10s| %-11s| %-10s\n",
+               "Threads", "Units", "Median (s)", "Units/s", "Speedup", "Efficiency", "CPU util");
+        print_line(92);
+
+        double base_time = 0;
+        uint64_t base_result = 0;
+        for (int i = 0; i < points; i++)
+        {
+            ctx.threads = thread_counts[i];
+
+            // the processes forked by random_iZprime exit flushing their copy of the stdio buffers
+            fflush(NULL);
+
+            BENCH_STATS stats;
+            double cpu_start = scaling_cpu_seconds();
+            double start = bench_now();
+            int is_measured = bench_measure(workload->run, &ctx, BENCH_WARMUP_RUNS, SCALING_RUNS, NULL, &stats);
+            double wall = bench_now() - start;
+            double cpu = scaling_cpu_seconds() - cpu_start;
+            if (!is_measured)
+                break;
+
+            if (i == 0)
+            {
+                base_time = stats.median;
+                base_result = ctx.result;
+            }
+
+            if (workload->is_deterministic && ctx.result != base_result)
+                printf("Warning: %s returned %llu with %d threads, %llu with 1\n", workload->name,
+                       (unsigned long long)ctx.result, ctx.threads, (unsigned long long)base_result);
+
+            double throughput = ctx.units / stats.median;
+            double speedup = base_time / stats.median;
+            double efficiency = speedup / ctx.threads;
+            double utilization = cpu / (wall * ctx.threads);
+
+            printf("| %-8d| %-12.0f| %-12.4f| %-16.4g| %-10.2f| %-11.2f| %-10.2f\n",
+                   ctx.threads, ctx.units, stats.median, throughput, speedup, efficiency, utilization);
+            fflush(stdout);
+
+            if (fp != NULL)
+                fprintf(fp, "\"%s\",%s,%.0f,%d,%d,%.9g,%.9g,%.9g,%.9g,%.6f,%.6f,%.6f\n",
+                        workload->name, workload->unit, ctx.units, ctx.threads, stats.runs,
+                        stats.min, stats.median, stats.p95, throughput, speedup, efficiency, utilization);
+        }
+
+        print_line(92);
+    }
+
+    if (fp != NULL && fclose(fp) == 0)
+        printf("\nResults saved to %s\n", file_path);
+
+    free(values);
+    free(ctx.factors);
+    free(ctx.factor_counts);
+}
@@ -1,7 +1,6 @@
 #include <benchmark.h>
-#include <sys/stat.h> // For mkdir
-#include <time.h>     // For time
-#include <string.h>   // For memcpy
+#include <string.h> // For memcpy
+#include <unistd.h> // For sysconf
 
 SieveAlgorithm ClassicSieveOfEratosthenes = {classic_sieve_eratosthenes, "Classic Sieve of Eratosthenes"};
 SieveAlgorithm SieveOfEratosthenes = {sieve_eratosthenes, "Sieve of Eratosthenes"};
@@ -10,6 +9,8 @@ SieveAlgorithm SieveOfEuler = {sieve_euler, "Sieve of Euler"};
 SieveAlgorithm SieveOfAtkin = {sieve_atkin, "Sieve of Atkin"};
 SieveAlgorithm Sieve_iZ = {sieve_iZ, "Sieve-iZ"};
 SieveAlgorithm Sieve_iZm = {sieve_iZm, "Sieve-iZm"};
+SieveAlgorithm SieveWheel30 = {sieve_wheel30, "Sieve-Wheel30"};
+SieveAlgorithm SieveLinear = {sieve_linear, "Sieve-Linear"};
 
 /**
  * @brief Tests the integrity of different sieve models by comparing their hash values.
@@ -76,97 +77,77 @@ int test_sieve_integrity(SieveModels sieve_models, uint64_t n)
 }
 
 /**
- * @brief Measures the execution time of a given sieve algorithm.
- *
- * This function takes a sieve algorithm and an upper limit `n`, runs the algorithm,
- * and measures the time taken to execute it. It prints the algorithm name, the value of `n`,
- * the count of prime numbers found, the last prime number in the list, and the time taken in seconds.
- * It returns the execution time in microseconds.
- *
- * @param algorithm The sieve algorithm to be measured.
- * @param n The upper limit for the sieve algorithm.
- * @return The execution time in microseconds.
+ * @brief Context of a timed sieve run: the model, its limit and the result of the last run.
  */
-size_t measure_sieve_time(SieveAlgorithm model, uint64_t n)
+typedef struct
 {
-    clock_t start, end;
-    double cpu_time_used;
-
-    start = clock();                        // Start time
-    PRIMES_OBJ *primes = model.function(n); // Run time
-    end = clock();                          // End time
+    SieveAlgorithm model;
+    uint64_t n;
+    int p_count;         ///< Primes count of the last run, -1 if it failed
+    uint64_t last_prime; ///< Last prime of the last run
+} SIEVE_RUN;
 
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-
-    printf("| %-16lld", n);
-    printf("| %-16d", primes->p_count);
-    printf("| %-16lld", primes->p_array[primes->p_count - 1]);
-    printf("| %-16f\n", cpu_time_used);
+/**
+ * @brief Runs a sieve model once for bench_measure, keeping the count and last prime.
+ */
+static void sieve_run(void *ctx, int run)
+{
+    (void)run;
+    SIEVE_RUN *sieve = ctx;
+    PRIMES_OBJ *primes = sieve->model.function(sieve->n);
 
+    sieve->p_count = primes != NULL ? primes->p_count : -1;
+    sieve->last_prime = primes != NULL && primes->p_count > 0 ? primes->p_array[primes->p_count - 1] : 0;
     primes_obj_free(primes);
-    return (size_t)(cpu_time_used * 1000000); // time in microseconds;
 }
 
-// Function to save benchmarks results to a file named by timestamp
 /**
- * @brief Saves the results of the sieve models to a file.
+ * @brief Measures the execution time of a given sieve algorithm.
  *
- * This function creates a directory if it does not exist, generates a timestamped
- * filename, and writes the results of the sieve models to this file. The results
- * include metadata about the test range and the results of each sieve model.
+ * This function takes a sieve algorithm and an upper limit `n`, runs the algorithm
+ * BENCH_WARMUP_RUNS untimed and BENCH_RUNS timed times by the monotonic clock, and
+ * prints the value of `n`, the count of prime numbers found, the last prime number
+ * in the list, and the min, median, p95 and standard deviation of the times in seconds.
+ * It also prints the peak RSS of the runs, the auxiliary bytes of the sieve, i.e. its
+ * peak library bytes (see mem_alloc.h) beyond the 8 bytes per prime of the returned
+ * array, and the peak library bytes per prime found.
+ * It returns the median execution time in microseconds.
  *
- * @param sieve_models The sieve models containing the algorithms and their names.
- * @param all_results A 2D array containing the results of the sieve models.
- * @param base The base number used in the test range.
- * @param min_exp The minimum exponent used in the test range.
- * @param max_exp The maximum exponent used in the test range.
+ * @param algorithm The sieve algorithm to be measured.
+ * @param n The upper limit for the sieve algorithm.
+ * @param stats Receives the timing summary, may be NULL.
+ * @param memory Receives the memory high-water marks, may be NULL.
+ * @return The median execution time in microseconds.
  */
-static void save_sieve_results_file(SieveModels sieve_models, int all_results[][32], int base, int min_exp, int max_exp)
+size_t measure_sieve_time(SieveAlgorithm model, uint64_t n, BENCH_STATS *stats, BENCH_MEMORY *memory)
 {
-    struct stat st = {0};
-    if (stat(DIR_output, &st) == -1)
-        mkdir(DIR_output, 0700);
-
-    // Get the current timestamp
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-
-    char timestamp[64];
-    strftime(timestamp, sizeof(timestamp) - 1, "%Y%m%d%H%M%S", t);
-
-    // Create the output file path
-    char file_path[256];
-    snprintf(file_path, sizeof(file_path), "%s/sieve_results_%s.txt", DIR_output, timestamp);
-
-    // Open the file for writing
-    FILE *fp = fopen(file_path, "w");
-    if (fp == NULL)
-    {
-        log_error("Failed to open file");
-        return;
-    }
-
-    // Write the test range metadata
-    fprintf(fp, "Test Range: %d^%d:%d^%d\n", base, min_exp, base, max_exp);
-
-    // Write the results to the file
-    for (int i = 0; i < sieve_models.models_count; i++)
-    {
-        SieveAlgorithm model = sieve_models.models_list[i];
-
-        fprintf(fp, "%s: [", model.name);
-        for (int j = 0; j <= max_exp - min_exp; j++)
-        {
-            fprintf(fp, "%d", all_results[i][j]);
-            if (j < max_exp - min_exp)
-                fprintf(fp, ", ");
-        }
-        fprintf(fp, "]\n");
-    }
-
-    // Close the file
-    fclose(fp);
-    printf("\nResults saved to %s\n", file_path);
+    SIEVE_RUN sieve = {model, n, -1, 0};
+    BENCH_STATS run_stats;
+    BENCH_MEMORY run_memory;
+    bench_memory_begin(&run_memory);
+    bench_measure(sieve_run, &sieve, BENCH_WARMUP_RUNS, BENCH_RUNS, NULL, &run_stats);
+    bench_memory_end(&run_memory);
+
+    uint64_t p_count = MAX(sieve.p_count, 1);
+    uint64_t array_bytes = p_count * sizeof(uint64_t);
+    uint64_t aux_bytes = run_memory.peak_bytes > array_bytes ? run_memory.peak_bytes - array_bytes : 0;
+
+    printf("| %-16llu", (unsigned long long)n);
+    printf("| %-14d", sieve.p_count);
+    printf("| %-16llu", (unsigned long long)sieve.last_prime);
+    printf("| %-12f", run_stats.min);
+    printf("| %-12f", run_stats.median);
+    printf("| %-12f", run_stats.p95);
+    printf("| %-12f", run_stats.stddev);
+    printf("| %-10.1f", run_memory.peak_rss / 1048576.0);
+    printf("| %-12.1f", aux_bytes / 1024.0);
+    printf("| %-8.2f\n", (double)run_memory.peak_bytes / p_count);
+
+    if (stats != NULL)
+        *stats = run_stats;
+    if (memory != NULL)
+        *memory = run_memory;
+    return (size_t)(run_stats.median * 1000000); // time in microseconds;
 }
 
 /**
@@ -174,7 +155,8 @@ static void save_sieve_results_file(SieveModels sieve_models, int all_results[][
  *
  * This function measures the execution time of various sieve algorithms for a range of values
  * determined by the base raised to the power of exponents from min_exp to max_exp. The results
- * are printed and optionally saved to a file.
+ * are printed and optionally saved to a CSV file of the timing summaries (see bench_report_write),
+ * read by plot_sieve_results.py.
  *
  * @param sieve_models A structure containing the list of sieve algorithms to benchmark.
  * @param base The base value to be raised to the power of exponents.
@@ -184,49 +166,61 @@ static void save_sieve_results_file(SieveModels sieve_models, int all_results[][
  */
 void benchmark_sieve_models(SieveModels sieve_models, int base, int min_exp, int max_exp, int save_results)
 {
-    int all_results[sieve_models.models_count][32];
+    BENCH_REPORT report = {0};
 
     for (int i = 0; i < sieve_models.models_count; i++)
     {
         SieveAlgorithm model = sieve_models.models_list[i];
 
-        // results array: [time in microsecond]
-        int results[32];
+        // results array: [median time in microsecond]
+        size_t results[32];
         int k = 0;
 
-        printf("\nAlgorithm: %s", model.name);
-        print_line(75);
+        printf("\nAlgorithm: %s (%d warmup, %d timed runs)", model.name, BENCH_WARMUP_RUNS, BENCH_RUNS);
+        print_line(150);
         printf("| %-16s", "n");
-        printf("| %-16s", "Primes Count");
+        printf("| %-14s", "Primes Count");
         printf("| %-16s", "Last Prime");
-        printf("| %-16s", "Time (s)");
-        print_line(75);
-
-        // warmup
-        PRIMES_OBJ *primes = model.function(pow(base, min_exp));
-        primes_obj_free(primes);
-
-        for (int j = min_exp; j <= max_exp; j++)
-            results[k++] = measure_sieve_time(model, pow(base, j)); // returns time in microseconds
-
-        print_line(75);
+        printf("| %-12s", "Min (s)");
+        printf("| %-12s", "Median (s)");
+        printf("| %-12s", "P95 (s)");
+        printf("| %-12s", "Stddev (s)");
+        printf("| %-10s", "RSS (MB)");
+        printf("| %-12s", "Aux (KB)");
+        printf("| %-8s", "B/prime");
+        print_line(150);
+
+        for (int j = min_exp; j <= max_exp && k < 32; j++)
+        {
+            BENCH_STATS stats;
+            BENCH_MEMORY memory;
+            uint64_t n = pow(base, j);
+            results[k++] = measure_sieve_time(model, n, &stats, &memory);
+            bench_report_add(&report, model.name, n, 1, &stats, &memory);
+        }
 
-        for (int j = 0; j < k; j++)
-            all_results[i][j] = results[j];
+        print_line(150);
 
         // print results array
         printf("Results summary of %s\n", model.name);
         printf("Test range: [%d^%d : %d^%d]\n", base, min_exp, base, max_exp);
-        printf("Execution time in microseconds: [%d", results[0]);
+        printf("Median execution time in microseconds: [%zu", results[0]);
         for (int j = 1; j < k; j++)
-            printf(", %d", results[j]);
+            printf(", %zu", results[j]);
         printf("]\n");
         fflush(stdout);
     }
 
     // save results in a file named by timestamp
     if (save_results)
-        save_sieve_results_file(sieve_models, all_results, base, min_exp, max_exp);
+    {
+        char file_path[256];
+        bench_output_path(file_path, sizeof(file_path), "sieve_results", "csv");
+        if (bench_report_write(&report, file_path))
+            printf("\nResults saved to %s\n", file_path);
+    }
+
+    bench_report_free(&report);
 }
 
 /**
@@ -251,19 +245,14 @@ void test_sieve_vx6(char *y, char *filename)
     VX_ASSETS *vx_assets = vx_assets_init(vx);
     VX_OBJ *vx_obj = vx_init(vx, y);
 
-    clock_t start, end;
-    double cpu_time_used;
-
-    start = clock();             // Start time
-    sieve_vx(vx_obj, vx_assets); // Run time
-    end = clock();               // End time
-
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    double start = bench_now();                  // Start time
+    sieve_vx(vx_obj, vx_assets);                 // Run time
+    double wall_time_used = bench_now() - start; // End time
 
     printf("| %-16s: %d\n", "VX", vx_obj->vx);
     printf("| %-16s: %s\n", "Y", vx_obj->y);
     printf("| %-16s: %d\n", "Primes Count", vx_obj->p_count);
-    printf("| %-16s: %f\n", "Execution time", cpu_time_used);
+    printf("| %-16s: %f\n", "Execution time", wall_time_used);
     printf("| %-16s: %d\n", "bit_ops", vx_obj->bit_ops);
     printf("| %-16s: %d\n", "p_test_ops", vx_obj->p_test_ops);
     vx_print_p_gaps(vx_obj, 10); // print p_gaps array
@@ -298,3 +287,239 @@ void test_sieve_vx6(char *y, char *filename)
     vx_assets_free(vx_assets);
     mpz_clear(p); // clear GMP variables
 }
+
+/**
+ * @brief Benchmarks the thread scaling of sieve_vx6_range_parallel.
+ *
+ * For 1, 2, 4, ... up to max_threads threads, sieves the same range and prints the
+ * wall-clock time, throughput, speedup and parallel efficiency against one thread,
+ * and how many workers run on each NUMA node.
+ *
+ * @param start_y Pointer to a numeric string representing the first y value in iZm.
+ * @param range_y The number of VX6 segments to be sieved.
+ * @param max_threads The largest thread count, 0 for one per online CPU.
+ */
+void benchmark_vx_range_scaling(char *start_y, int range_y, int max_threads)
+{
+    if (max_threads <= 0)
+        max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    int node_count = numa_node_count();
+
+    print_line(92);
+    printf("Thread scaling of sieve_vx6_range_parallel: y = %s, %d segments, %d NUMA node(s)", start_y, range_y, node_count);
+    print_line(92);
+    printf("| %-8s| %-16s| %-12s| %-14s| %-10s| %-10s| %-s",
+           "Threads", "Primes Count", "Time (s)", "Segments/s", "Speedup", "Efficiency", "Workers per node");
+    print_line(92);
+
+    double base_time = 0;
+    for (int threads = 1;; threads = MIN(2 * threads, max_threads))
+    {
+        double start = bench_now();
+        VX_RANGE *vx_range = sieve_vx6_range_parallel(start_y, range_y, threads);
+        double seconds = bench_now() - start;
+
+        if (vx_range == NULL)
+        {
+            printf("sieve_vx6_range_parallel failed with %d threads\n", threads);
+            return;
+        }
+
+        if (threads == 1)
+            base_time = seconds;
+
+        uint64_t p_count = 0;
+        for (int i = 0; i < vx_range->count; i++)
+            p_count += vx_range->vx_objs[i]->p_count;
+        vx_range_free(vx_range);
+
+        // workers of each node, as assigned by sieve_vx6_range_parallel
+        char placement[128] = "-";
+        if (node_count > 1 && threads > 1)
+        {
+            int workers[NUMA_MAX_NODES] = {0};
+            for (int w = 0; w < MIN(threads, range_y); w++)
+                workers[numa_worker_node(w, MIN(threads, range_y))]++;
+
+            int length = 0;
+            for (int node = 0; node < node_count && length < (int)sizeof(placement) - 8; node++)
+                length += snprintf(placement + length, sizeof(placement) - length, "%s%d", node ? "/" : "", workers[node]);
+        }
+
+        double speedup = base_time / seconds;
+        printf("| %-8d| %-16llu| %-12.3f| %-14.1f| %-10.2f| %-10.2f| %-s\n",
+               threads, (unsigned long long)p_count, seconds, range_y / seconds, speedup, speedup / threads, placement);
+        fflush(stdout);
+
+        if (threads == max_threads)
+            break;
+    }
+
+    print_line(92);
+}
+
+/**
+ * @brief Context of a timed plan run: the limit, the plan and whether every run succeeded.
+ */
+typedef struct
+{
+    uint64_t n;
+    IZ_SIEVE_PLAN plan;
+    int is_valid;
+} PLAN_RUN;
+
+/**
+ * @brief Runs a list plan once for bench_measure.
+ */
+static void plan_run(void *ctx, int run)
+{
+    (void)run;
+    PLAN_RUN *timed = ctx;
+    PRIMES_OBJ *primes = iz_sieve_run(timed->n, timed->plan);
+    timed->is_valid = timed->is_valid && primes != NULL;
+    primes_obj_free(primes);
+}
+
+/**
+ * @brief Returns the best wall-clock time of a list plan over a few runs, in seconds.
+ *
+ * @param n The upper limit.
+ * @param plan The plan to run.
+ * @return double The best time, or -1 if the sieve failed.
+ */
+static double time_sieve_plan(uint64_t n, IZ_SIEVE_PLAN plan)
+{
+    // more runs for small n, where a single run is noisy
+    int runs = (int)MAX(MIN(100000000 / MAX(n, 1), 25), 3);
+
+    PLAN_RUN ctx = {n, plan, 1};
+    BENCH_STATS stats;
+    if (!bench_measure(plan_run, &ctx, 0, runs, NULL, &stats) || !ctx.is_valid)
+        return -1;
+
+    return stats.min;
+}
+
+/**
+ * @brief Calibrates iz_sieve_plan: times every engine at n = 10^3, ..., 10^max_exp and
+ * prints the calibration table rows for sieve_auto.c.
+ *
+ * @description:
+ * Each engine runs single-threaded, best of several runs. An engine taking over
+ * half a second and 4 times the fastest is dropped for the larger n. Where the wheel-30
+ * engine wins, its segment size is swept over 1, 2, 4 and 8 L1 data cache sizes.
+ * Consecutive exponents with the same winner are merged, the row boundaries
+ * falling halfway between exponents (10^(e + 1/2)).
+ *
+ * @param max_exp The largest exponent of 10, from 3 to 12.
+ */
+void benchmark_sieve_calibration(int max_exp)
+{
+    max_exp = MAX(MIN(max_exp, 12), 3);
+
+    long l1 = 0;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+    size_t l1_unit = 4096;
+    while (l1 > 0 && l1_unit * 2 <= (size_t)l1)
+        l1_unit *= 2;
+    if (l1 <= 0)
+        l1_unit = 32 * 1024;
+
+    int active[IZ_ENGINE_COUNT];
+    for (int e = 0; e < IZ_ENGINE_COUNT; e++)
+        active[e] = 1;
+
+    IZ_SIEVE_ENGINE winners[13];
+    int winner_l1[13];
+
+    print_line(92);
+    printf("Calibration of iz_sieve_plan: best single-thread time (s) of each engine, L1d unit %zu bytes", l1_unit);
+    print_line(92);
+    printf("| %-6s", "n");
+    for (int e = 0; e < IZ_ENGINE_COUNT; e++)
+        printf("| %-11.11s", iz_sieve_engine_name(e));
+    printf("| %-s", "Segment (L1d)");
+    print_line(92);
+
+    for (int exp = 3; exp <= max_exp; exp++)
+    {
+        uint64_t n = 1;
+        for (int i = 0; i < exp; i++)
+            n *= 10;
+
+        double times[IZ_ENGINE_COUNT];
+        double best = -1;
+        winners[exp] = IZ_ENGINE_WHEEL30;
+        winner_l1[exp] = 1;
+
+        printf("| 10^%-3d", exp);
+        for (int e = 0; e < IZ_ENGINE_COUNT; e++)
+        {
+            times[e] = -1;
+            if (active[e])
+            {
+                IZ_SIEVE_PLAN plan = {e, IZ_SIEVE_LIST, l1_unit, 1};
+                times[e] = time_sieve_plan(n, plan);
+            }
+
+            if (times[e] < 0)
+                printf("| %-11s", "-");
+            else
+                printf("| %-11.3e", times[e]);
+            fflush(stdout);
+
+            if (times[e] >= 0 && (best < 0 || times[e] < best))
+            {
+                best = times[e];
+                winners[exp] = e;
+            }
+        }
+
+        // drop the engines far behind once they take long, small n being dominated by setup costs
+        for (int e = 0; e < IZ_ENGINE_COUNT; e++)
+            if (times[e] < 0 || (times[e] > 0.5 && times[e] > 4 * best))
+                active[e] = 0;
+
+        if (winners[exp] == IZ_ENGINE_WHEEL30)
+        {
+            double best_segment = -1;
+            for (int multiple = 1; multiple <= 8; multiple *= 2)
+            {
+                IZ_SIEVE_PLAN plan = {IZ_ENGINE_WHEEL30, IZ_SIEVE_LIST, multiple * l1_unit, 1};
+                double seconds = multiple == 1 ? times[IZ_ENGINE_WHEEL30] : time_sieve_plan(n, plan);
+                if (seconds >= 0 && (best_segment < 0 || seconds < 0.97 * best_segment))
+                {
+                    best_segment = seconds;
+                    winner_l1[exp] = multiple;
+                }
+            }
+            printf("| %d\n", winner_l1[exp]);
+        }
+        else
+            printf("| -\n");
+        fflush(stdout);
+    }
+
+    static const char *enum_names[IZ_ENGINE_COUNT] = {
+        "IZ_ENGINE_ERATOSTHENES", "IZ_ENGINE_SEGMENTED", "IZ_ENGINE_EULER", "IZ_ENGINE_ATKIN",
+        "IZ_ENGINE_IZ", "IZ_ENGINE_IZM", "IZ_ENGINE_WHEEL30"};
+
+    print_line(92);
+    printf("static const IZ_SIEVE_CALIBRATION sieve_auto_table[] = {\n");
+    for (int exp = 3; exp <= max_exp; exp++)
+    {
+        if (exp < max_exp && winners[exp + 1] == winners[exp] && winner_l1[exp + 1] == winner_l1[exp])
+            continue;
+
+        if (exp == max_exp)
+            printf("    {UINT64_MAX, %s, %d},\n", enum_names[winners[exp]], winner_l1[exp]);
+        else
+            printf("    {%lluULL, %s, %d},\n", (unsigned long long)llround(pow(10, exp + 0.5)),
+                   enum_names[winners[exp]], winner_l1[exp]);
+    }
+    printf("};");
+    print_line(92);
+}
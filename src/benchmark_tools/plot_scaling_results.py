@@ -0,0 +1,87 @@
+import csv
+import os
+
+import numpy as np
+from matplotlib import pyplot as plt
+
+# defaults plot values
+output_dir = './output/'
+plot_ext = 'svg'
+
+
+# Function to read a CSV of benchmark_thread_scaling into
+# {name: {'unit': ..., 'threads': [...], 'speedup': [...], ...}}, ordered by threads
+def read_results(filename: str):
+    filepath = os.path.join(output_dir, f"{filename}.csv")
+    results = {}
+    with open(filepath, 'r', newline='') as file:
+        for row in csv.DictReader(file):
+            series = results.setdefault(row['name'], {
+                'unit': row['unit'], 'threads': [], 'throughput': [],
+                'speedup': [], 'efficiency': [], 'cpu_utilization': []})
+            series['threads'].append(int(row['threads']))
+            for key in ('throughput', 'speedup', 'efficiency', 'cpu_utilization'):
+                series[key].append(float(row[key]))
+
+    for series in results.values():
+        order = np.argsort(series['threads'])
+        for key, values in series.items():
+            if key != 'unit':
+                series[key] = [values[i] for i in order]
+
+    return results
+
+
+# Function to plot the speedup, and the efficiency against the CPU utilization, of each operation
+def plot_scaling_results(filename: str, save: bool = False):
+    results = read_results(filename)
+    max_threads = max(max(series['threads']) for series in results.values())
+
+    fig, (ax_speedup, ax_efficiency) = plt.subplots(1, 2, figsize=(14, 6))
+    fig.suptitle("Thread scaling of the parallel paths")
+
+    # Speedup against one thread, with the ideal linear speedup
+    ax_speedup.set_title("Speedup")
+    ax_speedup.set_xlabel('Threads')
+    ax_speedup.set_ylabel('T(1) / T(threads)')
+    ax_speedup.plot([1, max_threads], [1, max_threads], 'k--', label='ideal')
+    for name, series in results.items():
+        ax_speedup.plot(series['threads'], series['speedup'], marker='o', label=name)
+
+    # Efficiency (solid) and CPU utilization (dotted): a gap between them is time
+    # the workers are busy but slowed, a low utilization is time they are idle
+    ax_efficiency.set_title("Parallel efficiency (solid) and CPU utilization (dotted)")
+    ax_efficiency.set_xlabel('Threads')
+    ax_efficiency.set_ylabel('Fraction of the threads')
+    ax_efficiency.set_ylim(0, 1.1)
+    for name, series in results.items():
+        line, = ax_efficiency.plot(series['threads'], series['efficiency'], marker='o', label=name)
+        ax_efficiency.plot(series['threads'], series['cpu_utilization'], linestyle=':',
+                           marker='x', color=line.get_color())
+
+    ticks = [2**i for i in range(int(np.log2(max_threads)) + 1)]
+    if ticks[-1] != max_threads:
+        ticks.append(max_threads)
+    for ax in (ax_speedup, ax_efficiency):
+        ax.set_xscale('log', base=2)
+        ax.set_xticks(ticks)
+        ax.set_xticklabels([str(t) for t in ticks])
+        ax.grid(True)
+        ax.legend()
+
+    plt.show()
+
+    if save:
+        save_plot_figure(fig, dir=output_dir, filename=filename)
+
+
+# Function to save the plot figure
+def save_plot_figure(fig, dir, filename):
+    """save plot in svg format in the default output_dir"""
+    filepath = os.path.join(dir, f"{filename}.{plot_ext}")
+    fig.savefig(filepath, format=plot_ext)
+    print(f"Figure saved as {filepath}")
+
+
+if __name__ == '__main__':
+    plot_scaling_results("scaling_results_20261018080000", save=True)
@@ -1,3 +1,5 @@
+import csv
+import json
 import os
 
 import numpy as np
@@ -8,10 +10,39 @@ output_dir = './output/'
 plot_ext = 'svg'
 
 
-# Function to read results from a file
+# Function to read the timing summaries of a CSV or JSON report (see bench_report_write)
+def read_report(filepath: str):
+    if filepath.endswith('.json'):
+        with open(filepath, 'r') as file:
+            return json.load(file)
+
+    with open(filepath, 'r', newline='') as file:
+        return list(csv.DictReader(file))
+
+
+# Function to read results from a file: a CSV or JSON report of benchmark_sieve_models,
+# or the legacy text format of median times in microseconds
 def read_results(filename: str):
+    for ext in ('csv', 'json'):
+        filepath = os.path.join(output_dir, f"{filename}.{ext}")
+        if os.path.exists(filepath):
+            data, spread, limits = {}, {}, set()
+            for row in read_report(filepath):
+                n = int(row['n'])
+                limits.add(n)
+                # times in microseconds, the median with its min and p95 as error bounds
+                data.setdefault(row['name'], {})[n] = float(row['median_s']) * 1e6
+                spread.setdefault(row['name'], {})[n] = (float(row['min_s']) * 1e6,
+                                                         float(row['p95_s']) * 1e6)
+
+            limits = sorted(limits)
+            data = {name: [times.get(n, np.nan) for n in limits] for name, times in data.items()}
+            spread = {name: [bounds.get(n, (np.nan, np.nan)) for n in limits]
+                      for name, bounds in spread.items()}
+            return data, limits, spread
+
     data = {}
-    with open(f"./output/{filename}.txt", 'r') as file:
+    with open(os.path.join(output_dir, f"{filename}.txt"), 'r') as file:
         lines = file.readlines()
 
         # Read the test range from the first line
@@ -30,13 +61,12 @@ def read_results(filename: str):
             times = list(map(int, times.strip('[]').split(', ')))
             data[algorithm] = times
 
-    return data, 10, list(np.arange(min_exp, max_exp + 1))
+    return data, [10**int(exp) for exp in np.arange(min_exp, max_exp + 1)], None
 
 
 # Function to plot the time performance of sieve benchmarking results
 def plot_sieve_results(filename: str, save: bool = False):
-    data, base, exponents = read_results(filename)
-    x_values = [base**exp for exp in exponents]
+    data, x_values, spread = read_results(filename)
 
     # Normalize the data
     normalized_data = {}
@@ -60,15 +90,23 @@ def plot_sieve_results(filename: str, save: bool = False):
         label = algorithm
         y = times
         all_y.append(y)
-        ax.plot(x_ticks, y, label=label, marker='o')
+        if spread is None:
+            ax.plot(x_ticks, y, label=label, marker='o')
+        else:
+            # error bars from the fastest run to the 95th percentile
+            bounds = [((lo * 1000) / n, (hi * 1000) / n)
+                      for (lo, hi), n in zip(spread[algorithm], x_values)]
+            y_err = [[max(t - lo, 0) for t, (lo, _) in zip(y, bounds)],
+                     [max(hi - t, 0) for t, (_, hi) in zip(y, bounds)]]
+            ax.errorbar(x_ticks, y, yerr=y_err, label=label, marker='o', capsize=3)
 
     # Set y ticks
-    max_y = max([max(y) for y in all_y])
+    max_y = np.nanmax([np.nanmax(y) for y in all_y])
     ax.set_yticks(np.arange(0, max_y + 1, 1))
 
     # Set x ticks
     ax.set_xticks(x_ticks)
-    ax.set_xticklabels([f'$10^{{{exp}}}$' for exp in exponents])
+    ax.set_xticklabels([f'$10^{{{exp:g}}}$' for exp in np.round(x_ticks, 2)])
 
     ax.grid(True)
     plt.legend()
@@ -402,6 +402,31 @@ uint64_t solve_for_x_gmp(int matrix_id, uint64_t p, size_t vx, mpz_t y)
     return x;
 }
 
+/**
+ * @brief Solve for x given matrix_id, p, and the residue (vx * y) mod p.
+ * Same as above, but takes the reduced product so callers can compute it
+ * once per prime and reuse it for both matrices.
+ *
+ * Parameters:
+ * @param matrix_id  int indicating the target matrix (-1 for iZm5, 1 for iZm7).
+ * @param p          Unsigned 64-bit integer parameter.
+ * @param yvx_mod_p  (vx * y) mod p.
+ *
+ * @return The computed x value as a 64-bit unsigned integer.
+ */
+uint64_t solve_for_x_mod(int matrix_id, uint64_t p, uint64_t yvx_mod_p)
+{
+    // 1. Normalize x_p to x_p if p_id = matrix_id, else to p - x_p
+    uint64_t x_p = (p + 1) / 6;
+    int p_id = (p % 6 == 1) ? 1 : -1;
+    x_p = matrix_id == p_id ? x_p : p - x_p;
+
+    // 2. x = p - (vx * y - x_p) mod p, where yvx_mod_p + p - x_p is in [1, 2p),
+    // so a conditional subtraction replaces the division
+    uint64_t delta = yvx_mod_p + p - x_p;
+    return p - (delta >= p ? delta - p : delta);
+}
+
 /**
  * @brief Solve for smallest y that satisfies (x + vx * y) \equiv x_p \mod p
  *
@@ -0,0 +1,127 @@
+/**
+ * @file arena.c
+ * @brief Implementation of the ARENA bump allocator, see arena.h.
+ */
+
+#include <iZ.h>
+
+// Block header size, rounded up so that the data that follows it is aligned
+#define ARENA_HEADER_SIZE ((sizeof(ARENA_BLOCK) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+/**
+ * @brief Allocates a block of capacity usable bytes, the header and data in one heap call.
+ *
+ * @param capacity The usable size of the block.
+ * @param next The block to link after the new one.
+ * @return ARENA_BLOCK* The new block, or NULL if memory allocation fails.
+ */
+static ARENA_BLOCK *arena_block_create(size_t capacity, ARENA_BLOCK *next)
+{
+    // malloc memory is aligned for any fundamental type, at least ARENA_ALIGN on 64-bit hosts
+    unsigned char *memory = malloc(ARENA_HEADER_SIZE + capacity);
+    if (memory == NULL)
+    {
+        log_error("Memory allocation failed for an arena block.");
+        return NULL;
+    }
+
+    mem_usage_alloc(MEM_KIND_ARENA, capacity);
+
+    ARENA_BLOCK *block = (ARENA_BLOCK *)memory;
+    block->next = next;
+    block->capacity = capacity;
+    block->used = 0;
+    block->data = memory + ARENA_HEADER_SIZE;
+    return block;
+}
+
+/**
+ * @brief Creates an arena with a first block of block_size bytes.
+ *
+ * @param block_size The usable size of the first block.
+ * @return ARENA* A pointer to the new ARENA, or NULL if memory allocation fails.
+ */
+ARENA *arena_create(size_t block_size)
+{
+    ARENA *arena = malloc(sizeof(ARENA));
+    if (arena == NULL)
+    {
+        log_error("Memory allocation failed for arena.");
+        return NULL;
+    }
+
+    arena->allocated = 0;
+    arena->head = arena_block_create(MAX(block_size, (size_t)ARENA_ALIGN), NULL);
+    if (arena->head == NULL)
+    {
+        free(arena);
+        return NULL;
+    }
+
+    return arena;
+}
+
+/**
+ * @brief Allocates size bytes from the current block, or from a new block
+ * of at least twice its capacity if it doesn't fit.
+ *
+ * @param arena A pointer to the ARENA.
+ * @param size The number of bytes to allocate.
+ * @return void* A pointer to the allocated memory, or NULL if memory allocation fails.
+ */
+void *arena_alloc(ARENA *arena, size_t size)
+{
+    // Round up so that the next allocation stays aligned
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+    ARENA_BLOCK *block = arena->head;
+    if (block->capacity - block->used < size)
+    {
+        block = arena_block_create(MAX(2 * block->capacity, size), block);
+        if (block == NULL)
+            return NULL;
+        arena->head = block;
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->allocated += size;
+    return ptr;
+}
+
+/**
+ * @brief Discards all allocations, freeing every block but the current one, the largest.
+ *
+ * @param arena A pointer to the ARENA.
+ */
+void arena_reset(ARENA *arena)
+{
+    ARENA_BLOCK *block = arena->head->next;
+    while (block != NULL)
+    {
+        ARENA_BLOCK *next = block->next;
+        mem_usage_free(MEM_KIND_ARENA, block->capacity);
+        free(block);
+        block = next;
+    }
+
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->allocated = 0;
+}
+
+/**
+ * @brief Frees the arena and all of its blocks.
+ *
+ * @param arena A pointer to the ARENA, may be NULL.
+ */
+void arena_free(ARENA *arena)
+{
+    if (arena == NULL)
+        return;
+
+    arena_reset(arena);
+    mem_usage_free(MEM_KIND_ARENA, arena->head->capacity);
+    free(arena->head);
+    free(arena);
+}
@@ -11,6 +11,7 @@
 
 /**
  * @brief Creates a BITMAP of a specified size.
+ * The data is MEM_ALIGN aligned and, when large, backed by huge pages (see mem_alloc.h).
  *
  * @param size The number of bits in the array.
  * @return BITMAP* A pointer to the newly created BITMAP, or NULL on failure.
@@ -32,7 +33,7 @@ BITMAP *bitmap_create(size_t size)
 
     bitmap->size = size;
     size_t byte_size = (size + 7) / 8;
-    bitmap->data = (unsigned char *)calloc(byte_size, sizeof(unsigned char));
+    bitmap->data = (unsigned char *)mem_alloc_kind(byte_size, 1, MEM_KIND_BITMAP);
     if (bitmap->data == NULL)
     {
         free(bitmap);
@@ -54,7 +55,7 @@ void bitmap_free(BITMAP *bitmap)
     {
         if (bitmap->data != NULL)
         {
-            free(bitmap->data);
+            mem_free(bitmap->data);
             bitmap->data = NULL;
         }
 
@@ -129,6 +130,28 @@ void bitmap_clear_bit(BITMAP *bitmap, size_t idx)
     bitmap->data[idx / 8] &= ~(1 << (idx % 8));
 }
 
+/**
+ * @brief Clears every p-th bit from start_idx to limit, unrolled by 4 marks.
+ * The marks scatter one byte each, so there is no SIMD variant to dispatch to.
+ */
+static inline void bitmap_clear_step(unsigned char *data, uint64_t p, size_t start_idx, size_t limit)
+{
+    size_t idx = start_idx;
+    size_t step = 4 * p;
+
+    for (; idx + 3 * p <= limit; idx += step)
+    {
+        size_t i1 = idx + p, i2 = idx + 2 * p, i3 = idx + 3 * p;
+        data[idx / 8] &= ~(1 << (idx % 8));
+        data[i1 / 8] &= ~(1 << (i1 % 8));
+        data[i2 / 8] &= ~(1 << (i2 % 8));
+        data[i3 / 8] &= ~(1 << (i3 % 8));
+    }
+
+    for (; idx <= limit; idx += p)
+        data[idx / 8] &= ~(1 << (idx % 8));
+}
+
 /**
  * @brief Clears bits that are multiples of a prime number `p`, starting from `start_idx` to `limit`.
  *
@@ -143,10 +166,139 @@ void bitmap_clear_mod_p(BITMAP *bitmap, uint64_t p, size_t start_idx, size_t lim
     limit = MIN(limit, bitmap->size);
 
     if (start_idx <= limit)
+        bitmap_clear_step(bitmap->data, p, start_idx, limit);
+}
+
+/**
+ * @brief Precomputes the word masks of a step size p.
+ *
+ * @param pattern The BITMAP_PATTERN to initialize.
+ * @param p The step size, odd and 1 < p < BITMAP_PATTERN_MAX_P.
+ */
+void bitmap_pattern_init(BITMAP_PATTERN *pattern, uint64_t p)
+{
+    pattern->p = p;
+
+    // Word k of a period, marked from bit 0, has its first mark at bit (-64 * k) mod p,
+    // and since p is odd these phases run over all of [0, p)
+    for (uint64_t k = 0; k < p; k++)
+    {
+        uint64_t r = (p - (64 * k) % p) % p;
+        uint64_t mask = 0;
+        for (uint64_t bit = r; bit < 64; bit += p)
+            mask |= (uint64_t)1 << bit;
+
+        pattern->cycle[k] = pattern->cycle[k + p] = ~mask;
+        pattern->phase_index[r] = k;
+    }
+}
+
+/**
+ * @brief Clears bits that are multiples of a small step `p`, from `start_idx` to `limit`,
+ * by masking whole 64-bit words with a precomputed pattern.
+ *
+ * @param bitmap The BITMAP to modify.
+ * @param pattern The precomputed pattern of p.
+ * @param start_idx The starting index.
+ * @param limit The upper limit.
+ */
+void bitmap_clear_pattern(BITMAP *bitmap, const BITMAP_PATTERN *pattern, size_t start_idx, size_t limit)
+{
+    // set limit to the minimum of bitmap->size and limit
+    limit = MIN(limit, bitmap->size);
+    if (start_idx > limit)
+        return;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Little-endian words match the LSB-first bit order of the bytes
+    unsigned char *data = bitmap->data;
+    uint64_t p = pattern->p;
+    size_t w = start_idx / 64, last_w = limit / 64;
+    uint64_t word;
+
+    // The first word is marked from bit start_idx % 64, possibly past its first phase
+    uint64_t bit = start_idx % 64;
+    uint64_t r = bit % p;
+    size_t k = pattern->phase_index[r];
+    uint64_t mask = ~pattern->cycle[k] << (bit - r);
+
+    if (w < last_w)
+    {
+        memcpy(&word, data + w * 8, 8);
+        word &= ~mask;
+        memcpy(data + w * 8, &word, 8);
+        w++;
+        k = k + 1 == p ? 0 : k + 1;
+
+        // Whole words before the last one, a period of p words at a time
+        size_t j = 0;
+        for (; w + p <= last_w; w += p)
+            for (j = 0; j < p; j++)
+            {
+                memcpy(&word, data + (w + j) * 8, 8);
+                word &= pattern->cycle[k + j];
+                memcpy(data + (w + j) * 8, &word, 8);
+            }
+
+        for (j = 0; w < last_w; w++, j++)
+        {
+            memcpy(&word, data + w * 8, 8);
+            word &= pattern->cycle[k + j];
+            memcpy(data + w * 8, &word, 8);
+        }
+
+        k = (k + j) % p;
+        mask = ~pattern->cycle[k];
+    }
+
+    // The last word is marked up to limit, and may be shorter than 8 bytes
+    if (limit % 64 != 63)
+        mask &= ((uint64_t)1 << (limit % 64 + 1)) - 1;
+
+    size_t n_bytes = MIN((size_t)8, (bitmap->size + 7) / 8 - w * 8);
+    word = 0;
+    memcpy(&word, data + w * 8, n_bytes);
+    word &= ~mask;
+    memcpy(data + w * 8, &word, n_bytes);
+#else
+    bitmap_clear_step(bitmap->data, pattern->p, start_idx, limit);
+#endif
+}
+
+/**
+ * @brief Counts the set bits among the first bitmap->size bits.
+ *
+ * @param bitmap The BITMAP to count.
+ * @return size_t The number of set bits.
+ */
+size_t bitmap_popcount(BITMAP *bitmap)
+{
+    // Full bytes go through the dispatched kernel
+    size_t full_bytes = bitmap->size / 8;
+    size_t count = cpu_kernels()->popcount(bitmap->data, full_bytes);
+
+    // Mask the trailing bits beyond bitmap->size, e.g. after bitmap_set_all
+    size_t tail_bits = bitmap->size % 8;
+    if (tail_bits)
     {
-        for (size_t idx = start_idx; idx <= limit; idx += p)
-            bitmap->data[idx / 8] &= ~(1 << (idx % 8));
+        unsigned char tail = bitmap->data[full_bytes] & ((1 << tail_bits) - 1);
+        for (; tail; tail &= tail - 1)
+            count++;
     }
+
+    return count;
+}
+
+/**
+ * @brief Finds the index of the next set bit at or after idx.
+ *
+ * @param bitmap The BITMAP to scan.
+ * @param idx The index to start scanning from.
+ * @return size_t The index of the next set bit, or bitmap->size if there is none.
+ */
+size_t bitmap_scan_next(BITMAP *bitmap, size_t idx)
+{
+    return cpu_kernels()->scan_next(bitmap->data, bitmap->size, idx);
 }
 
 /**
@@ -158,6 +310,8 @@ void bitmap_clear_mod_p(BITMAP *bitmap, uint64_t p, size_t start_idx, size_t lim
 BITMAP *bitmap_clone(BITMAP *bitmap)
 {
     BITMAP *clone = bitmap_create(bitmap->size);
+    if (clone == NULL)
+        return NULL;
 
     size_t byte_size = (bitmap->size + 7) / 8;
     memcpy(clone->data, bitmap->data, byte_size);
@@ -316,13 +470,9 @@ int bitmap_validate_hash(BITMAP *bitmap)
 }
 
 /**
- * @brief Writes a bitmap to a file in the specified directory.
- *
- * @param dir The directory where the file will be saved.
- * @param file_name The name of the file.
- * @return int 1 on success, 0 on failure.
+ * @brief Does the work of bitmap_write_file, outside the io phase hooks.
  */
-int bitmap_write_file(const char *file_name, BITMAP *bitmap)
+static int bitmap_write_io(const char *file_name, BITMAP *bitmap)
 {
     if (file_name == NULL || bitmap == NULL)
     {
@@ -378,13 +528,24 @@ int bitmap_write_file(const char *file_name, BITMAP *bitmap)
 }
 
 /**
- * @brief Reads a bit array from a file in the specified directory.
+ * @brief Writes a bitmap to a file in the specified directory.
  *
- * @param dir The directory where the file is located.
+ * @param dir The directory where the file will be saved.
  * @param file_name The name of the file.
- * @return bitmap* A pointer to the newly read bitmap, or NULL on failure.
+ * @return int 1 on success, 0 on failure.
  */
-BITMAP *bitmap_read_file(const char *file_name)
+int bitmap_write_file(const char *file_name, BITMAP *bitmap)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    int is_written = bitmap_write_io(file_name, bitmap);
+    IZ_PERF_END();
+    return is_written;
+}
+
+/**
+ * @brief Does the work of bitmap_read_file, outside the io phase hooks.
+ */
+static BITMAP *bitmap_read_io(const char *file_name)
 {
     if (file_name == NULL)
     {
@@ -459,3 +620,18 @@ BITMAP *bitmap_read_file(const char *file_name)
 
     return bitmap;
 }
+
+/**
+ * @brief Reads a bit array from a file in the specified directory.
+ *
+ * @param dir The directory where the file is located.
+ * @param file_name The name of the file.
+ * @return bitmap* A pointer to the newly read bitmap, or NULL on failure.
+ */
+BITMAP *bitmap_read_file(const char *file_name)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    BITMAP *bitmap = bitmap_read_io(file_name);
+    IZ_PERF_END();
+    return bitmap;
+}
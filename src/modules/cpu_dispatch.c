@@ -0,0 +1,495 @@
+/**
+ * @file cpu_dispatch.c
+ * @brief Runtime CPU feature detection and kernel dispatch for bitmap hot paths.
+ *
+ * @description:
+ * This file implements the bitmap kernels for each dispatch level and the logic
+ * that selects one table per process. The SIMD kernels are compiled with GCC/Clang
+ * target attributes, so the translation unit itself needs no -m flags and the
+ * binary stays runnable on any x86-64 host. On non-x86 hosts only the generic
+ * kernels are compiled.
+ */
+
+#include <iZ.h>
+#include <pthread.h> // For pthread_once
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_DISPATCH_X86
+#include <immintrin.h> // For SSE/AVX intrinsics
+#endif
+
+static const CPU_KERNELS *active_kernels = NULL;
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+// * Generic kernels
+// =========================================================
+
+static size_t popcount_generic(const unsigned char *data, size_t byte_size)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < byte_size; i++)
+    {
+        unsigned char byte = data[i];
+        while (byte)
+        {
+            byte &= byte - 1; // clear the lowest set bit
+            count++;
+        }
+    }
+    return count;
+}
+
+static size_t scan_next_generic(const unsigned char *data, size_t size, size_t idx)
+{
+    while (idx < size)
+    {
+        // skip whole zero bytes when aligned
+        if (idx % 8 == 0 && data[idx / 8] == 0)
+        {
+            idx += 8;
+            continue;
+        }
+
+        if (data[idx / 8] & (1 << (idx % 8)))
+            return idx;
+        idx++;
+    }
+    return size;
+}
+
+static size_t scan_ge_generic(const unsigned char *data, size_t size, size_t idx, unsigned char threshold)
+{
+    while (idx < size && data[idx] < threshold)
+        idx++;
+    return idx;
+}
+
+static const CPU_KERNELS generic_kernels = {
+    CPU_LEVEL_GENERIC,
+    popcount_generic,
+    scan_next_generic,
+    scan_ge_generic,
+};
+
+#ifdef CPU_DISPATCH_X86
+
+// * Shared word-level helpers, inlined into each target-specific kernel
+// =========================================================
+
+/**
+ * @brief Loads the w-th little-endian 64-bit word of data, zero-padding past byte_size.
+ */
+static inline __attribute__((always_inline)) uint64_t load_word(const unsigned char *data, size_t byte_size, size_t w)
+{
+    uint64_t word = 0;
+    size_t offset = w * 8;
+    memcpy(&word, data + offset, MIN((size_t)8, byte_size - offset));
+    return word;
+}
+
+static inline __attribute__((always_inline)) size_t popcount_words(const unsigned char *data, size_t byte_size)
+{
+    size_t count = 0;
+    size_t n_words = byte_size / 8;
+
+    for (size_t w = 0; w < n_words; w++)
+        count += __builtin_popcountll(load_word(data, byte_size, w));
+
+    for (size_t i = n_words * 8; i < byte_size; i++)
+        count += __builtin_popcount(data[i]);
+
+    return count;
+}
+
+static inline __attribute__((always_inline)) size_t scan_first_word(const unsigned char *data, size_t size, size_t idx, size_t *w, uint64_t *word)
+{
+    size_t byte_size = (size + 7) / 8;
+    *w = idx / 64;
+    *word = load_word(data, byte_size, *w) & (~0ULL << (idx % 64));
+    return byte_size;
+}
+
+static inline __attribute__((always_inline)) size_t scan_found(size_t size, size_t w, uint64_t word)
+{
+    size_t found = w * 64 + __builtin_ctzll(word);
+    return found < size ? found : size;
+}
+
+// * SSE4.2 + POPCNT kernels
+// =========================================================
+
+__attribute__((target("sse4.2,popcnt"))) static size_t popcount_sse42(const unsigned char *data, size_t byte_size)
+{
+    return popcount_words(data, byte_size);
+}
+
+__attribute__((target("sse4.2,popcnt"))) static size_t scan_next_sse42(const unsigned char *data, size_t size, size_t idx)
+{
+    if (idx >= size)
+        return size;
+
+    size_t w;
+    uint64_t word;
+    size_t byte_size = scan_first_word(data, size, idx, &w, &word);
+    size_t n_words = (byte_size + 7) / 8;
+
+    while (word == 0)
+    {
+        if (++w >= n_words)
+            return size;
+        word = load_word(data, byte_size, w);
+    }
+
+    return scan_found(size, w, word);
+}
+
+__attribute__((target("sse4.2,popcnt"))) static size_t scan_ge_sse42(const unsigned char *data, size_t size, size_t idx, unsigned char threshold)
+{
+    const __m128i t = _mm_set1_epi8((char)threshold);
+
+    // a byte b is >= t iff max(b, t) == b
+    for (; idx + 16 <= size; idx += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + idx));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, t), v));
+        if (mask)
+            return idx + __builtin_ctz(mask);
+    }
+
+    return scan_ge_generic(data, size, idx, threshold);
+}
+
+static const CPU_KERNELS sse42_kernels = {
+    CPU_LEVEL_SSE42,
+    popcount_sse42,
+    scan_next_sse42,
+    scan_ge_sse42,
+};
+
+// * AVX2 kernels
+// =========================================================
+
+__attribute__((target("avx2,popcnt,bmi"))) static size_t popcount_avx2(const unsigned char *data, size_t byte_size)
+{
+    // nibble lookup table: popcount of 0..15, repeated in both 128-bit lanes
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 32 <= byte_size; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i lo = _mm256_and_si256(v, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+
+    size_t count = (size_t)_mm256_extract_epi64(acc, 0) + (size_t)_mm256_extract_epi64(acc, 1) +
+                   (size_t)_mm256_extract_epi64(acc, 2) + (size_t)_mm256_extract_epi64(acc, 3);
+
+    return count + popcount_words(data + i, byte_size - i);
+}
+
+__attribute__((target("avx2,popcnt,bmi"))) static size_t scan_next_avx2(const unsigned char *data, size_t size, size_t idx)
+{
+    if (idx >= size)
+        return size;
+
+    size_t w;
+    uint64_t word;
+    size_t byte_size = scan_first_word(data, size, idx, &w, &word);
+    size_t n_words = (byte_size + 7) / 8;
+
+    while (word == 0)
+    {
+        w++;
+
+        // skip zero 256-bit blocks
+        while (w * 8 + 32 <= byte_size)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(data + w * 8));
+            if (!_mm256_testz_si256(v, v))
+                break;
+            w += 4;
+        }
+
+        if (w >= n_words)
+            return size;
+        word = load_word(data, byte_size, w);
+    }
+
+    return scan_found(size, w, word);
+}
+
+__attribute__((target("avx2,popcnt,bmi"))) static size_t scan_ge_avx2(const unsigned char *data, size_t size, size_t idx, unsigned char threshold)
+{
+    const __m256i t = _mm256_set1_epi8((char)threshold);
+
+    for (; idx + 32 <= size; idx += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + idx));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v));
+        if (mask)
+            return idx + __builtin_ctz(mask);
+    }
+
+    return scan_ge_generic(data, size, idx, threshold);
+}
+
+static const CPU_KERNELS avx2_kernels = {
+    CPU_LEVEL_AVX2,
+    popcount_avx2,
+    scan_next_avx2,
+    scan_ge_avx2,
+};
+
+// * AVX-512 F/BW kernels
+// =========================================================
+
+__attribute__((target("avx512f,avx512bw,popcnt,bmi"))) static size_t popcount_avx512(const unsigned char *data, size_t byte_size)
+{
+    const __m512i lut = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    __m512i acc = _mm512_setzero_si512();
+
+    size_t i = 0;
+    for (; i + 64 <= byte_size; i += 64)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(data + i));
+        __m512i lo = _mm512_and_si512(v, low_mask);
+        __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask);
+        __m512i cnt = _mm512_add_epi8(_mm512_shuffle_epi8(lut, lo), _mm512_shuffle_epi8(lut, hi));
+        acc = _mm512_add_epi64(acc, _mm512_sad_epu8(cnt, _mm512_setzero_si512()));
+    }
+
+    return (size_t)_mm512_reduce_add_epi64(acc) + popcount_words(data + i, byte_size - i);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt,bmi"))) static size_t scan_next_avx512(const unsigned char *data, size_t size, size_t idx)
+{
+    if (idx >= size)
+        return size;
+
+    size_t w;
+    uint64_t word;
+    size_t byte_size = scan_first_word(data, size, idx, &w, &word);
+    size_t n_words = (byte_size + 7) / 8;
+
+    while (word == 0)
+    {
+        w++;
+
+        // skip zero 512-bit blocks
+        while (w * 8 + 64 <= byte_size)
+        {
+            __m512i v = _mm512_loadu_si512((const void *)(data + w * 8));
+            if (_mm512_test_epi64_mask(v, v))
+                break;
+            w += 8;
+        }
+
+        if (w >= n_words)
+            return size;
+        word = load_word(data, byte_size, w);
+    }
+
+    return scan_found(size, w, word);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt,bmi"))) static size_t scan_ge_avx512(const unsigned char *data, size_t size, size_t idx, unsigned char threshold)
+{
+    const __m512i t = _mm512_set1_epi8((char)threshold);
+
+    for (; idx + 64 <= size; idx += 64)
+    {
+        __mmask64 mask = _mm512_cmpge_epu8_mask(_mm512_loadu_si512((const void *)(data + idx)), t);
+        if (mask)
+            return idx + __builtin_ctzll(mask);
+    }
+
+    return scan_ge_generic(data, size, idx, threshold);
+}
+
+static const CPU_KERNELS avx512_kernels = {
+    CPU_LEVEL_AVX512,
+    popcount_avx512,
+    scan_next_avx512,
+    scan_ge_avx512,
+};
+
+#endif // CPU_DISPATCH_X86
+
+// * Detection and selection
+// =========================================================
+
+CPU_LEVEL cpu_detect_level(void)
+{
+#ifdef CPU_DISPATCH_X86
+    __builtin_cpu_init(); // reads cpuid (and the OS-enabled AVX state)
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return CPU_LEVEL_AVX512;
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return CPU_LEVEL_AVX2;
+
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+        return CPU_LEVEL_SSE42;
+#endif
+
+    return CPU_LEVEL_GENERIC;
+}
+
+const char *cpu_level_to_string(CPU_LEVEL level)
+{
+    switch (level)
+    {
+    case CPU_LEVEL_SSE42:
+        return "sse4.2";
+    case CPU_LEVEL_AVX2:
+        return "avx2";
+    case CPU_LEVEL_AVX512:
+        return "avx512";
+    default:
+        return "generic";
+    }
+}
+
+const CPU_KERNELS *cpu_kernels_for_level(CPU_LEVEL level)
+{
+#ifdef CPU_DISPATCH_X86
+    switch (level)
+    {
+    case CPU_LEVEL_AVX512:
+        return &avx512_kernels;
+    case CPU_LEVEL_AVX2:
+        return &avx2_kernels;
+    case CPU_LEVEL_SSE42:
+        return &sse42_kernels;
+    default:
+        break;
+    }
+#else
+    (void)level;
+#endif
+
+    return &generic_kernels;
+}
+
+/**
+ * @brief Compares the given kernels with the generic ones on a dense and a sparse pattern.
+ *
+ * @description:
+ * The patterns use a bit size that is not a multiple of 8, 64 or 512, so the
+ * tail handling of every kernel is exercised. Popcount is checked over the whole
+ * buffer and over unaligned sub-buffers, set-bit scanning from every index of both
+ * patterns, and the byte threshold scan from every index of the dense pattern.
+ *
+ * @param kernels The kernel table to validate.
+ * @return 1 if all results match, 0 otherwise.
+ */
+int cpu_dispatch_self_test(const CPU_KERNELS *kernels)
+{
+    enum
+    {
+        TEST_BITS = 8 * 300 + 13,
+        TEST_BYTES = (TEST_BITS + 7) / 8
+    };
+
+    unsigned char dense[TEST_BYTES], sparse[TEST_BYTES];
+
+    // deterministic pseudo-random dense pattern, and a sparse one with few set bits
+    uint32_t state = 137;
+    for (int i = 0; i < TEST_BYTES; i++)
+    {
+        state = state * 1103515245u + 12345u;
+        dense[i] = (unsigned char)(state >> 16);
+    }
+    memset(sparse, 0, TEST_BYTES);
+    sparse[3] = 0x10;
+    sparse[200] = 0x01;
+    sparse[TEST_BYTES - 1] = 0x10; // bit 2412, the last valid bit
+
+    // 1. popcount over the whole buffer and unaligned sub-buffers
+    for (int offset = 0; offset < 9; offset++)
+        if (generic_kernels.popcount(dense + offset, TEST_BYTES - offset) != kernels->popcount(dense + offset, TEST_BYTES - offset))
+            return 0;
+
+    // 2. scanning from every index
+    for (size_t idx = 0; idx <= TEST_BITS; idx++)
+    {
+        if (generic_kernels.scan_next(dense, TEST_BITS, idx) != kernels->scan_next(dense, TEST_BITS, idx))
+            return 0;
+        if (generic_kernels.scan_next(sparse, TEST_BITS, idx) != kernels->scan_next(sparse, TEST_BITS, idx))
+            return 0;
+    }
+
+    // 3. byte threshold scanning from every index, thresholds across the sign bit
+    const unsigned char thresholds[] = {0, 1, 100, 128, 200, 255};
+    for (size_t t = 0; t < sizeof(thresholds); t++)
+        for (size_t idx = 0; idx <= TEST_BYTES; idx++)
+            if (generic_kernels.scan_ge(dense, TEST_BYTES, idx, thresholds[t]) != kernels->scan_ge(dense, TEST_BYTES, idx, thresholds[t]))
+                return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Selects the kernel table of the host, run once through pthread_once.
+ */
+static void cpu_dispatch_select(void)
+{
+    CPU_LEVEL detected = cpu_detect_level();
+    CPU_LEVEL level = detected;
+
+    // Forced override, e.g. IZ_CPU_DISPATCH=avx2
+    const char *forced = getenv(CPU_DISPATCH_ENV);
+    if (forced != NULL && *forced != '\0')
+    {
+        int matched = 0;
+        for (int l = CPU_LEVEL_GENERIC; l <= CPU_LEVEL_AVX512; l++)
+        {
+            if (strcmp(forced, cpu_level_to_string((CPU_LEVEL)l)) == 0)
+            {
+                level = (CPU_LEVEL)l;
+                matched = 1;
+                break;
+            }
+        }
+
+        if (!matched)
+            log_message(LOG_WARNING, "cpu_dispatch: unknown %s value '%s', using %s", CPU_DISPATCH_ENV, forced, cpu_level_to_string(detected));
+        else if (level > detected)
+        {
+            log_message(LOG_WARNING, "cpu_dispatch: %s=%s not supported by this host, using %s", CPU_DISPATCH_ENV, forced, cpu_level_to_string(detected));
+            level = detected;
+        }
+    }
+
+    const CPU_KERNELS *kernels = cpu_kernels_for_level(level);
+
+    // Startup self-test: never trust a kernel that disagrees with the generic one
+    if (kernels != &generic_kernels && !cpu_dispatch_self_test(kernels))
+    {
+        log_message(LOG_ERROR, "cpu_dispatch: self-test failed for %s kernels, using generic", cpu_level_to_string(kernels->level));
+        kernels = &generic_kernels;
+    }
+
+    active_kernels = kernels;
+    log_message(LOG_DEBUG, "cpu_dispatch: detected %s, using %s kernels", cpu_level_to_string(detected), cpu_level_to_string(kernels->level));
+}
+
+void cpu_dispatch_init(void)
+{
+    pthread_once(&dispatch_once, cpu_dispatch_select);
+}
+
+const CPU_KERNELS *cpu_kernels(void)
+{
+    cpu_dispatch_init();
+    return active_kernels;
+}
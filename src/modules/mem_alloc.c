@@ -0,0 +1,401 @@
+/**
+ * @file mem_alloc.c
+ * @brief Aligned and huge-page-backed buffer allocation, see mem_alloc.h.
+ *
+ * @description:
+ * Each buffer is preceded by a MEM_HEADER recording how it was obtained, so
+ * mem_free and mem_realloc work the same on heap and mapped buffers. Mapped
+ * buffers are placed on a 2 MB boundary, which transparent huge pages need to
+ * back the whole range; the header occupies the first MEM_ALIGN bytes.
+ *
+ * The header also records the kind of the buffer, so mem_realloc and mem_free
+ * update the counters of the kind it was allocated as.
+ */
+
+#define _GNU_SOURCE // For mremap and MAP_HUGETLB
+#include <iZ.h>
+#include <pthread.h> // For pthread_once
+#include <unistd.h>  // For sysconf
+
+#if defined(__linux__)
+#define MEM_HAVE_MMAP
+#include <sys/mman.h> // For mmap, madvise, mremap
+#endif
+
+/**
+ * @struct MEM_HEADER
+ * @brief Bookkeeping stored right before every buffer.
+ *
+ * @param base The address returned by malloc or mmap.
+ * @param size The usable size of the buffer.
+ * @param map_size The size of the mapping, 0 for heap buffers.
+ * @param kind The MEM_KIND the buffer is accounted to.
+ */
+typedef struct
+{
+    void *base;
+    size_t size;
+    size_t map_size;
+    int kind;
+} MEM_HEADER;
+
+// Slack of a heap buffer: room for the header plus the worst-case alignment shift
+#define MEM_HEAP_SLACK (sizeof(MEM_HEADER) + MEM_ALIGN)
+
+static int alloc_flags = MEM_ALLOC_HUGEPAGE;
+static pthread_once_t alloc_once = PTHREAD_ONCE_INIT;
+
+// Counters of each kind, the last slot for the total, updated atomically
+static MEM_USAGE usage[MEM_KINDS + 1];
+
+static const char *mem_kind_names[MEM_KINDS] = {"other", "bitmap", "primes", "vx", "arena"};
+
+/**
+ * @brief Reads the IZ_MEM_ALLOC environment variable, run once through pthread_once.
+ */
+static void mem_alloc_read_env(void)
+{
+    const char *env = getenv(MEM_ALLOC_ENV);
+    if (env == NULL || *env == '\0')
+        return;
+
+    // e.g. IZ_MEM_ALLOC=hugetlb,prefault
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s", env);
+
+    int flags = MEM_ALLOC_DEFAULT;
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        if (strcmp(token, "hugepage") == 0)
+            flags |= MEM_ALLOC_HUGEPAGE;
+        else if (strcmp(token, "hugetlb") == 0)
+            flags |= MEM_ALLOC_HUGETLB;
+        else if (strcmp(token, "prefault") == 0)
+            flags |= MEM_ALLOC_PREFAULT;
+        else if (strcmp(token, "none") != 0)
+            log_message(LOG_WARNING, "mem_alloc: unknown %s value '%s', ignored", MEM_ALLOC_ENV, token);
+    }
+
+    alloc_flags = flags;
+}
+
+int mem_alloc_get_flags(void)
+{
+    pthread_once(&alloc_once, mem_alloc_read_env);
+    return alloc_flags;
+}
+
+void mem_alloc_set_flags(int flags)
+{
+    // read the environment first, so it can't override an explicit setting later
+    pthread_once(&alloc_once, mem_alloc_read_env);
+    alloc_flags = flags & (MEM_ALLOC_HUGEPAGE | MEM_ALLOC_HUGETLB | MEM_ALLOC_PREFAULT);
+}
+
+/**
+ * @brief Returns the header of a buffer.
+ */
+static inline MEM_HEADER *mem_header(void *ptr)
+{
+    return (MEM_HEADER *)ptr - 1;
+}
+
+/**
+ * @brief Writes one byte per page of a fresh buffer, so the kernel maps every page now.
+ *
+ * @param data The buffer, whose contents are not yet meaningful.
+ * @param size The size of the buffer.
+ */
+static void mem_prefault(unsigned char *data, size_t size)
+{
+    volatile unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i += 4096)
+        bytes[i] = 0;
+}
+
+/**
+ * @brief Returns the first MEM_ALIGN boundary of a heap block that leaves room for the header.
+ *
+ * @param base The start of a heap block of at least size + MEM_HEAP_SLACK bytes.
+ * @return unsigned char* The aligned start of the buffer.
+ */
+static inline unsigned char *mem_heap_data(unsigned char *base)
+{
+    uintptr_t data = ((uintptr_t)base + sizeof(MEM_HEADER) + MEM_ALIGN - 1) & ~(uintptr_t)(MEM_ALIGN - 1);
+    return (unsigned char *)data;
+}
+
+/**
+ * @brief Writes the header of a heap buffer.
+ *
+ * @param data The aligned start of the buffer.
+ * @param base The start of its heap block.
+ * @param size The usable size of the buffer.
+ * @param kind The MEM_KIND of the buffer.
+ * @return void* data.
+ */
+static void *mem_heap_header(unsigned char *data, unsigned char *base, size_t size, int kind)
+{
+    MEM_HEADER *header = mem_header(data);
+    header->base = base;
+    header->size = size;
+    header->map_size = 0;
+    header->kind = kind;
+    return data;
+}
+
+/**
+ * @brief Raises the peak of a counter slot to bytes, if higher.
+ */
+static void mem_usage_peak(int slot, uint64_t bytes)
+{
+    uint64_t peak = __atomic_load_n(&usage[slot].peak_bytes, __ATOMIC_RELAXED);
+    while (bytes > peak &&
+           !__atomic_compare_exchange_n(&usage[slot].peak_bytes, &peak, bytes, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+/**
+ * @brief Adds the change of the live bytes of a buffer, and an allocation or a release, to its kind and the total.
+ *
+ * @param kind The MEM_KIND of the buffer.
+ * @param old_size The bytes before, 0 for an allocation.
+ * @param new_size The bytes after, 0 for a release.
+ * @param allocs 1 for an allocation, 0 otherwise.
+ * @param frees 1 for a release, 0 otherwise.
+ */
+static void mem_usage_update(int kind, size_t old_size, size_t new_size, int allocs, int frees)
+{
+    if (kind < 0 || kind >= MEM_KINDS)
+        kind = MEM_KIND_OTHER;
+
+    int slots[2] = {kind, MEM_KINDS};
+    for (int i = 0; i < 2; i++)
+    {
+        MEM_USAGE *u = &usage[slots[i]];
+        __atomic_add_fetch(&u->allocs, allocs, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&u->frees, frees, __ATOMIC_RELAXED);
+
+        // unsigned wrap-around subtracts a shrink
+        uint64_t bytes = __atomic_add_fetch(&u->bytes, (uint64_t)new_size - (uint64_t)old_size, __ATOMIC_RELAXED);
+        if (new_size > old_size)
+            mem_usage_peak(slots[i], bytes);
+    }
+}
+
+#ifdef MEM_HAVE_MMAP
+/**
+ * @brief Rounds the mapping of a buffer of size bytes up to the huge page size.
+ */
+static inline size_t mem_map_size(size_t size)
+{
+    return (size + MEM_ALIGN + MEM_HUGEPAGE_MIN_SIZE - 1) & ~(MEM_HUGEPAGE_MIN_SIZE - 1);
+}
+
+/**
+ * @brief Maps a buffer with huge pages, as set by flags.
+ *
+ * @param size The usable size of the buffer.
+ * @param flags The allocation flags.
+ * @param kind The MEM_KIND of the buffer.
+ * @return void* The buffer (zeroed, as all anonymous mappings), or NULL if mapping fails.
+ */
+static void *mem_map(size_t size, int flags, int kind)
+{
+    size_t map_size = mem_map_size(size);
+    unsigned char *base = NULL;
+
+#ifdef MAP_HUGETLB
+    if (flags & MEM_ALLOC_HUGETLB)
+    {
+        int populate = (flags & MEM_ALLOC_PREFAULT) ? MAP_POPULATE : 0;
+        void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+        if (map != MAP_FAILED)
+            base = map;
+        else
+            log_message(LOG_DEBUG, "mem_alloc: no hugetlbfs pages for %zu bytes, using transparent huge pages", map_size);
+    }
+#endif
+
+    if (base == NULL)
+    {
+        // over-map by one huge page, then trim to a huge page boundary
+        size_t span = map_size + MEM_HUGEPAGE_MIN_SIZE;
+        void *map = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED)
+            return NULL;
+
+        uintptr_t start = (uintptr_t)map;
+        uintptr_t aligned = (start + MEM_HUGEPAGE_MIN_SIZE - 1) & ~(uintptr_t)(MEM_HUGEPAGE_MIN_SIZE - 1);
+        if (aligned > start)
+            munmap(map, aligned - start);
+        if (aligned + map_size < start + span)
+            munmap((void *)(aligned + map_size), start + span - aligned - map_size);
+        base = (unsigned char *)aligned;
+
+#ifdef MADV_HUGEPAGE
+        madvise(base, map_size, MADV_HUGEPAGE);
+#endif
+        if (flags & MEM_ALLOC_PREFAULT)
+            mem_prefault(base, map_size);
+    }
+
+    MEM_HEADER *header = mem_header(base + MEM_ALIGN);
+    header->base = base;
+    header->size = size;
+    header->map_size = map_size;
+    header->kind = kind;
+    return base + MEM_ALIGN;
+}
+#endif
+
+void *mem_alloc_kind(size_t size, int zeroed, MEM_KIND kind)
+{
+    int flags = mem_alloc_get_flags();
+
+#ifdef MEM_HAVE_MMAP
+    if ((flags & (MEM_ALLOC_HUGEPAGE | MEM_ALLOC_HUGETLB)) && size >= MEM_HUGEPAGE_MIN_SIZE)
+    {
+        void *ptr = mem_map(size, flags, kind);
+        if (ptr != NULL)
+        {
+            mem_usage_update(kind, 0, size, 1, 0);
+            return ptr;
+        }
+    }
+#endif
+
+    unsigned char *base = zeroed ? calloc(1, size + MEM_HEAP_SLACK) : malloc(size + MEM_HEAP_SLACK);
+    if (base == NULL)
+        return NULL;
+
+    void *ptr = mem_heap_header(mem_heap_data(base), base, size, kind);
+    if (flags & MEM_ALLOC_PREFAULT)
+        mem_prefault(ptr, size);
+    mem_usage_update(kind, 0, size, 1, 0);
+    return ptr;
+}
+
+void *mem_alloc(size_t size, int zeroed)
+{
+    return mem_alloc_kind(size, zeroed, MEM_KIND_OTHER);
+}
+
+void *mem_alloc_pages(size_t size, MEM_KIND kind)
+{
+    // the header takes the page before the buffer, which spans whole pages of its own
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t span = MAX((size + page - 1) / page, (size_t)1) * page;
+    void *base = NULL;
+    if (posix_memalign(&base, page, page + span) != 0)
+        return NULL;
+
+    void *ptr = mem_heap_header((unsigned char *)base + page, base, size, kind);
+    mem_usage_update(kind, 0, size, 1, 0);
+    return ptr;
+}
+
+void *mem_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+        return mem_alloc(size, 0);
+
+    MEM_HEADER *header = mem_header(ptr);
+    int kind = header->kind;
+
+#ifdef MEM_HAVE_MMAP
+    if (header->map_size != 0)
+    {
+        // the data stays at offset MEM_ALIGN of the mapping, wherever mremap moves it
+        size_t map_size = mem_map_size(size);
+        unsigned char *base = mremap(header->base, header->map_size, map_size, MREMAP_MAYMOVE);
+        if (base == MAP_FAILED)
+        {
+            // e.g. hugetlbfs mappings on older kernels: copy to a new buffer
+            void *copy = mem_alloc_kind(size, 0, kind);
+            if (copy == NULL)
+                return NULL;
+
+            memcpy(copy, ptr, MIN(header->size, size));
+            mem_free(ptr);
+            return copy;
+        }
+
+        header = mem_header(base + MEM_ALIGN);
+        mem_usage_update(kind, header->size, size, 0, 0);
+        header->base = base;
+        header->size = size;
+        header->map_size = map_size;
+        return base + MEM_ALIGN;
+    }
+#endif
+
+    unsigned char *old_base = header->base;
+    size_t old_offset = (unsigned char *)ptr - old_base;
+    size_t old_size = header->size;
+
+    unsigned char *base = realloc(old_base, size + MEM_HEAP_SLACK);
+    if (base == NULL)
+        return NULL;
+
+    // realloc keeps only malloc's alignment: shift the data if its aligned offset changed
+    unsigned char *data = mem_heap_data(base);
+    if ((size_t)(data - base) != old_offset)
+        memmove(data, base + old_offset, MIN(old_size, size));
+
+    // the header goes in last, it may overlap where the data was
+    mem_usage_update(kind, old_size, size, 0, 0);
+    return mem_heap_header(data, base, size, kind);
+}
+
+void mem_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    MEM_HEADER *header = mem_header(ptr);
+    mem_usage_update(header->kind, header->size, 0, 0, 1);
+
+#ifdef MEM_HAVE_MMAP
+    if (header->map_size != 0)
+    {
+        munmap(header->base, header->map_size);
+        return;
+    }
+#endif
+
+    free(header->base);
+}
+
+void mem_usage_alloc(MEM_KIND kind, size_t size)
+{
+    mem_usage_update(kind, 0, size, 1, 0);
+}
+
+void mem_usage_free(MEM_KIND kind, size_t size)
+{
+    mem_usage_update(kind, size, 0, 0, 1);
+}
+
+void mem_usage_get(MEM_USAGE_REPORT *report)
+{
+    for (int slot = 0; slot <= MEM_KINDS; slot++)
+    {
+        MEM_USAGE *u = slot < MEM_KINDS ? &report->kind[slot] : &report->total;
+        u->allocs = __atomic_load_n(&usage[slot].allocs, __ATOMIC_RELAXED);
+        u->frees = __atomic_load_n(&usage[slot].frees, __ATOMIC_RELAXED);
+        u->bytes = __atomic_load_n(&usage[slot].bytes, __ATOMIC_RELAXED);
+        u->peak_bytes = __atomic_load_n(&usage[slot].peak_bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void mem_usage_reset_peaks(void)
+{
+    for (int slot = 0; slot <= MEM_KINDS; slot++)
+        __atomic_store_n(&usage[slot].peak_bytes, __atomic_load_n(&usage[slot].bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+const char *mem_kind_name(MEM_KIND kind)
+{
+    return (kind >= 0 && kind < MEM_KINDS) ? mem_kind_names[kind] : "unknown";
+}
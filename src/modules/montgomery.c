@@ -0,0 +1,618 @@
+/**
+ * @file montgomery.c
+ * @brief Native Montgomery arithmetic and probable-prime tests for fixed-width integers.
+ *
+ * @description:
+ * This file implements 128-bit Montgomery multiplication with R = 2^128 on top of
+ * 64x64 -> 128-bit products, and the Baillie-PSW test built on it. Restricting the
+ * modulus to n < 2^127 (U128_PRIME_LIMIT is 2^126) keeps every intermediate of the
+ * reduction below 2^256 and every residue below 2n < 2^128, so no carries need to
+ * be tracked beyond the one of the low half.
+ *
+ * Below 2^64, the deterministic Miller-Rabin test runs on the single-word
+ * Montgomery arithmetic inlined from montgomery.h.
+ */
+
+#include <iZ.h>
+
+typedef __uint128_t u128;
+
+/**
+ * @brief Montgomery context of an odd modulus n < 2^127.
+ */
+typedef struct
+{
+    u128 n;         ///< The modulus
+    u128 n_inv;     ///< -n^-1 mod 2^128
+    u128 one;       ///< R mod n, i.e. 1 in Montgomery form
+    u128 minus_one; ///< n - one, i.e. -1 in Montgomery form
+    u128 r2;        ///< R^2 mod n, to convert into Montgomery form
+} MONT128;
+
+// * 128-bit Montgomery arithmetic
+// =========================================================
+
+// Computes the 256-bit product a * b as hi:lo
+static inline void mul_wide(u128 a, u128 b, u128 *hi, u128 *lo)
+{
+    uint64_t a0 = (uint64_t)a, a1 = (uint64_t)(a >> 64);
+    uint64_t b0 = (uint64_t)b, b1 = (uint64_t)(b >> 64);
+
+    u128 p00 = (u128)a0 * b0;
+    u128 p01 = (u128)a0 * b1;
+    u128 p10 = (u128)a1 * b0;
+    u128 p11 = (u128)a1 * b1;
+
+    u128 mid = (p00 >> 64) + (uint64_t)p01 + (uint64_t)p10;
+    *lo = (mid << 64) | (uint64_t)p00;
+    *hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+// Montgomery reduction of hi:lo < n * 2^128, returns hi:lo * R^-1 mod n
+static inline u128 mont_redc(const MONT128 *m, u128 hi, u128 lo)
+{
+    u128 q = lo * m->n_inv;
+    u128 qn_hi, qn_lo;
+    mul_wide(q, m->n, &qn_hi, &qn_lo);
+
+    // lo + qn_lo = 0 mod 2^128, with a carry iff lo != 0
+    u128 t = hi + qn_hi + (lo != 0);
+    return t >= m->n ? t - m->n : t;
+}
+
+static inline u128 mont_mul(const MONT128 *m, u128 a, u128 b)
+{
+    u128 hi, lo;
+    mul_wide(a, b, &hi, &lo);
+    return mont_redc(m, hi, lo);
+}
+
+static inline u128 mont_add(const MONT128 *m, u128 a, u128 b)
+{
+    u128 s = a + b;
+    return s >= m->n ? s - m->n : s;
+}
+
+static inline u128 mont_sub(const MONT128 *m, u128 a, u128 b)
+{
+    return a >= b ? a - b : a + m->n - b;
+}
+
+// a / 2 mod n, linear so it applies to Montgomery forms as is
+static inline u128 mont_half(const MONT128 *m, u128 a)
+{
+    return (a & 1) ? (a + m->n) >> 1 : a >> 1;
+}
+
+static inline u128 mont_to(const MONT128 *m, u128 a)
+{
+    return mont_mul(m, a % m->n, m->r2);
+}
+
+static void mont_init(MONT128 *m, u128 n)
+{
+    m->n = n;
+
+    // Newton iteration for n^-1 mod 2^128, each step doubles the correct bits (3 -> 192)
+    u128 inv = n;
+    for (int i = 0; i < 6; i++)
+        inv *= 2 - n * inv;
+    m->n_inv = -inv;
+
+    // R mod n = (2^128 - n) mod n, then R^2 mod n by 128 modular doublings
+    m->one = (-n) % n;
+    m->minus_one = n - m->one;
+    m->r2 = m->one;
+    for (int i = 0; i < 128; i++)
+        m->r2 = mont_add(m, m->r2, m->r2);
+}
+
+static u128 mont_pow(const MONT128 *m, u128 base, u128 e)
+{
+    u128 result = m->one;
+    for (int bit = 127 - (e >> 64 ? __builtin_clzll((uint64_t)(e >> 64)) : 64 + __builtin_clzll((uint64_t)e));
+         bit >= 0; bit--)
+    {
+        result = mont_mul(m, result, result);
+        if ((e >> bit) & 1)
+            result = mont_mul(m, result, base);
+    }
+    return result;
+}
+
+static inline int u128_ctz(u128 a)
+{
+    uint64_t lo = (uint64_t)a;
+    return lo ? __builtin_ctzll(lo) : 64 + __builtin_ctzll((uint64_t)(a >> 64));
+}
+
+static inline int u128_bit_length(u128 a)
+{
+    uint64_t hi = (uint64_t)(a >> 64);
+    return hi ? 128 - __builtin_clzll(hi) : 64 - __builtin_clzll((uint64_t)a);
+}
+
+// Jacobi symbol (a/n) for odd n
+static int u128_jacobi(u128 a, u128 n)
+{
+    int j = 1;
+    a %= n;
+
+    while (a != 0)
+    {
+        while ((a & 1) == 0)
+        {
+            a >>= 1;
+            int r = n & 7;
+            if (r == 3 || r == 5)
+                j = -j;
+        }
+
+        u128 t = a;
+        a = n;
+        n = t;
+        if ((a & 3) == 3 && (n & 3) == 3)
+            j = -j;
+        a %= n;
+    }
+
+    return n == 1 ? j : 0;
+}
+
+// * mpz_t conversions and integer square root
+// =========================================================
+
+int u128_from_mpz(__uint128_t *out, mpz_t z)
+{
+    if (mpz_sgn(z) < 0 || mpz_sizeinbase(z, 2) > 128)
+        return 0;
+
+    uint64_t words[2] = {0, 0};
+    mpz_export(words, NULL, -1, sizeof(uint64_t), 0, 0, z);
+    *out = ((u128)words[1] << 64) | words[0];
+    return 1;
+}
+
+void u128_to_mpz(mpz_t z, __uint128_t n)
+{
+    uint64_t words[2] = {(uint64_t)n, (uint64_t)(n >> 64)};
+    mpz_import(z, 2, -1, sizeof(uint64_t), 0, 0, words);
+}
+
+__uint128_t u128_isqrt(__uint128_t n)
+{
+    if (n < 2)
+        return n;
+
+    // Start above the root from the floating-point estimate, then Newton down
+    u128 x = (u128)sqrtl((long double)n);
+    x += (x >> 40) + 2;
+
+    for (;;)
+    {
+        u128 y = (x + n / x) >> 1;
+        if (y >= x)
+            break;
+        x = y;
+    }
+
+    return x;
+}
+
+// * Probable-prime tests
+// =========================================================
+
+static int sprp_mont(const MONT128 *m, uint64_t base)
+{
+    u128 n = m->n;
+    u128 d = n - 1;
+    int s = u128_ctz(d);
+    d >>= s;
+
+    u128 b = base % n;
+    if (b == 0)
+        return 1;
+
+    u128 x = mont_pow(m, mont_to(m, b), d);
+    if (x == m->one || x == m->minus_one)
+        return 1;
+
+    for (int r = 1; r < s; r++)
+    {
+        x = mont_mul(m, x, x);
+        if (x == m->minus_one)
+            return 1;
+        if (x == m->one)
+            return 0;
+    }
+
+    return 0;
+}
+
+static int slprp_mont(const MONT128 *m)
+{
+    u128 n = m->n;
+
+    // Perfect squares have no D with (D/n) = -1
+    u128 root = u128_isqrt(n);
+    if (root * root == n)
+        return 0;
+
+    // Selfridge's method A: first D in 5, -7, 9, -11, ... with (D/n) = -1
+    int64_t D = 5;
+    for (;;)
+    {
+        u128 d_mod_n = D > 0 ? (u128)D % n : n - ((u128)(-D) % n);
+        int j = u128_jacobi(d_mod_n, n);
+        if (j == -1)
+            break;
+        if (j == 0 && (D > 0 ? (u128)D : (u128)(-D)) != n)
+            return 0;
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+
+    // P = 1, Q = (1 - D) / 4
+    int64_t Q = (1 - D) / 4;
+    u128 d_m = mont_to(m, D > 0 ? (u128)D : n - (u128)(-D));
+    u128 q_m = mont_to(m, Q >= 0 ? (u128)Q : n - (u128)(-Q));
+
+    // n + 1 = d * 2^s
+    u128 d = n + 1;
+    int s = u128_ctz(d);
+    d >>= s;
+
+    // Binary ladder for U_d, V_d and Q^d, from U_1 = 1, V_1 = P = 1
+    u128 U = m->one, V = m->one, Qk = q_m;
+    for (int bit = u128_bit_length(d) - 2; bit >= 0; bit--)
+    {
+        // k -> 2k
+        U = mont_mul(m, U, V);
+        V = mont_sub(m, mont_mul(m, V, V), mont_add(m, Qk, Qk));
+        Qk = mont_mul(m, Qk, Qk);
+
+        // k -> k + 1
+        if ((d >> bit) & 1)
+        {
+            u128 U_next = mont_half(m, mont_add(m, U, V));
+            u128 V_next = mont_half(m, mont_add(m, mont_mul(m, d_m, U), V));
+            U = U_next;
+            V = V_next;
+            Qk = mont_mul(m, Qk, q_m);
+        }
+    }
+
+    if (U == 0 || V == 0)
+        return 1;
+
+    // V_{d * 2^r} for 0 < r < s
+    for (int r = 1; r < s; r++)
+    {
+        V = mont_sub(m, mont_mul(m, V, V), mont_add(m, Qk, Qk));
+        Qk = mont_mul(m, Qk, Qk);
+        if (V == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+// Strong probable-prime test of m->n to a base, in 64-bit Montgomery form
+static int sprp_mont64(const MONT64 *m, uint64_t base)
+{
+    uint64_t n = m->n;
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+
+    uint64_t b = base % n;
+    if (b == 0)
+        return 1;
+
+    uint64_t minus_one = n - m->one;
+    uint64_t x = m->one, b_m = mont64_to(m, b);
+    for (int bit = 63 - __builtin_clzll(d); bit >= 0; bit--)
+    {
+        x = mont64_mul(m, x, x);
+        if ((d >> bit) & 1)
+            x = mont64_mul(m, x, b_m);
+    }
+
+    if (x == m->one || x == minus_one)
+        return 1;
+
+    for (int r = 1; r < s; r++)
+    {
+        x = mont64_mul(m, x, x);
+        if (x == minus_one)
+            return 1;
+        if (x == m->one)
+            return 0;
+    }
+
+    return 0;
+}
+
+// Miller-Rabin with Sinclair's bases, deterministic for odd n < 2^64
+static int is_prime_mont64(uint64_t n)
+{
+    static const uint64_t bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    MONT64 m;
+    mont64_init(&m, n);
+    for (int i = 0; i < (int)(sizeof(bases) / sizeof(bases[0])); i++)
+        if (!sprp_mont64(&m, bases[i]))
+            return 0;
+
+    return 1;
+}
+
+int u128_is_sprp(__uint128_t n, uint64_t base)
+{
+    MONT128 m;
+    mont_init(&m, n);
+    return sprp_mont(&m, base);
+}
+
+int u128_is_slprp(__uint128_t n)
+{
+    MONT128 m;
+    mont_init(&m, n);
+    return slprp_mont(&m);
+}
+
+int u128_is_prime(__uint128_t n)
+{
+    static const uint32_t small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
+    const int small_count = sizeof(small_primes) / sizeof(small_primes[0]);
+
+    if (n < 2)
+        return 0;
+
+    // Trial division by the small primes through a single wide reduction
+    uint64_t n_mod = n % 614889782588491410ULL; // 2 * 3 * 5 * ... * 47
+    for (int i = 0; i < small_count; i++)
+    {
+        if (n == small_primes[i])
+            return 1;
+        if (n_mod % small_primes[i] == 0)
+            return 0;
+    }
+
+    // No factor up to 47 and n < 53^2
+    if (n < 53 * 53)
+        return 1;
+
+    // Single-word arithmetic below 2^64, where Miller-Rabin is deterministic
+    if ((n >> 64) == 0)
+        return is_prime_mont64((uint64_t)n);
+
+    MONT128 m;
+    mont_init(&m, n);
+    return sprp_mont(&m, 2) && slprp_mont(&m);
+}
+
+int u64_is_prime(uint64_t n)
+{
+    static const uint32_t small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
+
+    if (n < 2)
+        return 0;
+
+    for (int i = 0; i < (int)(sizeof(small_primes) / sizeof(small_primes[0])); i++)
+    {
+        if (n == small_primes[i])
+            return 1;
+        if (n % small_primes[i] == 0)
+            return 0;
+    }
+
+    // No factor up to 47 and n < 53^2
+    if (n < 53 * 53)
+        return 1;
+
+    return is_prime_mont64(n);
+}
+
+// * Fixed-width multi-limb Montgomery arithmetic
+// =========================================================
+// The kernels below take the limb count L as a constant: they are always
+// inlined into one instance per width, so every loop has a fixed trip count
+// and all temporaries live on the stack.
+
+// a >= b over L limbs
+static inline __attribute__((always_inline)) int limbs_geq(const uint64_t *a, const uint64_t *b, const int L)
+{
+    for (int i = L - 1; i >= 0; i--)
+        if (a[i] != b[i])
+            return a[i] > b[i];
+    return 1;
+}
+
+// a -= b over L limbs, returns the borrow
+static inline __attribute__((always_inline)) uint64_t limbs_sub(uint64_t *a, const uint64_t *b, const int L)
+{
+    uint64_t borrow = 0;
+    for (int i = 0; i < L; i++)
+    {
+        u128 d = (u128)a[i] - b[i] - borrow;
+        a[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    return borrow;
+}
+
+// r = a * b * R^-1 mod n, by coarsely integrated operand scanning (CIOS)
+static inline __attribute__((always_inline)) void limbs_mont_mul(uint64_t *r, const uint64_t *a, const uint64_t *b,
+                                                                 const uint64_t *n, uint64_t n_inv, const int L)
+{
+    uint64_t t[MONT_MAX_LIMBS + 2];
+    for (int j = 0; j < L + 2; j++)
+        t[j] = 0;
+
+    for (int i = 0; i < L; i++)
+    {
+        // t += a * b[i]
+        uint64_t carry = 0;
+        for (int j = 0; j < L; j++)
+        {
+            u128 s = (u128)a[j] * b[i] + t[j] + carry;
+            t[j] = (uint64_t)s;
+            carry = (uint64_t)(s >> 64);
+        }
+        u128 s = (u128)t[L] + carry;
+        t[L] = (uint64_t)s;
+        t[L + 1] = (uint64_t)(s >> 64);
+
+        // t = (t + m * n) / 2^64, with m chosen to clear the low limb
+        uint64_t m = t[0] * n_inv;
+        s = (u128)m * n[0] + t[0];
+        carry = (uint64_t)(s >> 64);
+        for (int j = 1; j < L; j++)
+        {
+            s = (u128)m * n[j] + t[j] + carry;
+            t[j - 1] = (uint64_t)s;
+            carry = (uint64_t)(s >> 64);
+        }
+        s = (u128)t[L] + carry;
+        t[L - 1] = (uint64_t)s;
+        t[L] = t[L + 1] + (uint64_t)(s >> 64);
+    }
+
+    // t < 2n, a single subtraction completes the reduction
+    if (t[L] != 0 || limbs_geq(t, n, L))
+        limbs_sub(t, n, L);
+
+    for (int j = 0; j < L; j++)
+        r[j] = t[j];
+}
+
+// a = 2a mod n
+static inline __attribute__((always_inline)) void limbs_mont_double(uint64_t *a, const uint64_t *n, const int L)
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < L; i++)
+    {
+        uint64_t next = a[i] >> 63;
+        a[i] = (a[i] << 1) | carry;
+        carry = next;
+    }
+
+    if (carry || limbs_geq(a, n, L))
+        limbs_sub(a, n, L);
+}
+
+static inline __attribute__((always_inline)) int limbs_equal(const uint64_t *a, const uint64_t *b, const int L)
+{
+    for (int i = 0; i < L; i++)
+        if (a[i] != b[i])
+            return 0;
+    return 1;
+}
+
+// Base-2 strong probable-prime test of an odd n > 2 of at most L limbs
+static inline __attribute__((always_inline)) int limbs_sprp2(const uint64_t *n, const int L)
+{
+    // -n^-1 mod 2^64, Newton iteration from 3 correct bits
+    uint64_t inv = n[0];
+    for (int i = 0; i < 5; i++)
+        inv *= 2 - n[0] * inv;
+    uint64_t n_inv = -inv;
+
+    int top = L - 1;
+    while (n[top] == 0)
+        top--;
+    int bits = 64 * top + 64 - __builtin_clzll(n[top]);
+
+    // one = R mod n: 2^(bits - 1) < n, doubled up to 2^(64L)
+    uint64_t one[MONT_MAX_LIMBS], minus_one[MONT_MAX_LIMBS], x[MONT_MAX_LIMBS];
+    for (int i = 0; i < L; i++)
+        one[i] = 0;
+    one[(bits - 1) / 64] = (uint64_t)1 << ((bits - 1) % 64);
+    for (int i = bits - 1; i < 64 * L; i++)
+        limbs_mont_double(one, n, L);
+
+    for (int i = 0; i < L; i++)
+        minus_one[i] = n[i];
+    limbs_sub(minus_one, one, L);
+
+    // n - 1 = d * 2^s, n odd so n - 1 differs from n in bit 0 only
+    int s = 1;
+    while (((n[s / 64] >> (s % 64)) & 1) == 0)
+        s++;
+
+    // x = 2^d: left-to-right over the bits of n - 1 above s, doubling for set bits
+    for (int i = 0; i < L; i++)
+        x[i] = one[i];
+    for (int bit = bits - 1; bit >= s; bit--)
+    {
+        limbs_mont_mul(x, x, x, n, n_inv, L);
+        if ((n[bit / 64] >> (bit % 64)) & 1)
+            limbs_mont_double(x, n, L);
+    }
+
+    if (limbs_equal(x, one, L) || limbs_equal(x, minus_one, L))
+        return 1;
+
+    for (int r = 1; r < s; r++)
+    {
+        limbs_mont_mul(x, x, x, n, n_inv, L);
+        if (limbs_equal(x, minus_one, L))
+            return 1;
+        if (limbs_equal(x, one, L))
+            return 0;
+    }
+
+    return 0;
+}
+
+// Kernel instances for 256, 512 and 1024-bit moduli
+#define LIMBS_SPRP2_KERNEL(name, limbs)  \
+    static int name(const uint64_t *n)   \
+    {                                    \
+        return limbs_sprp2(n, limbs);    \
+    }
+
+LIMBS_SPRP2_KERNEL(sprp2_4_limbs, 4)
+LIMBS_SPRP2_KERNEL(sprp2_8_limbs, 8)
+LIMBS_SPRP2_KERNEL(sprp2_16_limbs, 16)
+
+int mont_is_sprp2(mpz_t n)
+{
+    size_t bits = mpz_sizeinbase(n, 2);
+    if (bits > 64 * MONT_MAX_LIMBS)
+        return -1;
+
+    uint64_t limbs[MONT_MAX_LIMBS] = {0};
+    mpz_export(limbs, NULL, -1, sizeof(uint64_t), 0, 0, n);
+
+    if (bits <= 256)
+        return sprp2_4_limbs(limbs);
+    if (bits <= 512)
+        return sprp2_8_limbs(limbs);
+    return sprp2_16_limbs(limbs);
+}
+
+void mont_set_tier_max_bits(int max_bits)
+{
+    // the tier bound lives in the tuning profile, which clamps it
+    IZ_TUNING tuning = *iz_tuning();
+    tuning.mont_tier_max_bits = max_bits;
+    iz_tuning_apply(&tuning);
+}
+
+int iZ_probab_prime(mpz_t n, int rounds)
+{
+    __uint128_t n128;
+    if (u128_from_mpz(&n128, n) && n128 < U128_PRIME_LIMIT)
+        return u128_is_prime(n128);
+
+    // Reject composites natively, confirm the survivors with GMP
+    if (mpz_sizeinbase(n, 2) <= (size_t)iz_tuning()->mont_tier_max_bits)
+    {
+        // Even n > 2^126 is composite, the Montgomery kernels need odd moduli
+        if (mpz_even_p(n) || mont_is_sprp2(n) == 0)
+            return 0;
+    }
+
+    return mpz_probab_prime_p(n, rounds);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file numa_topology.c
+ * @brief NUMA node discovery, thread pinning and memory placement, see numa_topology.h.
+ *
+ * @description:
+ * The CPUs of each node are read from /sys/devices/system/node/node<N>/cpulist.
+ * Threads are pinned with pthread_setaffinity_np and buffers bound with the mbind
+ * system call, so the library needs no libnuma.
+ */
+
+#define _GNU_SOURCE // For cpu_set_t and pthread_setaffinity_np
+#include <iZ.h>
+#include <pthread.h> // For pthread_once, pthread_setaffinity_np
+#include <unistd.h>  // For syscall, sysconf
+
+#if defined(__linux__)
+#include <sched.h>       // For cpu_set_t
+#include <sys/syscall.h> // For SYS_mbind
+
+#define NUMA_MPOL_PREFERRED 1 ///< mbind mode: allocate on the node if it has free memory
+#define NUMA_MPOL_MF_MOVE 2   ///< mbind flag: migrate the pages already placed elsewhere
+
+static int node_count = 1;
+static int node_ids[NUMA_MAX_NODES]; // sysfs id of each node with CPUs
+static cpu_set_t node_cpus[NUMA_MAX_NODES];
+static pthread_once_t topology_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Parses a sysfs CPU list, e.g. "0-15,32-47", into a CPU set.
+ *
+ * @param list The CPU list.
+ * @param cpus The CPU set to fill.
+ * @return int The number of CPUs in the list.
+ */
+static int numa_parse_cpulist(const char *list, cpu_set_t *cpus)
+{
+    CPU_ZERO(cpus);
+
+    const char *s = list;
+    while (*s != '\0' && *s != '\n')
+    {
+        char *end;
+        long first = strtol(s, &end, 10);
+        if (end == s)
+            break;
+
+        long last = first;
+        if (*end == '-')
+        {
+            s = end + 1;
+            last = strtol(s, &end, 10);
+        }
+
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+            CPU_SET(cpu, cpus);
+
+        s = (*end == ',') ? end + 1 : end;
+    }
+
+    return CPU_COUNT(cpus);
+}
+
+/**
+ * @brief Reads the nodes and their CPUs from sysfs, run once through pthread_once.
+ */
+static void numa_read_topology(void)
+{
+    int count = 0;
+
+    for (int id = 0; id < NUMA_MAX_NODES && count < NUMA_MAX_NODES; id++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+            continue;
+
+        char list[4096];
+        int has_list = fgets(list, sizeof(list), file) != NULL;
+        fclose(file);
+
+        // memory-only nodes have an empty list
+        if (has_list && numa_parse_cpulist(list, &node_cpus[count]) > 0)
+            node_ids[count++] = id;
+    }
+
+    if (count == 0)
+    {
+        // no NUMA information: one node holding every CPU
+        node_ids[0] = 0;
+        CPU_ZERO(&node_cpus[0]);
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < cpus && cpu < CPU_SETSIZE; cpu++)
+            CPU_SET(cpu, &node_cpus[0]);
+        count = 1;
+    }
+
+    node_count = count;
+    log_message(LOG_DEBUG, "numa_topology: %d node(s) with CPUs", node_count);
+}
+
+int numa_node_count(void)
+{
+    pthread_once(&topology_once, numa_read_topology);
+    return node_count;
+}
+
+int numa_node_cpu_count(int node)
+{
+    if (node < 0 || node >= numa_node_count())
+        return 0;
+
+    return CPU_COUNT(&node_cpus[node]);
+}
+
+int numa_worker_node(int worker, int workers)
+{
+    if (workers <= 0)
+        return 0;
+
+    return (int)((int64_t)worker * numa_node_count() / workers);
+}
+
+int numa_pin_thread(int node)
+{
+    if (node < 0 || node >= numa_node_count() || CPU_COUNT(&node_cpus[node]) == 0)
+        return 0;
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &node_cpus[node]) == 0;
+}
+
+int numa_bind_buffer(void *ptr, size_t size, int node)
+{
+    if (ptr == NULL || node < 0 || node >= numa_node_count())
+        return 0;
+
+#ifdef SYS_mbind
+    // the pages entirely within the buffer
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)ptr + page - 1) & ~(page - 1);
+    uintptr_t last = ((uintptr_t)ptr + size) & ~(page - 1);
+    if (last <= first)
+        return 1;
+
+    unsigned long mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+    int id = node_ids[node];
+    mask[id / (8 * sizeof(unsigned long))] = 1UL << (id % (8 * sizeof(unsigned long)));
+
+    // the kernel reads maxnode - 1 bits of the mask
+    long status = syscall(SYS_mbind, (void *)first, (unsigned long)(last - first), NUMA_MPOL_PREFERRED,
+                          mask, (unsigned long)NUMA_MAX_NODES + 1, NUMA_MPOL_MF_MOVE);
+    return status == 0;
+#else
+    (void)size;
+    return 0;
+#endif
+}
+
+#else
+
+// Without sysfs and CPU affinity: one node holding every CPU, no pinning or binding
+
+int numa_node_count(void)
+{
+    return 1;
+}
+
+int numa_node_cpu_count(int node)
+{
+    return node == 0 ? (int)sysconf(_SC_NPROCESSORS_ONLN) : 0;
+}
+
+int numa_worker_node(int worker, int workers)
+{
+    (void)worker;
+    (void)workers;
+    return 0;
+}
+
+int numa_pin_thread(int node)
+{
+    (void)node;
+    return 0;
+}
+
+int numa_bind_buffer(void *ptr, size_t size, int node)
+{
+    (void)ptr;
+    (void)size;
+    (void)node;
+    return 0;
+}
+
+#endif
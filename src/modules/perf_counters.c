@@ -0,0 +1,347 @@
+/**
+ * @file perf_counters.c
+ * @brief Hardware performance counters of the library phases, see perf_counters.h.
+ *
+ * @description:
+ * The events are opened as one perf_event_open group led by the cycles counter,
+ * so one read() returns them all, scheduled together on the PMU. Each phase
+ * boundary reads the group and the clock, and adds the difference since the
+ * previous boundary to the phase on top of a per-thread stack, which makes the
+ * counts of a phase exclusive of the phases it encloses.
+ */
+
+#include <iZ.h>
+#include <time.h>   // For clock_gettime
+#include <unistd.h> // For syscall, read, close
+
+#if defined(__linux__)
+#define PERF_HAVE_EVENTS
+#include <linux/perf_event.h> // For perf_event_attr
+#include <sys/ioctl.h>        // For ioctl
+#include <sys/syscall.h>      // For SYS_perf_event_open
+#endif
+
+#define PERF_MAX_DEPTH 16 ///< Deepest nesting of phases tracked
+
+/**
+ * @struct PERF_SAMPLE
+ * @brief A reading of the clock and of the counters at a phase boundary.
+ */
+typedef struct
+{
+    double seconds;
+    uint64_t count[IZ_PERF_EVENTS];
+} PERF_SAMPLE;
+
+/**
+ * @struct PERF_THREAD
+ * @brief The counters of a thread and the totals of its phases.
+ */
+typedef struct
+{
+    int is_active;                       ///< Between iz_perf_start and iz_perf_stop
+    int group_fd;                        ///< Group leader, -1 if no event is counted
+    int fds[IZ_PERF_EVENTS];             ///< Descriptor of each event, -1 if unavailable
+    int depth;                           ///< Number of phases entered and not left
+    IZ_PERF_PHASE stack[PERF_MAX_DEPTH]; ///< The phases entered, innermost last
+    PERF_SAMPLE start, last;             ///< Readings at iz_perf_start and at the last boundary
+    IZ_PERF_REPORT report;               ///< Totals so far
+} PERF_THREAD;
+
+static __thread PERF_THREAD perf_thread = {.group_fd = -1};
+
+static const char *perf_phase_names[IZ_PERF_PHASES] = {"marking", "extraction", "primality", "io"};
+
+#ifdef PERF_HAVE_EVENTS
+/**
+ * @brief Opens one user-space counter of the calling thread.
+ *
+ * @param type The perf event type.
+ * @param config The event of the type.
+ * @param group_fd The group leader, -1 to open a leader.
+ * @return int The descriptor, -1 if the event is not supported or not permitted.
+ */
+static int perf_open(uint32_t type, uint64_t config, int group_fd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd == -1; // the leader starts the group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/**
+ * @brief Returns the config of a cache read-miss event of the PERF_TYPE_HW_CACHE type.
+ */
+static uint64_t perf_cache_miss(uint64_t cache)
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+/**
+ * @brief Reads the clock and the counters of the calling thread.
+ *
+ * @description: The counts are scaled by time_enabled / time_running, which is 1
+ * unless the kernel multiplexed the group with other events.
+ */
+static void perf_sample(PERF_THREAD *t, PERF_SAMPLE *sample)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sample->seconds = now.tv_sec + now.tv_nsec * 1e-9;
+    memset(sample->count, 0, sizeof(sample->count));
+
+#ifdef PERF_HAVE_EVENTS
+    if (t->group_fd == -1)
+        return;
+
+    // nr, time_enabled, time_running, then the values in the order of opening
+    uint64_t values[3 + IZ_PERF_EVENTS];
+    if (read(t->group_fd, values, sizeof(values)) < (ssize_t)(3 * sizeof(uint64_t)) || values[2] == 0)
+        return;
+
+    double scale = (double)values[1] / values[2];
+    uint64_t v = 0;
+    for (int e = 0; e < IZ_PERF_EVENTS && v < values[0]; e++)
+        if (t->fds[e] != -1)
+            sample->count[e] = (uint64_t)(values[3 + v++] * scale);
+#else
+    (void)t;
+#endif
+}
+
+/**
+ * @brief Adds the difference between two readings to a total.
+ */
+static void perf_accumulate(IZ_PERF_TOTALS *totals, const PERF_SAMPLE *from, const PERF_SAMPLE *to)
+{
+    totals->seconds += to->seconds - from->seconds;
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+        totals->count[e] += to->count[e] >= from->count[e] ? to->count[e] - from->count[e] : 0;
+}
+
+/**
+ * @brief Closes the counters of the calling thread.
+ */
+static void perf_close(PERF_THREAD *t)
+{
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+    {
+        if (t->fds[e] != -1)
+            close(t->fds[e]);
+        t->fds[e] = -1;
+    }
+    t->group_fd = -1;
+}
+
+/**
+ * @brief Opens the performance counters of the calling thread and resets the phase totals.
+ *
+ * @description: The events the PMU or the kernel refuses are left out of the group
+ * and marked unavailable in the report. A second call restarts the counting.
+ *
+ * @return int The number of events counted, 0 if none can be (the phases are still timed).
+ */
+int iz_perf_start(void)
+{
+    PERF_THREAD *t = &perf_thread;
+    if (t->is_active)
+        perf_close(t);
+
+    memset(t, 0, sizeof(PERF_THREAD));
+    t->group_fd = -1;
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+        t->fds[e] = -1;
+
+    int opened = 0;
+
+#ifdef PERF_HAVE_EVENTS
+    const uint32_t types[IZ_PERF_EVENTS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    const uint64_t configs[IZ_PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, perf_cache_miss(PERF_COUNT_HW_CACHE_L1D),
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, perf_cache_miss(PERF_COUNT_HW_CACHE_DTLB)};
+
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+    {
+        t->fds[e] = perf_open(types[e], configs[e], t->group_fd);
+        if (t->fds[e] == -1)
+            continue;
+
+        if (t->group_fd == -1)
+            t->group_fd = t->fds[e];
+        t->report.available[e] = 1;
+        opened++;
+    }
+
+    if (t->group_fd != -1)
+    {
+        ioctl(t->group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(t->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+
+    if (opened == 0)
+        log_info("Performance counters unavailable, phases are timed only.");
+
+    t->is_active = 1;
+    perf_sample(t, &t->start);
+    t->last = t->start;
+    return opened;
+}
+
+/**
+ * @brief Stops counting, fills a report and closes the counters of the calling thread.
+ *
+ * @description: Phases still open are closed at this point.
+ *
+ * @param report Receives the counts, may be NULL to discard them.
+ */
+void iz_perf_stop(IZ_PERF_REPORT *report)
+{
+    PERF_THREAD *t = &perf_thread;
+    if (!t->is_active)
+    {
+        if (report != NULL)
+            memset(report, 0, sizeof(IZ_PERF_REPORT));
+        return;
+    }
+
+    PERF_SAMPLE now;
+    perf_sample(t, &now);
+    if (t->depth > 0)
+        perf_accumulate(&t->report.phase[t->stack[MIN(t->depth, PERF_MAX_DEPTH) - 1]], &t->last, &now);
+    perf_accumulate(&t->report.total, &t->start, &now);
+    t->report.total.calls = 1;
+
+    if (report != NULL)
+        *report = t->report;
+
+    perf_close(t);
+    t->is_active = 0;
+    t->depth = 0;
+}
+
+/**
+ * @brief Enters a phase, attributing the counts since the last boundary to the enclosing one.
+ *
+ * @param phase The phase entered. A no-op outside iz_perf_start / iz_perf_stop.
+ */
+void iz_perf_phase_begin(IZ_PERF_PHASE phase)
+{
+    PERF_THREAD *t = &perf_thread;
+    if (!t->is_active)
+        return;
+
+    PERF_SAMPLE now;
+    perf_sample(t, &now);
+    if (t->depth > 0)
+        perf_accumulate(&t->report.phase[t->stack[MIN(t->depth, PERF_MAX_DEPTH) - 1]], &t->last, &now);
+    t->last = now;
+
+    // deeper phases than tracked are attributed to the deepest tracked one
+    if (t->depth < PERF_MAX_DEPTH)
+    {
+        t->stack[t->depth] = phase;
+        t->report.phase[phase].calls++;
+    }
+    t->depth++;
+}
+
+/**
+ * @brief Leaves the current phase, attributing the counts since the last boundary to it.
+ */
+void iz_perf_phase_end(void)
+{
+    PERF_THREAD *t = &perf_thread;
+    if (!t->is_active || t->depth == 0)
+        return;
+
+    PERF_SAMPLE now;
+    perf_sample(t, &now);
+    perf_accumulate(&t->report.phase[t->stack[MIN(t->depth, PERF_MAX_DEPTH) - 1]], &t->last, &now);
+    t->last = now;
+    t->depth--;
+}
+
+/**
+ * @brief Returns the name of a phase, e.g. "marking".
+ */
+const char *iz_perf_phase_name(IZ_PERF_PHASE phase)
+{
+    return (phase >= 0 && phase < IZ_PERF_PHASES) ? perf_phase_names[phase] : "unknown";
+}
+
+/**
+ * @brief Prints one row of iz_perf_print.
+ */
+static void perf_print_row(const char *name, const IZ_PERF_TOTALS *totals, const IZ_PERF_REPORT *report,
+                           double units, double total_seconds)
+{
+    printf("| %-11s| %-10llu| %-7.1f| %-10.3g", name, (unsigned long long)totals->calls,
+           total_seconds > 0 ? 100 * totals->seconds / total_seconds : 0, 1e9 * totals->seconds / units);
+
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+    {
+        if (report->available[e])
+            printf("| %-10.3g", totals->count[e] / units);
+        else
+            printf("| %-10s", "n/a");
+    }
+
+    if (report->available[IZ_PERF_CYCLES] && report->available[IZ_PERF_INSTRUCTIONS] && totals->count[IZ_PERF_CYCLES])
+        printf("| %-5.2f\n", (double)totals->count[IZ_PERF_INSTRUCTIONS] / totals->count[IZ_PERF_CYCLES]);
+    else
+        printf("| %-5s\n", "n/a");
+}
+
+/**
+ * @brief Prints the counts of each phase, of the time outside the phases and of the run,
+ * per unit of work.
+ *
+ * @description: Each row shows the times the phase was entered, its share of the
+ * wall-clock time, then the ns and the event counts per unit, and the instructions
+ * per cycle. The row "other" is the run outside any phase, e.g. allocation and setup.
+ *
+ * @param report The report of the run.
+ * @param units The units of work of the run, e.g. the primes found or the segments sieved.
+ * @param unit The name of a unit, e.g. "prime".
+ */
+void iz_perf_print(const IZ_PERF_REPORT *report, double units, const char *unit)
+{
+    if (units <= 0)
+        units = 1;
+
+    // the run outside any phase
+    IZ_PERF_TOTALS other = report->total;
+    other.calls = 0;
+    for (int ph = 0; ph < IZ_PERF_PHASES; ph++)
+    {
+        other.seconds -= report->phase[ph].seconds;
+        for (int e = 0; e < IZ_PERF_EVENTS; e++)
+            other.count[e] -= MIN(other.count[e], report->phase[ph].count[e]);
+    }
+    other.seconds = MAX(other.seconds, 0);
+
+    print_line(122);
+    printf("Per %s (%.0f %ss)", unit, units, unit);
+    print_line(122);
+    printf("| %-11s| %-10s| %-7s| %-10s| %-10s| %-10s| %-10s| %-10s| %-10s| %-10s| %-5s",
+           "Phase", "Calls", "Time %", "ns", "Cycles", "Instr", "L1D miss", "LLC miss", "Br miss", "dTLB miss", "IPC");
+    print_line(122);
+
+    for (int ph = 0; ph < IZ_PERF_PHASES; ph++)
+        perf_print_row(perf_phase_names[ph], &report->phase[ph], report, units, report->total.seconds);
+    perf_print_row("other", &other, report, units, report->total.seconds);
+    perf_print_row("total", &report->total, report, units, report->total.seconds);
+
+    print_line(122);
+}
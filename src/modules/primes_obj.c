@@ -36,7 +36,8 @@ PRIMES_OBJ *primes_obj_init(int initial_estimate)
     primes_obj->p_count = 0;
 
     // Allocate memory for the primes array
-    primes_obj->p_array = malloc(initial_estimate * sizeof(uint64_t));
+    // aligned and, for large estimates, backed by huge pages (see mem_alloc.h)
+    primes_obj->p_array = mem_alloc_kind(initial_estimate * sizeof(uint64_t), 0, MEM_KIND_PRIMES);
     if (primes_obj->p_array == NULL)
     {
         log_error("Memory allocation failed for primes array.");
@@ -77,7 +78,7 @@ int primes_obj_resize_to_p_count(PRIMES_OBJ *primes_obj)
     }
 
     // Resize the primes array to fit exactly p_count
-    uint64_t *temp = realloc(primes_obj->p_array, primes_obj->p_count * sizeof(uint64_t));
+    uint64_t *temp = mem_realloc(primes_obj->p_array, primes_obj->p_count * sizeof(uint64_t));
     if (temp == NULL)
     {
         log_error("Memory reallocation failed for primes array.");
@@ -102,7 +103,7 @@ void primes_obj_free(PRIMES_OBJ *primes_obj)
     // Free the primes array if it has been allocated
     if (primes_obj->p_array != NULL)
     {
-        free(primes_obj->p_array);
+        mem_free(primes_obj->p_array);
         primes_obj->p_array = NULL; // Prevent dangling pointer
     }
 
@@ -158,13 +159,9 @@ int primes_obj_verify_hash(PRIMES_OBJ *primes_obj)
 }
 
 /**
- * @brief Writes the PRIMES_OBJ structure to a binary file.
- *
- * @param file_path The path to the file where the structure will be written.
- * @param primes_obj A pointer to the PRIMES_OBJ structure to be written.
- * @return int 1 on success, 0 on failure.
+ * @brief Does the work of primes_obj_write_file, outside the io phase hooks.
  */
-int primes_obj_write_file(const char *file_path, PRIMES_OBJ *primes_obj)
+static int primes_obj_write_io(const char *file_path, PRIMES_OBJ *primes_obj)
 {
     primes_obj_compute_hash(primes_obj);
 
@@ -179,14 +176,26 @@ int primes_obj_write_file(const char *file_path, PRIMES_OBJ *primes_obj)
     return 1; // Success
 }
 
-// Read the PRIMES_OBJ from a binary file
 /**
- * @brief Reads a PRIMES_OBJ structure from a binary file.
+ * @brief Writes the PRIMES_OBJ structure to a binary file.
  *
- * @param file_path The path to the file from which the structure will be read.
- * @return PRIMES_OBJ* Pointer to the read PRIMES_OBJ structure, or NULL on failure.
+ * @param file_path The path to the file where the structure will be written.
+ * @param primes_obj A pointer to the PRIMES_OBJ structure to be written.
+ * @return int 1 on success, 0 on failure.
  */
-PRIMES_OBJ *primes_obj_read_file(const char *file_path)
+int primes_obj_write_file(const char *file_path, PRIMES_OBJ *primes_obj)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    int is_written = primes_obj_write_io(file_path, primes_obj);
+    IZ_PERF_END();
+    return is_written;
+}
+
+// Read the PRIMES_OBJ from a binary file
+/**
+ * @brief Does the work of primes_obj_read_file, outside the io phase hooks.
+ */
+static PRIMES_OBJ *primes_obj_read_io(const char *file_path)
 {
     FILE *file = fopen(file_path, "rb");
     if (!file)
@@ -212,3 +221,17 @@ PRIMES_OBJ *primes_obj_read_file(const char *file_path)
 
     return primes_obj;
 }
+
+/**
+ * @brief Reads a PRIMES_OBJ structure from a binary file.
+ *
+ * @param file_path The path to the file from which the structure will be read.
+ * @return PRIMES_OBJ* Pointer to the read PRIMES_OBJ structure, or NULL on failure.
+ */
+PRIMES_OBJ *primes_obj_read_file(const char *file_path)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    PRIMES_OBJ *primes_obj = primes_obj_read_io(file_path);
+    IZ_PERF_END();
+    return primes_obj;
+}
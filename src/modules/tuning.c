@@ -0,0 +1,183 @@
+/**
+ * @file tuning.c
+ * @brief Loading, saving and applying the tuning profile, see tuning.h.
+ *
+ * @description:
+ * The keys of a profile are described by one table, mapping each key to its
+ * field of IZ_TUNING and its valid range, so parsing, clamping and writing
+ * share the same definitions.
+ */
+
+#include <iZ.h>
+#include <stddef.h>  // For offsetof
+#include <pthread.h> // For pthread_once
+
+/**
+ * @struct TUNING_KEY
+ * @brief A key of the profile file and the IZ_TUNING field it sets.
+ */
+typedef struct
+{
+    const char *name;    ///< Key in the profile file
+    size_t offset;       ///< Offset of the field in IZ_TUNING
+    int is_size;         ///< 1 for a size_t field, 0 for an int field
+    long long min;       ///< Smallest valid value
+    long long max;       ///< Largest valid value
+    const char *comment; ///< Written above the key by iz_tuning_save
+} TUNING_KEY;
+
+static const TUNING_KEY tuning_keys[] = {
+    {"vx_limit", offsetof(IZ_TUNING, vx_limit), 0, 2, 7,
+     "primes multiplied into the vx of sieve_iZm"},
+    {"pattern_max_p", offsetof(IZ_TUNING, pattern_max_p), 0, 3, BITMAP_PATTERN_MAX_P,
+     "root primes below this are cleared by word patterns"},
+    {"izm_block_rows", offsetof(IZ_TUNING, izm_block_rows), 0, 1, SIEVE_MAX_BLOCK_ROWS,
+     "rows of iZm marked together by sieve_iZm"},
+    {"vx_block_rows", offsetof(IZ_TUNING, vx_block_rows), 0, 1, SIEVE_MAX_BLOCK_ROWS,
+     "VX segments marked together by the range sieves"},
+    {"w30_segment_bytes", offsetof(IZ_TUNING, w30_segment_bytes), 1, 4096, 16 << 20,
+     "default segment size of sieve_wheel30"},
+    {"vx_sieve_depth", offsetof(IZ_TUNING, vx_sieve_depth), 0, 0, INT32_MAX,
+     "largest root prime sieved on huge-y VX segments, 0 for all below vx"},
+    {"test_rounds", offsetof(IZ_TUNING, test_rounds), 0, 1, 100,
+     "Miller-Rabin rounds of the primality tests"},
+    {"mont_tier_max_bits", offsetof(IZ_TUNING, mont_tier_max_bits), 0, 0, 64 * MONT_MAX_LIMBS,
+     "largest candidate size of the fixed-width Montgomery tier"},
+    {"threads", offsetof(IZ_TUNING, threads), 0, 0, 4096,
+     "default thread count of the parallel drivers, 0 for one per online CPU"},
+};
+
+#define TUNING_KEY_COUNT (int)(sizeof(tuning_keys) / sizeof(tuning_keys[0]))
+
+static IZ_TUNING active_tuning;
+static pthread_once_t tuning_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Reads a field of a profile as a long long.
+ */
+static long long tuning_get(const IZ_TUNING *tuning, const TUNING_KEY *key)
+{
+    const char *field = (const char *)tuning + key->offset;
+    return key->is_size ? (long long)*(const size_t *)field : (long long)*(const int *)field;
+}
+
+/**
+ * @brief Sets a field of a profile, clamped to the key's range.
+ */
+static void tuning_set(IZ_TUNING *tuning, const TUNING_KEY *key, long long value)
+{
+    value = MAX(key->min, MIN(value, key->max));
+
+    char *field = (char *)tuning + key->offset;
+    if (key->is_size)
+        *(size_t *)field = (size_t)value;
+    else
+        *(int *)field = (int)value;
+}
+
+/**
+ * @brief Loads the profile file into the active profile, run once through pthread_once.
+ */
+static void tuning_init(void)
+{
+    iz_tuning_defaults(&active_tuning);
+
+    const char *path = getenv(IZ_TUNE_ENV);
+    if (path != NULL && *path != '\0')
+    {
+        if (!iz_tuning_load(&active_tuning, path))
+            log_message(LOG_WARNING, "tuning: can't read profile %s, using the defaults", path);
+    }
+    else if (iz_tuning_load(&active_tuning, IZ_TUNE_DEFAULT_PATH))
+        log_message(LOG_DEBUG, "tuning: loaded %s", IZ_TUNE_DEFAULT_PATH);
+}
+
+const IZ_TUNING *iz_tuning(void)
+{
+    pthread_once(&tuning_once, tuning_init);
+    return &active_tuning;
+}
+
+void iz_tuning_defaults(IZ_TUNING *tuning)
+{
+    tuning->vx_limit = 6;
+    tuning->pattern_max_p = BITMAP_PATTERN_MAX_P;
+    tuning->izm_block_rows = SIEVE_IZM_BLOCK_ROWS;
+    tuning->vx_block_rows = SIEVE_VX_BLOCK_ROWS;
+    tuning->w30_segment_bytes = SIEVE_W30_SEGMENT_BYTES;
+    tuning->vx_sieve_depth = 0;
+    tuning->test_rounds = TEST_ROUNDS;
+    tuning->mont_tier_max_bits = MONT_TIER_MAX_BITS;
+    tuning->threads = 0;
+}
+
+int iz_tuning_load(IZ_TUNING *tuning, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return 0;
+
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+
+        char name[64];
+        long long value;
+        if (sscanf(line, " %63[a-z0-9_] = %lld", name, &value) != 2)
+        {
+            if (strspn(line, " \t\r\n") != strlen(line))
+                log_message(LOG_WARNING, "tuning: %s:%d: expected 'key = value'", path, line_number);
+            continue;
+        }
+
+        int k = 0;
+        while (k < TUNING_KEY_COUNT && strcmp(tuning_keys[k].name, name) != 0)
+            k++;
+
+        if (k == TUNING_KEY_COUNT)
+            log_message(LOG_WARNING, "tuning: %s:%d: unknown key '%s', ignored", path, line_number, name);
+        else
+            tuning_set(tuning, &tuning_keys[k], value);
+    }
+
+    fclose(file);
+    return 1;
+}
+
+int iz_tuning_save(const IZ_TUNING *tuning, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        log_message(LOG_ERROR, "tuning: can't write profile %s", path);
+        return 0;
+    }
+
+    fprintf(file, "# iZ-lib tuning profile, see include/tuning.h\n");
+    for (int k = 0; k < TUNING_KEY_COUNT; k++)
+        fprintf(file, "\n# %s\n%s = %lld\n", tuning_keys[k].comment, tuning_keys[k].name,
+                tuning_get(tuning, &tuning_keys[k]));
+
+    int status = fclose(file) == 0;
+    if (!status)
+        log_message(LOG_ERROR, "tuning: can't write profile %s", path);
+    return status;
+}
+
+void iz_tuning_apply(const IZ_TUNING *tuning)
+{
+    // load first, so the profile file can't override the new values later
+    pthread_once(&tuning_once, tuning_init);
+
+    IZ_TUNING clamped = *tuning;
+    for (int k = 0; k < TUNING_KEY_COUNT; k++)
+        tuning_set(&clamped, &tuning_keys[k], tuning_get(tuning, &tuning_keys[k]));
+
+    active_tuning = clamped;
+}
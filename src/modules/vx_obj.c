@@ -10,10 +10,114 @@
 
 #include <vx_obj.h>
 #include <iZ.h>
+#include <unistd.h> // For sysconf
 
+/**
+ * @brief Looks up the compiled-in VX_ASSETS of a given vx.
+ *
+ * @param vx The size of the segment.
+ * @return VX_ASSETS* The read-only assets, or NULL if vx was not generated at build time.
+ */
+VX_ASSETS *vx_assets_static(size_t vx)
+{
+    for (int i = 0; i < vx_static_assets_count; i++)
+        if ((size_t)vx_static_assets[i]->vx == vx)
+            return vx_static_assets[i];
+
+    return NULL;
+}
+
+/**
+ * @brief Builds the ROOT_PRIME_TABLE of the first p_count primes for a given vx.
+ *
+ * @description:
+ * Stores each root prime as uint32 alongside x_p normalized for both matrices,
+ * vx mod p and the reciprocal of p. The primes that divide vx are expected to
+ * be the leading ones after 2, 3, as in every vx standard; start is the index
+ * of the first prime that doesn't.
+ *
+ * @param primes The primes in ascending order, starting with 2, 3.
+ * @param p_count The number of primes to include.
+ * @param vx The size of the segment.
+ * @return ROOT_PRIME_TABLE* A pointer to the table, or NULL if memory allocation fails.
+ */
+ROOT_PRIME_TABLE *root_table_init(PRIMES_OBJ *primes, int p_count, size_t vx)
+{
+    ROOT_PRIME_TABLE *table = malloc(sizeof(ROOT_PRIME_TABLE));
+    if (table == NULL)
+    {
+        log_error("Memory allocation failed for root_table.");
+        return NULL;
+    }
+
+    table->p_count = p_count;
+    table->p = mem_alloc(p_count * sizeof(uint32_t), 0);
+    table->x5_p = mem_alloc(p_count * sizeof(uint32_t), 0);
+    table->x7_p = mem_alloc(p_count * sizeof(uint32_t), 0);
+    table->vx_mod_p = mem_alloc(p_count * sizeof(uint32_t), 0);
+    table->p_inv = mem_alloc(p_count * sizeof(uint64_t), 0);
+
+    if (table->p == NULL || table->x5_p == NULL || table->x7_p == NULL ||
+        table->vx_mod_p == NULL || table->p_inv == NULL)
+    {
+        log_error("Memory allocation failed for root_table arrays.");
+        root_table_free(table);
+        return NULL;
+    }
+
+    table->start = p_count;
+    for (int i = 0; i < p_count; i++)
+    {
+        uint64_t p = primes->p_array[i];
+
+        // Normalize x_p to x_p in the matrix of p, else to p - x_p
+        uint64_t x_p = (p + 1) / 6;
+        int p_id = (p % 6 == 1) ? 1 : -1;
+
+        table->p[i] = p;
+        table->x5_p[i] = p_id == -1 ? x_p : p - x_p;
+        table->x7_p[i] = p_id == 1 ? x_p : p - x_p;
+        table->vx_mod_p[i] = vx % p;
+        table->p_inv[i] = fast_mod_inv(p);
+
+        if (i >= 2 && table->vx_mod_p[i] != 0 && table->start == p_count)
+            table->start = i;
+    }
+
+    return table;
+}
+
+void root_table_free(ROOT_PRIME_TABLE *table)
+{
+    if (table == NULL)
+        return;
+
+    mem_free(table->p);
+    mem_free(table->x5_p);
+    mem_free(table->x7_p);
+    mem_free(table->vx_mod_p);
+    mem_free(table->p_inv);
+    free(table);
+}
+
+/**
+ * @brief Initialize the VX_ASSETS of a given vx.
+ *
+ * @description:
+ * For the vx standards generated at build time this is a lookup of the
+ * compiled-in tables. Otherwise, the root primes are sieved and the base
+ * bitmaps pre-sieved for the primes that divide vx.
+ *
+ * @param vx The size of the segment.
+ * @return VX_ASSETS* A pointer to the assets, or NULL if memory allocation fails.
+ */
 VX_ASSETS *vx_assets_init(size_t vx)
 {
-    VX_ASSETS *vx_assets = malloc(sizeof(VX_ASSETS));
+    VX_ASSETS *vx_assets = vx_assets_static(vx);
+    if (vx_assets != NULL)
+        return vx_assets;
+
+    vx_assets = malloc(sizeof(VX_ASSETS));
     if (vx_assets == NULL)
     {
         log_error("Memory allocation failed for vx_assets.");
@@ -21,6 +125,8 @@ VX_ASSETS *vx_assets_init(size_t vx)
     }
 
     vx_assets->vx = vx;
+    vx_assets->is_static = 0;
+    vx_assets->root_table = NULL;
     // get root primes for sieving
     vx_assets->root_primes = sieve_iZ(vx);
     // construct pre-sieved base_x5, base_x7 bitmaps
@@ -28,16 +134,138 @@ VX_ASSETS *vx_assets_init(size_t vx)
     vx_assets->base_x7 = bitmap_create(vx + 10);
     construct_iZm_segment(vx, vx_assets->base_x5, vx_assets->base_x7);
 
+    // wheel metadata per root prime, so the sieve setup doesn't divide per segment
+    vx_assets->root_table = root_table_init(vx_assets->root_primes, vx_assets->root_primes->p_count, vx);
+    if (vx_assets->root_table == NULL)
+    {
+        vx_assets_free(vx_assets);
+        return NULL;
+    }
+
     return vx_assets;
 }
 
+/**
+ * @brief Copies a buffer into pages of its own bound to a NUMA node.
+ *
+ * @description:
+ * The copy starts on a page boundary and is bound before it is written, so every
+ * page of it, the last one included, is placed on the node at its first touch.
+ *
+ * @param data The buffer to copy.
+ * @param size The size of the buffer in bytes.
+ * @param kind The MEM_KIND of the copy.
+ * @param node The NUMA node index.
+ * @return void* The copy, to be freed with mem_free, or NULL if memory allocation fails.
+ */
+static void *replica_copy(const void *data, size_t size, MEM_KIND kind, int node)
+{
+    void *copy = mem_alloc_pages(size, kind);
+    if (copy == NULL)
+        return NULL;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    numa_bind_buffer(copy, (size + page - 1) / page * page, node);
+    memcpy(copy, data, size);
+    return copy;
+}
+
+/**
+ * @brief Copies a root table into heap memory bound to a NUMA node.
+ *
+ * @param table The table to copy.
+ * @param node The NUMA node index.
+ * @return ROOT_PRIME_TABLE* The copy, or NULL if memory allocation fails.
+ */
+static ROOT_PRIME_TABLE *root_table_replicate(ROOT_PRIME_TABLE *table, int node)
+{
+    ROOT_PRIME_TABLE *copy = calloc(1, sizeof(ROOT_PRIME_TABLE));
+    if (copy == NULL)
+        return NULL;
+
+    size_t size32 = table->p_count * sizeof(uint32_t);
+    size_t size64 = table->p_count * sizeof(uint64_t);
+    copy->p_count = table->p_count;
+    copy->start = table->start;
+    copy->p = replica_copy(table->p, size32, MEM_KIND_OTHER, node);
+    copy->x5_p = replica_copy(table->x5_p, size32, MEM_KIND_OTHER, node);
+    copy->x7_p = replica_copy(table->x7_p, size32, MEM_KIND_OTHER, node);
+    copy->vx_mod_p = replica_copy(table->vx_mod_p, size32, MEM_KIND_OTHER, node);
+    copy->p_inv = replica_copy(table->p_inv, size64, MEM_KIND_OTHER, node);
+
+    if (copy->p == NULL || copy->x5_p == NULL || copy->x7_p == NULL ||
+        copy->vx_mod_p == NULL || copy->p_inv == NULL)
+    {
+        root_table_free(copy);
+        return NULL;
+    }
+
+    return copy;
+}
+
+/**
+ * @brief Copies vx assets into heap memory bound to a NUMA node.
+ *
+ * @param vx_assets The vx assets to copy.
+ * @param node The NUMA node index.
+ * @return VX_ASSETS* The replica, or NULL if memory allocation fails.
+ */
+VX_ASSETS *vx_assets_replicate(VX_ASSETS *vx_assets, int node)
+{
+    VX_ASSETS *replica = calloc(1, sizeof(VX_ASSETS));
+    if (replica == NULL)
+    {
+        log_error("Memory allocation failed for vx_assets replica.");
+        return NULL;
+    }
+
+    replica->vx = vx_assets->vx;
+    replica->is_static = 0;
+
+    // the structs are copied with their arrays replaced by bound copies
+    replica->root_primes = calloc(1, sizeof(PRIMES_OBJ));
+    replica->base_x5 = calloc(1, sizeof(BITMAP));
+    replica->base_x7 = calloc(1, sizeof(BITMAP));
+    replica->root_table = root_table_replicate(vx_assets->root_table, node);
+
+    if (replica->root_primes == NULL || replica->base_x5 == NULL ||
+        replica->base_x7 == NULL || replica->root_table == NULL)
+    {
+        log_error("Memory allocation failed for vx_assets replica.");
+        vx_assets_free(replica);
+        return NULL;
+    }
+
+    PRIMES_OBJ *root_primes = vx_assets->root_primes;
+    size_t byte_size = (vx_assets->base_x5->size + 7) / 8;
+    *replica->root_primes = *root_primes;
+    *replica->base_x5 = *vx_assets->base_x5;
+    *replica->base_x7 = *vx_assets->base_x7;
+    replica->root_primes->p_array = replica_copy(root_primes->p_array, root_primes->p_count * sizeof(uint64_t),
+                                                 MEM_KIND_PRIMES, node);
+    replica->base_x5->data = replica_copy(vx_assets->base_x5->data, byte_size, MEM_KIND_BITMAP, node);
+    replica->base_x7->data = replica_copy(vx_assets->base_x7->data, byte_size, MEM_KIND_BITMAP, node);
+
+    if (replica->root_primes->p_array == NULL || replica->base_x5->data == NULL || replica->base_x7->data == NULL)
+    {
+        log_error("Memory allocation failed for vx_assets replica.");
+        vx_assets_free(replica);
+        return NULL;
+    }
+
+    return replica;
+}
+
 void vx_assets_free(VX_ASSETS *vx_assets)
 {
-    if (vx_assets == NULL)
+    // compiled-in tables are shared and read-only
+    if (vx_assets == NULL || vx_assets->is_static)
         return;
 
+    primes_obj_free(vx_assets->root_primes);
     bitmap_free(vx_assets->base_x5);
     bitmap_free(vx_assets->base_x7);
+    root_table_free(vx_assets->root_table);
     free(vx_assets);
     vx_assets = NULL;
 }
@@ -75,11 +303,72 @@ VX_OBJ *vx_init(int vx, char *y)
     vx_obj->vx = vx;
     vx_obj->y = y;
     vx_obj->p_count = 0;
-    vx_obj->p_gaps = malloc(vx / 2 * GAP_SIZE); // initial estimate
+    vx_obj->bit_ops = 0;
+    vx_obj->p_test_ops = 0;
+    vx_obj->p_gaps = mem_alloc_kind(vx / 2 * GAP_SIZE, 0, MEM_KIND_VX); // initial estimate
+
+    return vx_obj;
+}
+
+/**
+ * @brief Initialize a VX_OBJ and its y string in an arena.
+ *
+ * @description:
+ * This function allocates the VX_OBJ structure and the decimal string of y
+ * from the arena, so they are released with it and must not be passed to vx_free.
+ * The p_gaps array is left NULL, to be provided by the caller.
+ *
+ * Parameters:
+ * @param arena The arena to allocate from.
+ * @param vx The segment size.
+ * @param y The segment index in iZm.
+ *
+ * @return VX_OBJ* A pointer to the initialized VX_OBJ structure.
+ *        NULL if memory allocation fails.
+ */
+VX_OBJ *vx_arena_init(ARENA *arena, int vx, mpz_t y)
+{
+    VX_OBJ *vx_obj = arena_alloc(arena, sizeof(VX_OBJ));
+    // mpz_sizeinbase may exceed the digit count by 1, plus the null terminator
+    char *y_str = arena_alloc(arena, mpz_sizeinbase(y, 10) + 2);
+    if (vx_obj == NULL || y_str == NULL)
+    {
+        log_error("Memory allocation failed in vx_arena_init");
+        return NULL;
+    }
+
+    vx_obj->vx = vx;
+    vx_obj->y = mpz_get_str(y_str, 10, y);
+    vx_obj->p_count = 0;
+    vx_obj->p_gaps = NULL;
+    vx_obj->bit_ops = 0;
+    vx_obj->p_test_ops = 0;
 
     return vx_obj;
 }
 
+/**
+ * @brief Free a VX_RANGE and all of its segments.
+ *
+ * @description:
+ * The range, its VX_OBJ headers, y strings and p_gaps arrays all live in
+ * the arena of the range, which is released in one go.
+ *
+ * Parameters:
+ * @param vx_range Pointer to the VX_RANGE to be freed.
+ */
+void vx_range_free(VX_RANGE *vx_range)
+{
+    if (vx_range == NULL)
+        return;
+
+    for (int i = 0; i < vx_range->worker_count; i++)
+        arena_free(vx_range->worker_arenas[i]);
+
+    // The range itself is allocated in its arena
+    arena_free(vx_range->arena);
+}
+
 /**
  * @brief Free the VX_OBJ structure.
  *
@@ -99,7 +388,7 @@ void vx_free(VX_OBJ *vx_obj)
     // clear p_gaps array
     if (vx_obj->p_gaps)
     {
-        free(vx_obj->p_gaps);
+        mem_free(vx_obj->p_gaps);
         vx_obj->p_gaps = NULL;
     }
 
@@ -134,7 +423,7 @@ void vx_resize_p_gaps(VX_OBJ *vx_obj)
     if (vx_obj == NULL)
         return;
 
-    vx_obj->p_gaps = realloc(vx_obj->p_gaps, vx_obj->p_count * sizeof(int));
+    vx_obj->p_gaps = mem_realloc(vx_obj->p_gaps, vx_obj->p_count * GAP_SIZE);
 }
 
 /**
@@ -188,25 +477,9 @@ int vx_verify_hash(VX_OBJ *vx_obj)
 }
 
 /**
- * @brief vx_write_file - Write a VX_OBJ structure to a binary file.
- *
- * @description:
- * This function serializes the VX_OBJ structure into a binary file. It writes the following data:
- *   - The length of the y string (including the terminating null character) followed by the y string.
- *   - The p_count value indicating the number of elements in the p_gaps array.
- *   - The p_gaps array itself.
- *   - A SHA256 hash computed over the p_gaps array for data integrity, which is then written to the file.
- *
- * Parameters:
- * @param vx_obj: Pointer to a VX_OBJ structure containing data to be written.
- * @param filename: The full path of the file to write to. If the filename does not include the
- *            ".vx6" extension, it is automatically appended.
- *
- * @return:
- *   - 1 on successful write,
- *   - 0 if any error occurs (e.g., invalid parameters, failure to open the file, or file write errors).
+ * @brief Does the work of vx_write_file, outside the io phase hooks.
  */
-int vx_write_file(VX_OBJ *vx_obj, char *filename)
+static int vx_write_io(VX_OBJ *vx_obj, char *filename)
 {
     if (vx_obj == NULL || filename == NULL)
         return 0;
@@ -246,27 +519,36 @@ int vx_write_file(VX_OBJ *vx_obj, char *filename)
 }
 
 /**
- * vx_read_file - Read a VX_OBJ structure from a binary file.
+ * @brief vx_write_file - Write a VX_OBJ structure to a binary file.
  *
  * @description:
- * This function reads the VX_OBJ structure from a binary file by performing the following steps:
- *   - Reads the length of the y string and allocates memory for it, then reads the y string.
- *   - Reads the p_count value to determine the number of elements in the p_gaps array.
- *   - Reads the p_gaps array (assuming the p_gaps field in vx_obj has been properly allocated).
- *   - Reads the previously stored SHA256 hash and computes a new hash on the read p_gaps array.
- *   - Compares the computed hash with the read hash to validate data integrity.
+ * This function serializes the VX_OBJ structure into a binary file. It writes the following data:
+ *   - The length of the y string (including the terminating null character) followed by the y string.
+ *   - The p_count value indicating the number of elements in the p_gaps array.
+ *   - The p_gaps array itself.
+ *   - A SHA256 hash computed over the p_gaps array for data integrity, which is then written to the file.
  *
- *  Parameters:
- * @param vx_obj: Pointer to a VX_OBJ structure where the read data will be stored.
- * @param filename: The name (or path) of the file to read from. If the filename does not include the
+ * Parameters:
+ * @param vx_obj: Pointer to a VX_OBJ structure containing data to be written.
+ * @param filename: The full path of the file to write to. If the filename does not include the
  *            ".vx6" extension, it is automatically appended.
  *
  * @return:
- *   - 1 if the file is successfully read and the hash validation passes,
- *   - 0 if any error occurs (e.g., invalid parameters, file read errors, memory allocation failure,
- *         or hash mismatch).
+ *   - 1 on successful write,
+ *   - 0 if any error occurs (e.g., invalid parameters, failure to open the file, or file write errors).
  */
-int vx_read_file(VX_OBJ *vx_obj, char *filename)
+int vx_write_file(VX_OBJ *vx_obj, char *filename)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    int is_written = vx_write_io(vx_obj, filename);
+    IZ_PERF_END();
+    return is_written;
+}
+
+/**
+ * @brief Does the work of vx_read_file, outside the io phase hooks.
+ */
+static int vx_read_io(VX_OBJ *vx_obj, char *filename)
 {
     if (vx_obj == NULL || filename == NULL)
         return 0;
@@ -314,6 +596,35 @@ int vx_read_file(VX_OBJ *vx_obj, char *filename)
     return is_valid;
 }
 
+/**
+ * vx_read_file - Read a VX_OBJ structure from a binary file.
+ *
+ * @description:
+ * This function reads the VX_OBJ structure from a binary file by performing the following steps:
+ *   - Reads the length of the y string and allocates memory for it, then reads the y string.
+ *   - Reads the p_count value to determine the number of elements in the p_gaps array.
+ *   - Reads the p_gaps array (assuming the p_gaps field in vx_obj has been properly allocated).
+ *   - Reads the previously stored SHA256 hash and computes a new hash on the read p_gaps array.
+ *   - Compares the computed hash with the read hash to validate data integrity.
+ *
+ *  Parameters:
+ * @param vx_obj: Pointer to a VX_OBJ structure where the read data will be stored.
+ * @param filename: The name (or path) of the file to read from. If the filename does not include the
+ *            ".vx6" extension, it is automatically appended.
+ *
+ * @return:
+ *   - 1 if the file is successfully read and the hash validation passes,
+ *   - 0 if any error occurs (e.g., invalid parameters, file read errors, memory allocation failure,
+ *         or hash mismatch).
+ */
+int vx_read_file(VX_OBJ *vx_obj, char *filename)
+{
+    IZ_PERF_BEGIN(IZ_PERF_IO);
+    int is_valid = vx_read_io(vx_obj, filename);
+    IZ_PERF_END();
+    return is_valid;
+}
+
 /**
  * @brief Print the p_gaps array in the VX_OBJ structure.
  *
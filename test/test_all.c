@@ -3,8 +3,27 @@
 #include <iZ.h>
 
 // Test functions prototypes
+int testing_cpu_dispatch(void);
+int testing_arena(void);
+int testing_mem_alloc(void);
+int testing_mem_usage(void);
+int testing_vx_tables(void);
 int testing_sieve_integrity(void);
 int testing_sieve_vx(void);
+int testing_sieve_vx_kernels(void);
+int testing_sieve_vx_u128(void);
+int testing_block_sieve(void);
+int testing_vx_range_parallel(void);
+int testing_sieve_state(void);
+int testing_sieve_auto(void);
+int testing_tuning(void);
+int testing_spf_table(void);
+int testing_factor_u64(void);
+int testing_sieve_multiplicative(void);
+int testing_sieve_smooth(void);
+int testing_primes_mod(void);
+int testing_montgomery(void);
+int testing_perf_counters(void);
 int testing_vx_io(void);
 int testing_next_prime_gen(void);
 int testing_prime_gen_algorithms(void);
@@ -19,8 +38,27 @@ int main(void)
 
     int is_success = 0;
     // Run all tests:
+    is_success = testing_cpu_dispatch();
+    is_success = testing_arena();
+    is_success = testing_mem_alloc();
+    is_success = testing_mem_usage();
+    is_success = testing_vx_tables();
     is_success = testing_sieve_integrity();
     is_success = testing_sieve_vx();
+    is_success = testing_sieve_vx_kernels();
+    is_success = testing_sieve_vx_u128();
+    is_success = testing_block_sieve();
+    is_success = testing_vx_range_parallel();
+    is_success = testing_sieve_state();
+    is_success = testing_sieve_auto();
+    is_success = testing_tuning();
+    is_success = testing_spf_table();
+    is_success = testing_factor_u64();
+    is_success = testing_sieve_multiplicative();
+    is_success = testing_sieve_smooth();
+    is_success = testing_primes_mod();
+    is_success = testing_montgomery();
+    is_success = testing_perf_counters();
     is_success = testing_vx_io();
     is_success = testing_next_prime_gen();
     is_success = testing_prime_gen_algorithms();
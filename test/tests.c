@@ -22,6 +22,8 @@ int testing_sieve_integrity(void)
         SieveOfAtkin,
         Sieve_iZ,
         Sieve_iZm,
+        SieveWheel30,
+        SieveLinear,
     };
 
     int models_count = sizeof(models_list) / sizeof(SieveAlgorithm);
@@ -37,6 +39,125 @@ int testing_sieve_integrity(void)
     return is_valid;
 }
 
+/**
+ * @brief Tests the runtime CPU dispatch layer
+ *
+ * Self-tests every kernel level supported by this host against the generic
+ * kernels, then checks bitmap_popcount and bitmap_scan_next of the active
+ * kernels against bit-by-bit reference results.
+ *
+ * @return 1 if all kernels agree, 0 otherwise
+ */
+int testing_cpu_dispatch(void)
+{
+    print_line(92);
+    printf("Testing CPU dispatch kernels");
+    print_line(92);
+
+    CPU_LEVEL detected = cpu_detect_level();
+    printf("Detected level: %s\n", cpu_level_to_string(detected));
+    printf("Active kernels: %s\n", cpu_level_to_string(cpu_kernels()->level));
+
+    int is_valid = 1;
+    for (int level = CPU_LEVEL_GENERIC; level <= (int)detected; level++)
+    {
+        int passed = cpu_dispatch_self_test(cpu_kernels_for_level((CPU_LEVEL)level));
+        printf("Self-test %-8s: %s\n", cpu_level_to_string((CPU_LEVEL)level), passed ? "passed" : "FAILED");
+        is_valid &= passed;
+    }
+
+    // Compare the bitmap API with bit-by-bit results on a pre-sieved segment
+    BITMAP *x5 = bitmap_create(VX6 + 10);
+    BITMAP *x7 = bitmap_create(VX6 + 10);
+    construct_iZm_segment(VX6, x5, x7);
+
+    size_t expected_count = 0, actual_count = 0;
+    for (size_t x = 0; x < x5->size; x++)
+        expected_count += bitmap_get_bit(x5, x);
+
+    for (size_t x = bitmap_scan_next(x5, 0); x < x5->size; x = bitmap_scan_next(x5, x + 1))
+    {
+        if (!bitmap_get_bit(x5, x))
+            is_valid = 0;
+        actual_count++;
+    }
+
+    if (bitmap_popcount(x5) != expected_count || actual_count != expected_count)
+        is_valid = 0;
+
+    bitmap_free(x5);
+    bitmap_free(x7);
+
+    if (is_valid)
+        printf("Success: CPU dispatch kernels match the reference results\n");
+    else
+        printf("Error: CPU dispatch kernels mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the compiled-in VX_ASSETS tables
+ *
+ * Verifies that the tables generated at build time for VX6 match the root
+ * primes and base segments computed at runtime by sieve_iZ and construct_iZm_segment.
+ *
+ * @return 1 if the tables match, 0 otherwise
+ */
+int testing_vx_tables(void)
+{
+    print_line(92);
+    printf("Testing compiled-in VX tables against runtime construction");
+    print_line(92);
+
+    VX_ASSETS *static_assets = vx_assets_static(VX6);
+    if (static_assets == NULL)
+    {
+        printf("Error: VX6 tables are not compiled in, check VX_TABLES in the Makefile\n");
+        return 0;
+    }
+
+    BITMAP *x5 = bitmap_create(VX6 + 10);
+    BITMAP *x7 = bitmap_create(VX6 + 10);
+    construct_iZm_segment(VX6, x5, x7);
+    PRIMES_OBJ *root_primes = sieve_iZ(VX6);
+
+    size_t byte_size = (x5->size + 7) / 8;
+    int is_valid = static_assets->is_static &&
+                   static_assets->base_x5->size == x5->size &&
+                   memcmp(static_assets->base_x5->data, x5->data, byte_size) == 0 &&
+                   memcmp(static_assets->base_x7->data, x7->data, byte_size) == 0 &&
+                   static_assets->root_primes->p_count == root_primes->p_count &&
+                   memcmp(static_assets->root_primes->p_array, root_primes->p_array, root_primes->p_count * sizeof(uint64_t)) == 0;
+
+    // Root prime table columns against the runtime construction
+    ROOT_PRIME_TABLE *table = root_table_init(root_primes, root_primes->p_count, VX6);
+    ROOT_PRIME_TABLE *static_table = static_assets->root_table;
+    size_t col_size = root_primes->p_count * sizeof(uint32_t);
+    is_valid = is_valid && table != NULL &&
+               static_table->p_count == table->p_count &&
+               static_table->start == table->start &&
+               memcmp(static_table->p, table->p, col_size) == 0 &&
+               memcmp(static_table->x5_p, table->x5_p, col_size) == 0 &&
+               memcmp(static_table->x7_p, table->x7_p, col_size) == 0 &&
+               memcmp(static_table->vx_mod_p, table->vx_mod_p, col_size) == 0 &&
+               memcmp(static_table->p_inv, table->p_inv, root_primes->p_count * sizeof(uint64_t)) == 0;
+    root_table_free(table);
+
+    printf("Root primes: %d, base segment: %zu bits\n", static_assets->root_primes->p_count, static_assets->base_x5->size);
+
+    if (is_valid)
+        printf("Success: compiled-in VX6 tables match the runtime construction\n");
+    else
+        printf("Error: compiled-in VX6 tables mismatch\n");
+
+    bitmap_free(x5);
+    bitmap_free(x7);
+    primes_obj_free(root_primes);
+
+    return is_valid;
+}
+
 /**
  * @brief Tests primality of p_gaps in vx_obj
  *
@@ -125,6 +246,1290 @@ int testing_sieve_vx(void)
     return is_valid;
 }
 
+/**
+ * @brief Tests the specialized Sieve-VX kernels
+ *
+ * Sieves a fully deterministic segment (root_limit < vx) with the VX5 and VX6
+ * kernels and compares its prime gaps with the primes of sieve_iZ in the same range.
+ *
+ * @return 1 if the prime gaps of all kernels match, 0 otherwise
+ */
+int testing_sieve_vx_kernels(void)
+{
+    print_line(92);
+    printf("Testing Sieve-VX kernels against Sieve-iZ");
+    print_line(92);
+
+    int vx_list[] = {VX5, VX6};
+    int y = 3;
+    int is_valid = 1;
+
+    for (int k = 0; k < 2; k++)
+    {
+        int vx = vx_list[k];
+        char y_str[16];
+        snprintf(y_str, sizeof(y_str), "%d", y);
+
+        VX_OBJ *vx_obj = vx_init(vx, y_str);
+        VX_ASSETS *vx_assets = vx_assets_init(vx);
+        sieve_vx(vx_obj, vx_assets);
+
+        // The segment covers (iZ(vx * y, 1), iZ(vx * (y + 1), 1)]
+        uint64_t base = iZ((uint64_t)vx * y, 1);
+        uint64_t top = iZ((uint64_t)vx * (y + 1), 1);
+        PRIMES_OBJ *primes = sieve_iZ(top + 1);
+
+        int p_count = 0, is_match = 1;
+        uint64_t prev = base;
+        for (int i = 0; i < primes->p_count && is_match; i++)
+        {
+            uint64_t p = primes->p_array[i];
+            if (p <= base || p > top)
+                continue;
+
+            is_match = p_count < vx_obj->p_count && vx_obj->p_gaps[p_count] == p - prev;
+            prev = p;
+            p_count++;
+        }
+        is_match = is_match && p_count == vx_obj->p_count;
+
+        printf("vx = %d, y = %d: %d primes, %s\n", vx, y, vx_obj->p_count, is_match ? "match" : "mismatch");
+        is_valid = is_valid && is_match;
+
+        primes_obj_free(primes);
+        vx_free(vx_obj);
+        vx_assets_free(vx_assets);
+    }
+
+    if (is_valid)
+        printf("Success: Sieve-VX kernels match Sieve-iZ\n");
+    else
+        printf("Error: Sieve-VX kernels mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the native 128-bit path of Sieve-VX
+ *
+ * Sieves a VX5 segment around 5 * 10^29, where candidates are tested by the
+ * 128-bit BPSW test, and walks its prime gaps with GMP's mpz_nextprime.
+ *
+ * @return 1 if every prime of the segment is found, 0 otherwise
+ */
+int testing_sieve_vx_u128(void)
+{
+    print_line(92);
+    printf("Testing Sieve-VX 128-bit path against mpz_nextprime");
+    print_line(92);
+
+    char y[64] = "1000000000000000000000000";
+    VX_OBJ *vx_obj = vx_init(VX5, y);
+    VX_ASSETS *vx_assets = vx_assets_init(VX5);
+    sieve_vx(vx_obj, vx_assets);
+
+    // Walk from the base iZ(vx * y, 1) through consecutive primes
+    mpz_t p, expected;
+    mpz_init(p);
+    mpz_init(expected);
+    mpz_set_str(p, y, 10);
+    mpz_mul_ui(p, p, VX5);
+    iZ_gmp(p, p, 1);
+
+    int is_valid = vx_obj->p_count > 0;
+    for (int i = 0; i < vx_obj->p_count && is_valid; i++)
+    {
+        mpz_nextprime(expected, p);
+        mpz_add_ui(p, p, vx_obj->p_gaps[i]);
+        is_valid = mpz_cmp(p, expected) == 0;
+    }
+
+    // No prime left between the last gap and the segment end iZ(vx * (y+1), 1)
+    mpz_t top;
+    mpz_init(top);
+    mpz_set_str(top, y, 10);
+    mpz_add_ui(top, top, 1);
+    mpz_mul_ui(top, top, VX5);
+    iZ_gmp(top, top, 1);
+    mpz_nextprime(expected, p);
+    is_valid = is_valid && mpz_cmp(expected, top) > 0;
+
+    printf("y = %s: %d primes, %d primality tests\n", y, vx_obj->p_count, vx_obj->p_test_ops);
+
+    if (is_valid)
+        printf("Success: 128-bit Sieve-VX matches mpz_nextprime\n");
+    else
+        printf("Error: 128-bit Sieve-VX mismatch\n");
+
+    mpz_clear(p);
+    mpz_clear(expected);
+    mpz_clear(top);
+    vx_free(vx_obj);
+    vx_assets_free(vx_assets);
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the ARENA allocator
+ *
+ * Fills an arena past its first block with aligned allocations of various sizes,
+ * checks their contents survive the growth, then resets and reuses it.
+ *
+ * @return 1 if all allocations are aligned and intact, 0 otherwise
+ */
+int testing_arena(void)
+{
+    print_line(92);
+    printf("Testing arena allocator");
+    print_line(92);
+
+    ARENA *arena = arena_create(256);
+    int is_valid = arena != NULL;
+
+    for (int round = 0; round < 2 && is_valid; round++)
+    {
+        unsigned char *chunks[64];
+        for (int i = 0; i < 64 && is_valid; i++)
+        {
+            size_t size = 1 + i * 37;
+            chunks[i] = arena_alloc(arena, size);
+            is_valid = chunks[i] != NULL && (uintptr_t)chunks[i] % ARENA_ALIGN == 0;
+            if (is_valid)
+                memset(chunks[i], i, size);
+        }
+
+        for (int i = 0; i < 64 && is_valid; i++)
+            for (size_t j = 0; j < (size_t)(1 + i * 37) && is_valid; j++)
+                is_valid = chunks[i][j] == i;
+
+        printf("Round %d: %zu bytes allocated, %s\n", round, arena->allocated, is_valid ? "intact" : "corrupted");
+
+        // The second round reuses the largest block
+        arena_reset(arena);
+        is_valid = is_valid && arena->allocated == 0 && arena->head->next == NULL;
+    }
+
+    arena_free(arena);
+
+    if (is_valid)
+        printf("Success: arena allocations are aligned and intact\n");
+    else
+        printf("Error: arena allocator failure\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the aligned, huge-page-backed buffer allocator
+ *
+ * For each allocation mode, allocates small and huge-page-sized buffers, checks
+ * they are aligned and zeroed, then grows and shrinks them with mem_realloc and
+ * checks their contents survive. Ends with sieve_iZ on huge-page-backed buffers.
+ *
+ * @return 1 if all buffers are aligned and intact, 0 otherwise
+ */
+int testing_mem_alloc(void)
+{
+    print_line(92);
+    printf("Testing aligned buffer allocation");
+    print_line(92);
+
+    int saved_flags = mem_alloc_get_flags();
+    int modes[] = {MEM_ALLOC_DEFAULT, MEM_ALLOC_HUGEPAGE, MEM_ALLOC_HUGETLB | MEM_ALLOC_PREFAULT};
+    size_t sizes[] = {1, 1000, MEM_HUGEPAGE_MIN_SIZE + 12345};
+    int is_valid = 1;
+
+    for (int m = 0; m < 3 && is_valid; m++)
+    {
+        mem_alloc_set_flags(modes[m]);
+
+        for (int s = 0; s < 3 && is_valid; s++)
+        {
+            size_t size = sizes[s];
+            unsigned char *buffer = mem_alloc(size, 1);
+            is_valid = buffer != NULL && (uintptr_t)buffer % MEM_ALIGN == 0;
+            for (size_t i = 0; i < size && is_valid; i++)
+                is_valid = buffer[i] == 0;
+
+            // grow past the huge page threshold, then shrink below the original size
+            for (size_t i = 0; i < size && is_valid; i++)
+                buffer[i] = (unsigned char)(i * 7);
+
+            size_t grown = 3 * size + MEM_HUGEPAGE_MIN_SIZE;
+            unsigned char *temp = is_valid ? mem_realloc(buffer, grown) : NULL;
+            is_valid = temp != NULL && (uintptr_t)temp % MEM_ALIGN == 0;
+            buffer = is_valid ? temp : buffer;
+            for (size_t i = 0; i < size && is_valid; i++)
+                is_valid = buffer[i] == (unsigned char)(i * 7);
+
+            size_t shrunk = (size + 1) / 2;
+            temp = is_valid ? mem_realloc(buffer, shrunk) : NULL;
+            is_valid = temp != NULL && (uintptr_t)temp % MEM_ALIGN == 0;
+            buffer = is_valid ? temp : buffer;
+            for (size_t i = 0; i < shrunk && is_valid; i++)
+                is_valid = buffer[i] == (unsigned char)(i * 7);
+
+            mem_free(buffer);
+        }
+
+        printf("Mode %d: %s\n", modes[m], is_valid ? "aligned and intact" : "corrupted");
+    }
+
+    // a sieve whose bitmaps and prime array are large enough to be mapped
+    if (is_valid)
+    {
+        mem_alloc_set_flags(MEM_ALLOC_HUGEPAGE);
+        PRIMES_OBJ *primes = sieve_iZ(100000000);
+        is_valid = primes != NULL && primes->p_count == 5761455 && (uintptr_t)primes->p_array % MEM_ALIGN == 0;
+        primes_obj_free(primes);
+    }
+
+    mem_alloc_set_flags(saved_flags);
+
+    if (is_valid)
+        printf("Success: buffers are aligned and intact in every allocation mode\n");
+    else
+        printf("Error: buffer allocation failure\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Returns the live bytes of a kind, or of all kinds if kind is MEM_KINDS.
+ */
+static uint64_t mem_usage_bytes(int kind)
+{
+    MEM_USAGE_REPORT usage;
+    mem_usage_get(&usage);
+    return kind < MEM_KINDS ? usage.kind[kind].bytes : usage.total.bytes;
+}
+
+/**
+ * @brief Tests the allocation counters of mem_alloc.h
+ *
+ * Allocates a bitmap, a PRIMES_OBJ, a sieved VX_OBJ and an arena of two blocks,
+ * checks each kind accounts their sizes, through the resizes of the prime and gap
+ * arrays, and that freeing them all returns every kind to its bytes before, the
+ * peak of the total holding all of them.
+ *
+ * @return 1 if the counters balance, 0 otherwise
+ */
+int testing_mem_usage(void)
+{
+    print_line(92);
+    printf("Testing allocation counters");
+    print_line(92);
+
+    MEM_USAGE_REPORT before, after;
+    mem_usage_reset_peaks();
+    mem_usage_get(&before);
+
+    BITMAP *bitmap = bitmap_create(80000);
+    int is_valid = bitmap != NULL && mem_usage_bytes(MEM_KIND_BITMAP) == before.kind[MEM_KIND_BITMAP].bytes + 10000;
+
+    PRIMES_OBJ *primes = primes_obj_init(1000);
+    for (int i = 0; i < 10 && primes != NULL; i++)
+        primes_obj_append(primes, 2 * i + 1);
+    is_valid = is_valid && primes != NULL && primes_obj_resize_to_p_count(primes) &&
+               mem_usage_bytes(MEM_KIND_PRIMES) == before.kind[MEM_KIND_PRIMES].bytes + 10 * sizeof(uint64_t);
+
+    VX_ASSETS *vx_assets = vx_assets_init(VX6);
+    VX_OBJ *vx_obj = vx_init(VX6, "1");
+    if (vx_assets != NULL && vx_obj != NULL)
+    {
+        sieve_vx(vx_obj, vx_assets);
+        vx_resize_p_gaps(vx_obj);
+    }
+    is_valid = is_valid && vx_obj != NULL && vx_obj->p_gaps != NULL &&
+               mem_usage_bytes(MEM_KIND_VX) == before.kind[MEM_KIND_VX].bytes + vx_obj->p_count * GAP_SIZE;
+
+    ARENA *arena = arena_create(4096);
+    is_valid = is_valid && arena != NULL && arena_alloc(arena, 8192) != NULL &&
+               mem_usage_bytes(MEM_KIND_ARENA) == before.kind[MEM_KIND_ARENA].bytes + 4096 + 8192;
+
+    uint64_t live = mem_usage_bytes(MEM_KINDS) - before.total.bytes;
+
+    arena_free(arena);
+    vx_free(vx_obj);
+    vx_assets_free(vx_assets);
+    primes_obj_free(primes);
+    bitmap_free(bitmap);
+
+    mem_usage_get(&after);
+    for (int kind = 0; kind < MEM_KINDS && is_valid; kind++)
+        is_valid = after.kind[kind].bytes == before.kind[kind].bytes &&
+                   after.kind[kind].allocs - before.kind[kind].allocs == after.kind[kind].frees - before.kind[kind].frees;
+    is_valid = is_valid && after.total.bytes == before.total.bytes && after.total.peak_bytes >= before.total.bytes + live;
+
+    for (int kind = 0; kind < MEM_KINDS; kind++)
+        printf("%-8s %llu allocations, peak %llu bytes\n", mem_kind_name(kind),
+               (unsigned long long)(after.kind[kind].allocs - before.kind[kind].allocs),
+               (unsigned long long)after.kind[kind].peak_bytes);
+
+    if (is_valid)
+        printf("Success: allocation counters balance\n");
+    else
+        printf("Error: allocation counters do not balance\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the multi-row block sieving of sieve_iZm and sieve_vx6_range
+ *
+ * Checks bitmap_clear_pattern against bitmap_clear_mod_p for the small steps,
+ * sieve_iZm against sieve_iZ over several blocks of rows, and the segments of
+ * sieve_vx6_range, including a partial block, against sieve_vx one at a time.
+ *
+ * @return 1 if all results match, 0 otherwise
+ */
+int testing_block_sieve(void)
+{
+    print_line(92);
+    printf("Testing multi-row block sieving");
+    print_line(92);
+
+    // 1. Word patterns against bit-by-bit clearing, with random bounds
+    int is_valid = 1;
+    BITMAP *expected = bitmap_create(VX5 + 10);
+    BITMAP *actual = bitmap_create(VX5 + 10);
+    for (uint64_t p = 3; p < BITMAP_PATTERN_MAX_P && is_valid; p += 2)
+    {
+        BITMAP_PATTERN pattern;
+        bitmap_pattern_init(&pattern, p);
+        for (int k = 0; k < 20 && is_valid; k++)
+        {
+            size_t start_idx = rand() % 1000, limit = VX5 + 10 - rand() % 1000;
+            bitmap_set_all(expected);
+            bitmap_set_all(actual);
+            bitmap_clear_mod_p(expected, p, start_idx, limit);
+            bitmap_clear_pattern(actual, &pattern, start_idx, limit);
+            is_valid = memcmp(expected->data, actual->data, (expected->size + 7) / 8) == 0;
+        }
+    }
+    printf("bitmap_clear_pattern: %s\n", is_valid ? "match" : "mismatch");
+    bitmap_free(expected);
+    bitmap_free(actual);
+
+    // 2. sieve_iZm over 10 rows of VX6, i.e. 3 blocks of rows
+    uint64_t n = 100000000;
+    PRIMES_OBJ *primes_iZ = sieve_iZ(n);
+    PRIMES_OBJ *primes_iZm = sieve_iZm(n);
+    int is_match = primes_iZ->p_count == primes_iZm->p_count &&
+                   memcmp(primes_iZ->p_array, primes_iZm->p_array, primes_iZ->p_count * sizeof(uint64_t)) == 0;
+    printf("sieve_iZm(%lu): %d primes, %s\n", (unsigned long)n, primes_iZm->p_count, is_match ? "match" : "mismatch");
+    is_valid = is_valid && is_match;
+    primes_obj_free(primes_iZ);
+    primes_obj_free(primes_iZm);
+
+    // 3. sieve_vx6_range against sieve_vx, segment by segment
+    int range_y = SIEVE_VX_BLOCK_ROWS + 2;
+    VX_RANGE *vx_range = sieve_vx6_range("3", range_y);
+    VX_ASSETS *vx_assets = vx_assets_init(VX6);
+    is_match = vx_range != NULL && vx_range->count == range_y;
+    for (int i = 0; i < range_y && is_match; i++)
+    {
+        char y[16];
+        snprintf(y, sizeof(y), "%d", 3 + i);
+        VX_OBJ *vx_obj = vx_init(VX6, y);
+        sieve_vx(vx_obj, vx_assets);
+        is_match = vx_obj->p_count == vx_range->vx_objs[i]->p_count &&
+                   memcmp(vx_obj->p_gaps, vx_range->vx_objs[i]->p_gaps, vx_obj->p_count * GAP_SIZE) == 0;
+        vx_free(vx_obj);
+    }
+    printf("sieve_vx6_range(3, %d): %s\n", range_y, is_match ? "match" : "mismatch");
+    is_valid = is_valid && is_match;
+
+    vx_range_free(vx_range);
+    vx_assets_free(vx_assets);
+
+    if (is_valid)
+        printf("Success: block sieving matches row by row sieving\n");
+    else
+        printf("Error: block sieving mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Reference base-2 strong probable-prime test with GMP's mpz_powm.
+ */
+static int gmp_is_sprp2(mpz_t n)
+{
+    mpz_t d, x, n_minus_1;
+    mpz_inits(d, x, n_minus_1, NULL);
+    mpz_sub_ui(n_minus_1, n, 1);
+
+    mp_bitcnt_t s = mpz_scan1(n_minus_1, 0);
+    mpz_fdiv_q_2exp(d, n_minus_1, s);
+    mpz_set_ui(x, 2);
+    mpz_powm(x, x, d, n);
+
+    int is_sprp = mpz_cmp_ui(x, 1) == 0 || mpz_cmp(x, n_minus_1) == 0;
+    for (mp_bitcnt_t r = 1; r < s && !is_sprp; r++)
+    {
+        mpz_powm_ui(x, x, 2, n);
+        is_sprp = mpz_cmp(x, n_minus_1) == 0;
+    }
+
+    mpz_clears(d, x, n_minus_1, NULL);
+    return is_sprp;
+}
+
+/**
+ * @brief Tests the NUMA-aware parallel range sieve
+ *
+ * Checks that numa_worker_node assigns workers to nodes in contiguous blocks,
+ * that a VX_ASSETS replica matches its source on page-aligned arrays, and that sieve_vx6_range_parallel
+ * returns the same segments as sieve_vx6_range, with more threads than segments too.
+ *
+ * @return 1 if all results match, 0 otherwise
+ */
+int testing_vx_range_parallel(void)
+{
+    print_line(92);
+    printf("Testing parallel range sieving");
+    print_line(92);
+
+    // 1. Contiguous worker blocks, covering every node
+    int node_count = numa_node_count();
+    int is_valid = node_count >= 1 && numa_node_cpu_count(0) >= 1;
+    for (int w = 1; w < 16 && is_valid; w++)
+        is_valid = numa_worker_node(w, 16) >= numa_worker_node(w - 1, 16) && numa_worker_node(w, 16) < node_count;
+    is_valid = is_valid && numa_worker_node(15, 16) == MIN(node_count, 16) - 1;
+    printf("NUMA nodes: %d, CPUs on node 0: %d\n", node_count, numa_node_cpu_count(0));
+
+    // 2. Replicated assets
+    VX_ASSETS *vx_assets = vx_assets_init(VX6);
+    VX_ASSETS *replica = vx_assets_replicate(vx_assets, node_count - 1);
+    is_valid = is_valid && replica != NULL && !replica->is_static &&
+               replica->root_table->p_count == vx_assets->root_table->p_count &&
+               replica->root_table->start == vx_assets->root_table->start &&
+               memcmp(replica->root_table->p_inv, vx_assets->root_table->p_inv, vx_assets->root_table->p_count * sizeof(uint64_t)) == 0 &&
+               memcmp(replica->base_x7->data, vx_assets->base_x7->data, (VX6 + 10 + 7) / 8) == 0 &&
+               (uintptr_t)replica->base_x7->data % 4096 == 0 && (uintptr_t)replica->root_table->p_inv % 4096 == 0;
+    vx_assets_free(replica);
+    vx_assets_free(vx_assets);
+
+    // 3. Parallel against sequential ranges
+    int thread_counts[] = {2, 3, 16};
+    VX_RANGE *expected = sieve_vx6_range("1000000000000", 7);
+    for (int t = 0; t < 3 && is_valid; t++)
+    {
+        VX_RANGE *actual = sieve_vx6_range_parallel("1000000000000", 7, thread_counts[t]);
+        is_valid = expected != NULL && actual != NULL && actual->count == expected->count;
+        for (int i = 0; i < 7 && is_valid; i++)
+        {
+            VX_OBJ *a = actual->vx_objs[i], *e = expected->vx_objs[i];
+            is_valid = strcmp(a->y, e->y) == 0 && a->p_count == e->p_count &&
+                       memcmp(a->p_gaps, e->p_gaps, e->p_count * GAP_SIZE) == 0;
+        }
+        printf("%d threads: %s\n", thread_counts[t], is_valid ? "match" : "mismatch");
+        vx_range_free(actual);
+    }
+    vx_range_free(expected);
+
+    if (is_valid)
+        printf("Success: parallel range sieving matches sequential sieving\n");
+    else
+        printf("Error: parallel range sieving mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the resumable sieve jobs
+ *
+ * Steps an iZm job and a VX6 range job in small slices, writes each to a file midway,
+ * reads it back and resumes it, then compares the results with sieve_eratosthenes and
+ * sieve_vx6_range_parallel. A corrupted state file, a finished iZm job whose prime
+ * count or limit is forged past its capacity, and a range job whose segment count is
+ * forged past its limit, must be rejected.
+ *
+ * @return 1 if all results match, 0 otherwise
+ */
+int testing_sieve_state(void)
+{
+    print_line(92);
+    printf("Testing resumable sieve jobs");
+    print_line(92);
+
+    char filename[256];
+    sprintf(filename, "%s/test_sieve_state.izs", DIR_output);
+
+    // 1. iZm job, snapshotted after 3 rows and resumed 2 rows at a time
+    uint64_t n = 100000000;
+    IZ_SIEVE_STATE *state = iz_sieve_state_izm(n);
+    int is_valid = state != NULL && iz_sieve_step(state, 3) == 1 &&
+                   iz_sieve_state_write_file(filename, state);
+    int remaining = iz_sieve_state_remaining(state);
+    iz_sieve_state_free(state);
+
+    state = is_valid ? iz_sieve_state_read_file(filename) : NULL;
+    is_valid = state != NULL && iz_sieve_state_remaining(state) == remaining;
+    int steps = 0, status = 1;
+    while (is_valid && (status = iz_sieve_step(state, 2)) > 0)
+        steps++;
+
+    PRIMES_OBJ *actual = status == 0 ? iz_sieve_state_take_primes(state) : NULL;
+    PRIMES_OBJ *expected = sieve_eratosthenes(n);
+    is_valid = actual != NULL && expected != NULL && actual->p_count == expected->p_count &&
+               memcmp(actual->p_array, expected->p_array, expected->p_count * sizeof(uint64_t)) == 0;
+    printf("iZm job up to %llu: %d rows left after the snapshot, %d steps, %s\n",
+           (unsigned long long)n, remaining, steps + 1, is_valid ? "match" : "mismatch");
+    primes_obj_free(actual);
+    primes_obj_free(expected);
+    iz_sieve_state_free(state);
+
+    // 2. VX6 range job, snapshotted after 2 segments and resumed 1 segment at a time
+    state = iz_sieve_state_vx6_range("1000000000000", 5);
+    int is_written = state != NULL && iz_sieve_step(state, 2) == 1 &&
+                     iz_sieve_state_write_file(filename, state);
+    iz_sieve_state_free(state);
+
+    state = is_written ? iz_sieve_state_read_file(filename) : NULL;
+    is_written = state != NULL && iz_sieve_state_remaining(state) == 3;
+    while (is_written && (status = iz_sieve_step(state, 1)) > 0)
+        ;
+
+    VX_RANGE *range = is_written && status == 0 ? iz_sieve_state_take_vx_range(state) : NULL;
+    VX_RANGE *expected_range = sieve_vx6_range_parallel("1000000000000", 5, 2);
+    int is_range_valid = range != NULL && expected_range != NULL && range->count == expected_range->count;
+    for (int i = 0; i < 5 && is_range_valid; i++)
+    {
+        VX_OBJ *a = range->vx_objs[i], *e = expected_range->vx_objs[i];
+        is_range_valid = strcmp(a->y, e->y) == 0 && a->p_count == e->p_count &&
+                         memcmp(a->p_gaps, e->p_gaps, e->p_count * GAP_SIZE) == 0;
+    }
+    printf("VX6 range job of 5 segments: %s\n", is_range_valid ? "match" : "mismatch");
+    vx_range_free(range);
+    vx_range_free(expected_range);
+    iz_sieve_state_free(state);
+
+    // 3. A corrupted file is rejected
+    FILE *file = fopen(filename, "r+b");
+    if (file != NULL)
+    {
+        fseek(file, 64, SEEK_SET);
+        fputc(fgetc(file) ^ 0xFF, file);
+        fclose(file);
+    }
+    state = iz_sieve_state_read_file(filename);
+    int is_rejected = file != NULL && state == NULL;
+    iz_sieve_state_free(state);
+
+    // 4. Forged sizes are rejected before the results are allocated: a finished iZm job up
+    // to 500 claiming INT_MAX primes, one up to 2^62 (n at offset 8, p_count at 40), and a
+    // range job from y = 1000 claiming 2^21 segments (range_y at offset 16 + 5)
+    int forged_count = INT_MAX, forged_range_y = 1 << 21;
+    uint64_t forged_n = 1ULL << 62;
+    MEM_USAGE_REPORT usage;
+    mem_usage_reset_peaks();
+    mem_usage_get(&usage);
+    uint64_t primes_bytes = usage.kind[MEM_KIND_PRIMES].bytes;
+    uint64_t arena_bytes = usage.kind[MEM_KIND_ARENA].bytes;
+    for (int i = 0; i < 3 && is_rejected; i++)
+    {
+        state = i < 2 ? iz_sieve_state_izm(500) : iz_sieve_state_vx6_range("1000", 2);
+        is_rejected = state != NULL && iz_sieve_state_write_file(filename, state);
+        iz_sieve_state_free(state);
+
+        file = is_rejected ? fopen(filename, "r+b") : NULL;
+        if (file != NULL)
+        {
+            fseek(file, i == 0 ? 40 : i == 1 ? 8 : 21, SEEK_SET);
+            if (i == 0)
+                fwrite(&forged_count, sizeof(int), 1, file);
+            else if (i == 1)
+                fwrite(&forged_n, sizeof(uint64_t), 1, file);
+            else
+                fwrite(&forged_range_y, sizeof(int), 1, file);
+            fclose(file);
+        }
+        state = file != NULL ? iz_sieve_state_read_file(filename) : NULL;
+        is_rejected = file != NULL && state == NULL;
+        iz_sieve_state_free(state);
+    }
+    remove(filename);
+
+    mem_usage_get(&usage);
+    is_rejected = is_rejected && usage.kind[MEM_KIND_PRIMES].peak_bytes - primes_bytes < (1 << 20) &&
+                  usage.kind[MEM_KIND_ARENA].peak_bytes - arena_bytes < (64 << 20);
+
+    is_valid = is_valid && is_range_valid && is_rejected;
+    if (is_valid)
+        printf("Success: resumed sieve jobs match the monolithic sieves\n");
+    else
+        printf("Error: resumable sieve jobs mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Stream callback of testing_sieve_auto: checks each prime against the expected list.
+ */
+static int check_streamed_prime(uint64_t p, void *ctx)
+{
+    PRIMES_OBJ *expected = ctx;
+    if (expected->p_count == 0 || expected->p_array[0] != p)
+        return 1;
+
+    // consume the expected prime
+    expected->p_array++;
+    expected->p_count--;
+    return 0;
+}
+
+/**
+ * @brief Tests the automatic sieve selection
+ *
+ * Compares the lists, counts and streams of iz_sieve_auto with sieve_eratosthenes
+ * on both sides of the calibration boundaries, including a prime n = 6x - 1, and
+ * a multi-threaded wheel-30 plan with small segments. Below 10 the counts and
+ * streams are checked against the primes 2, 3, 5, 7.
+ *
+ * @return 1 if all results match, 0 otherwise
+ */
+int testing_sieve_auto(void)
+{
+    print_line(92);
+    printf("Testing automatic sieve selection");
+    print_line(92);
+
+    uint64_t limits[] = {1013, 30029, 100003, 2000000, 20000000};
+    int is_valid = 1;
+
+    for (int i = 0; i < 5 && is_valid; i++)
+    {
+        uint64_t n = limits[i];
+        PRIMES_OBJ *expected = sieve_eratosthenes(n);
+        IZ_SIEVE_PLAN plan = iz_sieve_plan(n, IZ_SIEVE_LIST);
+
+        // 1. List
+        PRIMES_OBJ *primes = iz_sieve_auto(n, IZ_SIEVE_LIST);
+        is_valid = expected != NULL && primes != NULL && primes->p_count == expected->p_count &&
+                   memcmp(primes->p_array, expected->p_array, expected->p_count * sizeof(uint64_t)) == 0;
+        primes_obj_free(primes);
+
+        // 2. Count
+        is_valid = is_valid && iz_sieve_auto_count(n, IZ_SIEVE_COUNT) == (uint64_t)expected->p_count;
+
+        // 3. Stream, consuming a view of the expected list
+        PRIMES_OBJ view = *expected;
+        is_valid = is_valid && iz_sieve_auto_stream(n, 0, check_streamed_prime, &view) == (uint64_t)expected->p_count &&
+                   view.p_count == 0;
+
+        printf("n = %-10llu %-14s segment %-8zu threads %d: %s\n", (unsigned long long)n,
+               iz_sieve_engine_name(plan.engine), plan.segment_bytes, plan.threads, is_valid ? "match" : "mismatch");
+        primes_obj_free(expected);
+    }
+
+    // 4. Wheel-30 chunks split across threads, with segments smaller than the pattern
+    IZ_SIEVE_PLAN plan = {IZ_ENGINE_WHEEL30, IZ_SIEVE_LIST, 1000, 3};
+    PRIMES_OBJ *expected = sieve_eratosthenes(10000019);
+    PRIMES_OBJ *primes = iz_sieve_run(10000019, plan);
+    is_valid = is_valid && primes != NULL && primes->p_count == expected->p_count &&
+               memcmp(primes->p_array, expected->p_array, expected->p_count * sizeof(uint64_t)) == 0;
+    primes_obj_free(primes);
+    primes_obj_free(expected);
+
+    // 5. Count and stream below 10, where there is no list to compare with
+    uint64_t small_primes[] = {2, 3, 5, 7};
+    for (uint64_t n = 0; n < 10 && is_valid; n++)
+    {
+        int pi = (n >= 2) + (n >= 3) + (n >= 5) + (n >= 7);
+        PRIMES_OBJ view = {pi, small_primes, {0}};
+        is_valid = iz_sieve_auto_count(n, IZ_SIEVE_COUNT) == (uint64_t)pi &&
+                   iz_sieve_auto_stream(n, 0, check_streamed_prime, &view) == (uint64_t)pi && view.p_count == 0;
+    }
+    printf("n < 10: %s\n", is_valid ? "match" : "mismatch");
+
+    if (is_valid)
+        printf("Success: automatic sieve selection matches the Sieve of Eratosthenes\n");
+    else
+        printf("Error: automatic sieve selection mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the tuning profile
+ *
+ * Writes a profile and reads it back, checks that out-of-range values are
+ * clamped when applied, and that sieve_iZm and sieve_vx6_range return the same
+ * results under a non-default profile. The active profile is restored after.
+ *
+ * @return 1 if all results match, 0 otherwise
+ */
+int testing_tuning(void)
+{
+    print_line(92);
+    printf("Testing the tuning profile");
+    print_line(92);
+
+    char path[256];
+    sprintf(path, "%s/test_tuning.profile", DIR_output);
+    IZ_TUNING saved = *iz_tuning();
+
+    // 1. Save and load round trip
+    IZ_TUNING tuning, loaded;
+    iz_tuning_defaults(&tuning);
+    tuning.vx_limit = 5;
+    tuning.pattern_max_p = 32;
+    tuning.izm_block_rows = 3;
+    tuning.vx_block_rows = 1;
+    tuning.w30_segment_bytes = 65536;
+    tuning.threads = 2;
+    iz_tuning_defaults(&loaded);
+    int is_valid = iz_tuning_save(&tuning, path) && iz_tuning_load(&loaded, path) &&
+                   memcmp(&loaded, &tuning, sizeof(IZ_TUNING)) == 0;
+    remove(path);
+    printf("Save and load: %s\n", is_valid ? "match" : "mismatch");
+
+    // 2. Clamping
+    IZ_TUNING out_of_range = tuning;
+    out_of_range.vx_limit = 100;
+    out_of_range.izm_block_rows = 0;
+    out_of_range.test_rounds = -1;
+    iz_tuning_apply(&out_of_range);
+    is_valid = is_valid && iz_tuning()->vx_limit == 7 && iz_tuning()->izm_block_rows == 1 &&
+               iz_tuning()->test_rounds == 1;
+    printf("Clamping: %s\n", is_valid ? "ok" : "failed");
+
+    // 3. Same results under the profile of step 1
+    iz_tuning_apply(&saved);
+    PRIMES_OBJ *expected_primes = sieve_iZm(10000019);
+    VX_RANGE *expected_range = sieve_vx6_range("1000000000000", 3);
+
+    iz_tuning_apply(&tuning);
+    PRIMES_OBJ *primes = sieve_iZm(10000019);
+    VX_RANGE *range = sieve_vx6_range("1000000000000", 3);
+
+    is_valid = is_valid && primes != NULL && expected_primes != NULL && primes->p_count == expected_primes->p_count &&
+               memcmp(primes->p_array, expected_primes->p_array, expected_primes->p_count * sizeof(uint64_t)) == 0;
+    is_valid = is_valid && range != NULL && expected_range != NULL;
+    for (int i = 0; i < 3 && is_valid; i++)
+    {
+        VX_OBJ *a = range->vx_objs[i], *e = expected_range->vx_objs[i];
+        is_valid = a->p_count == e->p_count && memcmp(a->p_gaps, e->p_gaps, e->p_count * GAP_SIZE) == 0;
+    }
+    printf("Tuned sieves: %s\n", is_valid ? "match" : "mismatch");
+
+    primes_obj_free(primes);
+    primes_obj_free(expected_primes);
+    vx_range_free(range);
+    vx_range_free(expected_range);
+    iz_tuning_apply(&saved);
+
+    if (is_valid)
+        printf("Success: tuning profile round trip, clamping and tuned sieves\n");
+    else
+        printf("Error: tuning profile mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the smallest-prime-factor table
+ *
+ * Checks every factorization of factorize_u64_small up to a bound past several
+ * segments of sieve_spf: the factors must be primes of sieve_eratosthenes, in
+ * increasing order, multiplying back to n.
+ *
+ * @return 1 if all factorizations are valid, 0 otherwise
+ */
+int testing_spf_table(void)
+{
+    print_line(92);
+    printf("Testing the smallest-prime-factor table");
+    print_line(92);
+
+    uint64_t n = 3 * (uint64_t)SIEVE_SPF_SEGMENT_ENTRIES * 5 + 1234;
+    SPF_TABLE *spf = sieve_spf(n);
+    PRIMES_OBJ *primes = sieve_eratosthenes(n);
+    BITMAP *is_prime = bitmap_create(n + 1);
+    int is_valid = spf != NULL && primes != NULL && is_prime != NULL;
+
+    for (int i = 0; is_valid && i < primes->p_count; i++)
+        bitmap_set_bit(is_prime, primes->p_array[i]);
+
+    uint64_t factors[SPF_MAX_FACTORS];
+    for (uint64_t m = 1; is_valid && m <= n; m++)
+    {
+        int count = factorize_u64_small(spf, m, factors);
+        uint64_t product = 1;
+        for (int k = 0; k < count && is_valid; k++)
+        {
+            is_valid = bitmap_get_bit(is_prime, factors[k]) && (k == 0 || factors[k] >= factors[k - 1]);
+            product *= factors[k];
+        }
+        is_valid = is_valid && count >= 0 && product == m;
+
+        if (!is_valid)
+            printf("Invalid factorization of %llu\n", (unsigned long long)m);
+    }
+    is_valid = is_valid && factorize_u64_small(spf, n + 1, factors) == -1 && factorize_u64_small(spf, 0, factors) == -1;
+    printf("Factorizations up to %llu: %s\n", (unsigned long long)n, is_valid ? "valid" : "invalid");
+
+    bitmap_free(is_prime);
+    primes_obj_free(primes);
+    spf_table_free(spf);
+
+    if (is_valid)
+        printf("Success: factorize_u64_small returns the prime factorizations\n");
+    else
+        printf("Error: factorize_u64_small mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Checks a factorization of n: primes in increasing order, multiplying back to n.
+ */
+static int check_factors(uint64_t n, const uint64_t *factors, int count)
+{
+    mpz_t factor;
+    mpz_init(factor);
+
+    __uint128_t product = 1;
+    int is_valid = count >= 0;
+    for (int i = 0; i < count && is_valid; i++)
+    {
+        mpz_set_ui(factor, factors[i]);
+        is_valid = mpz_probab_prime_p(factor, 25) && (i == 0 || factors[i] >= factors[i - 1]);
+        product *= factors[i];
+    }
+
+    mpz_clear(factor);
+    return is_valid && product == n;
+}
+
+/**
+ * @brief Tests the 64-bit factorization
+ *
+ * Checks u64_is_prime against mpz_probab_prime_p, then the factorizations of
+ * iz_factor_u64 for small n, random 64-bit n and products of two 32-bit primes,
+ * and that iz_factor_u64_batch returns the same factorizations.
+ *
+ * @return 1 if all results are valid, 0 otherwise
+ */
+int testing_factor_u64(void)
+{
+    print_line(92);
+    printf("Testing 64-bit factorization");
+    print_line(92);
+
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, 91);
+
+    mpz_t z;
+    mpz_init(z);
+    int count = 4000;
+    uint64_t *values = malloc(count * sizeof(uint64_t));
+    uint64_t *factors = malloc(count * IZ_FACTOR_MAX * sizeof(uint64_t));
+    int *factor_counts = malloc(count * sizeof(int));
+    int is_valid = values != NULL && factors != NULL && factor_counts != NULL;
+
+    // 1. Deterministic primality test, on random sizes
+    for (int i = 0; i < 100000 && is_valid; i++)
+    {
+        mpz_urandomb(z, state, 2 + i % 63);
+        is_valid = (mpz_probab_prime_p(z, 25) != 0) == u64_is_prime(mpz_get_ui(z));
+    }
+    printf("u64_is_prime: %s\n", is_valid ? "match" : "mismatch");
+
+    // 2. Small n, random n and semiprimes
+    uint64_t f[IZ_FACTOR_MAX];
+    for (uint64_t n = 1; n <= 100000 && is_valid; n++)
+        is_valid = check_factors(n, f, iz_factor_u64(n, f));
+
+    for (int i = 0; i < count && is_valid; i++)
+    {
+        mpz_urandomb(z, state, 64);
+        values[i] = mpz_get_ui(z) | 1;
+        if (i % 2)
+        {
+            // two primes of 32 bits
+            uint64_t p, q;
+            do p = ((uint64_t)gmp_urandomb_ui(state, 31) | 0x80000000ULL);
+            while (!u64_is_prime(p));
+            do q = ((uint64_t)gmp_urandomb_ui(state, 31) | 0x80000000ULL);
+            while (!u64_is_prime(q));
+            values[i] = p * q;
+        }
+
+        int n_count = iz_factor_u64(values[i], f);
+        is_valid = check_factors(values[i], f, n_count) && (i % 2 == 0 || n_count == 2);
+    }
+    is_valid = is_valid && iz_factor_u64(0, f) == -1 && iz_factor_u64(1, f) == 0;
+    printf("iz_factor_u64: %s\n", is_valid ? "valid" : "invalid");
+
+    // 3. Batch against single calls
+    is_valid = is_valid && iz_factor_u64_batch(values, count, factors, factor_counts, 3);
+    for (int i = 0; i < count && is_valid; i++)
+    {
+        int n_count = iz_factor_u64(values[i], f);
+        is_valid = factor_counts[i] == n_count && memcmp(factors + i * IZ_FACTOR_MAX, f, n_count * sizeof(uint64_t)) == 0;
+    }
+    printf("iz_factor_u64_batch: %s\n", is_valid ? "match" : "mismatch");
+
+    free(values);
+    free(factors);
+    free(factor_counts);
+    mpz_clear(z);
+    gmp_randclear(state);
+
+    if (is_valid)
+        printf("Success: 64-bit factorizations are valid\n");
+    else
+        printf("Error: 64-bit factorization mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the multiplicative-function sieve
+ *
+ * Compares φ, μ, ω and Ω from sieve_multiplicative with their values computed
+ * from the factorizations of iz_factor_u64, from 1 and past 10^12, with one and
+ * several threads.
+ *
+ * @return 1 if all values match, 0 otherwise
+ */
+int testing_sieve_multiplicative(void)
+{
+    print_line(92);
+    printf("Testing the multiplicative-function sieve");
+    print_line(92);
+
+    uint64_t ranges[][2] = {{1, 100000}, {1000000000000ULL, 1000000050000ULL}};
+    int thread_counts[] = {1, 3};
+    int is_valid = 1;
+
+    for (int r = 0; r < 2 && is_valid; r++)
+    {
+        uint64_t lo = ranges[r][0], hi = ranges[r][1];
+        size_t count = hi - lo + 1;
+        uint64_t *phi = malloc(count * sizeof(uint64_t));
+        int8_t *mu = malloc(count);
+        uint8_t *omega = malloc(count), *big_omega = malloc(count);
+        IZ_MULT_FUNCS out = {phi, mu, omega, big_omega};
+
+        is_valid = phi != NULL && mu != NULL && omega != NULL && big_omega != NULL &&
+                   sieve_multiplicative(lo, hi, &out, thread_counts[r]);
+
+        uint64_t factors[IZ_FACTOR_MAX];
+        for (size_t i = 0; i < count && is_valid; i++)
+        {
+            int factor_count = iz_factor_u64(lo + i, factors);
+            uint64_t expected_phi = 1;
+            int expected_mu = 1, expected_omega = 0;
+            for (int k = 0; k < factor_count; k++)
+            {
+                if (k == 0 || factors[k] != factors[k - 1])
+                {
+                    expected_phi *= factors[k] - 1;
+                    expected_mu = -expected_mu;
+                    expected_omega++;
+                }
+                else
+                {
+                    expected_phi *= factors[k];
+                    expected_mu = 0;
+                }
+            }
+
+            is_valid = phi[i] == expected_phi && mu[i] == expected_mu && omega[i] == expected_omega &&
+                       big_omega[i] == factor_count;
+        }
+
+        printf("[%llu, %llu], %d thread(s): %s\n", (unsigned long long)lo, (unsigned long long)hi,
+               thread_counts[r], is_valid ? "match" : "mismatch");
+        free(phi);
+        free(mu);
+        free(omega);
+        free(big_omega);
+    }
+
+    if (is_valid)
+        printf("Success: multiplicative-function sieve matches the factorizations\n");
+    else
+        printf("Error: multiplicative-function sieve mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Callback of testing_primes_mod: appends a prime to a PRIMES_OBJ.
+ */
+static int append_prime(uint64_t p, void *ctx)
+{
+    primes_obj_append((PRIMES_OBJ *)ctx, p);
+    return 0;
+}
+
+/**
+ * @brief Tests the residue-class sieves
+ *
+ * Compares the per-class counts of iz_count_primes_mod, the single-class counts of
+ * iz_count_primes_in_class and the primes of iz_primes_mod_stream with the primes
+ * of the Sieve of Eratosthenes, for moduli dividing 6 vx and larger ones, and
+ * that 2 and 3 are counted once from lo = 1 for the moduli divisible by 4 and 9.
+ *
+ * @return 1 if all counts and primes match, 0 otherwise
+ */
+int testing_primes_mod(void)
+{
+    print_line(92);
+    printf("Testing the residue-class sieves");
+    print_line(92);
+
+    uint64_t lo = 1000, hi = 20000000;
+    uint64_t moduli[] = {4, 30, 1000, 65536, 999983};
+    PRIMES_OBJ *primes = sieve_eratosthenes(hi);
+    uint64_t *counts = malloc(999983 * sizeof(uint64_t));
+    uint64_t *expected = malloc(999983 * sizeof(uint64_t));
+    int is_valid = primes != NULL && counts != NULL && expected != NULL;
+
+    for (int i = 0; i < 5 && is_valid; i++)
+    {
+        uint64_t m = moduli[i];
+        memset(expected, 0, m * sizeof(uint64_t));
+        for (int k = 0; k < primes->p_count; k++)
+            if (primes->p_array[k] >= lo)
+                expected[primes->p_array[k] % m]++;
+
+        // 1. Every class in one pass
+        is_valid = iz_count_primes_mod(lo, hi, m, counts, 2) &&
+                   memcmp(counts, expected, m * sizeof(uint64_t)) == 0;
+
+        // 2. One class, counted and listed
+        uint64_t a = 12347 % m;
+        PRIMES_OBJ *listed = primes_obj_init(expected[a] + 1);
+        uint64_t count = iz_count_primes_in_class(lo, hi, a, m, 2);
+        uint64_t streamed = iz_primes_mod_stream(lo, hi, a, m, append_prime, listed);
+        is_valid = is_valid && listed != NULL && count == expected[a] && streamed == expected[a];
+
+        int next = 0;
+        for (int k = 0; k < primes->p_count && is_valid; k++)
+            if (primes->p_array[k] >= lo && primes->p_array[k] % m == a)
+                is_valid = listed->p_array[next++] == primes->p_array[k];
+
+        printf("[%llu, %llu] mod %llu: %llu primes ≡ %llu, %s\n", (unsigned long long)lo,
+               (unsigned long long)hi, (unsigned long long)m, (unsigned long long)count,
+               (unsigned long long)a, is_valid ? "match" : "mismatch");
+        primes_obj_free(listed);
+    }
+
+    // 3. From lo = 1 over a range wide enough for vx > 1, where 4 and 9 divide m but not vx: 2 and 3 count once
+    uint64_t wide_moduli[] = {4, 9};
+    for (int i = 0; i < 2 && is_valid; i++)
+    {
+        uint64_t m = wide_moduli[i], a = m == 4 ? 2 : 3, total = 0;
+        is_valid = iz_count_primes_mod(1, 100000000, m, counts, 2);
+        for (uint64_t k = 0; k < m; k++)
+            total += counts[k];
+
+        uint64_t count = iz_count_primes_in_class(1, 100000000, a, m, 2);
+        is_valid = is_valid && total == 5761455 && counts[a] == 1 && count == 1;
+        printf("[1, 100000000] mod %llu: %llu primes, %llu ≡ %llu, %s\n", (unsigned long long)m,
+               (unsigned long long)total, (unsigned long long)count, (unsigned long long)a, is_valid ? "match" : "mismatch");
+    }
+
+    if (is_valid)
+        printf("Success: residue-class counts and primes match the Sieve of Eratosthenes\n");
+    else
+        printf("Error: residue-class sieve mismatch\n");
+
+    free(counts);
+    free(expected);
+    primes_obj_free(primes);
+    return is_valid;
+}
+
+/**
+ * @brief Tests the logarithmic smoothness sieve
+ *
+ * Compares the positions reported by sieve_smooth for the linear form 6i + 1 past
+ * 10^9 and the quadratic form i^2 - 1000003 with the positions whose rounded logs
+ * of the distinct prime factors up to B, from iz_factor_u64, reach the threshold.
+ *
+ * @return 1 if the positions match, 0 otherwise
+ */
+int testing_sieve_smooth(void)
+{
+    print_line(92);
+    printf("Testing the logarithmic smoothness sieve");
+    print_line(92);
+
+    IZ_SMOOTH_FORM forms[] = {{1, 6, 0}, {-1000003, 0, 1}};
+    uint64_t starts[] = {1000000000ULL, 1001};
+    uint64_t bounds[] = {10000, 5000};
+    int thread_counts[] = {1, 3};
+    uint64_t len = 200000;
+    uint8_t threshold = 20;
+    int is_valid = 1;
+
+    for (int f = 0; f < 2 && is_valid; f++)
+    {
+        uint64_t *positions = NULL;
+        size_t count = 0;
+        is_valid = sieve_smooth(&forms[f], starts[f], len, bounds[f], threshold, thread_counts[f], &positions, &count);
+
+        size_t next = 0, expected_count = 0;
+        uint64_t factors[IZ_FACTOR_MAX];
+        for (uint64_t i = starts[f]; i < starts[f] + len && is_valid; i++)
+        {
+            int64_t value = forms[f].c2 * (int64_t)(i * i) + forms[f].c1 * (int64_t)i + forms[f].c0;
+            int factor_count = iz_factor_u64(value < 0 ? -value : value, factors);
+
+            int logs = 0;
+            for (int k = 0; k < factor_count && factors[k] <= bounds[f]; k++)
+                if (k == 0 || factors[k] != factors[k - 1])
+                    logs += (int)lround(log2((double)factors[k]));
+
+            if (logs >= threshold)
+            {
+                is_valid = next < count && positions[next] == i;
+                next++;
+                expected_count++;
+            }
+        }
+        is_valid = is_valid && next == count;
+
+        printf("f(i) = %lld i^2 + %lld i + %lld, B = %llu, %d thread(s): %zu of %zu positions %s\n",
+               (long long)forms[f].c2, (long long)forms[f].c1, (long long)forms[f].c0,
+               (unsigned long long)bounds[f], thread_counts[f], count, expected_count,
+               is_valid ? "match" : "mismatch");
+        free(positions);
+    }
+
+    if (is_valid)
+        printf("Success: logarithmic sieve positions match the factorizations\n");
+    else
+        printf("Error: logarithmic sieve mismatch\n");
+
+    return is_valid;
+}
+
+/**
+ * @brief Tests the native Montgomery primality tests
+ *
+ * Compares the 128-bit BPSW test with mpz_probab_prime_p, and the fixed-width
+ * 256/512/1024-bit base-2 SPRP kernels with a GMP reference, on random odd
+ * numbers and primes of each size.
+ *
+ * @return 1 if all results agree, 0 otherwise
+ */
+int testing_montgomery(void)
+{
+    print_line(92);
+    printf("Testing Montgomery primality tests against GMP");
+    print_line(92);
+
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, 137);
+
+    mpz_t n;
+    mpz_init(n);
+    int mismatches = 0;
+
+    int bit_sizes[] = {64, 100, 126, 256, 512, 1024};
+    for (int k = 0; k < 6; k++)
+    {
+        int bits = bit_sizes[k];
+        for (int i = 0; i < 200; i++)
+        {
+            mpz_urandomb(n, state, bits);
+            mpz_setbit(n, bits - 1);
+            mpz_setbit(n, 0);
+            if (i % 4 == 0)
+                mpz_nextprime(n, n);
+
+            int is_match;
+            __uint128_t n128;
+            if (u128_from_mpz(&n128, n) && n128 < U128_PRIME_LIMIT)
+                is_match = u128_is_prime(n128) == (mpz_probab_prime_p(n, TEST_ROUNDS) > 0);
+            else
+                is_match = mont_is_sprp2(n) == gmp_is_sprp2(n);
+
+            // the tiered test must agree with GMP at every size
+            is_match = is_match && (iZ_probab_prime(n, TEST_ROUNDS) > 0) == (mpz_probab_prime_p(n, TEST_ROUNDS) > 0);
+            mismatches += !is_match;
+        }
+        printf("%4d bits: %s\n", bits, mismatches ? "mismatch" : "match");
+    }
+
+    mpz_clear(n);
+    gmp_randclear(state);
+
+    if (mismatches == 0)
+        printf("Success: Montgomery primality tests match GMP\n");
+    else
+        printf("Error: %d Montgomery primality test mismatches\n", mismatches);
+
+    return mismatches == 0;
+}
+
+/**
+ * @brief Tests the phase accounting of the performance counters
+ *
+ * Nests an io phase in a marking phase, checks the calls, the exclusive times of
+ * the phases within the run and the events reported available; hooks outside a
+ * counting run must be ignored. The counts themselves depend on the PMU access
+ * of the host and are not checked.
+ *
+ * @return 1 if the accounting is consistent, 0 otherwise
+ */
+int testing_perf_counters(void)
+{
+    print_line(92);
+    printf("Testing performance counter phases");
+    print_line(92);
+
+    iz_perf_phase_begin(IZ_PERF_PRIMALITY); // ignored, not counting
+    iz_perf_phase_end();
+
+    int events = iz_perf_start();
+
+    BITMAP *bitmap = bitmap_create(VX6);
+    iz_perf_phase_begin(IZ_PERF_MARKING);
+    bitmap_set_all(bitmap);
+    bitmap_clear_mod_p(bitmap, 7, 3, bitmap->size);
+    iz_perf_phase_begin(IZ_PERF_IO);
+    size_t count = bitmap_popcount(bitmap);
+    iz_perf_phase_end();
+    iz_perf_phase_end();
+    bitmap_free(bitmap);
+
+    IZ_PERF_REPORT report;
+    iz_perf_stop(&report);
+
+    int available = 0;
+    for (int e = 0; e < IZ_PERF_EVENTS; e++)
+        available += report.available[e];
+
+    const IZ_PERF_TOTALS *marking = &report.phase[IZ_PERF_MARKING];
+    const IZ_PERF_TOTALS *io = &report.phase[IZ_PERF_IO];
+    int is_valid = count == VX6 - (VX6 - 3 + 6) / 7 && available == events &&
+                   marking->calls == 1 && io->calls == 1 && report.phase[IZ_PERF_PRIMALITY].calls == 0 &&
+                   marking->seconds > 0 && io->seconds > 0 &&
+                   marking->seconds + io->seconds <= report.total.seconds;
+
+    printf("%d of %d events available, marking %.1f us, io %.1f us, run %.1f us\n", events, IZ_PERF_EVENTS,
+           1e6 * marking->seconds, 1e6 * io->seconds, 1e6 * report.total.seconds);
+
+    if (is_valid)
+        printf("Success: Performance counter phases are consistent\n");
+    else
+        printf("Error: Performance counter phases are inconsistent\n");
+
+    return is_valid;
+}
+
 /**
  * @brief Tests VX_OBJ I/O operations
  *
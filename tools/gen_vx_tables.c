@@ -0,0 +1,231 @@
+/**
+ * @file gen_vx_tables.c
+ * @brief Build-time generator of the static VX_ASSETS tables compiled into the library.
+ *
+ * @description:
+ * This program is built and run by the Makefile before the library is compiled.
+ * For each requested vx standard (e.g. 6 for VX6 = 5 * 7 * 11 * 13 * 17 * 19) it
+ * emits, as `static const` C arrays:
+ * - the root primes up to vx, as returned by sieve_iZ(vx),
+ * - the pre-sieved base_x5 and base_x7 bitmaps, as built by construct_iZm_segment(vx),
+ * - the ROOT_PRIME_TABLE columns of the root primes: p, x_p normalized for each
+ *   matrix, vx mod p (0 for the primes that divide vx) and the reciprocal of p.
+ *
+ * A bit x in [1:vx] of the base segment is set iff iZ(x, -1) (base_x5) or iZ(x, 1)
+ * (base_x7) is coprime to vx, which is exactly what the Xp-Wheel construction leaves
+ * unmarked. All other bits are 0. The bitmaps are vx + 10 bits, like vx_assets_init.
+ *
+ * The generated file defines vx_static_assets[], looked up by vx_assets_static().
+ * It depends only on the C standard library, so it can run before anything else is built.
+ *
+ * @usage:
+ * gen_vx_tables 6 7 > vx_tables.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// iZ primes that can be multiplied into a vx standard: VX1 = 5, ..., VX8 = 5 * ... * 29
+static const uint64_t s_primes[] = {5, 7, 11, 13, 17, 19, 23, 29};
+#define MAX_VX_STD (int)(sizeof(s_primes) / sizeof(s_primes[0]))
+
+/**
+ * @brief Returns 1 if n is coprime to every prime factor of vx_std.
+ */
+static int is_coprime_to_vx(uint64_t n, int vx_std)
+{
+    for (int i = 0; i < vx_std; i++)
+        if (n % s_primes[i] == 0)
+            return 0;
+    return 1;
+}
+
+/**
+ * @brief Emits a byte array in hexadecimal, 16 bytes per line.
+ */
+static void emit_bytes(const char *name, const unsigned char *data, size_t byte_size)
+{
+    printf("static const unsigned char %s[%zu] = {", name, byte_size);
+    for (size_t i = 0; i < byte_size; i++)
+        printf("%s0x%02x,", i % 16 == 0 ? "\n    " : " ", data[i]);
+    printf("\n};\n\n");
+}
+
+// Columns of the root primes table, see ROOT_PRIME_TABLE in vx_obj.h
+enum
+{
+    COL_P,
+    COL_X5_P,
+    COL_X7_P,
+    COL_VX_MOD_P,
+    COL_P_INV
+};
+
+/**
+ * @brief Returns the value of a root prime table column for p.
+ */
+static uint64_t root_column_value(int column, uint64_t p, uint64_t vx)
+{
+    // x_p normalized for iZm5 and iZm7, as root_table_init
+    uint64_t x_p = (p + 1) / 6;
+    int p_id = (p % 6 == 1) ? 1 : -1;
+
+    switch (column)
+    {
+    case COL_X5_P:
+        return p_id == -1 ? x_p : p - x_p;
+    case COL_X7_P:
+        return p_id == 1 ? x_p : p - x_p;
+    case COL_VX_MOD_P:
+        return vx % p;
+    case COL_P_INV:
+        return UINT64_MAX / p; // fast_mod_inv(p), see fast_mod.h
+    default:
+        return p;
+    }
+}
+
+/**
+ * @brief Emits one column over the primes up to vx, 12 values per line.
+ */
+static void emit_root_column(const char *type, const char *name, int column,
+                             const unsigned char *composite, uint64_t vx)
+{
+    size_t i = 0;
+    printf("static const %s %s[] = {", type, name);
+    for (uint64_t n = 2; n <= vx; n++)
+    {
+        if (composite[n])
+            continue;
+        // reciprocals exceed INT64_MAX for p = 2, hence the suffix
+        printf("%s%llu%s,", i % 12 == 0 ? "\n    " : " ", (unsigned long long)root_column_value(column, n, vx),
+               column == COL_P_INV ? "ULL" : "");
+        i++;
+    }
+    printf("\n};\n\n");
+}
+
+/**
+ * @brief Emits the root primes and base bitmaps of one vx standard.
+ */
+static int emit_vx_table(int vx_std)
+{
+    uint64_t vx = 1;
+    for (int i = 0; i < vx_std; i++)
+        vx *= s_primes[i];
+
+    // 1. Root primes up to vx (sieve of Eratosthenes, byte per number)
+    unsigned char *composite = calloc(vx + 1, 1);
+    if (composite == NULL)
+    {
+        fprintf(stderr, "gen_vx_tables: memory allocation failed for vx%d\n", vx_std);
+        return 0;
+    }
+
+    for (uint64_t p = 2; p * p <= vx; p++)
+        if (!composite[p])
+            for (uint64_t m = p * p; m <= vx; m += p)
+                composite[m] = 1;
+
+    size_t p_count = 0;
+    for (uint64_t n = 2; n <= vx; n++)
+        p_count += !composite[n];
+
+    // Root primes as PRIMES_OBJ array and ROOT_PRIME_TABLE columns
+    char name[64];
+    snprintf(name, sizeof(name), "vx%d_root_primes", vx_std);
+    emit_root_column("uint64_t", name, COL_P, composite, vx);
+    snprintf(name, sizeof(name), "vx%d_rt_p", vx_std);
+    emit_root_column("uint32_t", name, COL_P, composite, vx);
+    snprintf(name, sizeof(name), "vx%d_rt_x5_p", vx_std);
+    emit_root_column("uint32_t", name, COL_X5_P, composite, vx);
+    snprintf(name, sizeof(name), "vx%d_rt_x7_p", vx_std);
+    emit_root_column("uint32_t", name, COL_X7_P, composite, vx);
+    snprintf(name, sizeof(name), "vx%d_rt_vx_mod_p", vx_std);
+    emit_root_column("uint32_t", name, COL_VX_MOD_P, composite, vx);
+    snprintf(name, sizeof(name), "vx%d_rt_p_inv", vx_std);
+    emit_root_column("uint64_t", name, COL_P_INV, composite, vx);
+    free(composite);
+
+    // 2. Pre-sieved base segment of vx + 10 bits
+    size_t bits = vx + 10;
+    size_t byte_size = (bits + 7) / 8;
+    unsigned char *x5 = calloc(byte_size, 1);
+    unsigned char *x7 = calloc(byte_size, 1);
+    if (x5 == NULL || x7 == NULL)
+    {
+        fprintf(stderr, "gen_vx_tables: memory allocation failed for vx%d bitmaps\n", vx_std);
+        free(x5);
+        free(x7);
+        return 0;
+    }
+
+    for (uint64_t x = 1; x <= vx; x++)
+    {
+        if (is_coprime_to_vx(6 * x - 1, vx_std))
+            x5[x / 8] |= 1 << (x % 8);
+        if (is_coprime_to_vx(6 * x + 1, vx_std))
+            x7[x / 8] |= 1 << (x % 8);
+    }
+
+    snprintf(name, sizeof(name), "vx%d_base_x5_data", vx_std);
+    emit_bytes(name, x5, byte_size);
+    snprintf(name, sizeof(name), "vx%d_base_x7_data", vx_std);
+    emit_bytes(name, x7, byte_size);
+    free(x5);
+    free(x7);
+
+    // 3. Static structures pointing at the tables, never written nor freed
+    printf("static PRIMES_OBJ vx%d_root_primes_obj = {%zu, (uint64_t *)vx%d_root_primes, {0}};\n", vx_std, p_count, vx_std);
+    printf("static BITMAP vx%d_base_x5 = {%zu, (unsigned char *)vx%d_base_x5_data, {0}};\n", vx_std, bits, vx_std);
+    printf("static BITMAP vx%d_base_x7 = {%zu, (unsigned char *)vx%d_base_x7_data, {0}};\n", vx_std, bits, vx_std);
+    // root primes 2, 3 and the vx_std primes that divide vx are skipped by the sieve
+    printf("static ROOT_PRIME_TABLE vx%d_root_table = {%zu, %d, (uint32_t *)vx%d_rt_p, (uint32_t *)vx%d_rt_x5_p, "
+           "(uint32_t *)vx%d_rt_x7_p, (uint32_t *)vx%d_rt_vx_mod_p, (uint64_t *)vx%d_rt_p_inv};\n",
+           vx_std, p_count, 2 + vx_std, vx_std, vx_std, vx_std, vx_std, vx_std);
+    printf("static VX_ASSETS vx%d_assets = {%llu, &vx%d_root_primes_obj, &vx%d_base_x5, &vx%d_base_x7, &vx%d_root_table, 1};\n\n",
+           vx_std, (unsigned long long)vx, vx_std, vx_std, vx_std, vx_std);
+
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <vx standard>... (e.g. 6 7)\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int vx_stds[MAX_VX_STD];
+    int vx_count = 0;
+
+    for (int i = 1; i < argc && vx_count < MAX_VX_STD; i++)
+    {
+        int vx_std = atoi(argv[i]);
+        // VX1 and VX2 are smaller than the minimum vx of 35 built by construct_vx2
+        if (vx_std < 2 || vx_std > MAX_VX_STD)
+        {
+            fprintf(stderr, "gen_vx_tables: vx standard must be in [2:%d], got '%s'\n", MAX_VX_STD, argv[i]);
+            return EXIT_FAILURE;
+        }
+        vx_stds[vx_count++] = vx_std;
+    }
+
+    printf("// Generated by tools/gen_vx_tables.c, do not edit.\n\n");
+    printf("#include <iZ.h>\n\n");
+
+    for (int i = 0; i < vx_count; i++)
+        if (!emit_vx_table(vx_stds[i]))
+            return EXIT_FAILURE;
+
+    printf("VX_ASSETS *const vx_static_assets[] = {");
+    for (int i = 0; i < vx_count; i++)
+        printf("%s&vx%d_assets", i ? ", " : "", vx_stds[i]);
+    printf("};\n");
+    printf("const int vx_static_assets_count = %d;\n", vx_count);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file iz_bench.c
+ * @brief iz-bench: runs a benchmark suite of the library on its own, outside of
+ * the demo program, and saves its results to the output directory.
+ *
+ * @description:
+ * The suites are selected by name:
+ * - bitmap: the BITMAP primitives in ns per bit or per mark, on bitmaps sized
+ *   from the L1 cache to DRAM (see benchmark_bitmap_primitives),
+ * - perf: hardware performance counters per library phase, per prime or per
+ *   segment (see benchmark_perf_counters),
+ * - scaling: throughput, speedup, efficiency and CPU utilization of the parallel
+ *   paths at 1, 2, 4, ... threads (see benchmark_thread_scaling).
+ *
+ * @usage:
+ * make bench-bitmap                        # all sizes, CSV saved to output/
+ * build/tools/iz-bench -m 8 -n bitmap      # bitmaps up to 8 MB, not saved
+ * make clean && make IZ_PERF=1 bench-perf  # counters of the instrumented phases
+ * build/tools/iz-bench -q perf             # quick run, smaller inputs
+ * make bench-scaling                       # up to one thread per online CPU, CSV saved to output/
+ * build/tools/iz-bench -t 64 -q scaling    # up to 64 threads, smaller inputs
+ */
+
+#include <benchmark.h>
+#include <unistd.h> // For getopt
+
+int main(int argc, char **argv)
+{
+    size_t max_bytes = 0;
+    int save_results = 1, quick = 0, max_threads = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "m:nqt:h")) != -1)
+    {
+        switch (option)
+        {
+        case 'm':
+            max_bytes = (size_t)strtoull(optarg, NULL, 10) << 20;
+            break;
+        case 'n':
+            save_results = 0;
+            break;
+        case 'q':
+            quick = 1;
+            break;
+        case 't':
+            max_threads = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-m max_MB] [-n] [-q] [-t max_threads] bitmap|perf|scaling\n", argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        fprintf(stderr, "usage: %s [-m max_MB] [-n] [-q] [-t max_threads] bitmap|perf|scaling\n", argv[0]);
+        return 1;
+    }
+
+    const char *suite = argv[optind];
+    if (strcmp(suite, "bitmap") == 0)
+        benchmark_bitmap_primitives(max_bytes, save_results);
+    else if (strcmp(suite, "perf") == 0)
+        benchmark_perf_counters(quick);
+    else if (strcmp(suite, "scaling") == 0)
+        benchmark_thread_scaling(max_threads, quick, save_results);
+    else
+    {
+        fprintf(stderr, "%s: unknown suite %s\n", argv[0], suite);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,365 @@
+/**
+ * @file iz_tune.c
+ * @brief iz-tune: benchmarks the tunable parameters of the library on this host
+ * and writes a tuning profile (see include/tuning.h).
+ *
+ * @description:
+ * Starting from the compiled-in defaults, each parameter is swept in turn with
+ * the best values found so far applied (coordinate descent), timing the sieve
+ * it affects, best of a few runs:
+ * - izm_block_rows, vx_limit: sieve_iZm,
+ * - pattern_max_p: sieve_iZm and sieve_vx6_range,
+ * - vx_block_rows: sieve_vx6_range,
+ * - w30_segment_bytes: sieve_wheel30_count,
+ * - vx_sieve_depth: sieve_vx6_range at a huge y, where survivors are primality tested,
+ * - mont_tier_max_bits: iZ_probab_prime with and without the fixed-width tier,
+ *   on odd candidates free of factors below 1000, per size,
+ * - threads: sieve_vx6_range_parallel from 1 to the online CPUs.
+ *
+ * test_rounds trades speed for certainty, not one setting for another, so it
+ * is not benchmarked: it keeps its default unless set with -r.
+ *
+ * @usage:
+ * make tune                            # writes iz-tune.profile in the repository root
+ * build/tools/iz-tune -q -o my.profile # quick run, smaller inputs
+ * IZ_TUNE_PROFILE=my.profile ./build/src/iZ
+ */
+
+#include <benchmark.h>
+#include <unistd.h> // For getopt, sysconf
+
+#define TUNE_RUNS 3 ///< Runs per measurement, the best is kept
+
+/**
+ * @struct TUNE_INPUTS
+ * @brief The inputs of the timed runs, scaled down by -q.
+ */
+typedef struct
+{
+    uint64_t izm_n;      ///< Limit of sieve_iZm
+    uint64_t w30_n;      ///< Limit of sieve_wheel30_count
+    int range_y;         ///< Segments of sieve_vx6_range
+    const char *huge_y;  ///< y of the sieve depth runs
+    int huge_range_y;    ///< Segments of the sieve depth runs
+    int prime_tests;     ///< Candidates per size of the tier runs
+} TUNE_INPUTS;
+
+/**
+ * @struct TUNE_PRIME_TESTS
+ * @brief The candidates of a timed run of iZ_probab_prime.
+ */
+typedef struct
+{
+    mpz_t *candidates; ///< Odd candidates of one size
+    int count;         ///< Number of candidates
+} TUNE_PRIME_TESTS;
+
+/**
+ * @struct TUNE_RANGE
+ * @brief The range and thread count of a timed run of sieve_vx6_range_parallel.
+ */
+typedef struct
+{
+    int range_y; ///< Segments sieved
+    int threads; ///< Threads of the run
+} TUNE_RANGE;
+
+static TUNE_INPUTS inputs;
+static IZ_TUNING best;
+
+// The timed runs, as bench_fn for bench_measure
+
+static void run_izm(void *ctx, int run)
+{
+    (void)ctx;
+    (void)run;
+    primes_obj_free(sieve_iZm(inputs.izm_n));
+}
+
+// y = 10^5 keeps 6 * y * VX6 below VX6^2, where the root primes cover the segments
+static void run_vx_range(void *ctx, int run)
+{
+    (void)ctx;
+    (void)run;
+    vx_range_free(sieve_vx6_range("100000", inputs.range_y));
+}
+
+static void run_izm_and_vx_range(void *ctx, int run)
+{
+    run_izm(ctx, run);
+    run_vx_range(ctx, run);
+}
+
+static void run_w30(void *ctx, int run)
+{
+    (void)ctx;
+    (void)run;
+    sieve_wheel30_count(inputs.w30_n, 0, 1);
+}
+
+// y = 10^20 is past the root primes, survivors are tested by the 128-bit BPSW path
+static void run_huge_y(void *ctx, int run)
+{
+    (void)ctx;
+    (void)run;
+    vx_range_free(sieve_vx6_range((char *)inputs.huge_y, inputs.huge_range_y));
+}
+
+static void run_prime_tests(void *ctx, int run)
+{
+    (void)run;
+    TUNE_PRIME_TESTS *tests = ctx;
+    for (int i = 0; i < tests->count; i++)
+        iZ_probab_prime(tests->candidates[i], best.test_rounds);
+}
+
+static void run_vx_range_parallel(void *ctx, int run)
+{
+    (void)run;
+    TUNE_RANGE *range = ctx;
+    vx_range_free(sieve_vx6_range_parallel("100000", range->range_y, range->threads));
+}
+
+/**
+ * @brief Applies a profile and returns the best time of a run over TUNE_RUNS runs.
+ */
+static double time_profile(const IZ_TUNING *tuning, bench_fn run, void *ctx)
+{
+    iz_tuning_apply(tuning);
+
+    BENCH_STATS stats;
+    if (!bench_measure(run, ctx, 0, TUNE_RUNS, NULL, &stats))
+        return -1;
+
+    return stats.min;
+}
+
+/**
+ * @brief Sweeps an int field of the best profile over values, keeping the fastest.
+ *
+ * @param name The profile key, for the report.
+ * @param field The field of `best` to sweep.
+ * @param values The candidate values.
+ * @param count The number of candidates.
+ * @param run The timed run.
+ */
+static void sweep_int(const char *name, int *field, const int *values, int count, bench_fn run)
+{
+    int best_value = *field;
+    double best_time = -1;
+
+    printf("%-20s", name);
+    for (int i = 0; i < count; i++)
+    {
+        *field = values[i];
+        double seconds = time_profile(&best, run, NULL);
+        printf(" %d:%.3fs", values[i], seconds);
+        fflush(stdout);
+
+        // keep the earlier value unless clearly faster
+        if (best_time < 0 || seconds < 0.98 * best_time)
+        {
+            best_time = seconds;
+            best_value = values[i];
+        }
+    }
+
+    *field = best_value;
+    printf("  -> %d\n", best_value);
+}
+
+/**
+ * @brief Sweeps the wheel-30 segment size from 16 KB to 2 MB.
+ */
+static void sweep_w30_segment(void)
+{
+    size_t best_value = best.w30_segment_bytes;
+    double best_time = -1;
+
+    printf("%-20s", "w30_segment_bytes");
+    for (size_t bytes = 16 << 10; bytes <= (2 << 20); bytes *= 2)
+    {
+        best.w30_segment_bytes = bytes;
+        double seconds = time_profile(&best, run_w30, NULL);
+        printf(" %zuK:%.3fs", bytes >> 10, seconds);
+        fflush(stdout);
+
+        if (best_time < 0 || seconds < 0.98 * best_time)
+        {
+            best_time = seconds;
+            best_value = bytes;
+        }
+    }
+
+    best.w30_segment_bytes = best_value;
+    printf("  -> %zu\n", best_value);
+}
+
+/**
+ * @brief Draws a random odd number of the given size without prime factors below 1000.
+ */
+static void random_candidate(mpz_t n, int bits, gmp_randstate_t state, PRIMES_OBJ *small_primes)
+{
+    for (;;)
+    {
+        mpz_urandomb(n, state, bits);
+        mpz_setbit(n, bits - 1);
+        mpz_setbit(n, 0);
+
+        int i = 1; // skip 2
+        while (i < small_primes->p_count && mpz_fdiv_ui(n, small_primes->p_array[i]) != 0)
+            i++;
+        if (i == small_primes->p_count)
+            return;
+    }
+}
+
+/**
+ * @brief Times iZ_probab_prime on the same candidates with the tier bound at max_bits.
+ */
+static double time_prime_tests(mpz_t *candidates, int count, int max_bits)
+{
+    best.mont_tier_max_bits = max_bits;
+    TUNE_PRIME_TESTS tests = {candidates, count};
+    return time_profile(&best, run_prime_tests, &tests);
+}
+
+/**
+ * @brief Finds the largest candidate size up to which the fixed-width tier pays off.
+ */
+static void sweep_mont_tier(void)
+{
+    static const int sizes[] = {192, 256, 384, 512, 768, 1024};
+    int count = inputs.prime_tests;
+
+    PRIMES_OBJ *small_primes = sieve_iZ(1000);
+    mpz_t *candidates = malloc(count * sizeof(mpz_t));
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, 137);
+
+    int tier_bits = 0;
+    printf("%-20s", "mont_tier_max_bits");
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            mpz_init(candidates[i]);
+            random_candidate(candidates[i], sizes[s], state, small_primes);
+        }
+
+        double with_tier = time_prime_tests(candidates, count, sizes[s]);
+        double without_tier = time_prime_tests(candidates, count, 0);
+        printf(" %d:%.2fx", sizes[s], without_tier / with_tier);
+        fflush(stdout);
+
+        for (int i = 0; i < count; i++)
+            mpz_clear(candidates[i]);
+
+        // the tier covers a prefix of sizes: stop at the first size it slows down
+        if (with_tier >= without_tier)
+            break;
+        tier_bits = sizes[s];
+    }
+
+    best.mont_tier_max_bits = tier_bits;
+    printf("  -> %d\n", tier_bits);
+
+    gmp_randclear(state);
+    free(candidates);
+    primes_obj_free(small_primes);
+}
+
+/**
+ * @brief Times sieve_vx6_range_parallel from 1 to the online CPUs, in powers of two.
+ */
+static void sweep_threads(void)
+{
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    TUNE_RANGE range = {MAX(inputs.range_y, 4 * cpus), 1};
+    int best_threads = 1;
+    double best_rate = -1;
+
+    printf("%-20s", "threads");
+    for (int threads = 1;; threads = MIN(2 * threads, cpus))
+    {
+        range.threads = threads;
+        double rate = range.range_y / time_profile(&best, run_vx_range_parallel, &range);
+        printf(" %d:%.1f/s", threads, rate);
+        fflush(stdout);
+
+        if (best_rate < 0 || rate > 1.02 * best_rate)
+        {
+            best_rate = rate;
+            best_threads = threads;
+        }
+
+        if (threads >= cpus)
+            break;
+    }
+
+    // 0 follows the CPU count if the profile moves to another host of the same kind
+    best.threads = best_threads == cpus ? 0 : best_threads;
+    printf("  -> %d\n", best.threads);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = IZ_TUNE_DEFAULT_PATH;
+    int quick = 0, rounds = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "o:qr:h")) != -1)
+    {
+        switch (option)
+        {
+        case 'o':
+            path = optarg;
+            break;
+        case 'q':
+            quick = 1;
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-o profile] [-q] [-r test_rounds]\n", argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+
+    inputs.izm_n = quick ? 100000000ULL : 1000000000ULL;
+    inputs.w30_n = quick ? 400000000ULL : 4000000000ULL;
+    inputs.range_y = quick ? 16 : 64;
+    inputs.huge_y = "100000000000000000000";
+    inputs.huge_range_y = quick ? 1 : 2;
+    inputs.prime_tests = quick ? 500 : 2000;
+
+    iz_tuning_defaults(&best);
+    if (rounds > 0)
+        best.test_rounds = rounds;
+
+    printf("iz-tune: %ld CPU(s), %d NUMA node(s)%s\n", sysconf(_SC_NPROCESSORS_ONLN), numa_node_count(),
+           quick ? ", quick run" : "");
+
+    static const int block_rows[] = {1, 2, 4, 8, 16};
+    static const int vx_limits[] = {4, 5, 6, 7};
+    static const int pattern_limits[] = {3, 32, 64, 128};
+    int depths[] = {0, VX6 / 4, VX6 / 16, VX6 / 64};
+
+    sweep_int("izm_block_rows", &best.izm_block_rows, block_rows, 5, run_izm);
+    sweep_int("vx_limit", &best.vx_limit, vx_limits, 4, run_izm);
+    sweep_int("pattern_max_p", &best.pattern_max_p, pattern_limits, 4, run_izm_and_vx_range);
+    sweep_int("vx_block_rows", &best.vx_block_rows, block_rows, 5, run_vx_range);
+    sweep_w30_segment();
+    sweep_int("vx_sieve_depth", &best.vx_sieve_depth, depths, 4, run_huge_y);
+    sweep_mont_tier();
+    sweep_threads();
+
+    iz_tuning_apply(&best);
+    if (!iz_tuning_save(iz_tuning(), path))
+        return 1;
+
+    printf("Profile written to %s\n", path);
+    return 0;
+}